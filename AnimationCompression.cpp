@@ -0,0 +1,511 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "AnimationCompression.h"
+#include "AnimationSampler.h"
+#include "CpuSkinning.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+
+constexpr uint32_t MAX_SEGMENT_KEYS = 256; // Longest run of source keys one interpolated segment may replace
+constexpr uint32_t MAX_TIGHTEN_PASSES = 6;  // Reductions, from 4x the budgets down to 1/8, before a clip is left uncompressed
+
+inline uint16_t ToUNorm16(float v) {
+    v = std::max(0.0f, std::min(1.0f, v));
+    return static_cast<uint16_t>(lroundf(v * 65535.0f));
+}
+
+// Angle between two rotations, accurate for the tiny angles compared here (acos of the dot isn't)
+float RotationError(FXMVECTOR q, FXMVECTOR reference) {
+    XMVECTOR r = XMVectorGetX(XMVector4Dot(q, reference)) < 0.0f ? XMVectorNegate(reference) : reference;
+    float chord = XMVectorGetX(XMVector4Length(XMVectorSubtract(q, r)));
+    return 4.0f * std::asin(std::min(chord * 0.5f, 1.0f));
+}
+
+XMVECTOR NLerp(FXMVECTOR q0, FXMVECTOR q1In, float alpha) {
+    XMVECTOR q1 = XMVectorGetX(XMVector4Dot(q0, q1In)) < 0.0f ? XMVectorNegate(q1In) : q1In;
+    return XMQuaternionNormalize(XMVectorLerp(q0, q1, alpha));
+}
+
+// One source track prepared for reduction: source and quantized-decoded keys side by side
+struct ReductionTrack {
+    const float* Times = nullptr;
+    std::vector<XMFLOAT4A> Source;
+    std::vector<XMFLOAT4A> Decoded;
+    std::vector<uint16_t> Ticks;
+    std::vector<uint16_t> Packed; // 3 per key
+    CompressedTrack Range;
+    bool IsRotation = false;
+    float Tolerance = 0.0f; // Model units for positions, radians for rotations, scale units for scales
+};
+
+float KeyError(const ReductionTrack& track, FXMVECTOR value, size_t sourceKey) {
+    XMVECTOR source = XMLoadFloat4A(&track.Source[sourceKey]);
+    return track.IsRotation ? RotationError(value, source) : XMVectorGetX(XMVector3Length(XMVectorSubtract(value, source)));
+}
+
+// Indices of the keys to keep: greedy, each segment is grown while interpolating its (decoded) end keys
+// reproduces every source key in between within tolerance
+std::vector<uint32_t> ReduceKeys(const ReductionTrack& track, float ticksToTime) {
+    const uint32_t count = static_cast<uint32_t>(track.Source.size());
+    std::vector<uint32_t> kept;
+    if (count == 0) {
+        return kept;
+    }
+    kept.push_back(0);
+
+    // Constant track (common for scales and most translations): one key
+    XMVECTOR first = XMLoadFloat4A(&track.Decoded[0]);
+    bool constant = true;
+    for (uint32_t i = 0; i < count && constant; ++i) {
+        constant = KeyError(track, first, i) <= track.Tolerance;
+    }
+    if (constant) {
+        return kept;
+    }
+
+    uint32_t anchor = 0;
+    while (anchor + 1 < count) {
+        uint32_t end = anchor + 1;
+        XMVECTOR a = XMLoadFloat4A(&track.Decoded[anchor]);
+        float timeA = track.Ticks[anchor] * ticksToTime;
+        for (uint32_t candidate = anchor + 2; candidate < count && candidate - anchor <= MAX_SEGMENT_KEYS; ++candidate) {
+            XMVECTOR b = XMLoadFloat4A(&track.Decoded[candidate]);
+            float span = track.Ticks[candidate] * ticksToTime - timeA;
+            bool fits = true;
+            for (uint32_t i = anchor + 1; i < candidate && fits; ++i) {
+                float alpha = span > 0.0f ? std::min(std::max((track.Times[i] - timeA) / span, 0.0f), 1.0f) : 0.0f;
+                XMVECTOR value = track.IsRotation ? NLerp(a, b, alpha) : XMVectorLerp(a, b, alpha);
+                fits = KeyError(track, value, i) <= track.Tolerance;
+            }
+            if (!fits) {
+                break;
+            }
+            end = candidate;
+        }
+        kept.push_back(end);
+        anchor = end;
+    }
+    return kept;
+}
+
+// Quantizes every key of a track (values, times) and decodes them again for the reduction
+void QuantizeTrack(ReductionTrack& track, float timeToTicks) {
+    const size_t count = track.Source.size();
+    track.Decoded.resize(count);
+    track.Ticks.resize(count);
+    track.Packed.resize(count * 3);
+    for (size_t i = 0; i < count; ++i) {
+        track.Ticks[i] = ToUNorm16(track.Times[i] * timeToTicks / 65535.0f);
+    }
+
+    if (track.IsRotation) {
+        for (size_t i = 0; i < count; ++i) {
+            AnimationCompressor::PackQuaternion(XMLoadFloat4A(&track.Source[i]), &track.Packed[i * 3]);
+            XMStoreFloat4A(&track.Decoded[i], AnimationCompressor::UnpackQuaternion(&track.Packed[i * 3]));
+        }
+        return;
+    }
+
+    XMVECTOR minimum = XMLoadFloat4A(&track.Source[0]);
+    XMVECTOR maximum = minimum;
+    for (size_t i = 1; i < count; ++i) {
+        minimum = XMVectorMin(minimum, XMLoadFloat4A(&track.Source[i]));
+        maximum = XMVectorMax(maximum, XMLoadFloat4A(&track.Source[i]));
+    }
+    XMStoreFloat3(&track.Range.RangeMin, minimum);
+    XMStoreFloat3(&track.Range.RangeExtent, XMVectorSubtract(maximum, minimum));
+    const float* rangeMin = &track.Range.RangeMin.x;
+    const float* extent = &track.Range.RangeExtent.x;
+    for (size_t i = 0; i < count; ++i) {
+        const float* value = &track.Source[i].x;
+        for (int axis = 0; axis < 3; ++axis) {
+            track.Packed[i * 3 + axis] = extent[axis] > 0.0f ? ToUNorm16((value[axis] - rangeMin[axis]) / extent[axis]) : 0;
+        }
+        XMStoreFloat4A(&track.Decoded[i], AnimationCompressor::UnpackRange(&track.Packed[i * 3], track.Range));
+    }
+}
+
+// Largest error of the track's quantized keys; reduction can't get below it
+float QuantizationError(const ReductionTrack& track) {
+    float maxError = 0.0f;
+    for (size_t i = 0; i < track.Source.size(); ++i) {
+        maxError = std::max(maxError, KeyError(track, XMLoadFloat4A(&track.Decoded[i]), i));
+    }
+    return maxError;
+}
+
+// Stores the compressed arrays in 'clip' and releases the float keys of every track that has them
+void ApplyCompression(AnimationClip& clip, float duration, const std::vector<CompressedTrack>& tracks, const std::vector<uint16_t>& keyTimes,
+                      const std::vector<uint16_t>& keyValues, const std::vector<uint8_t>& floatTracks) {
+    clip.Duration = duration;
+    clip.CompressedTracks.assign(tracks.begin(), tracks.end());
+    clip.KeyTimes.assign(keyTimes.begin(), keyTimes.end());
+    clip.KeyValues.assign(keyValues.begin(), keyValues.end());
+    auto release = [](auto& keys) { std::remove_reference_t<decltype(keys)>(keys.get_allocator()).swap(keys); };
+    for (size_t c = 0; c < clip.Channels.size(); ++c) {
+        AnimationChannel& channel = clip.Channels[c];
+        if (!floatTracks[c * 3 + AnimationCompressor::PositionTrack]) {
+            release(channel.PositionTimestamps);
+            release(channel.Positions);
+        }
+        if (!floatTracks[c * 3 + AnimationCompressor::RotationTrack]) {
+            release(channel.RotationTimestamps);
+            release(channel.Rotations);
+        }
+        if (!floatTracks[c * 3 + AnimationCompressor::ScaleTrack]) {
+            release(channel.ScaleTimestamps);
+            release(channel.Scales);
+        }
+    }
+}
+
+// Depth of every joint and a parents-first order (joints may be stored in any order)
+void GetJointDepths(const Skeleton& skeleton, std::vector<uint32_t>& outDepths, std::vector<uint32_t>& outOrder) {
+    const size_t jointCount = skeleton.Joints.size();
+    outDepths.assign(jointCount, 0);
+    for (size_t j = 0; j < jointCount; ++j) {
+        int parent = skeleton.Joints[j].ParentIndex;
+        // Bounded walk, so a broken (cyclic) hierarchy can't hang the cooker
+        for (size_t steps = 0; parent >= 0 && static_cast<size_t>(parent) < jointCount && steps < jointCount; ++steps) {
+            ++outDepths[j];
+            parent = skeleton.Joints[parent].ParentIndex;
+        }
+    }
+    outOrder.resize(jointCount);
+    for (size_t j = 0; j < jointCount; ++j) outOrder[j] = static_cast<uint32_t>(j);
+    std::stable_sort(outOrder.begin(), outOrder.end(), [&](uint32_t a, uint32_t b) { return outDepths[a] < outDepths[b]; });
+}
+
+// Largest model-space distance between the two poses of the joint origins and of points 'skinDistance'
+// away from each joint along its axes
+float MeasurePoseError(const Skeleton& skeleton, const std::vector<uint32_t>& order, const LocalPose& a, const LocalPose& b,
+                       float skinDistance, std::vector<XMFLOAT4X4>& scratchA, std::vector<XMFLOAT4X4>& scratchB) {
+    const size_t jointCount = skeleton.Joints.size();
+    scratchA.resize(jointCount);
+    scratchB.resize(jointCount);
+    auto toModel = [&](const LocalPose& pose, std::vector<XMFLOAT4X4>& out, uint32_t j) {
+        XMMATRIX local = XMMatrixAffineTransformation(XMLoadFloat4A(&pose.Scales[j]), XMVectorZero(), XMLoadFloat4A(&pose.Rotations[j]),
+                                                      XMLoadFloat4A(&pose.Translations[j]));
+        int parent = skeleton.Joints[j].ParentIndex;
+        if (parent >= 0 && static_cast<size_t>(parent) < jointCount) {
+            local = XMMatrixMultiply(local, XMLoadFloat4x4(&out[parent]));
+        }
+        XMStoreFloat4x4(&out[j], local);
+    };
+
+    float maxError = 0.0f;
+    const XMVECTOR points[4] = { XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(skinDistance, 0.0f, 0.0f, 1.0f),
+                                 XMVectorSet(0.0f, skinDistance, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, skinDistance, 1.0f) };
+    for (uint32_t j : order) {
+        toModel(a, scratchA, j);
+        toModel(b, scratchB, j);
+        XMMATRIX ma = XMLoadFloat4x4(&scratchA[j]);
+        XMMATRIX mb = XMLoadFloat4x4(&scratchB[j]);
+        for (const XMVECTOR& point : points) {
+            float error = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMVector3Transform(point, ma), XMVector3Transform(point, mb))));
+            maxError = std::max(maxError, error);
+        }
+    }
+    return maxError;
+}
+
+} // namespace
+
+size_t AnimationCompressor::ConvertToDualQuaternionKeys(AnimationClip& clip, const Skeleton& skeleton, float scaleTolerance) {
+    if (clip.IsCompressed()) {
+        return 0;
+    }
+    LocalPose bindPose;
+    AnimationSampler::GetBindPose(skeleton, bindPose);
+    const XMVECTOR tolerance = XMVectorReplicate(scaleTolerance);
+    const XMVECTOR one = XMVectorReplicate(1.0f);
+
+    // Linear position / nlerped rotation at 't', as the runtime sampler interpolates the source keys
+    auto sample = [](const AssetVector<float>& times, size_t count, float t, auto load, bool rotation, FXMVECTOR fallback) {
+        if (count == 0 || times.size() != count) return fallback;
+        size_t key = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+        if (key == 0) return load(0);
+        if (key >= count) return load(count - 1);
+        float span = times[key] - times[key - 1];
+        float alpha = span > 0.0f ? std::min(std::max((t - times[key - 1]) / span, 0.0f), 1.0f) : 0.0f;
+        XMVECTOR v0 = load(key - 1);
+        XMVECTOR v1 = load(key);
+        if (!rotation) return XMVectorLerp(v0, v1, alpha);
+        if (XMVectorGetX(XMVector4Dot(v0, v1)) < 0.0f) v1 = XMVectorNegate(v1);
+        return XMQuaternionNormalize(XMVectorLerp(v0, v1, alpha));
+    };
+
+    size_t converted = 0;
+    std::vector<float> times;
+    for (AnimationChannel& channel : clip.Channels) {
+        auto it = skeleton.JointNameToIndex.find(channel.TargetNodeId);
+        if (it == skeleton.JointNameToIndex.end() || it->second < 0 || static_cast<size_t>(it->second) >= skeleton.Joints.size() ||
+            !channel.DQs.empty() || (channel.Positions.empty() && channel.Rotations.empty())) {
+            continue;
+        }
+        const size_t joint = static_cast<size_t>(it->second);
+        bool rigid = true;
+        if (channel.Scales.empty()) {
+            rigid = XMVector3NearEqual(XMLoadFloat4A(&bindPose.Scales[joint]), one, tolerance);
+        }
+        for (const XMFLOAT3& scale : channel.Scales) {
+            rigid = rigid && XMVector3NearEqual(XMLoadFloat3(&scale), one, tolerance);
+        }
+        if (!rigid) {
+            continue;
+        }
+
+        const bool hasPositions = !channel.Positions.empty() && channel.PositionTimestamps.size() == channel.Positions.size();
+        const bool hasRotations = !channel.Rotations.empty() && channel.RotationTimestamps.size() == channel.Rotations.size();
+        times.clear();
+        if (hasPositions) times.insert(times.end(), channel.PositionTimestamps.begin(), channel.PositionTimestamps.end());
+        if (hasRotations) times.insert(times.end(), channel.RotationTimestamps.begin(), channel.RotationTimestamps.end());
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+        if (times.empty()) {
+            continue;
+        }
+
+        const XMVECTOR bindTranslation = XMLoadFloat4A(&bindPose.Translations[joint]);
+        const XMVECTOR bindRotation = XMLoadFloat4A(&bindPose.Rotations[joint]);
+        auto loadPosition = [&](size_t key) { return XMLoadFloat3(&channel.Positions[key]); };
+        auto loadRotation = [&](size_t key) { return XMQuaternionNormalize(XMLoadFloat4(&channel.Rotations[key])); };
+        AssetVector<float> dqTimes(channel.DQTimestamps.get_allocator());
+        AssetVector<DualQuaternion> dqs(channel.DQs.get_allocator());
+        dqTimes.assign(times.begin(), times.end());
+        dqs.reserve(times.size());
+        XMVECTOR previous = XMVectorZero();
+        for (float t : times) {
+            XMVECTOR position = sample(channel.PositionTimestamps, channel.Positions.size(), t, loadPosition, false, bindTranslation);
+            XMVECTOR rotation = sample(channel.RotationTimestamps, channel.Rotations.size(), t, loadRotation, true, bindRotation);
+            // Consecutive keys in one hemisphere, so blending neighbours never takes the long way round
+            if (XMVectorGetX(XMVector4Dot(previous, rotation)) < 0.0f) rotation = XMVectorNegate(rotation);
+            previous = rotation;
+            dqs.push_back(CpuSkinning::MakeDualQuaternion(rotation, position));
+        }
+        channel.DQTimestamps = std::move(dqTimes);
+        channel.DQs = std::move(dqs);
+        auto release = [](auto& keys) { std::remove_reference_t<decltype(keys)>(keys.get_allocator()).swap(keys); };
+        release(channel.PositionTimestamps);
+        release(channel.Positions);
+        release(channel.RotationTimestamps);
+        release(channel.Rotations);
+        ++converted;
+    }
+    return converted;
+}
+
+void AnimationCompressor::PackQuaternion(FXMVECTOR quaternion, uint16_t outPacked[3]) {
+    XMFLOAT4 q;
+    XMStoreFloat4(&q, XMQuaternionNormalize(quaternion));
+    float values[4] = { q.x, q.y, q.z, q.w };
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i) {
+        if (std::abs(values[i]) > std::abs(values[largest])) largest = i;
+    }
+    // q and -q are the same rotation: make the dropped component positive so it decodes as +sqrt(...)
+    float sign = values[largest] < 0.0f ? -1.0f : 1.0f;
+    uint64_t bits = static_cast<uint64_t>(largest) << 45;
+    int shift = 30;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (i == largest) continue;
+        float v = std::max(-0.70710678f, std::min(0.70710678f, values[i] * sign));
+        uint64_t quantized = static_cast<uint64_t>(lroundf((v + 0.70710678f) * (32767.0f / 1.41421356f)));
+        bits |= std::min<uint64_t>(quantized, 0x7FFF) << shift;
+        shift -= 15;
+    }
+    outPacked[0] = static_cast<uint16_t>(bits);
+    outPacked[1] = static_cast<uint16_t>(bits >> 16);
+    outPacked[2] = static_cast<uint16_t>(bits >> 32);
+}
+
+XMVECTOR AnimationCompressor::GetKey(const AnimationClip& clip, size_t trackIndex, uint32_t key) {
+    const CompressedTrack& track = clip.CompressedTracks[trackIndex];
+    const uint16_t* packed = &clip.KeyValues[(static_cast<size_t>(track.FirstKey) + key) * 3];
+    return trackIndex % 3 == RotationTrack ? UnpackQuaternion(packed) : UnpackRange(packed, track);
+}
+
+float AnimationCompressor::GetKeyTime(const AnimationClip& clip, size_t trackIndex, uint32_t key) {
+    const CompressedTrack& track = clip.CompressedTracks[trackIndex];
+    return clip.KeyTimes[track.FirstKey + key] * (clip.Duration / 65535.0f);
+}
+
+bool AnimationCompressor::Compress(AnimationClip& clip, const Skeleton& skeleton, const AnimationCompressionSettings& settings,
+                                   AnimationCompressionStats* outStats) {
+    if (clip.IsCompressed() || clip.Channels.empty()) {
+        return false;
+    }
+
+    // Keys are normalized to the clip duration; grow it if keys run past it
+    float duration = std::max(clip.Duration, 0.0f);
+    size_t sourceKeys = 0;
+    for (const AnimationChannel& channel : clip.Channels) {
+        for (const AssetVector<float>* times : { &channel.PositionTimestamps, &channel.RotationTimestamps, &channel.ScaleTimestamps,
+                                                 &channel.DQTimestamps }) {
+            if (!times->empty()) duration = std::max(duration, times->back());
+        }
+        sourceKeys += channel.Positions.size() + channel.Rotations.size() + channel.Scales.size();
+    }
+    if (sourceKeys == 0) {
+        return false;
+    }
+    const float timeToTicks = duration > 0.0f ? 65535.0f / duration : 0.0f;
+    const float ticksToTime = duration / 65535.0f;
+
+    // Per joint error budget: the tolerance split over the longest chain through the joint; 'reach'
+    // converts rotation and scale errors into distances at the farthest affected point
+    const size_t jointCount = skeleton.Joints.size();
+    std::vector<uint32_t> depths, order;
+    GetJointDepths(skeleton, depths, order);
+    std::vector<float> offsets(jointCount, 0.0f), reach(jointCount, settings.SkinDistance);
+    std::vector<uint32_t> heights(jointCount, 0);
+    for (size_t j = 0; j < jointCount; ++j) {
+        const XMFLOAT4X4& bind = skeleton.Joints[j].LocalBindTransform;
+        offsets[j] = XMVectorGetX(XMVector3Length(XMVectorSet(bind._41, bind._42, bind._43, 0.0f)));
+    }
+    for (const AnimationChannel& channel : clip.Channels) {
+        auto it = skeleton.JointNameToIndex.find(channel.TargetNodeId);
+        if (it == skeleton.JointNameToIndex.end() || it->second < 0 || static_cast<size_t>(it->second) >= jointCount) continue;
+        for (const XMFLOAT3& position : channel.Positions) {
+            offsets[it->second] = std::max(offsets[it->second], XMVectorGetX(XMVector3Length(XMLoadFloat3(&position))));
+        }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        int parent = skeleton.Joints[*it].ParentIndex;
+        if (parent >= 0 && static_cast<size_t>(parent) < jointCount) {
+            reach[parent] = std::max(reach[parent], offsets[*it] + reach[*it]);
+            heights[parent] = std::max(heights[parent], heights[*it] + 1);
+        }
+    }
+
+    // Model-space error of a candidate against the source clip at every source key time
+    std::vector<float> sampleTimes;
+    for (const AnimationChannel& channel : clip.Channels) {
+        sampleTimes.insert(sampleTimes.end(), channel.PositionTimestamps.begin(), channel.PositionTimestamps.end());
+        sampleTimes.insert(sampleTimes.end(), channel.RotationTimestamps.begin(), channel.RotationTimestamps.end());
+        sampleTimes.insert(sampleTimes.end(), channel.ScaleTimestamps.begin(), channel.ScaleTimestamps.end());
+    }
+    std::sort(sampleTimes.begin(), sampleTimes.end());
+    sampleTimes.erase(std::unique(sampleTimes.begin(), sampleTimes.end()), sampleTimes.end());
+    AnimationSampler sourceSampler;
+    const bool measurable = jointCount > 0 && sourceSampler.Bind(clip, skeleton);
+    auto measure = [&](const AnimationClip& candidate) {
+        float maxError = 0.0f;
+        AnimationSampler candidateSampler;
+        if (!measurable || !candidateSampler.Bind(candidate, skeleton)) {
+            return maxError;
+        }
+        LocalPose sourcePose, candidatePose;
+        AnimationCursor sourceCursor, candidateCursor;
+        std::vector<XMFLOAT4X4> scratchA, scratchB;
+        for (float time : sampleTimes) {
+            sourceSampler.Sample(time, sourcePose, &sourceCursor);
+            candidateSampler.Sample(time, candidatePose, &candidateCursor);
+            maxError = std::max(maxError, MeasurePoseError(skeleton, order, sourcePose, candidatePose, settings.SkinDistance, scratchA, scratchB));
+        }
+        return maxError;
+    };
+
+    // The even split of the budget is conservative (errors down a chain rarely add up): the first pass
+    // allows 4x each joint's share, later passes halve it until the measured error is within the tolerance
+    std::vector<CompressedTrack> tracks;
+    std::vector<uint16_t> keyTimes, keyValues;
+    std::vector<uint8_t> floatTracks; // Per track: quantizing alone misses the track's tolerance, keep its float keys
+    size_t sourceBytes = 0, floatBytes = 0, floatKeys = 0;
+    float maxError = 0.0f;
+    bool withinTolerance = false;
+    ReductionTrack track;
+    for (uint32_t pass = 0; pass < MAX_TIGHTEN_PASSES && !withinTolerance; ++pass) {
+        const float tighten = std::ldexp(1.0f, 2 - static_cast<int>(pass));
+        tracks.clear();
+        keyTimes.clear();
+        keyValues.clear();
+        floatTracks.assign(clip.Channels.size() * 3, 0);
+        sourceBytes = floatBytes = floatKeys = 0;
+        for (size_t c = 0; c < clip.Channels.size(); ++c) {
+            const AnimationChannel& channel = clip.Channels[c];
+            float budget = settings.Tolerance * tighten;
+            float jointReach = settings.SkinDistance;
+            auto it = skeleton.JointNameToIndex.find(channel.TargetNodeId);
+            if (it != skeleton.JointNameToIndex.end() && it->second >= 0 && static_cast<size_t>(it->second) < jointCount) {
+                size_t joint = static_cast<size_t>(it->second);
+                budget /= static_cast<float>(depths[joint] + 1 + heights[joint]);
+                jointReach = reach[joint];
+            }
+            jointReach = std::max(jointReach, 1e-6f);
+
+            for (uint32_t type = PositionTrack; type <= ScaleTrack; ++type) {
+                const AssetVector<float>& times = type == PositionTrack ? channel.PositionTimestamps :
+                                                  type == RotationTrack ? channel.RotationTimestamps : channel.ScaleTimestamps;
+                size_t count = type == PositionTrack ? channel.Positions.size() :
+                               type == RotationTrack ? channel.Rotations.size() : channel.Scales.size();
+                CompressedTrack compressed;
+                compressed.FirstKey = static_cast<uint32_t>(keyTimes.size());
+                if (count == 0 || times.size() != count) {
+                    tracks.push_back(compressed);
+                    continue;
+                }
+
+                track.Times = times.data();
+                track.IsRotation = type == RotationTrack;
+                track.Tolerance = type == PositionTrack ? budget : budget / jointReach;
+                track.Range = CompressedTrack();
+                track.Source.resize(count);
+                for (size_t i = 0; i < count; ++i) {
+                    XMVECTOR value = type == PositionTrack ? XMLoadFloat3(&channel.Positions[i]) :
+                                     type == RotationTrack ? XMQuaternionNormalize(XMLoadFloat4(&channel.Rotations[i])) :
+                                                             XMLoadFloat3(&channel.Scales[i]);
+                    XMStoreFloat4A(&track.Source[i], value);
+                }
+                const size_t trackBytes = count * (sizeof(float) + (track.IsRotation ? sizeof(XMFLOAT4) : sizeof(XMFLOAT3)));
+                sourceBytes += trackBytes;
+
+                QuantizeTrack(track, timeToTicks);
+                if (QuantizationError(track) > track.Tolerance) {
+                    floatTracks[c * 3 + type] = 1;
+                    floatBytes += trackBytes;
+                    floatKeys += count;
+                    tracks.push_back(compressed);
+                    continue;
+                }
+                std::vector<uint32_t> kept = ReduceKeys(track, ticksToTime);
+                compressed.KeyCount = static_cast<uint32_t>(kept.size());
+                compressed.RangeMin = track.Range.RangeMin;
+                compressed.RangeExtent = track.Range.RangeExtent;
+                for (uint32_t key : kept) {
+                    keyTimes.push_back(track.Ticks[key]);
+                    keyValues.insert(keyValues.end(), &track.Packed[key * 3], &track.Packed[key * 3] + 3);
+                }
+                tracks.push_back(compressed);
+            }
+        }
+
+        AnimationClip candidate = clip;
+        ApplyCompression(candidate, duration, tracks, keyTimes, keyValues, floatTracks);
+        maxError = measure(candidate);
+        withinTolerance = maxError <= settings.Tolerance;
+    }
+
+    if (outStats) {
+        outStats->SourceKeys = sourceKeys;
+        outStats->StoredKeys = keyTimes.size() + floatKeys;
+        outStats->FloatTracks = static_cast<size_t>(std::count(floatTracks.begin(), floatTracks.end(), 1));
+        outStats->SourceBytes = sourceBytes;
+        outStats->CompressedBytes =
+            tracks.size() * sizeof(CompressedTrack) + (keyTimes.size() + keyValues.size()) * sizeof(uint16_t) + floatBytes;
+        outStats->MaxError = maxError;
+    }
+    if (!withinTolerance) {
+        return false; // The clip keeps its float keys
+    }
+    ApplyCompression(clip, duration, tracks, keyTimes, keyValues, floatTracks);
+    return true;
+}
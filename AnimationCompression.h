@@ -0,0 +1,85 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <cmath>
+
+struct AnimationCompressionSettings {
+    float Tolerance = 0.0005f;  // Max model-space error of a skinned point, model units (0.5 mm for meter-scale models)
+    float SkinDistance = 0.05f; // Assumed distance of skinned vertices from their joint (also used for leaf joints)
+};
+
+struct AnimationCompressionStats {
+    size_t SourceKeys = 0;
+    size_t StoredKeys = 0;
+    size_t FloatTracks = 0;     // Tracks kept as float keys: quantizing alone missed their share of the tolerance
+    size_t SourceBytes = 0;     // Float keys and timestamps
+    size_t CompressedBytes = 0; // Tracks, key times and key values
+    float MaxError = 0.0f;      // Largest model-space joint position error measured at the source keys
+};
+
+// Cook-time clip compression (see AnimationClip::CompressedTracks).
+//
+// Keys that linear interpolation of the kept keys reproduces are dropped. Each joint gets an error budget
+// of Tolerance split evenly over the longest joint chain through it, since errors accumulate down the
+// hierarchy; a rotation error is weighted by the joint's reach (longest distance to a descendant joint
+// plus SkinDistance), so roots keep more keys than fingers. Reduction is checked against the quantized
+// keys, so the budget covers quantization too; a track whose quantized keys alone miss its budget keeps
+// its float keys. The result is measured in model space: reduction starts from 4x the budgets and halves
+// them until the measured error is within the tolerance.
+//
+// Storage, 6 bytes per key plus a 2 byte time:
+//  - Rotations: smallest three, 2 bit index of the dropped (largest) component + 3 x 15 bits in [-1/sqrt2, 1/sqrt2]
+//  - Positions and scales: 3 x 16 bits range reduced to the track's min / extent
+//  - Times: 16 bits normalized to the clip duration
+class AnimationCompressor {
+public:
+    // Track order within a channel
+    enum TrackType : uint32_t { PositionTrack = 0, RotationTrack = 1, ScaleTrack = 2 };
+
+    // Compresses 'clip' in place: fills the compressed arrays and clears the channels' float keys (except
+    // the float key tracks). Channels that don't target a joint of 'skeleton' get the whole tolerance.
+    // Returns false, leaving the clip as it is, if the clip is already compressed or has no keys, or if the
+    // measured error is still over the tolerance after the tighter passes (outStats->MaxError says by how much).
+    static bool Compress(AnimationClip& clip, const Skeleton& skeleton, const AnimationCompressionSettings& settings,
+                         AnimationCompressionStats* outStats = nullptr);
+
+    // Replaces the position and rotation keys of rigid channels (every scale key, or the bind scale
+    // without scale keys, within 'scaleTolerance' of 1) with dual quaternion keys at the union of their
+    // key times, for runtimes that blend and skin with dual quaternions. Run before Compress, which
+    // keeps the dual quaternion keys as they are. Returns the number of channels converted.
+    static size_t ConvertToDualQuaternionKeys(AnimationClip& clip, const Skeleton& skeleton, float scaleTolerance = 1e-4f);
+
+    static void PackQuaternion(DirectX::FXMVECTOR quaternion, uint16_t outPacked[3]);
+
+    static DirectX::XMVECTOR UnpackQuaternion(const uint16_t packed[3]) {
+        uint64_t bits = packed[0] | (static_cast<uint64_t>(packed[1]) << 16) | (static_cast<uint64_t>(packed[2]) << 32);
+        uint32_t largest = static_cast<uint32_t>(bits >> 45) & 3;
+        const float scale = 1.41421356f / 32767.0f; // [0, 32767] -> [-1/sqrt2, 1/sqrt2]
+        float a = static_cast<float>((bits >> 30) & 0x7FFF) * scale - 0.70710678f;
+        float b = static_cast<float>((bits >> 15) & 0x7FFF) * scale - 0.70710678f;
+        float c = static_cast<float>(bits & 0x7FFF) * scale - 0.70710678f;
+        float d = std::sqrt(std::max(0.0f, 1.0f - a * a - b * b - c * c));
+        switch (largest) {
+        case 0: return DirectX::XMVectorSet(d, a, b, c);
+        case 1: return DirectX::XMVectorSet(a, d, b, c);
+        case 2: return DirectX::XMVectorSet(a, b, d, c);
+        default: return DirectX::XMVectorSet(a, b, c, d);
+        }
+    }
+
+    static DirectX::XMVECTOR UnpackRange(const uint16_t packed[3], const CompressedTrack& track) {
+        DirectX::XMVECTOR q = DirectX::XMVectorSet(packed[0], packed[1], packed[2], 0.0f);
+        return DirectX::XMVectorMultiplyAdd(q, DirectX::XMVectorScale(DirectX::XMLoadFloat3(&track.RangeExtent), 1.0f / 65535.0f),
+                                            DirectX::XMLoadFloat3(&track.RangeMin));
+    }
+
+    // Decoded key of a compressed track: position / scale (w = 0) or rotation
+    static DirectX::XMVECTOR GetKey(const AnimationClip& clip, size_t trackIndex, uint32_t key);
+    // Key time in the clip's time units
+    static float GetKeyTime(const AnimationClip& clip, size_t trackIndex, uint32_t key);
+};
@@ -0,0 +1,368 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "AnimationSampler.h"
+#include "Timing.h"
+#include "AnimationCompression.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+
+float Alpha(float time0, float time1, float time) {
+    float span = time1 - time0;
+    return span > 0.0f ? std::min(std::max((time - time0) / span, 0.0f), 1.0f) : 0.0f;
+}
+
+template <typename T>
+uint32_t FindInterval(const T* times, uint32_t count, float time, const uint32_t* cachedKey) {
+    const uint32_t lastInterval = count - 2;
+    if (cachedKey) {
+        uint32_t key = std::min(*cachedKey, lastInterval);
+        if (times[key] <= time) {
+            // Forward playback: usually the same interval or the next one
+            while (key < lastInterval && times[key + 1] <= time) {
+                ++key;
+            }
+            return key;
+        }
+    }
+    const T* upper = std::upper_bound(times, times + count, time, [](float t, T key) { return t < key; });
+    uint32_t key = upper == times ? 0 : static_cast<uint32_t>(upper - times - 1);
+    return std::min(key, lastInterval);
+}
+
+// Unit dual quaternion -> rotation and translation (2 * dual * conjugate(real))
+inline void StoreRigidTransform(FXMVECTOR real, FXMVECTOR dual, XMFLOAT4A& outRotation, XMFLOAT4A& outTranslation) {
+    XMStoreFloat4A(&outRotation, real);
+    XMStoreFloat4A(&outTranslation, XMVectorScale(XMQuaternionMultiply(XMQuaternionConjugate(real), dual), 2.0f));
+}
+
+} // namespace
+
+bool AnimationSampler::Bind(const AnimationClip& clip, const Skeleton& skeleton, RotationInterpolation rotation) {
+    m_clip = &clip;
+    m_rotation = rotation;
+    m_channels.clear();
+    GetBindPose(skeleton, m_bindPose);
+    const bool compressed = clip.IsCompressed() && clip.CompressedTracks.size() == clip.Channels.size() * 3;
+    m_timeToTicks = compressed && clip.Duration > 0.0f ? 65535.0f / clip.Duration : 0.0f;
+
+    auto makeTrack3 = [](const AssetVector<float>& times, const AssetVector<XMFLOAT3>& values) {
+        Track track;
+        if (!values.empty() && times.size() == values.size()) {
+            track.Times = times.data();
+            track.Values3 = values.data();
+            track.Count = static_cast<uint32_t>(values.size());
+        }
+        return track;
+    };
+    auto makeCompressedTrack = [&clip](size_t index) {
+        Track track;
+        const CompressedTrack& compressedTrack = clip.CompressedTracks[index];
+        if (compressedTrack.KeyCount > 0) {
+            track.Ticks = clip.KeyTimes.data() + compressedTrack.FirstKey;
+            track.Packed = clip.KeyValues.data() + static_cast<size_t>(compressedTrack.FirstKey) * 3;
+            track.Range = &compressedTrack;
+            track.Count = compressedTrack.KeyCount;
+        }
+        return track;
+    };
+    for (size_t c = 0; c < clip.Channels.size(); ++c) {
+        const AnimationChannel& channel = clip.Channels[c];
+        auto it = skeleton.JointNameToIndex.find(channel.TargetNodeId);
+        if (it == skeleton.JointNameToIndex.end() || it->second < 0 || static_cast<size_t>(it->second) >= skeleton.Joints.size()) {
+            continue;
+        }
+        BoundChannel bound;
+        bound.Joint = static_cast<uint32_t>(it->second);
+        if (!channel.DQs.empty() && channel.DQTimestamps.size() == channel.DQs.size()) {
+            bound.Rigid.Times = channel.DQTimestamps.data();
+            bound.Rigid.ValuesDQ = channel.DQs.data();
+            bound.Rigid.Count = static_cast<uint32_t>(channel.DQs.size());
+        }
+        bound.Position = makeTrack3(channel.PositionTimestamps, channel.Positions);
+        bound.Scale = makeTrack3(channel.ScaleTimestamps, channel.Scales);
+        if (!channel.Rotations.empty() && channel.RotationTimestamps.size() == channel.Rotations.size()) {
+            bound.Rotation.Times = channel.RotationTimestamps.data();
+            bound.Rotation.Values4 = channel.Rotations.data();
+            bound.Rotation.Count = static_cast<uint32_t>(channel.Rotations.size());
+        }
+        // Compressed clips: tracks the compressor kept as float keys have no compressed keys
+        if (compressed) {
+            Track* tracks[3] = { &bound.Position, &bound.Rotation, &bound.Scale };
+            for (uint32_t type = AnimationCompressor::PositionTrack; type <= AnimationCompressor::ScaleTrack; ++type) {
+                if (clip.CompressedTracks[c * 3 + type].KeyCount > 0) *tracks[type] = makeCompressedTrack(c * 3 + type);
+            }
+        }
+        m_channels.push_back(bound);
+    }
+    return !m_channels.empty();
+}
+
+void AnimationSampler::ResetCursor(AnimationCursor& cursor) const {
+    cursor.Keys.assign(m_channels.size() * 3, 0);
+    cursor.Time = 0.0f;
+}
+
+float AnimationSampler::TrackTime(const Track& track, float time) const {
+    return track.Ticks ? time * m_timeToTicks : time;
+}
+
+uint32_t AnimationSampler::FindKey(const Track& track, float time, const uint32_t* cachedKey) {
+    return track.Ticks ? FindInterval(track.Ticks, track.Count, time, cachedKey) : FindInterval(track.Times, track.Count, time, cachedKey);
+}
+
+XMVECTOR AnimationSampler::GetKey3(const Track& track, uint32_t key) {
+    return track.Packed ? AnimationCompressor::UnpackRange(track.Packed + key * 3, *track.Range) : XMLoadFloat3(&track.Values3[key]);
+}
+
+XMVECTOR AnimationSampler::GetKey4(const Track& track, uint32_t key) {
+    return track.Packed ? AnimationCompressor::UnpackQuaternion(track.Packed + key * 3) : XMLoadFloat4(&track.Values4[key]);
+}
+
+size_t AnimationSampler::Sample(float time, LocalPose& outPose, AnimationCursor* cursor, const uint8_t* jointMask) const {
+    outPose = m_bindPose;
+    if (cursor) {
+        if (cursor->Keys.size() != m_channels.size() * 3) {
+            ResetCursor(*cursor);
+        }
+        cursor->Time = time;
+    }
+
+    size_t sampled = 0;
+    for (size_t c = 0; c < m_channels.size(); ++c) {
+        const BoundChannel& channel = m_channels[c];
+        if (jointMask && !jointMask[channel.Joint]) {
+            continue;
+        }
+        ++sampled;
+        uint32_t* keys = cursor ? &cursor->Keys[c * 3] : nullptr;
+
+        const Track& position = channel.Position;
+        if (position.Count == 1) {
+            XMStoreFloat4A(&outPose.Translations[channel.Joint], GetKey3(position, 0));
+        } else if (position.Count > 1) {
+            const float trackTime = TrackTime(position, time);
+            uint32_t key = FindKey(position, trackTime, keys);
+            if (keys) keys[0] = key;
+            XMVECTOR value = XMVectorLerp(GetKey3(position, key), GetKey3(position, key + 1),
+                                          Alpha(GetKeyTime(position, key), GetKeyTime(position, key + 1), trackTime));
+            XMStoreFloat4A(&outPose.Translations[channel.Joint], value);
+        }
+
+        const Track& rotation = channel.Rotation;
+        if (rotation.Count == 1) {
+            XMStoreFloat4A(&outPose.Rotations[channel.Joint], GetKey4(rotation, 0));
+        } else if (rotation.Count > 1) {
+            const float trackTime = TrackTime(rotation, time);
+            uint32_t key = FindKey(rotation, trackTime, keys ? keys + 1 : nullptr);
+            if (keys) keys[1] = key;
+            XMVECTOR q0 = GetKey4(rotation, key);
+            XMVECTOR q1 = GetKey4(rotation, key + 1);
+            float alpha = Alpha(GetKeyTime(rotation, key), GetKeyTime(rotation, key + 1), trackTime);
+            XMVECTOR value;
+            if (m_rotation == RotationInterpolation::Slerp) {
+                value = XMQuaternionSlerp(q0, q1, alpha);
+            } else {
+                // Shorter arc: q and -q are the same rotation
+                if (XMVectorGetX(XMVector4Dot(q0, q1)) < 0.0f) q1 = XMVectorNegate(q1);
+                value = XMQuaternionNormalize(XMVectorLerp(q0, q1, alpha));
+            }
+            XMStoreFloat4A(&outPose.Rotations[channel.Joint], value);
+        }
+
+        // Dual quaternion keys are in clip time; they share the rotation slot of the cursor
+        const Track& rigid = channel.Rigid;
+        if (rigid.Count == 1) {
+            StoreRigidTransform(XMLoadFloat4(&rigid.ValuesDQ[0].Real), XMLoadFloat4(&rigid.ValuesDQ[0].Dual),
+                                outPose.Rotations[channel.Joint], outPose.Translations[channel.Joint]);
+        } else if (rigid.Count > 1) {
+            uint32_t key = FindKey(rigid, time, keys ? keys + 1 : nullptr);
+            if (keys) keys[1] = key;
+            const DualQuaternion& dq0 = rigid.ValuesDQ[key];
+            const DualQuaternion& dq1 = rigid.ValuesDQ[key + 1];
+            float alpha = Alpha(rigid.Times[key], rigid.Times[key + 1], time);
+            XMVECTOR real0 = XMLoadFloat4(&dq0.Real);
+            XMVECTOR real1 = XMLoadFloat4(&dq1.Real);
+            XMVECTOR dual1 = XMLoadFloat4(&dq1.Dual);
+            if (XMVectorGetX(XMVector4Dot(real0, real1)) < 0.0f) {
+                real1 = XMVectorNegate(real1);
+                dual1 = XMVectorNegate(dual1);
+            }
+            XMVECTOR real = XMVectorLerp(real0, real1, alpha);
+            XMVECTOR dual = XMVectorLerp(XMLoadFloat4(&dq0.Dual), dual1, alpha);
+            XMVECTOR inverseLength = XMVectorReciprocalSqrt(XMVector4Dot(real, real));
+            StoreRigidTransform(XMVectorMultiply(real, inverseLength), XMVectorMultiply(dual, inverseLength),
+                                outPose.Rotations[channel.Joint], outPose.Translations[channel.Joint]);
+        }
+
+        const Track& scale = channel.Scale;
+        if (scale.Count == 1) {
+            XMStoreFloat4A(&outPose.Scales[channel.Joint], GetKey3(scale, 0));
+        } else if (scale.Count > 1) {
+            const float trackTime = TrackTime(scale, time);
+            uint32_t key = FindKey(scale, trackTime, keys ? keys + 2 : nullptr);
+            if (keys) keys[2] = key;
+            XMVECTOR value = XMVectorLerp(GetKey3(scale, key), GetKey3(scale, key + 1),
+                                          Alpha(GetKeyTime(scale, key), GetKeyTime(scale, key + 1), trackTime));
+            XMStoreFloat4A(&outPose.Scales[channel.Joint], value);
+        }
+    }
+    return sampled;
+}
+
+void AnimationSampler::GetBindPose(const Skeleton& skeleton, LocalPose& outPose) {
+    outPose.Resize(skeleton.Joints.size());
+    for (size_t j = 0; j < skeleton.Joints.size(); ++j) {
+        const Joint& joint = skeleton.Joints[j];
+        XMVECTOR scale, rotation, translation;
+        if (!XMMatrixDecompose(&scale, &rotation, &translation, XMLoadFloat4x4(&joint.LocalBindTransform))) {
+            scale = XMLoadFloat3(&joint.Scale);
+            rotation = XMLoadFloat4(&joint.RotationQuat);
+            translation = XMLoadFloat3(&joint.Translation);
+        }
+        XMStoreFloat4A(&outPose.Translations[j], translation);
+        XMStoreFloat4A(&outPose.Rotations[j], rotation);
+        XMStoreFloat4A(&outPose.Scales[j], scale);
+    }
+}
+
+float AnimationSampler::WrapTime(float time, float duration) {
+    if (duration <= 0.0f) {
+        return 0.0f;
+    }
+    float wrapped = std::fmod(time, duration);
+    return wrapped < 0.0f ? wrapped + duration : wrapped;
+}
+
+bool AnimationSampler::RunBenchmark(size_t instanceCount, size_t jointCount) {
+    instanceCount = std::max<size_t>(instanceCount, 1);
+    jointCount = std::max<size_t>(jointCount, 1);
+    const float keyRate = 30.0f;
+    const float duration = 10.0f;
+    const size_t keyCount = static_cast<size_t>(duration * keyRate) + 1;
+
+    // Chain skeleton; every joint has rotation and translation keys, scale is constant (a single key)
+    Skeleton skeleton;
+    for (size_t j = 0; j < jointCount; ++j) {
+        Joint joint;
+        joint.Name = L"joint" + std::to_wstring(j);
+        joint.NameId = StringId::Intern(joint.Name);
+        joint.ParentIndex = static_cast<int>(j) - 1;
+        XMStoreFloat4x4(&joint.LocalBindTransform, XMMatrixTranslation(0.0f, 0.1f, 0.0f));
+        XMStoreFloat4x4(&joint.InverseBindPoseMatrix, XMMatrixTranslation(0.0f, -0.1f * j, 0.0f));
+        skeleton.JointNameToIndex[joint.NameId] = static_cast<int>(j);
+        skeleton.Joints.push_back(joint);
+    }
+    AnimationClip clip;
+    clip.Duration = duration;
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> phase(0.0f, 6.28f);
+    for (size_t j = 0; j < jointCount; ++j) {
+        AnimationChannel channel;
+        channel.TargetNodeId = skeleton.Joints[j].NameId;
+        float offset = phase(random);
+        for (size_t k = 0; k < keyCount; ++k) {
+            float t = k / keyRate;
+            channel.PositionTimestamps.push_back(t);
+            channel.Positions.push_back(XMFLOAT3(0.0f, 0.1f + 0.01f * std::sin(t * 2.0f + offset), 0.0f));
+            channel.RotationTimestamps.push_back(t);
+            XMFLOAT4 q;
+            XMStoreFloat4(&q, XMQuaternionRotationRollPitchYaw(0.5f * std::sin(t + offset), 0.3f * std::cos(t * 1.3f + offset), 0.0f));
+            channel.Rotations.push_back(q);
+        }
+        channel.ScaleTimestamps.push_back(0.0f);
+        channel.Scales.push_back(XMFLOAT3(1.0f, 1.0f, 1.0f));
+        clip.Channels.push_back(std::move(channel));
+    }
+
+    AnimationSampler sampler;
+    if (!sampler.Bind(clip, skeleton)) {
+        std::cerr << "Animation sampler benchmark: bind failed." << std::endl;
+        return false;
+    }
+
+    // Instances start at different clip times and loop; 5 s at 60 Hz
+    const size_t frameCount = 300;
+    const float frameTime = 1.0f / 60.0f;
+    std::vector<float> startTimes(instanceCount);
+    for (float& start : startTimes) start = std::uniform_real_distribution<float>(0.0f, duration)(random);
+    std::vector<AnimationCursor> cursors(instanceCount);
+    for (AnimationCursor& cursor : cursors) sampler.ResetCursor(cursor);
+    LocalPose pose, reference;
+
+    auto run = [&](const AnimationSampler& clipSampler, bool useCursors, double& outChecksum) {
+        outChecksum = 0.0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t frame = 0; frame < frameCount; ++frame) {
+            for (size_t i = 0; i < instanceCount; ++i) {
+                float time = WrapTime(startTimes[i] + frame * frameTime, duration);
+                clipSampler.Sample(time, pose, useCursors ? &cursors[i] : nullptr);
+                outChecksum += pose.Rotations[jointCount - 1].x + pose.Translations[jointCount / 2].y;
+            }
+        }
+        return SecondsSince(start);
+    };
+    double cursorChecksum = 0.0, searchChecksum = 0.0;
+    double cursorSeconds = run(sampler, true, cursorChecksum);
+    double searchSeconds = run(sampler, false, searchChecksum);
+
+    // Same playback decoding the compressed clip
+    AnimationClip compressedClip = clip;
+    AnimationCompressionSettings compressionSettings;
+    AnimationCompressionStats compression;
+    AnimationSampler compressedSampler;
+    double compressedChecksum = 0.0, compressedSeconds = 0.0;
+    bool compressed = AnimationCompressor::Compress(compressedClip, skeleton, compressionSettings, &compression) &&
+                      compressedSampler.Bind(compressedClip, skeleton);
+    if (compressed) {
+        for (AnimationCursor& cursor : cursors) compressedSampler.ResetCursor(cursor);
+        compressedSeconds = run(compressedSampler, true, compressedChecksum);
+        for (AnimationCursor& cursor : cursors) sampler.ResetCursor(cursor);
+    }
+
+    // Cursor and binary search must find the same keys
+    bool ok = std::abs(cursorChecksum - searchChecksum) <= 1e-6 * std::max(1.0, std::abs(searchChecksum));
+    for (float time : { 0.0f, 3.3f, 9.99f, 1.0f, 10.0f }) {
+        AnimationCursor& cursor = cursors[0];
+        sampler.Sample(time, pose, &cursor);
+        sampler.Sample(time, reference, nullptr);
+        for (size_t j = 0; j < jointCount && ok; ++j) {
+            ok = XMVector4NearEqual(XMLoadFloat4A(&pose.Rotations[j]), XMLoadFloat4A(&reference.Rotations[j]), XMVectorReplicate(1e-6f)) &&
+                 XMVector3NearEqual(XMLoadFloat4A(&pose.Translations[j]), XMLoadFloat4A(&reference.Translations[j]), XMVectorReplicate(1e-6f));
+        }
+    }
+
+    double jointSamples = static_cast<double>(instanceCount) * jointCount * frameCount;
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(0);
+    report << "Animation sampler benchmark: " << instanceCount << " instances x " << jointCount << " joints x " << frameCount
+           << " frames (" << keyCount << " keys per track)\n"
+           << "  Cursor:        " << jointSamples / std::max(cursorSeconds * 1000.0, 1e-9) << " joints/ms\n"
+           << "  Binary search: " << jointSamples / std::max(searchSeconds * 1000.0, 1e-9) << " joints/ms\n";
+    if (compressed) {
+        report << "  Compressed:    " << jointSamples / std::max(compressedSeconds * 1000.0, 1e-9) << " joints/ms ("
+               << compression.SourceBytes / 1024 << " KB -> " << compression.CompressedBytes / 1024 << " KB, "
+               << compression.StoredKeys << " of " << compression.SourceKeys << " keys, " << compression.FloatTracks
+               << " float tracks, max error " << std::setprecision(5) << compression.MaxError << ")\n";
+    }
+    if (!ok) {
+        report << "  FAILED: cursor and binary search poses differ\n";
+    }
+    // Compress only succeeds within the tolerance; check the measurement anyway
+    bool compressionOk = compressed && compression.MaxError <= compressionSettings.Tolerance;
+    if (!compressionOk) {
+        report << std::setprecision(5) << "  FAILED: compression max error " << compression.MaxError << " over the tolerance "
+               << compressionSettings.Tolerance << "\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok && compressionOk;
+}
@@ -0,0 +1,110 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <vector>
+
+// Local (parent relative) joint transforms of one skeleton, one stream per component.
+// Entries are 16-byte aligned so they load straight into XMVECTORs; w of translations and scales is unused.
+struct LocalPose {
+    std::vector<DirectX::XMFLOAT4A> Translations;
+    std::vector<DirectX::XMFLOAT4A> Rotations; // Quaternions
+    std::vector<DirectX::XMFLOAT4A> Scales;
+
+    void Resize(size_t jointCount) {
+        Translations.resize(jointCount);
+        Rotations.resize(jointCount);
+        Scales.resize(jointCount);
+    }
+    size_t GetJointCount() const { return Rotations.size(); }
+};
+
+enum class RotationInterpolation : uint8_t {
+    NLerp, // Normalized lerp along the shorter arc: cheaper, indistinguishable at sampled key rates
+    Slerp,
+};
+
+// Playback state of one clip on one instance: the current key of every track, so playback moving
+// forward finds its keys in O(1) (a step or two from the last frame) instead of a binary search.
+// Sampling an earlier time (loop wrap, seek) falls back to a binary search once.
+struct AnimationCursor {
+    std::vector<uint32_t> Keys; // Left key of the current interval, 3 per channel (position, rotation, scale)
+    float Time = 0.0f;          // Last sampled time
+};
+
+// Samples one AnimationClip for a skeleton (runtime). Binding resolves every channel to its joint
+// once; a sampler is then shared (read only) by all instances playing the clip, each with its own cursor.
+// Clip times are in the units of the clip's timestamps (seconds for parsed clips). Compressed clips
+// (AnimationCompressor) are sampled straight from their quantized keys. Dual quaternion keys of rigid
+// channels are blended as dual quaternions (linear blend, renormalized) and written as rotation and
+// translation.
+class AnimationSampler {
+public:
+    AnimationSampler() = default;
+
+    // Channels whose target is not a joint of 'skeleton' are ignored. Both must outlive the sampler.
+    bool Bind(const AnimationClip& clip, const Skeleton& skeleton, RotationInterpolation rotation = RotationInterpolation::NLerp);
+
+    void ResetCursor(AnimationCursor& cursor) const;
+
+    // Writes every joint of 'outPose' (resized to the skeleton): animated tracks at 'time', the rest
+    // from the bind pose. Without a cursor each key is found by binary search. Joints whose
+    // 'jointMask' entry is 0 are not sampled and keep the bind pose (animation LOD).
+    // Returns the number of channels sampled.
+    size_t Sample(float time, LocalPose& outPose, AnimationCursor* cursor = nullptr, const uint8_t* jointMask = nullptr) const;
+
+    // Local bind pose of every joint (LocalBindTransform decomposed)
+    static void GetBindPose(const Skeleton& skeleton, LocalPose& outPose);
+    // 'time' wrapped into [0, duration) for looping playback
+    static float WrapTime(float time, float duration);
+
+    const AnimationClip* GetClip() const { return m_clip; }
+    const LocalPose& GetBindPose() const { return m_bindPose; }
+    size_t GetChannelCount() const { return m_channels.size(); }
+
+    // Samples a synthetic clip ('jointCount' joints, 30 Hz keys) on 'instanceCount' characters for a
+    // few seconds of 60 Hz playback, with cursors, with per-key binary search and from the compressed
+    // clip (WinMain "-animbench"). Reports joints sampled per millisecond.
+    static bool RunBenchmark(size_t instanceCount = 1000, size_t jointCount = 60);
+
+private:
+    // One channel, flattened so sampling doesn't go through the containers
+    struct Track {
+        const float* Times = nullptr;
+        const DirectX::XMFLOAT3* Values3 = nullptr; // Positions or scales
+        const DirectX::XMFLOAT4* Values4 = nullptr; // Rotations
+        const DualQuaternion* ValuesDQ = nullptr;   // Rigid transforms
+        // Compressed clips: times in ticks (see m_timeToTicks), 3 packed values per key
+        const uint16_t* Ticks = nullptr;
+        const uint16_t* Packed = nullptr;
+        const CompressedTrack* Range = nullptr;
+        uint32_t Count = 0;
+    };
+    struct BoundChannel {
+        uint32_t Joint = 0;
+        Track Position;
+        Track Rotation;
+        Track Scale;
+        Track Rigid; // Dual quaternion keys; replace the position and rotation tracks
+    };
+
+    const AnimationClip* m_clip = nullptr;
+    std::vector<BoundChannel> m_channels;
+    LocalPose m_bindPose;
+    RotationInterpolation m_rotation = RotationInterpolation::NLerp;
+    float m_timeToTicks = 0.0f; // Compressed clips: sample time to key ticks, 0 otherwise
+
+    // 'time' in the units of the track's keys: ticks for compressed tracks, clip time for float tracks
+    float TrackTime(const Track& track, float time) const;
+    // Interval [key, key + 1] of 'track' (2+ keys) containing 'time'. 'cachedKey' is the interval of the
+    // previous sample; without it, or when 'time' lies before it, the key is found by binary search.
+    static uint32_t FindKey(const Track& track, float time, const uint32_t* cachedKey);
+    // Key time (ticks for compressed tracks), decoded position / scale key, decoded rotation key
+    static float GetKeyTime(const Track& track, uint32_t key) { return track.Ticks ? track.Ticks[key] : track.Times[key]; }
+    static DirectX::XMVECTOR GetKey3(const Track& track, uint32_t key);
+    static DirectX::XMVECTOR GetKey4(const Track& track, uint32_t key);
+};
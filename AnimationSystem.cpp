@@ -0,0 +1,1388 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "AnimationSystem.h"
+#include "Timing.h"
+#include "AnimationCompression.h"
+#include "Camera.h"
+#include "JobSystem.h"
+#include <cfloat>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+
+// out = lerp(out, pose, t) per joint; rotations along the shorter arc, renormalized
+void LerpPose(LocalPose& out, const LocalPose& pose, float t) {
+    const size_t jointCount = std::min(out.GetJointCount(), pose.GetJointCount());
+    XMVECTOR weight = XMVectorReplicate(t);
+    for (size_t j = 0; j < jointCount; ++j) {
+        XMStoreFloat4A(&out.Translations[j], XMVectorLerpV(XMLoadFloat4A(&out.Translations[j]), XMLoadFloat4A(&pose.Translations[j]), weight));
+        XMStoreFloat4A(&out.Scales[j], XMVectorLerpV(XMLoadFloat4A(&out.Scales[j]), XMLoadFloat4A(&pose.Scales[j]), weight));
+        XMVECTOR from = XMLoadFloat4A(&out.Rotations[j]);
+        XMVECTOR to = XMLoadFloat4A(&pose.Rotations[j]);
+        if (XMVectorGetX(XMVector4Dot(from, to)) < 0.0f) {
+            to = XMVectorNegate(to);
+        }
+        XMStoreFloat4A(&out.Rotations[j], XMQuaternionNormalize(XMVectorLerpV(from, to, weight)));
+    }
+}
+
+// Adds 'weight' times the difference of 'additive' from 'reference' onto 'out'. The rotation
+// difference is applied on the parent side: reference rotated by it gives the additive rotation.
+void AddPose(LocalPose& out, const LocalPose& additive, const LocalPose& reference, float weight) {
+    const size_t jointCount = std::min(std::min(out.GetJointCount(), additive.GetJointCount()), reference.GetJointCount());
+    XMVECTOR scaledWeight = XMVectorReplicate(weight);
+    XMVECTOR identity = XMQuaternionIdentity();
+    for (size_t j = 0; j < jointCount; ++j) {
+        XMVECTOR translation = XMVectorSubtract(XMLoadFloat4A(&additive.Translations[j]), XMLoadFloat4A(&reference.Translations[j]));
+        XMStoreFloat4A(&out.Translations[j], XMVectorMultiplyAdd(translation, scaledWeight, XMLoadFloat4A(&out.Translations[j])));
+        XMVECTOR scale = XMVectorSubtract(XMLoadFloat4A(&additive.Scales[j]), XMLoadFloat4A(&reference.Scales[j]));
+        XMStoreFloat4A(&out.Scales[j], XMVectorMultiplyAdd(scale, scaledWeight, XMLoadFloat4A(&out.Scales[j])));
+
+        XMVECTOR delta = XMQuaternionMultiply(XMQuaternionInverse(XMLoadFloat4A(&reference.Rotations[j])), XMLoadFloat4A(&additive.Rotations[j]));
+        if (XMVectorGetW(delta) < 0.0f) {
+            delta = XMVectorNegate(delta);
+        }
+        delta = XMQuaternionNormalize(XMVectorLerpV(identity, delta, scaledWeight));
+        XMStoreFloat4A(&out.Rotations[j], XMQuaternionNormalize(XMQuaternionMultiply(XMLoadFloat4A(&out.Rotations[j]), delta)));
+    }
+}
+
+void CopyPose(LocalPose& out, const LocalPose& pose) {
+    out.Translations.assign(pose.Translations.begin(), pose.Translations.end());
+    out.Rotations.assign(pose.Rotations.begin(), pose.Rotations.end());
+    out.Scales.assign(pose.Scales.begin(), pose.Scales.end());
+}
+
+} // namespace
+
+// --- BlendTree ---
+
+BlendTree::BlendTree(const Skeleton& skeleton) : m_skeleton(&skeleton) {
+    AnimationSampler::GetBindPose(skeleton, m_bindPose);
+}
+
+uint32_t BlendTree::AddNode(BlendNode&& node, uint32_t weightCount) {
+    uint32_t depth = 0;
+    for (uint32_t child : node.Children) {
+        if (child >= m_nodes.size()) {
+            return InvalidNode;
+        }
+        depth = std::max(depth, m_nodes[child].ScratchDepth);
+    }
+    // A blend writes its first contributing child into its output and the others into one scratch pose
+    node.ScratchDepth = node.Children.empty() ? 0 : depth + 1;
+    node.FirstWeight = static_cast<uint32_t>(m_weightCount);
+    m_weightCount += weightCount;
+    if (node.Type != BlendNodeType::Clip) {
+        m_parameterCount = std::max<size_t>(m_parameterCount, node.ParameterX + 1);
+    }
+    if (node.Type == BlendNodeType::Blend2D) {
+        m_parameterCount = std::max<size_t>(m_parameterCount, node.ParameterY + 1);
+    }
+    m_nodes.push_back(std::move(node));
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+uint32_t BlendTree::AddClip(const AnimationSampler& sampler, float playbackRate) {
+    if (!sampler.GetClip()) {
+        return InvalidNode;
+    }
+    BlendNode node;
+    node.Type = BlendNodeType::Clip;
+    node.Sampler = &sampler;
+    node.PlaybackRate = std::max(playbackRate, 0.0f);
+    return AddNode(std::move(node), 0);
+}
+
+uint32_t BlendTree::AddBlend1D(uint32_t parameter, const std::vector<uint32_t>& children, const std::vector<float>& thresholds) {
+    if (children.empty() || thresholds.size() != children.size() || !std::is_sorted(thresholds.begin(), thresholds.end())) {
+        return InvalidNode;
+    }
+    BlendNode node;
+    node.Type = BlendNodeType::Blend1D;
+    node.ParameterX = parameter;
+    node.Children = children;
+    for (float threshold : thresholds) {
+        node.Positions.push_back(XMFLOAT2(threshold, 0.0f));
+    }
+    return AddNode(std::move(node), static_cast<uint32_t>(children.size()));
+}
+
+uint32_t BlendTree::AddBlend2D(uint32_t parameterX, uint32_t parameterY, const std::vector<uint32_t>& children,
+                               const std::vector<XMFLOAT2>& positions) {
+    if (children.empty() || positions.size() != children.size()) {
+        return InvalidNode;
+    }
+    BlendNode node;
+    node.Type = BlendNodeType::Blend2D;
+    node.ParameterX = parameterX;
+    node.ParameterY = parameterY;
+    node.Children = children;
+    node.Positions = positions;
+    return AddNode(std::move(node), static_cast<uint32_t>(children.size()));
+}
+
+uint32_t BlendTree::AddAdditive(uint32_t base, uint32_t additive, uint32_t weightParameter) {
+    BlendNode node;
+    node.Type = BlendNodeType::Additive;
+    node.ParameterX = weightParameter;
+    node.Children = { base, additive };
+    return AddNode(std::move(node), 1);
+}
+
+void BlendTree::ComputeWeights(uint32_t nodeIndex, const float* parameters, float* outWeights) const {
+    const BlendNode& node = m_nodes[nodeIndex];
+    const size_t count = node.Children.size();
+    switch (node.Type) {
+    case BlendNodeType::Blend1D: {
+        // The two samples around the parameter, clamped to the end samples
+        const float x = parameters[node.ParameterX];
+        std::fill(outWeights, outWeights + count, 0.0f);
+        if (x <= node.Positions.front().x) {
+            outWeights[0] = 1.0f;
+            break;
+        }
+        if (x >= node.Positions.back().x) {
+            outWeights[count - 1] = 1.0f;
+            break;
+        }
+        size_t upper = 1;
+        while (node.Positions[upper].x <= x) ++upper;
+        float span = node.Positions[upper].x - node.Positions[upper - 1].x;
+        float t = span > 0.0f ? (x - node.Positions[upper - 1].x) / span : 1.0f;
+        outWeights[upper - 1] = 1.0f - t;
+        outWeights[upper] = t;
+        break;
+    }
+    case BlendNodeType::Blend2D: {
+        // Gradient band interpolation: each sample's weight falls off linearly towards every other
+        // sample, so any layout of samples blends smoothly and a sample position plays only that sample
+        const XMFLOAT2 p(parameters[node.ParameterX], parameters[node.ParameterY]);
+        float total = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            const XMFLOAT2& pi = node.Positions[i];
+            float weight = 1.0f;
+            for (size_t k = 0; k < count && weight > 0.0f; ++k) {
+                const XMFLOAT2& pk = node.Positions[k];
+                float dx = pk.x - pi.x, dy = pk.y - pi.y;
+                float lengthSquared = dx * dx + dy * dy;
+                if (k == i || lengthSquared <= 0.0f) continue;
+                float h = 1.0f - ((p.x - pi.x) * dx + (p.y - pi.y) * dy) / lengthSquared;
+                weight = std::min(weight, std::max(h, 0.0f));
+            }
+            outWeights[i] = weight;
+            total += weight;
+        }
+        if (total > 0.0f) {
+            for (size_t i = 0; i < count; ++i) outWeights[i] /= total;
+        } else {
+            // Only possible for coincident samples: the first one plays
+            std::fill(outWeights, outWeights + count, 0.0f);
+            outWeights[0] = 1.0f;
+        }
+        break;
+    }
+    case BlendNodeType::Additive:
+        outWeights[0] = std::min(std::max(parameters[node.ParameterX], 0.0f), 1.0f);
+        break;
+    case BlendNodeType::Clip:
+        break;
+    }
+}
+
+// --- AnimationSystem ---
+
+void AnimationSystem::Playback::Reset(const BlendTree* tree, float phase) {
+    Tree = tree;
+    const size_t nodeCount = tree ? tree->GetNodeCount() : 0;
+    Phases.assign(nodeCount, AnimationSampler::WrapTime(phase, 1.0f));
+    Weights.assign(tree ? tree->GetWeightCount() : 0, 0.0f);
+    Cursors.resize(nodeCount);
+    for (size_t n = 0; n < nodeCount; ++n) {
+        const BlendNode& node = tree->GetNode(static_cast<uint32_t>(n));
+        if (node.Type == BlendNodeType::Clip) {
+            node.Sampler->ResetCursor(Cursors[n]);
+        }
+    }
+}
+
+void AnimationSystem::Initialize(JobSystem* jobSystem, size_t batchSize) {
+    m_jobSystem = jobSystem;
+    m_batchSize = std::max<size_t>(batchSize, 1);
+}
+
+AnimationInstanceId AnimationSystem::CreateInstance(const Skeleton& skeleton) {
+    SharedEvaluator& shared = m_evaluators[&skeleton];
+    if (!shared.Evaluator) {
+        shared.Evaluator = std::make_unique<PoseEvaluator>();
+        if (!shared.Evaluator->Bind(skeleton)) {
+            m_evaluators.erase(&skeleton);
+            std::cerr << "AnimationSystem: skeleton joints are not parents-first." << std::endl;
+            return InvalidInstance;
+        }
+        // Roots and joints with children stay animated at every LOD
+        shared.LeafJointMask.assign(skeleton.Joints.size(), 0);
+        for (size_t j = 0; j < skeleton.Joints.size(); ++j) {
+            int parent = skeleton.Joints[j].ParentIndex;
+            if (parent < 0) {
+                shared.LeafJointMask[j] = 1;
+            } else {
+                shared.LeafJointMask[parent] = 1;
+            }
+        }
+    }
+    ++shared.Users;
+
+    AnimationInstanceId id;
+    if (!m_freeInstances.empty()) {
+        id = m_freeInstances.back();
+        m_freeInstances.pop_back();
+    } else {
+        id = static_cast<AnimationInstanceId>(m_instances.size());
+        m_instances.emplace_back();
+    }
+    Instance& instance = m_instances[id];
+    instance = Instance();
+    instance.Alive = true;
+    instance.Rig = &skeleton;
+    instance.Evaluator = shared.Evaluator.get();
+    instance.LeafJointMask = shared.LeafJointMask.data();
+    AnimationSampler::GetBindPose(skeleton, instance.Pose);
+    instance.Model.resize(skeleton.Joints.size());
+    instance.ModelDualQuaternions.resize(skeleton.Joints.size());
+    m_layoutDirty = true;
+    return id;
+}
+
+void AnimationSystem::DestroyInstance(AnimationInstanceId id) {
+    if (id >= m_instances.size() || !m_instances[id].Alive) {
+        return;
+    }
+    auto shared = m_evaluators.find(m_instances[id].Rig);
+    if (shared != m_evaluators.end() && --shared->second.Users == 0) {
+        EvictPoseCache(shared->first); // Shared poses of the skeleton point to its evaluator
+        m_evaluators.erase(shared);
+    }
+    m_instances[id] = Instance();
+    m_freeInstances.push_back(id);
+    m_layoutDirty = true;
+}
+
+bool AnimationSystem::Play(AnimationInstanceId id, const BlendTree& tree, float fadeSeconds, float startPhase) {
+    if (id >= m_instances.size() || !m_instances[id].Alive || &tree.GetSkeleton() != m_instances[id].Rig ||
+        tree.GetRoot() == BlendTree::InvalidNode) {
+        return false;
+    }
+    Instance& instance = m_instances[id];
+    if (fadeSeconds > 0.0f && instance.Current.Tree) {
+        std::swap(instance.Previous, instance.Current);
+        instance.FadeElapsed = 0.0f;
+        instance.FadeDuration = fadeSeconds;
+        instance.PreviousFramesAhead = instance.FramesLeft;
+    } else {
+        instance.Previous.Reset(nullptr);
+        instance.FadeDuration = 0.0f;
+        instance.Snap = true;
+        instance.PreviousFramesAhead = 0;
+    }
+    instance.Current.Reset(&tree, startPhase);
+    instance.FramesLeft = 0; // Evaluate at the next update even when throttled
+    instance.MotionSamples = 0;
+    if (instance.Parameters.size() < tree.GetParameterCount()) {
+        instance.Parameters.resize(tree.GetParameterCount(), 0.0f);
+    }
+    size_t scratch = tree.GetNode(tree.GetRoot()).ScratchDepth;
+    if (instance.Previous.Tree) {
+        scratch = std::max<size_t>(scratch, instance.Previous.Tree->GetNode(instance.Previous.Tree->GetRoot()).ScratchDepth);
+    }
+    if (instance.Scratch.size() < scratch) {
+        instance.Scratch.resize(scratch);
+    }
+    return true;
+}
+
+void AnimationSystem::SetParameter(AnimationInstanceId id, uint32_t index, float value) {
+    if (id >= m_instances.size() || !m_instances[id].Alive) {
+        return;
+    }
+    std::vector<float>& parameters = m_instances[id].Parameters;
+    if (index >= parameters.size()) {
+        parameters.resize(index + 1, 0.0f);
+    }
+    parameters[index] = value;
+}
+
+void AnimationSystem::SetBounds(AnimationInstanceId id, const XMFLOAT3& center, float radius) {
+    if (id >= m_instances.size() || !m_instances[id].Alive) {
+        return;
+    }
+    m_instances[id].Center = center;
+    m_instances[id].Radius = std::max(radius, 0.0f);
+}
+
+void AnimationSystem::SetPoseCacheTolerance(float distance) {
+    m_poseCacheTolerance = std::max(distance, 0.0f);
+    EvictPoseCache(nullptr); // Shared poses and steps of the old tolerance
+}
+
+void AnimationSystem::SetSkinningMode(SkinningMode mode) {
+    if (mode != m_skinningMode) {
+        m_skinningMode = mode;
+        EvictPoseCache(nullptr); // Shared poses hold the other palette
+    }
+}
+
+void AnimationSystem::RebuildLayout() {
+    m_active.clear();
+    for (size_t i = 0; i < m_instances.size(); ++i) {
+        if (m_instances[i].Alive) m_active.push_back(static_cast<AnimationInstanceId>(i));
+    }
+    m_layoutDirty = false;
+}
+
+void AnimationSystem::Update(float deltaTime) {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (m_layoutDirty) {
+        RebuildLayout();
+    }
+
+    // Serial pass: shared pose lookups, then palette offsets (own poses first, then shared poses)
+    for (uint32_t entry : m_usedPoseCache) m_poseCache[entry].Used = false;
+    m_usedPoseCache.clear();
+    m_evaluated.clear();
+    size_t hits = 0, misses = 0;
+    size_t offset = 0;
+    for (AnimationInstanceId id : m_active) {
+        Instance& instance = m_instances[id];
+        if (UsePoseCache(instance, deltaTime, hits, misses)) continue;
+        instance.PaletteOffset = offset;
+        offset += instance.Evaluator->GetJointCount();
+        m_evaluated.push_back(id);
+    }
+    for (uint32_t entry : m_usedPoseCache) {
+        m_poseCache[entry].PaletteOffset = offset;
+        offset += m_poseCache[entry].Evaluator->GetJointCount();
+    }
+    for (AnimationInstanceId id : m_active) {
+        Instance& instance = m_instances[id];
+        if (instance.CacheEntry != NoCacheEntry) instance.PaletteOffset = m_poseCache[instance.CacheEntry].PaletteOffset;
+    }
+    const bool dualQuaternions = m_skinningMode == SkinningMode::DualQuaternion;
+    if (dualQuaternions) {
+        m_dualQuaternionPalette.resize(offset);
+        m_palette.clear();
+    } else {
+        m_palette.resize(offset);
+        m_dualQuaternionPalette.clear();
+    }
+    // Shared poses no instance asked for this frame
+    for (auto it = m_poseCacheIndex.begin(); it != m_poseCacheIndex.end();) {
+        if (m_poseCache[it->second].Used) {
+            ++it;
+        } else {
+            m_freePoseCache.push_back(it->second);
+            it = m_poseCacheIndex.erase(it);
+        }
+    }
+
+    // Jobs: shared poses, then instances with their own pose
+    const size_t sharedCount = m_usedPoseCache.size();
+    auto updateRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (i < sharedCount) {
+                CachedPose& entry = m_poseCache[m_usedPoseCache[i]];
+                if (entry.NeedsEvaluation) {
+                    entry.Sampler->Sample(entry.Time, entry.Pose);
+                    if (dualQuaternions) {
+                        entry.Evaluator->EvaluateDualQuaternion(entry.Pose, entry.ModelDualQuaternions.data(),
+                                                                entry.SkinningDualQuaternions.data(), entry.Model.data());
+                    } else {
+                        entry.Evaluator->Evaluate(entry.Pose, entry.Model.data(), entry.Skinning.data());
+                    }
+                    entry.NeedsEvaluation = false;
+                }
+                if (dualQuaternions) {
+                    std::copy(entry.SkinningDualQuaternions.begin(), entry.SkinningDualQuaternions.end(),
+                              m_dualQuaternionPalette.begin() + entry.PaletteOffset);
+                } else {
+                    std::copy(entry.Skinning.begin(), entry.Skinning.end(), m_palette.begin() + entry.PaletteOffset);
+                }
+            } else {
+                AnimationInstanceId id = m_evaluated[i - sharedCount];
+                UpdateInstance(m_instances[id], id, deltaTime);
+            }
+        }
+    };
+    const size_t jobCount = sharedCount + m_evaluated.size();
+    if (m_jobSystem && m_jobSystem->GetWorkerCount() > 0 && jobCount > m_batchSize) {
+        m_jobSystem->ParallelFor(jobCount, m_batchSize, updateRange);
+    } else {
+        updateRange(0, jobCount);
+    }
+    ++m_frame;
+
+    m_stats = AnimationSystemStats();
+    m_stats.Instances = m_active.size();
+    m_stats.Joints = offset;
+    m_stats.CacheHits = hits;
+    m_stats.CacheMisses = misses;
+    m_stats.CacheEntries = sharedCount;
+    for (AnimationInstanceId id : m_evaluated) {
+        const InstanceWork& work = m_instances[id].Work;
+        ++m_stats.LodInstances[work.Lod];
+        ++(work.Evaluated ? m_stats.PosesEvaluated : m_stats.PosesInterpolated);
+        m_stats.ChannelsSampled += work.ChannelsSampled;
+        m_stats.ChannelsDropped += work.ChannelsDropped;
+        m_stats.LayersSkipped += work.LayersSkipped;
+    }
+    m_stats.UpdateMilliseconds = SecondsSince(start) * 1000.0;
+}
+
+bool AnimationSystem::UsePoseCache(Instance& instance, float deltaTime, size_t& hits, size_t& misses) {
+    instance.CacheEntry = NoCacheEntry;
+    if (m_poseCacheTolerance <= 0.0f || !instance.Current.Tree || instance.Previous.Tree) {
+        return false;
+    }
+    const BlendTree& tree = *instance.Current.Tree;
+    const uint32_t root = tree.GetRoot();
+    const BlendNode& node = tree.GetNode(root);
+    if (node.Type != BlendNodeType::Clip) {
+        return false;
+    }
+
+    // The instance keeps its own clip time; only the pose is shared
+    AdvanceNode(instance.Current, root, deltaTime, nullptr);
+    const AnimationClip* clip = node.Sampler->GetClip();
+    const float stepTime = GetPoseCacheStep(*node.Sampler, instance);
+    int64_t step = std::llround(instance.Current.Phases[root] * clip->Duration / stepTime);
+    if (step * stepTime >= clip->Duration) {
+        step = 0; // Looping: the end is the start
+    }
+    const PoseCacheKey key = { clip, instance.Rig, step };
+    auto found = m_poseCacheIndex.find(key);
+    uint32_t index;
+    if (found != m_poseCacheIndex.end()) {
+        index = found->second;
+        ++hits;
+    } else {
+        if (!m_freePoseCache.empty()) {
+            index = m_freePoseCache.back();
+            m_freePoseCache.pop_back();
+        } else {
+            index = static_cast<uint32_t>(m_poseCache.size());
+            m_poseCache.emplace_back();
+        }
+        CachedPose& entry = m_poseCache[index];
+        entry.Key = key;
+        entry.Sampler = node.Sampler;
+        entry.Evaluator = instance.Evaluator;
+        entry.Time = step * stepTime;
+        entry.NeedsEvaluation = true;
+        const size_t jointCount = instance.Evaluator->GetJointCount();
+        entry.Model.resize(jointCount);
+        if (m_skinningMode == SkinningMode::DualQuaternion) {
+            entry.ModelDualQuaternions.resize(jointCount);
+            entry.SkinningDualQuaternions.resize(jointCount);
+        } else {
+            entry.Skinning.resize(jointCount);
+        }
+        m_poseCacheIndex.emplace(key, index);
+        ++misses;
+    }
+    CachedPose& entry = m_poseCache[index];
+    if (!entry.Used) {
+        entry.Used = true;
+        m_usedPoseCache.push_back(index);
+    }
+    instance.CacheEntry = index;
+    instance.Snap = true; // Its own pose is stale when it stops sharing
+    instance.FramesLeft = 0;
+    instance.Work = InstanceWork();
+    return true;
+}
+
+float AnimationSystem::GetPoseCacheStep(const AnimationSampler& sampler, const Instance& instance) {
+    const PoseCacheKey key = { sampler.GetClip(), instance.Rig, 0 };
+    auto found = m_poseCacheSteps.find(key);
+    if (found != m_poseCacheSteps.end()) {
+        return found->second;
+    }
+    // Fastest joint of the clip, from model-space positions sampled at 240 Hz (capped for long clips).
+    // A shared pose is at most half a step from the instance's time: step = 2 * tolerance / speed.
+    const float duration = sampler.GetClip()->Duration;
+    const size_t jointCount = instance.Evaluator->GetJointCount();
+    const size_t sampleCount = std::min<size_t>(static_cast<size_t>(duration * 240.0f) + 2, 4096);
+    const float interval = duration / (sampleCount - 1);
+    LocalPose pose;
+    std::vector<XMFLOAT4X4A> model(jointCount), previous(jointCount);
+    float maxSpeed = 0.0f;
+    for (size_t i = 0; i < sampleCount; ++i) {
+        sampler.Sample(i * interval, pose);
+        instance.Evaluator->Evaluate(pose, model.data(), nullptr);
+        for (size_t j = 0; j < jointCount && i > 0; ++j) {
+            XMVECTOR offset = XMVectorSubtract(XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&model[j]._41)),
+                                               XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&previous[j]._41)));
+            maxSpeed = std::max(maxSpeed, XMVectorGetX(XMVector3Length(offset)) / interval);
+        }
+        std::swap(model, previous);
+    }
+    // A still clip shares one pose; the margin covers speed peaks between the samples
+    float step = maxSpeed > 0.0f ? 2.0f * m_poseCacheTolerance / (maxSpeed * 1.05f) : duration;
+    step = std::max(step, 1e-5f);
+    m_poseCacheSteps.emplace(key, step);
+    return step;
+}
+
+void AnimationSystem::EvictPoseCache(const Skeleton* rig) {
+    for (auto it = m_poseCacheSteps.begin(); it != m_poseCacheSteps.end();) {
+        it = !rig || it->first.Rig == rig ? m_poseCacheSteps.erase(it) : std::next(it);
+    }
+    for (auto it = m_poseCacheIndex.begin(); it != m_poseCacheIndex.end();) {
+        if (!rig || it->first.Rig == rig) {
+            m_poseCache[it->second].Used = false;
+            m_freePoseCache.push_back(it->second);
+            it = m_poseCacheIndex.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_usedPoseCache.erase(std::remove_if(m_usedPoseCache.begin(), m_usedPoseCache.end(),
+                                         [&](uint32_t entry) { return !rig || m_poseCache[entry].Key.Rig == rig; }),
+                          m_usedPoseCache.end());
+}
+
+void AnimationSystem::SelectLod(Instance& instance, AnimationInstanceId id, float deltaTime) {
+    float pixels = FLT_MAX;
+    if (!m_lodViews.empty() && instance.Radius > 0.0f) {
+        pixels = 0.0f;
+        for (const AnimationLodView& view : m_lodViews) {
+            if (view.View) {
+                pixels = std::max(pixels, view.View->GetProjectedSize(2.0f * instance.Radius, instance.Center, view.ViewportHeight));
+            }
+        }
+    }
+    uint32_t rate = pixels < m_lodSettings.HalfRatePixels ? 4 : pixels < m_lodSettings.FullRatePixels ? 2 : 1;
+    // Halfway between two evaluations, a joint accelerating at 'a' is up to a * span^2 / 8 off the
+    // interpolated pose; lower the rate until that fits half the error budget. The end of a crossfade
+    // is a kink no estimate sees coming, so an interval never spans it.
+    const float errorBudget = 0.5f * m_lodSettings.MaxPixelError;
+    while (rate > 1) {
+        const float span = rate * deltaTime;
+        const float pixelsPerUnit = pixels / (2.0f * instance.Radius);
+        const bool fadeEnds = instance.Previous.Tree && instance.FadeDuration - instance.FadeElapsed < span;
+        if (instance.MotionSamples >= 3 && !fadeEnds &&
+            instance.MaxAcceleration * span * span * 0.125f * pixelsPerUnit <= errorBudget) {
+            break;
+        }
+        rate /= 2;
+    }
+    instance.Work.Lod = rate == 4 ? 2 : rate == 2 ? 1 : 0;
+    // Each throttled instance evaluates on its own slot of the cycle, spreading the work over frames
+    instance.Interval = rate - (m_frame + id) % rate;
+    const bool reduced = instance.Work.Lod > 0;
+    instance.JointMask = reduced && pixels < m_lodSettings.LeafJointPixels ? instance.LeafJointMask : nullptr;
+    // Dropping a layer of weight w (and renormalizing) moves a joint by up to w / (1 - w) times the
+    // character's size
+    instance.MinBlendWeight =
+        reduced ? std::max(m_lodSettings.MinBlendWeight, errorBudget / (errorBudget + pixels)) : m_lodSettings.MinBlendWeight;
+}
+
+void AnimationSystem::SampleMotion(Instance& instance) {
+    // Called at an evaluation: the last update showed the previous evaluated pose
+    const size_t jointCount = instance.Model.size();
+    const float span = instance.MotionElapsed;
+    instance.MotionElapsed = 0.0f;
+    if (instance.MotionSamples == 0 || span <= 0.0f) {
+        instance.MotionPositions.resize(jointCount);
+        for (size_t j = 0; j < jointCount; ++j) {
+            instance.MotionPositions[j] = XMFLOAT3(instance.Model[j]._41, instance.Model[j]._42, instance.Model[j]._43);
+        }
+        instance.MotionSamples = 1;
+        return;
+    }
+    instance.MotionVelocities.resize(jointCount);
+    const float accelerationSpan = 0.5f * (span + instance.MotionSpan); // Between the midpoints of the two spans
+    float maxAcceleration = 0.0f;
+    for (size_t j = 0; j < jointCount; ++j) {
+        XMVECTOR position = XMVectorSet(instance.Model[j]._41, instance.Model[j]._42, instance.Model[j]._43, 0.0f);
+        XMVECTOR velocity = XMVectorScale(XMVectorSubtract(position, XMLoadFloat3(&instance.MotionPositions[j])), 1.0f / span);
+        if (instance.MotionSamples >= 2) {
+            XMVECTOR change = XMVectorSubtract(velocity, XMLoadFloat3(&instance.MotionVelocities[j]));
+            maxAcceleration = std::max(maxAcceleration, XMVectorGetX(XMVector3Length(change)) / accelerationSpan);
+        }
+        XMStoreFloat3(&instance.MotionPositions[j], position);
+        XMStoreFloat3(&instance.MotionVelocities[j], velocity);
+    }
+    if (instance.MotionSamples >= 2) {
+        // The peak decays slowly: one sample can fall between the peaks of a motion cycle
+        instance.MaxAcceleration = std::max(maxAcceleration, instance.MaxAcceleration * 0.95f);
+    }
+    instance.MotionSpan = span;
+    instance.MotionSamples = std::min(instance.MotionSamples + 1, 3u);
+}
+
+void AnimationSystem::UpdateInstance(Instance& instance, AnimationInstanceId id, float deltaTime) {
+    // Runs on a worker: touches only this instance and read-only shared data
+    const uint8_t lod = instance.Work.Lod;
+    instance.Work = InstanceWork();
+    instance.Work.Lod = lod;
+    if (instance.FramesLeft == 0) {
+        const LocalPose& shown = instance.DisplayPoseShown ? instance.DisplayPose : instance.Pose;
+        if (instance.Snap) {
+            instance.MotionSamples = 0;
+            instance.MotionElapsed = 0.0f;
+        } else if (instance.PreviousFramesAhead == 0) {
+            SampleMotion(instance); // Not after Play cut an interval short: the shown pose was interpolated
+        }
+        SelectLod(instance, id, deltaTime);
+        if (instance.Snap) {
+            // One frame at full rate; the stagger picks up from the next evaluation
+            instance.Interval = 1;
+            instance.Snap = false;
+        }
+        if (instance.Interval > 1) {
+            CopyPose(instance.FromPose, shown);
+        }
+        // Throttled instances evaluate the pose at the end of their interval. A tree fading out since
+        // Play cut the last interval short was evaluated ahead already.
+        const float framesAhead = static_cast<float>(instance.PreviousFramesAhead);
+        EvaluateTrees(instance, deltaTime * instance.Interval, deltaTime * (instance.Interval - framesAhead));
+        instance.PreviousFramesAhead = 0;
+        instance.Work.Evaluated = true;
+        instance.FramesLeft = instance.Interval;
+    }
+    --instance.FramesLeft;
+    instance.MotionElapsed += deltaTime;
+
+    const LocalPose* pose = &instance.Pose;
+    if (instance.FramesLeft > 0) {
+        CopyPose(instance.DisplayPose, instance.FromPose);
+        LerpPose(instance.DisplayPose, instance.Pose, static_cast<float>(instance.Interval - instance.FramesLeft) / instance.Interval);
+        pose = &instance.DisplayPose;
+    }
+    instance.DisplayPoseShown = pose == &instance.DisplayPose;
+    if (m_skinningMode == SkinningMode::DualQuaternion) {
+        instance.Evaluator->EvaluateDualQuaternion(*pose, instance.ModelDualQuaternions.data(),
+                                                   m_dualQuaternionPalette.data() + instance.PaletteOffset, instance.Model.data());
+    } else {
+        instance.Evaluator->Evaluate(*pose, instance.Model.data(), m_palette.data() + instance.PaletteOffset);
+    }
+}
+
+void AnimationSystem::EvaluateTrees(Instance& instance, float deltaTime, float previousDeltaTime) {
+    if (instance.Current.Tree) {
+        UpdateWeights(instance, instance.Current);
+        AdvanceNode(instance.Current, instance.Current.Tree->GetRoot(), deltaTime, nullptr);
+        SkipNegligibleLayers(instance, instance.Current);
+        EvaluateNode(instance, instance.Current, instance.Current.Tree->GetRoot(), instance.Pose, instance.Scratch.data());
+    }
+    if (instance.Previous.Tree) {
+        instance.FadeElapsed += deltaTime;
+        if (instance.FadeElapsed >= instance.FadeDuration) {
+            instance.Previous.Reset(nullptr);
+        } else {
+            UpdateWeights(instance, instance.Previous);
+            AdvanceNode(instance.Previous, instance.Previous.Tree->GetRoot(), previousDeltaTime, nullptr);
+            SkipNegligibleLayers(instance, instance.Previous);
+            EvaluateNode(instance, instance.Previous, instance.Previous.Tree->GetRoot(), instance.FadePose, instance.Scratch.data());
+            LerpPose(instance.FadePose, instance.Pose, instance.FadeElapsed / instance.FadeDuration);
+            std::swap(instance.Pose, instance.FadePose);
+        }
+    }
+}
+
+void AnimationSystem::UpdateWeights(const Instance& instance, Playback& playback) const {
+    const BlendTree& tree = *playback.Tree;
+    for (uint32_t n = 0; n < tree.GetNodeCount(); ++n) {
+        if (tree.GetNode(n).Type != BlendNodeType::Clip) {
+            tree.ComputeWeights(n, instance.Parameters.data(), playback.Weights.data() + tree.GetNode(n).FirstWeight);
+        }
+    }
+}
+
+void AnimationSystem::SkipNegligibleLayers(Instance& instance, Playback& playback) const {
+    // After advancing: timing uses the full weights, so skipping a layer never shifts the phase
+    const BlendTree& tree = *playback.Tree;
+    const float minWeight = instance.MinBlendWeight;
+    if (minWeight <= 0.0f) {
+        return;
+    }
+    for (uint32_t n = 0; n < tree.GetNodeCount(); ++n) {
+        const BlendNode& node = tree.GetNode(n);
+        if (node.Type == BlendNodeType::Clip) continue;
+        float* weights = playback.Weights.data() + node.FirstWeight;
+
+        if (node.Type == BlendNodeType::Additive) {
+            if (weights[0] > 0.0f && weights[0] < minWeight) {
+                weights[0] = 0.0f;
+                ++instance.Work.LayersSkipped;
+            }
+            continue;
+        }
+        // Drop children under the threshold (never the strongest one) and renormalize the rest
+        const size_t count = node.Children.size();
+        const size_t strongest = static_cast<size_t>(std::max_element(weights, weights + count) - weights);
+        float total = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            if (i != strongest && weights[i] > 0.0f && weights[i] < minWeight) {
+                weights[i] = 0.0f;
+                ++instance.Work.LayersSkipped;
+            }
+            total += weights[i];
+        }
+        for (size_t i = 0; i < count; ++i) weights[i] /= total;
+    }
+}
+
+float AnimationSystem::GetDuration(const Playback& playback, uint32_t nodeIndex) const {
+    const BlendNode& node = playback.Tree->GetNode(nodeIndex);
+    switch (node.Type) {
+    case BlendNodeType::Clip:
+        return node.PlaybackRate > 0.0f ? node.Sampler->GetClip()->Duration / node.PlaybackRate : 0.0f;
+    case BlendNodeType::Blend1D:
+    case BlendNodeType::Blend2D: {
+        float duration = 0.0f;
+        for (size_t i = 0; i < node.Children.size(); ++i) {
+            float weight = playback.Weights[node.FirstWeight + i];
+            if (weight > 0.0f) duration += weight * GetDuration(playback, node.Children[i]);
+        }
+        return duration;
+    }
+    case BlendNodeType::Additive:
+        return GetDuration(playback, node.Children[0]);
+    }
+    return 0.0f;
+}
+
+void AnimationSystem::AdvanceNode(Playback& playback, uint32_t nodeIndex, float deltaTime, const float* syncPhase) const {
+    const BlendNode& node = playback.Tree->GetNode(nodeIndex);
+    if (node.Type == BlendNodeType::Additive) {
+        // The base follows any enclosing blend space, the additive layer keeps its own time
+        AdvanceNode(playback, node.Children[0], deltaTime, syncPhase);
+        AdvanceNode(playback, node.Children[1], deltaTime, nullptr);
+        return;
+    }
+
+    float& phase = playback.Phases[nodeIndex];
+    if (syncPhase) {
+        phase = *syncPhase;
+    } else {
+        float duration = GetDuration(playback, nodeIndex);
+        if (duration > 0.0f) {
+            phase = AnimationSampler::WrapTime(phase + deltaTime / duration, 1.0f);
+        }
+    }
+    for (uint32_t child : node.Children) {
+        AdvanceNode(playback, child, deltaTime, &phase);
+    }
+}
+
+void AnimationSystem::EvaluateNode(Instance& instance, Playback& playback, uint32_t nodeIndex, LocalPose& outPose, LocalPose* scratch) const {
+    const BlendTree& tree = *playback.Tree;
+    const BlendNode& node = tree.GetNode(nodeIndex);
+    switch (node.Type) {
+    case BlendNodeType::Clip: {
+        size_t sampled = node.Sampler->Sample(playback.Phases[nodeIndex] * node.Sampler->GetClip()->Duration, outPose,
+                                              &playback.Cursors[nodeIndex], instance.JointMask);
+        instance.Work.ChannelsSampled += sampled;
+        instance.Work.ChannelsDropped += node.Sampler->GetChannelCount() - sampled;
+        break;
+    }
+    case BlendNodeType::Blend1D:
+    case BlendNodeType::Blend2D: {
+        // Running blend: after each child the output is the weighted average of the children so far
+        float total = 0.0f;
+        for (size_t i = 0; i < node.Children.size(); ++i) {
+            float weight = playback.Weights[node.FirstWeight + i];
+            if (weight <= 0.0f) continue;
+            if (total == 0.0f) {
+                EvaluateNode(instance, playback, node.Children[i], outPose, scratch);
+            } else {
+                EvaluateNode(instance, playback, node.Children[i], scratch[0], scratch + 1);
+                LerpPose(outPose, scratch[0], weight / (total + weight));
+            }
+            total += weight;
+        }
+        if (total == 0.0f) {
+            CopyPose(outPose, tree.GetBindPose());
+        }
+        break;
+    }
+    case BlendNodeType::Additive: {
+        EvaluateNode(instance, playback, node.Children[0], outPose, scratch);
+        float weight = playback.Weights[node.FirstWeight];
+        if (weight > 0.0f) {
+            EvaluateNode(instance, playback, node.Children[1], scratch[0], scratch + 1);
+            AddPose(outPose, scratch[0], tree.GetBindPose(), weight);
+        }
+        break;
+    }
+    }
+}
+
+// --- Benchmark ---
+
+namespace {
+
+// Looping clip on every joint of 'skeleton': a swing of 'amplitude' radians at 'cycles' per clip
+// around 'axis', translations kept at the bind pose
+void MakeBenchmarkClip(const Skeleton& skeleton, const LocalPose& bindPose, float duration, float cycles, float amplitude,
+                       XMFLOAT3 axis, AnimationClip& clip) {
+    const float keyRate = 30.0f;
+    const size_t keyCount = static_cast<size_t>(duration * keyRate) + 1;
+    clip.Duration = duration;
+    for (size_t j = 0; j < skeleton.Joints.size(); ++j) {
+        AnimationChannel channel;
+        channel.TargetNodeId = skeleton.Joints[j].NameId;
+        channel.PositionTimestamps.push_back(0.0f);
+        channel.Positions.push_back(XMFLOAT3(bindPose.Translations[j].x, bindPose.Translations[j].y, bindPose.Translations[j].z));
+        for (size_t k = 0; k < keyCount; ++k) {
+            float t = std::min(k / keyRate, duration);
+            float angle = amplitude * std::sin(XM_2PI * cycles * t / duration + 0.3f * j);
+            XMFLOAT4 q;
+            XMStoreFloat4(&q, XMQuaternionRotationAxis(XMLoadFloat3(&axis), angle));
+            channel.RotationTimestamps.push_back(t);
+            channel.Rotations.push_back(q);
+        }
+        channel.ScaleTimestamps.push_back(0.0f);
+        channel.Scales.push_back(XMFLOAT3(1.0f, 1.0f, 1.0f));
+        clip.Channels.push_back(std::move(channel));
+    }
+}
+
+// 60 joint branchy skeleton with idle / walk / run / strafe clips and an additive lean, optionally
+// cooked to dual quaternion keys. Trees (parameters: 0 speed, 1 direction, 2 lean weight): Locomotion is a 2D blend space of the
+// five clips under the additive lean, Forward a 1D blend of idle, walk and run.
+struct BenchmarkScene {
+    static constexpr size_t JointCount = 60;
+
+    Skeleton Rig;
+    std::vector<AnimationClip> Clips;
+    std::vector<AnimationSampler> Samplers;
+    std::unique_ptr<BlendTree> Locomotion;
+    std::unique_ptr<BlendTree> Forward;
+
+    bool Build(bool dualQuaternionKeys = false) {
+        std::mt19937 random(17);
+        Rig.Joints.resize(JointCount);
+        std::vector<XMFLOAT4X4> bindModel(JointCount);
+        for (size_t j = 0; j < JointCount; ++j) {
+            Joint& joint = Rig.Joints[j];
+            joint.NameId = StringId::Intern(L"animsys" + std::to_wstring(j));
+            joint.ParentIndex = j == 0 ? -1 : static_cast<int>(std::uniform_int_distribution<size_t>(j > 4 ? j - 4 : 0, j - 1)(random));
+            XMMATRIX local = XMMatrixTranslation(0.0f, 0.1f, 0.02f * (j % 3));
+            XMMATRIX model = joint.ParentIndex >= 0 ? XMMatrixMultiply(local, XMLoadFloat4x4(&bindModel[joint.ParentIndex])) : local;
+            XMStoreFloat4x4(&bindModel[j], model);
+            XMStoreFloat4x4(&joint.LocalBindTransform, local);
+            XMStoreFloat4x4(&joint.InverseBindPoseMatrix, XMMatrixInverse(nullptr, model));
+            Rig.JointNameToIndex[joint.NameId] = static_cast<int>(j);
+        }
+        LocalPose bindPose;
+        AnimationSampler::GetBindPose(Rig, bindPose);
+
+        Clips.resize(6);
+        MakeBenchmarkClip(Rig, bindPose, 4.0f, 1.0f, 0.05f, XMFLOAT3(1.0f, 0.0f, 0.0f), Clips[0]);
+        MakeBenchmarkClip(Rig, bindPose, 1.2f, 1.0f, 0.4f, XMFLOAT3(1.0f, 0.0f, 0.0f), Clips[1]);
+        MakeBenchmarkClip(Rig, bindPose, 0.8f, 1.0f, 0.7f, XMFLOAT3(1.0f, 0.0f, 0.0f), Clips[2]);
+        MakeBenchmarkClip(Rig, bindPose, 1.0f, 1.0f, 0.4f, XMFLOAT3(0.0f, 0.0f, 1.0f), Clips[3]);
+        MakeBenchmarkClip(Rig, bindPose, 1.0f, 1.0f, -0.4f, XMFLOAT3(0.0f, 0.0f, 1.0f), Clips[4]);
+        MakeBenchmarkClip(Rig, bindPose, 2.0f, 1.0f, 0.2f, XMFLOAT3(0.0f, 1.0f, 0.0f), Clips[5]);
+        Samplers.resize(Clips.size());
+        for (size_t c = 0; c < Clips.size(); ++c) {
+            if (dualQuaternionKeys && AnimationCompressor::ConvertToDualQuaternionKeys(Clips[c], Rig) != Clips[c].Channels.size()) {
+                return false;
+            }
+            if (!Samplers[c].Bind(Clips[c], Rig)) {
+                return false;
+            }
+        }
+
+        Locomotion = std::make_unique<BlendTree>(Rig);
+        std::vector<uint32_t> samples;
+        for (size_t c = 0; c < 5; ++c) samples.push_back(Locomotion->AddClip(Samplers[c]));
+        uint32_t space = Locomotion->AddBlend2D(0, 1, samples, { { 0.0f, 0.0f }, { 1.5f, 0.0f }, { 4.0f, 0.0f }, { 1.5f, -1.0f }, { 1.5f, 1.0f } });
+        uint32_t lean = Locomotion->AddClip(Samplers[5]);
+        uint32_t root = Locomotion->AddAdditive(space, lean, 2);
+
+        Forward = std::make_unique<BlendTree>(Rig);
+        std::vector<uint32_t> forwardSamples = { Forward->AddClip(Samplers[0]), Forward->AddClip(Samplers[1]), Forward->AddClip(Samplers[2]) };
+        uint32_t forwardRoot = Forward->AddBlend1D(0, forwardSamples, { 0.0f, 1.5f, 4.0f });
+        return root != BlendTree::InvalidNode && forwardRoot != BlendTree::InvalidNode;
+    }
+
+    // Characters alternate between the trees with random parameters
+    void AddCharacters(AnimationSystem& system, size_t count) const {
+        std::mt19937 random(5);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (size_t i = 0; i < count; ++i) {
+            AnimationInstanceId id = system.CreateInstance(Rig);
+            system.Play(id, (i % 2) ? *Forward : *Locomotion);
+            system.SetParameter(id, 0, 4.0f * unit(random));
+            system.SetParameter(id, 1, 2.0f * unit(random) - 1.0f);
+            system.SetParameter(id, 2, unit(random));
+        }
+    }
+
+    // Every 4th character switches trees (0.25 s crossfade) every 30 frames
+    void SwitchTrees(AnimationSystem& system, size_t count, size_t frame) const {
+        if (frame % 30 != 15) return;
+        for (AnimationInstanceId id = 0; id < count; id += 4) {
+            system.Play(id, ((id + frame / 30) % 2) ? *Locomotion : *Forward, 0.25f);
+        }
+    }
+};
+
+} // namespace
+
+bool AnimationSystem::RunBenchmark(size_t characterCount, JobSystem* jobSystem) {
+    characterCount = std::max<size_t>(characterCount, 1);
+    const size_t jointCount = BenchmarkScene::JointCount;
+    BenchmarkScene scene;
+    if (!scene.Build()) {
+        std::cerr << "Animation system benchmark: scene setup failed." << std::endl;
+        return false;
+    }
+
+    // Same characters on the calling thread and on the job system
+    AnimationSystem serial, parallel;
+    serial.Initialize(nullptr);
+    parallel.Initialize(jobSystem);
+    scene.AddCharacters(serial, characterCount);
+    scene.AddCharacters(parallel, characterCount);
+
+    const size_t frameCount = 120;
+    const float frameTime = 1.0f / 60.0f;
+    double serialSeconds = 0.0, parallelSeconds = 0.0;
+    bool same = true;
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        scene.SwitchTrees(serial, characterCount, frame);
+        scene.SwitchTrees(parallel, characterCount, frame);
+        auto start = std::chrono::high_resolution_clock::now();
+        serial.Update(frameTime);
+        serialSeconds += SecondsSince(start);
+        start = std::chrono::high_resolution_clock::now();
+        parallel.Update(frameTime);
+        parallelSeconds += SecondsSince(start);
+        same = same && std::memcmp(serial.GetPalette().data(), parallel.GetPalette().data(),
+                                   serial.GetPalette().size() * sizeof(XMFLOAT4X4A)) == 0;
+    }
+
+    // A 1D blend at a sample's threshold must play exactly that clip
+    AnimationSystem single;
+    single.Initialize(nullptr);
+    AnimationInstanceId walker = single.CreateInstance(scene.Rig);
+    single.Play(walker, *scene.Forward);
+    single.SetParameter(walker, 0, 1.5f);
+    PoseEvaluator evaluator;
+    evaluator.Bind(scene.Rig);
+    std::vector<XMFLOAT4X4A> referenceModel(jointCount), referenceSkinning(jointCount);
+    LocalPose pose;
+    float maxDifference = 0.0f;
+    float time = 0.0f;
+    for (size_t frame = 0; frame < 90; ++frame) {
+        single.Update(frameTime);
+        time = AnimationSampler::WrapTime(time + frameTime, scene.Clips[1].Duration);
+        scene.Samplers[1].Sample(time, pose);
+        evaluator.Evaluate(pose, referenceModel.data(), referenceSkinning.data());
+        const float* palette = &single.GetPalette()[single.GetPaletteOffset(walker)]._11;
+        const float* reference = &referenceSkinning[0]._11;
+        for (size_t k = 0; k < jointCount * 16; ++k) {
+            maxDifference = std::max(maxDifference, std::abs(palette[k] - reference[k]));
+        }
+    }
+    bool ok = same && maxDifference <= 1e-3f;
+
+    double characterUpdates = static_cast<double>(characterCount) * frameCount;
+    unsigned int workers = jobSystem ? jobSystem->GetWorkerCount() : 0;
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    report << "Animation system benchmark: " << characterCount << " characters x " << jointCount << " joints x " << frameCount
+           << " frames (2D blend space + additive layer / 1D blend, crossfades)\n"
+           << "  Calling thread: " << serialSeconds * 1000.0 / frameCount << " ms/frame ("
+           << characterUpdates / std::max(serialSeconds * 1000.0, 1e-9) << " characters/ms)\n"
+           << "  Job system:     " << parallelSeconds * 1000.0 / frameCount << " ms/frame ("
+           << characterUpdates / std::max(parallelSeconds * 1000.0, 1e-9) << " characters/ms, " << workers << " workers, "
+           << std::setprecision(2) << serialSeconds / std::max(parallelSeconds, 1e-9) << "x, ideal " << workers + 1 << "x)\n"
+           << "  Palette: " << serial.GetPalette().size() << " matrices, "
+           << serial.GetPalette().size() * sizeof(XMFLOAT4X4A) / 1024 << " KB contiguous\n";
+    if (!same) {
+        report << "  FAILED: job system palettes differ from the calling thread's\n";
+    }
+    if (maxDifference > 1e-3f) {
+        report << "  FAILED: blend space at a sample differs from its clip by " << std::setprecision(5) << maxDifference << "\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
+
+bool AnimationSystem::RunLodBenchmark(size_t characterCount) {
+    characterCount = std::max<size_t>(characterCount, 1);
+    const size_t jointCount = BenchmarkScene::JointCount;
+    BenchmarkScene scene;
+    if (!scene.Build()) {
+        std::cerr << "Animation LOD benchmark: scene setup failed." << std::endl;
+        return false;
+    }
+
+    // Two players side by side (horizontal split screen), characters from 2 to 200 m ahead
+    const float viewportHeight = 540.0f;
+    Camera cameras[2];
+    std::vector<AnimationLodView> views;
+    for (int c = 0; c < 2; ++c) {
+        cameras[c].SetPosition(c * 4.0f - 2.0f, 1.7f, 0.0f);
+        cameras[c].LookAt(XMFLOAT3(c * 4.0f - 2.0f, 1.7f, 100.0f));
+        cameras[c].UpdateProjectionMatrix(XM_PIDIV4, 1920.0f / viewportHeight, 0.1f, 1000.0f);
+        views.push_back({ &cameras[c], viewportHeight });
+    }
+
+    AnimationSystem full, lod;
+    full.Initialize(nullptr);
+    lod.Initialize(nullptr);
+    lod.SetLodViews(views);
+    scene.AddCharacters(full, characterCount);
+    scene.AddCharacters(lod, characterCount);
+    // Bounds: a sphere around the root through the farthest point the joint chains can reach, so every
+    // pose fits (the error budget relies on it)
+    std::vector<float> reach(jointCount, 0.0f);
+    float radius = 0.0f;
+    for (size_t j = 1; j < jointCount; ++j) {
+        const XMFLOAT4X4& local = scene.Rig.Joints[j].LocalBindTransform;
+        reach[j] = reach[scene.Rig.Joints[j].ParentIndex] + XMVectorGetX(XMVector3Length(XMVectorSet(local._41, local._42, local._43, 0.0f)));
+        radius = std::max(radius, reach[j]);
+    }
+    std::vector<float> pixelsPerMeter(characterCount);
+    for (AnimationInstanceId id = 0; id < characterCount; ++id) {
+        float distance = 2.0f + 198.0f * (id + 0.5f) / characterCount;
+        XMFLOAT3 center((id % 11) * 1.5f - 7.5f, 0.0f, distance);
+        full.SetBounds(id, center, radius);
+        lod.SetBounds(id, center, radius);
+        pixelsPerMeter[id] = std::max(cameras[0].GetProjectedSize(1.0f, center, viewportHeight),
+                                      cameras[1].GetProjectedSize(1.0f, center, viewportHeight));
+    }
+
+    // Joint position error of the LOD run against full detail, in pixels, per LOD level
+    const size_t frameCount = 240;
+    const float frameTime = 1.0f / 60.0f;
+    double fullSeconds = 0.0, lodSeconds = 0.0;
+    AnimationSystemStats fullTotal, lodTotal;
+    auto accumulate = [](AnimationSystemStats& total, const AnimationSystemStats& frame) {
+        total.PosesEvaluated += frame.PosesEvaluated;
+        total.PosesInterpolated += frame.PosesInterpolated;
+        total.ChannelsSampled += frame.ChannelsSampled;
+        total.ChannelsDropped += frame.ChannelsDropped;
+        total.LayersSkipped += frame.LayersSkipped;
+    };
+    float maxPixelError[3] = {};
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        scene.SwitchTrees(full, characterCount, frame);
+        scene.SwitchTrees(lod, characterCount, frame);
+        auto start = std::chrono::high_resolution_clock::now();
+        full.Update(frameTime);
+        fullSeconds += SecondsSince(start);
+        start = std::chrono::high_resolution_clock::now();
+        lod.Update(frameTime);
+        lodSeconds += SecondsSince(start);
+        accumulate(fullTotal, full.GetStats());
+        accumulate(lodTotal, lod.GetStats());
+
+        for (AnimationInstanceId id = 0; id < characterCount; ++id) {
+            const XMFLOAT4X4A* reference = full.GetModelTransforms(id);
+            const XMFLOAT4X4A* reduced = lod.GetModelTransforms(id);
+            float error = 0.0f;
+            for (size_t j = 0; j < jointCount; ++j) {
+                XMVECTOR offset = XMVectorSubtract(XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&reference[j]._41)),
+                                                   XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&reduced[j]._41)));
+                error = std::max(error, XMVectorGetX(XMVector3Length(offset)));
+            }
+            uint8_t level = lod.m_instances[id].Work.Lod;
+            maxPixelError[level] = std::max(maxPixelError[level], error * pixelsPerMeter[id]);
+        }
+    }
+    const AnimationSystemStats& levels = lod.GetStats();
+
+    // Characters at full detail must match (up to the rounding of clip times advanced by whole intervals
+    // before), reduced ones stay within the error budget
+    const float budget = lod.m_lodSettings.MaxPixelError;
+    bool ok = maxPixelError[0] <= 0.01f && maxPixelError[1] <= budget && maxPixelError[2] <= budget &&
+              lodTotal.PosesEvaluated < fullTotal.PosesEvaluated;
+
+    auto saved = [](double before, double after) { return before > 0.0 ? 100.0 * (1.0 - after / before) : 0.0; };
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    report << "Animation LOD benchmark: " << characterCount << " characters x " << jointCount << " joints x " << frameCount
+           << " frames, 2 views\n"
+           << "  LOD levels: " << levels.LodInstances[0] << " every frame, " << levels.LodInstances[1] << " every 2nd, "
+           << levels.LodInstances[2] << " every 4th\n"
+           << "  Poses evaluated:  " << fullTotal.PosesEvaluated << " -> " << lodTotal.PosesEvaluated << " ("
+           << saved(fullTotal.PosesEvaluated, lodTotal.PosesEvaluated) << "% saved, " << lodTotal.PosesInterpolated << " interpolated)\n"
+           << "  Channels sampled: " << fullTotal.ChannelsSampled << " -> " << lodTotal.ChannelsSampled << " ("
+           << saved(fullTotal.ChannelsSampled, lodTotal.ChannelsSampled) << "% saved, " << lodTotal.ChannelsDropped
+           << " leaf joint channels dropped, " << lodTotal.LayersSkipped << " layers skipped)\n"
+           << "  Update: " << fullSeconds * 1000.0 / frameCount << " -> " << lodSeconds * 1000.0 / frameCount << " ms/frame ("
+           << saved(fullSeconds, lodSeconds) << "% saved)\n"
+           << std::setprecision(2) << "  Max joint error: " << maxPixelError[0] << " / " << maxPixelError[1] << " / "
+           << maxPixelError[2] << " pixels (full / 2nd / 4th frame levels, budget " << budget << ")\n";
+    if (maxPixelError[0] > 0.01f) {
+        report << "  FAILED: full detail characters differ from the reference\n";
+    }
+    if (maxPixelError[1] > budget || maxPixelError[2] > budget) {
+        report << "  FAILED: reduced characters over the screen-space error budget\n";
+    }
+    if (lodTotal.PosesEvaluated >= fullTotal.PosesEvaluated) {
+        report << "  FAILED: LOD saved no evaluations\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
+
+bool AnimationSystem::RunCrowdBenchmark(size_t agentCount, JobSystem* jobSystem, float tolerance) {
+    agentCount = std::max<size_t>(agentCount, 1);
+    tolerance = std::max(tolerance, 1e-5f);
+    const size_t jointCount = BenchmarkScene::JointCount;
+    BenchmarkScene scene;
+    if (!scene.Build()) {
+        std::cerr << "Crowd benchmark: scene setup failed." << std::endl;
+        return false;
+    }
+    // Idle, walk and run, each a single clip
+    std::vector<std::unique_ptr<BlendTree>> trees;
+    for (size_t c = 0; c < 3; ++c) {
+        trees.push_back(std::make_unique<BlendTree>(scene.Rig));
+        trees.back()->AddClip(scene.Samplers[c]);
+    }
+
+    AnimationSystem exact, shared;
+    exact.Initialize(jobSystem);
+    exact.SetPoseCacheTolerance(0.0f);
+    shared.Initialize(jobSystem);
+    shared.SetPoseCacheTolerance(tolerance);
+    std::mt19937 random(23);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (size_t i = 0; i < agentCount; ++i) {
+        const BlendTree& tree = *trees[std::uniform_int_distribution<size_t>(0, trees.size() - 1)(random)];
+        float phase = unit(random);
+        exact.Play(exact.CreateInstance(scene.Rig), tree, 0.0f, phase);
+        shared.Play(shared.CreateInstance(scene.Rig), tree, 0.0f, phase);
+    }
+
+    const size_t frameCount = 240;
+    const float frameTime = 1.0f / 60.0f;
+    double exactSeconds = 0.0, sharedSeconds = 0.0;
+    size_t hits = 0, misses = 0, entries = 0;
+    float maxJointError = 0.0f; // Of any agent in any frame
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        auto start = std::chrono::high_resolution_clock::now();
+        exact.Update(frameTime);
+        exactSeconds += SecondsSince(start);
+        start = std::chrono::high_resolution_clock::now();
+        shared.Update(frameTime);
+        sharedSeconds += SecondsSince(start);
+        hits += shared.GetStats().CacheHits;
+        misses += shared.GetStats().CacheMisses;
+        entries += shared.GetStats().CacheEntries;
+
+        for (AnimationInstanceId id = 0; id < agentCount; ++id) {
+            const XMFLOAT4X4A* reference = exact.GetModelTransforms(id);
+            const XMFLOAT4X4A* approximated = shared.GetModelTransforms(id);
+            for (size_t j = 0; j < jointCount; ++j) {
+                XMVECTOR difference = XMVectorSubtract(XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&reference[j]._41)),
+                                                       XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&approximated[j]._41)));
+                maxJointError = std::max(maxJointError, XMVectorGetX(XMVector3Length(difference)));
+            }
+        }
+    }
+
+    // Every agent shares a pose, that pose is the clip's pose at the shared time, and no joint of it
+    // is farther than the tolerance from the agent's own pose
+    bool ok = true;
+    float maxTimeOffset = 0.0f, maxSharedDifference = 0.0f;
+    LocalPose pose;
+    std::vector<XMFLOAT4X4A> model(jointCount), skinning(jointCount);
+    for (AnimationInstanceId id = 0; id < agentCount && ok; ++id) {
+        const Instance& instance = shared.m_instances[id];
+        if (instance.CacheEntry == NoCacheEntry) {
+            ok = false;
+            break;
+        }
+        const CachedPose& entry = shared.m_poseCache[instance.CacheEntry];
+        const float duration = entry.Key.Clip->Duration;
+        float offset = std::abs(instance.Current.Phases[instance.Current.Tree->GetRoot()] * duration - entry.Time);
+        maxTimeOffset = std::max(maxTimeOffset, std::min(offset, duration - offset));
+        if (id % 50 == 0) {
+            entry.Sampler->Sample(entry.Time, pose);
+            entry.Evaluator->Evaluate(pose, model.data(), skinning.data());
+            const float* cached = &shared.GetPalette()[shared.GetPaletteOffset(id)]._11;
+            for (size_t k = 0; k < jointCount * 16; ++k) {
+                maxSharedDifference = std::max(maxSharedDifference, std::abs(cached[k] - (&skinning[0]._11)[k]));
+            }
+        }
+    }
+    ok = ok && maxSharedDifference <= 1e-5f && maxJointError <= tolerance;
+
+    auto saved = [](double before, double after) { return before > 0.0 ? 100.0 * (1.0 - after / before) : 0.0; };
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    report << "Crowd benchmark: " << agentCount << " agents x " << jointCount << " joints x " << frameCount << " frames, 3 clips, "
+           << tolerance * 1000.0f << " mm tolerance\n"
+           << "  Pose cache: " << std::setprecision(2) << 100.0 * hits / std::max<size_t>(hits + misses, 1) << "% hit rate, "
+           << std::setprecision(1)
+           << static_cast<double>(entries) / frameCount << " shared poses per frame, "
+           << static_cast<double>(misses) / frameCount << " evaluated\n"
+           << "  Update: " << exactSeconds * 1000.0 / frameCount << " -> " << sharedSeconds * 1000.0 / frameCount << " ms/frame ("
+           << saved(exactSeconds, sharedSeconds) << "% saved, " << (jobSystem ? jobSystem->GetWorkerCount() : 0) << " workers)\n"
+           << "  Palette: " << exact.GetPalette().size() * sizeof(XMFLOAT4X4A) / 1024 << " -> "
+           << shared.GetPalette().size() * sizeof(XMFLOAT4X4A) / 1024 << " KB per frame\n"
+           << std::setprecision(2) << "  Max time offset " << maxTimeOffset * 1000.0f << " ms, max joint offset "
+           << maxJointError * 1000.0f << " mm from each agent's exact pose\n";
+    if (!ok) {
+        report << "  FAILED: shared poses over the joint error tolerance or not the clip's pose\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
+
+bool AnimationSystem::RunDualQuaternionBenchmark(size_t characterCount, JobSystem* jobSystem) {
+    characterCount = std::max<size_t>(characterCount, 1);
+    const size_t jointCount = BenchmarkScene::JointCount;
+    BenchmarkScene scene, rigidScene;
+    if (!scene.Build() || !rigidScene.Build(true)) {
+        std::cerr << "Dual quaternion benchmark: scene setup failed." << std::endl;
+        return false;
+    }
+    auto transformPoint = [](const DualQuaternion& dq, FXMVECTOR point) {
+        XMVECTOR real = XMLoadFloat4(&dq.Real);
+        XMVECTOR translation = XMVectorScale(XMQuaternionMultiply(XMQuaternionConjugate(real), XMLoadFloat4(&dq.Dual)), 2.0f);
+        return XMVectorAdd(XMVector3Rotate(point, real), translation);
+    };
+    const XMVECTOR testPoint = XMVectorSet(0.1f, 0.2f, 0.3f, 0.0f);
+
+    // Dual quaternion keys against the source keys, model space, between and at the keys
+    PoseEvaluator evaluator;
+    evaluator.Bind(scene.Rig);
+    std::vector<XMFLOAT4X4A> model(jointCount), rigidModel(jointCount);
+    LocalPose pose, rigidPose;
+    float keyError = 0.0f;
+    for (size_t c = 0; c < scene.Clips.size(); ++c) {
+        for (size_t step = 0; step <= 240; ++step) {
+            float time = scene.Clips[c].Duration * step / 240.0f;
+            scene.Samplers[c].Sample(time, pose);
+            rigidScene.Samplers[c].Sample(time, rigidPose);
+            evaluator.Evaluate(pose, model.data(), nullptr);
+            evaluator.Evaluate(rigidPose, rigidModel.data(), nullptr);
+            for (size_t j = 0; j < jointCount; ++j) {
+                XMVECTOR a = XMVector3Transform(testPoint, XMLoadFloat4x4A(&model[j]));
+                XMVECTOR b = XMVector3Transform(testPoint, XMLoadFloat4x4A(&rigidModel[j]));
+                keyError = std::max(keyError, XMVectorGetX(XMVector3Length(XMVectorSubtract(a, b))));
+            }
+        }
+    }
+
+    // Matrix palettes converted afterwards (the previous path), dual quaternion palettes from the
+    // source keys, and from the dual quaternion keys
+    AnimationSystem matrices, direct, rigid;
+    matrices.Initialize(jobSystem);
+    direct.Initialize(jobSystem);
+    rigid.Initialize(jobSystem);
+    direct.SetSkinningMode(SkinningMode::DualQuaternion);
+    rigid.SetSkinningMode(SkinningMode::DualQuaternion);
+    scene.AddCharacters(matrices, characterCount);
+    scene.AddCharacters(direct, characterCount);
+    rigidScene.AddCharacters(rigid, characterCount);
+
+    const size_t frameCount = 120;
+    const float frameTime = 1.0f / 60.0f;
+    std::vector<DualQuaternion> converted;
+    double matrixSeconds = 0.0, directSeconds = 0.0;
+    float paletteError = 0.0f, rigidPaletteError = 0.0f;
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        scene.SwitchTrees(matrices, characterCount, frame);
+        scene.SwitchTrees(direct, characterCount, frame);
+        rigidScene.SwitchTrees(rigid, characterCount, frame);
+        auto start = std::chrono::high_resolution_clock::now();
+        matrices.Update(frameTime);
+        converted.resize(matrices.GetPalette().size());
+        CpuSkinning::BuildDualQuaternionPalette(matrices.GetPalette().data(), converted.size(), converted.data());
+        matrixSeconds += SecondsSince(start);
+        start = std::chrono::high_resolution_clock::now();
+        direct.Update(frameTime);
+        directSeconds += SecondsSince(start);
+        rigid.Update(frameTime);
+
+        const std::vector<DualQuaternion>& palette = direct.GetDualQuaternionPalette();
+        const std::vector<DualQuaternion>& rigidPalette = rigid.GetDualQuaternionPalette();
+        if (palette.size() != converted.size() || rigidPalette.size() != converted.size()) {
+            paletteError = FLT_MAX;
+            break;
+        }
+        for (size_t k = frame % 7; k < palette.size(); k += 7) {
+            XMVECTOR reference = transformPoint(converted[k], testPoint);
+            paletteError = std::max(paletteError, XMVectorGetX(XMVector3Length(XMVectorSubtract(transformPoint(palette[k], testPoint), reference))));
+            rigidPaletteError = std::max(rigidPaletteError, XMVectorGetX(XMVector3Length(XMVectorSubtract(transformPoint(rigidPalette[k], testPoint), reference))));
+        }
+    }
+
+    // Skinning: vertices bound to a single joint must land where linear blend skinning puts them
+    Mesh mesh;
+    for (size_t j = 0; j < jointCount; ++j) {
+        XMMATRIX bind = XMMatrixInverse(nullptr, XMLoadFloat4x4(&scene.Rig.Joints[j].InverseBindPoseMatrix));
+        for (int v = 0; v < 4; ++v) {
+            Vertex vertex = {};
+            XMStoreFloat3(&vertex.Position, XMVectorAdd(bind.r[3], XMVectorSet(0.05f * (v & 1), 0.03f, 0.05f * (v >> 1), 0.0f)));
+            XMStoreFloat3(&vertex.Normal, XMVector3Normalize(XMVectorSet(1.0f, static_cast<float>(v), 0.5f, 0.0f)));
+            vertex.BoneWeights = XMFLOAT4(1.0f, 0.0f, 0.0f, 0.0f);
+            vertex.BoneIndices = XMUINT4(static_cast<uint32_t>(j), 0, 0, 0);
+            mesh.Vertices.push_back(vertex);
+        }
+    }
+    SkinningInput input;
+    SkinnedVertexStreams linear, dualQuaternion;
+    float skinningError = FLT_MAX;
+    if (input.Build(mesh, jointCount) && !converted.empty()) {
+        skinningError = 0.0f;
+        CpuSkinning::SkinLinear(input, matrices.GetPalette().data() + matrices.GetPaletteOffset(0), linear);
+        CpuSkinning::SkinDualQuaternion(input, direct.GetDualQuaternionPalette().data() + direct.GetPaletteOffset(0), dualQuaternion);
+        for (size_t i = 0; i < linear.VertexCount; ++i) {
+            XMFLOAT3 p0 = linear.GetPosition(i), p1 = dualQuaternion.GetPosition(i);
+            XMFLOAT3 n0 = linear.GetNormal(i), n1 = dualQuaternion.GetNormal(i);
+            XMVECTOR position = XMVectorSubtract(XMLoadFloat3(&p0), XMLoadFloat3(&p1));
+            XMVECTOR normal = XMVectorSubtract(XMLoadFloat3(&n0), XMLoadFloat3(&n1));
+            skinningError = std::max(skinningError, std::max(XMVectorGetX(XMVector3Length(position)), XMVectorGetX(XMVector3Length(normal))));
+        }
+    }
+    const float tolerance = 1e-3f;
+    bool ok = keyError <= tolerance && paletteError <= tolerance && rigidPaletteError <= tolerance && skinningError <= tolerance;
+
+    size_t channels = 0;
+    for (const AnimationClip& clip : rigidScene.Clips) channels += clip.Channels.size();
+    double characterUpdates = static_cast<double>(characterCount) * frameCount;
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2);
+    report << "Dual quaternion benchmark: " << characterCount << " characters x " << jointCount << " joints x " << frameCount
+           << " frames, " << channels << " channels cooked to dual quaternion keys\n"
+           << "  Matrix palette + conversion: " << matrixSeconds * 1000.0 / frameCount << " ms/frame ("
+           << characterUpdates / std::max(matrixSeconds * 1000.0, 1e-9) << " characters/ms)\n"
+           << "  Dual quaternion palette:     " << directSeconds * 1000.0 / frameCount << " ms/frame ("
+           << characterUpdates / std::max(directSeconds * 1000.0, 1e-9) << " characters/ms, "
+           << matrixSeconds / std::max(directSeconds, 1e-9) << "x)\n"
+           << "  Upload: " << jointCount * sizeof(XMFLOAT4X4A) << " -> " << jointCount * sizeof(DualQuaternion)
+           << " bytes per character (" << matrices.GetPalette().size() * sizeof(XMFLOAT4X4A) / 1024 << " -> "
+           << direct.GetDualQuaternionPalette().size() * sizeof(DualQuaternion) / 1024 << " KB per frame)\n"
+           << std::setprecision(4) << "  Max point error (mm): keys " << keyError * 1000.0f << ", palette " << paletteError * 1000.0f
+           << ", palette from keys " << rigidPaletteError * 1000.0f << ", rigid skinning vs linear " << skinningError * 1000.0f << "\n";
+    if (!ok) {
+        report << "  FAILED: dual quaternion results differ from the matrix path\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
@@ -0,0 +1,336 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include "AnimationSampler.h"
+#include "CpuSkinning.h"
+#include "PoseEvaluator.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Camera;
+class JobSystem;
+
+enum class BlendNodeType : uint8_t {
+    Clip,     // One clip, looping
+    Blend1D,  // Children placed on one parameter axis; the two around the parameter value are blended
+    Blend2D,  // Children placed on a plane of two parameters (gradient band weights, any layout)
+    Additive, // Base child plus the additive child's difference from the bind pose, scaled by a parameter
+};
+
+struct BlendNode {
+    BlendNodeType Type = BlendNodeType::Clip;
+    const AnimationSampler* Sampler = nullptr; // Clip
+    float PlaybackRate = 1.0f;                 // Clip
+    uint32_t ParameterX = 0;                   // Blend1D / Blend2D axis, Additive weight (clamped to [0, 1])
+    uint32_t ParameterY = 0;                   // Blend2D
+    std::vector<uint32_t> Children;            // Blend1D / Blend2D samples; Additive: base, additive
+    std::vector<DirectX::XMFLOAT2> Positions;  // Sample positions (Blend1D: x, ascending)
+    uint32_t FirstWeight = 0;                  // Offset of the child weights (Additive: its weight) per playback
+    uint32_t ScratchDepth = 0;                 // Scratch poses evaluating the node needs
+};
+
+// How an instance's pose is built from clips: a read-only tree for one skeleton, shared by any
+// number of instances. Nodes are added children first; the last added node is the root.
+// Children of a blend space play in sync: the blend space advances one normalized phase at the
+// weighted duration of its children, so walk and run cycles stay aligned while blending.
+class BlendTree {
+public:
+    static constexpr uint32_t InvalidNode = UINT32_MAX;
+
+    // The skeleton must outlive the tree; samplers must be bound to it
+    explicit BlendTree(const Skeleton& skeleton);
+
+    // Return the new node, or InvalidNode for unknown children or mismatched positions
+    uint32_t AddClip(const AnimationSampler& sampler, float playbackRate = 1.0f);
+    uint32_t AddBlend1D(uint32_t parameter, const std::vector<uint32_t>& children, const std::vector<float>& thresholds);
+    uint32_t AddBlend2D(uint32_t parameterX, uint32_t parameterY, const std::vector<uint32_t>& children,
+                        const std::vector<DirectX::XMFLOAT2>& positions);
+    uint32_t AddAdditive(uint32_t base, uint32_t additive, uint32_t weightParameter);
+
+    const Skeleton& GetSkeleton() const { return *m_skeleton; }
+    const LocalPose& GetBindPose() const { return m_bindPose; }
+    const BlendNode& GetNode(uint32_t node) const { return m_nodes[node]; }
+    size_t GetNodeCount() const { return m_nodes.size(); }
+    uint32_t GetRoot() const { return m_nodes.empty() ? InvalidNode : static_cast<uint32_t>(m_nodes.size() - 1); }
+    size_t GetParameterCount() const { return m_parameterCount; }
+    size_t GetWeightCount() const { return m_weightCount; }
+
+    // Child weights (summing to 1) of a Blend1D / Blend2D node, the clamped weight of an Additive node
+    void ComputeWeights(uint32_t node, const float* parameters, float* outWeights) const;
+
+private:
+    const Skeleton* m_skeleton;
+    LocalPose m_bindPose;
+    std::vector<BlendNode> m_nodes;
+    size_t m_parameterCount = 0;
+    size_t m_weightCount = 0;
+
+    uint32_t AddNode(BlendNode&& node, uint32_t weightCount);
+};
+
+using AnimationInstanceId = uint32_t;
+
+// Animation LOD from an instance's projected height in pixels, the largest over all LOD views
+// (a character is reduced only when it is small in every view). Without views, or for instances
+// without bounds, everything animates at full detail.
+struct AnimationLodSettings {
+    float FullRatePixels = 120.0f;      // Below: blend tree evaluated every 2nd frame, interpolated between
+    float HalfRatePixels = 40.0f;       // Below: every 4th frame
+    float LeafJointPixels = 80.0f;      // Below: joints without children (fingers, toes, face) keep the bind pose
+    float MinBlendWeight = 0.01f;       // Blend children / additive layers under this weight are skipped
+    // Screen-space joint error budget of the reduced levels, half for interpolating between evaluations
+    // and half for skipped layers. An instance updates at a lower rate only while its estimated
+    // interpolation error fits, and skips layers under MaxPixelError / 2 / its projected height (a layer
+    // moves no joint farther than the character's size).
+    float MaxPixelError = 2.0f;
+};
+
+// A camera whose view drives animation LOD, with its viewport height in pixels
+struct AnimationLodView {
+    const Camera* View = nullptr;
+    float ViewportHeight = 0.0f;
+};
+
+struct AnimationSystemStats {
+    size_t Instances = 0;
+    size_t Joints = 0;                 // Palette entries written
+    size_t LodInstances[3] = {};       // Instances updating every frame, every 2nd, every 4th
+    size_t PosesEvaluated = 0;         // Blend trees sampled and blended
+    size_t PosesInterpolated = 0;      // Throttled instances that only interpolated their last poses
+    size_t ChannelsSampled = 0;
+    size_t ChannelsDropped = 0;        // Leaf joint channels not sampled
+    size_t LayersSkipped = 0;          // Blend children / additive layers under the weight threshold
+    size_t CacheHits = 0;              // Instances served a pose evaluated for another instance or kept from the last frame
+    size_t CacheMisses = 0;            // Shared poses sampled and resolved this frame
+    size_t CacheEntries = 0;           // Distinct shared poses in the palette
+    double UpdateMilliseconds = 0.0;
+
+    float GetCacheHitRate() const { return CacheHits + CacheMisses > 0 ? static_cast<float>(CacheHits) / (CacheHits + CacheMisses) : 0.0f; }
+};
+
+// Animates every character instance in one Update per frame: advances and evaluates each instance's
+// blend tree (crossfading from the previous tree after Play), resolves the pose with the skeleton's
+// PoseEvaluator and writes the skinning matrices into one contiguous palette, instance after
+// instance, ready for a single upload. Instances only share read-only data (trees, samplers,
+// evaluators), so each is an independent job; batches of 'batchSize' instances run on the JobSystem.
+// Instances that are small in every LOD view are evaluated every 2nd or 4th frame and interpolated in
+// between, with fewer joints and blend layers, within a screen-space error budget (AnimationLodSettings); their hierarchy is still resolved
+// every frame. In SkinningMode::DualQuaternion the palette holds dual quaternions instead (half the
+// upload), chained straight from the blended poses. Create / destroy / Play / SetParameter are main
+// thread calls between updates.
+class AnimationSystem {
+public:
+    static constexpr AnimationInstanceId InvalidInstance = UINT32_MAX;
+
+    AnimationSystem() = default;
+
+    // Without a job system (or without workers) instances update on the calling thread
+    void Initialize(JobSystem* jobSystem, size_t batchSize = 4);
+
+    void SetLodSettings(const AnimationLodSettings& settings) { m_lodSettings = settings; }
+    // Cameras of this frame (the views must stay valid until the next call); empty disables LOD
+    void SetLodViews(const std::vector<AnimationLodView>& views) { m_lodViews = views; }
+    // Instances playing a single clip (a tree of one Clip node, not crossfading) share one sampled and
+    // resolved pose per (clip, skeleton, clip time rounded to a step): crowds playing the same clip at
+    // nearly the same time are evaluated once and differ only by world transform. The step of each
+    // clip is derived from its fastest joint (model space, measured once per clip and skeleton) so no
+    // joint of a shared pose is farther than 'distance' model units from the instance's own pose.
+    // 0 turns sharing off.
+    void SetPoseCacheTolerance(float distance);
+    // Which palette Update fills: skinning matrices (GetPalette, the default) or dual quaternions
+    // (GetDualQuaternionPalette; for rigid skeletons, joint scale is ignored)
+    void SetSkinningMode(SkinningMode mode);
+
+    // Bind pose until the first Play. Returns InvalidInstance if the joints are not parents-first.
+    // The skeleton must outlive the instance.
+    AnimationInstanceId CreateInstance(const Skeleton& skeleton);
+    void DestroyInstance(AnimationInstanceId id);
+
+    // Switches to 'tree' (built for the instance's skeleton) at normalized phase 'startPhase' (crowds
+    // start at random phases), crossfading from the current pose over 'fadeSeconds'. Playing during a
+    // fade drops the tree that was fading out.
+    bool Play(AnimationInstanceId id, const BlendTree& tree, float fadeSeconds = 0.0f, float startPhase = 0.0f);
+    // Blend parameters of the instance, shared by its current and fading trees. Instances updating
+    // at a reduced rate pick them up at their next evaluation.
+    void SetParameter(AnimationInstanceId id, uint32_t index, float value);
+    // World-space bounding sphere of the instance for LOD; a radius of 0 keeps full detail
+    void SetBounds(AnimationInstanceId id, const DirectX::XMFLOAT3& center, float radius);
+
+    void Update(float deltaTime);
+
+    // Skinning matrices (InverseBindPose * model, row-major) of every instance: instances with their own
+    // pose first, then the shared poses. Offsets can change every update; instances sharing a pose
+    // share its offset.
+    const std::vector<DirectX::XMFLOAT4X4A>& GetPalette() const { return m_palette; }
+    // SkinningMode::DualQuaternion: InverseBindPose then model per joint, same offsets as GetPalette
+    const std::vector<DualQuaternion>& GetDualQuaternionPalette() const { return m_dualQuaternionPalette; }
+    size_t GetPaletteOffset(AnimationInstanceId id) const { return m_instances[id].PaletteOffset; }
+    size_t GetJointCount(AnimationInstanceId id) const { return m_instances[id].Evaluator->GetJointCount(); }
+    // Model space joint transforms of the last update (attachments, hit boxes)
+    const DirectX::XMFLOAT4X4A* GetModelTransforms(AnimationInstanceId id) const {
+        const Instance& instance = m_instances[id];
+        return instance.CacheEntry != NoCacheEntry ? m_poseCache[instance.CacheEntry].Model.data() : instance.Model.data();
+    }
+    size_t GetInstanceCount() const { return m_active.size(); }
+    const AnimationSystemStats& GetStats() const { return m_stats; }
+
+    // Updates 'characterCount' characters (60 joints; a 2D locomotion blend space with an additive
+    // layer, crossfading to and from a 1D blend) for 120 frames on the calling thread and on
+    // 'jobSystem' (WinMain "-animsysbench"). Reports characters per millisecond and the speedup, and
+    // checks both produce the same palettes and that a blend space at a sample plays that clip.
+    static bool RunBenchmark(size_t characterCount = 500, JobSystem* jobSystem = nullptr);
+    // Spreads 'characterCount' characters from 2 to 200 m in front of two split-screen cameras and
+    // updates them for 240 frames without and with LOD (WinMain "-animlodbench"). Reports the LOD
+    // levels, the evaluation work and time saved, and the pose error of throttled characters; fails when
+    // a reduced level is over AnimationLodSettings::MaxPixelError.
+    static bool RunLodBenchmark(size_t characterCount = 1000);
+    // 'agentCount' crowd agents (60 joints) each loop one of three clips from a random start time, for
+    // 240 frames without and with the pose cache on 'jobSystem' (WinMain "-crowdbench"). Reports the hit
+    // rate, the time and palette size saved and the largest joint offset from the agent's exact pose;
+    // fails when that offset, measured every frame, is over 'tolerance' model units.
+    static bool RunCrowdBenchmark(size_t agentCount = 5000, JobSystem* jobSystem = nullptr, float tolerance = 0.005f);
+    // Cooks the benchmark clips to dual quaternion keys and updates 'characterCount' characters with
+    // matrix palettes (converted to dual quaternions afterwards, as before) and with dual quaternion
+    // palettes (WinMain "-dqbench"). Validates the sampled keys against the source clips, the palettes
+    // against the matrix path, and dual quaternion against linear skinning of rigidly bound vertices;
+    // reports the time and upload size of both palettes.
+    static bool RunDualQuaternionBenchmark(size_t characterCount = 500, JobSystem* jobSystem = nullptr);
+
+private:
+    static constexpr uint32_t NoCacheEntry = UINT32_MAX;
+
+    // One blend tree being played by an instance
+    struct Playback {
+        const BlendTree* Tree = nullptr;
+        std::vector<float> Phases;            // Normalized time per node
+        std::vector<float> Weights;           // See BlendNode::FirstWeight
+        std::vector<AnimationCursor> Cursors; // Per clip node
+
+        void Reset(const BlendTree* tree, float phase = 0.0f);
+    };
+    // Work done by one instance in the last update, summed into the stats after the jobs
+    struct InstanceWork {
+        uint8_t Lod = 0;
+        bool Evaluated = false;
+        size_t ChannelsSampled = 0;
+        size_t ChannelsDropped = 0;
+        size_t LayersSkipped = 0;
+    };
+    struct Instance {
+        bool Alive = false;
+        const Skeleton* Rig = nullptr; // The instance's skeleton
+        const PoseEvaluator* Evaluator = nullptr;
+        const uint8_t* LeafJointMask = nullptr; // Of the skeleton: 0 for joints without children
+        std::vector<float> Parameters;
+        Playback Current;
+        Playback Previous; // Fading out while FadeElapsed < FadeDuration
+        float FadeElapsed = 0.0f;
+        float FadeDuration = 0.0f;
+        LocalPose Pose;     // Blend tree output of the last evaluation
+        LocalPose FadePose;
+        std::vector<LocalPose> Scratch;
+        std::vector<DirectX::XMFLOAT4X4A> Model;
+        std::vector<DualQuaternion> ModelDualQuaternions; // SkinningMode::DualQuaternion
+        size_t PaletteOffset = 0;
+        // LOD: the tree is evaluated 'Interval' frames ahead and the frames in between interpolate
+        // from the pose shown at the evaluation ('FromPose') to it
+        DirectX::XMFLOAT3 Center = { 0.0f, 0.0f, 0.0f };
+        float Radius = 0.0f;
+        uint32_t Interval = 1;
+        uint32_t FramesLeft = 0;
+        uint32_t PreviousFramesAhead = 0; // Play cut an interval short: the fading out tree is this far ahead
+        // Interpolation error estimate: joint positions and velocities (model space) at the last
+        // evaluated poses, when they were shown; the largest joint acceleration between them
+        std::vector<DirectX::XMFLOAT3> MotionPositions;
+        std::vector<DirectX::XMFLOAT3> MotionVelocities;
+        uint32_t MotionSamples = 0; // 0 after Play / Snap; a rate above 1 needs an acceleration (3 samples)
+        float MotionElapsed = 0.0f; // Since the last sample
+        float MotionSpan = 0.0f;    // Between the last two samples
+        float MaxAcceleration = 0.0f;
+        const uint8_t* JointMask = nullptr; // Joints sampled at the current LOD, null for all
+        float MinBlendWeight = 0.0f;
+        LocalPose FromPose;
+        LocalPose DisplayPose;
+        bool DisplayPoseShown = false; // The last update resolved DisplayPose rather than Pose
+        bool Snap = true;              // Nothing to interpolate from (new instance, Play without fade)
+        uint32_t CacheEntry = NoCacheEntry; // Shared pose used this frame
+        InstanceWork Work;
+    };
+    struct PoseCacheKey {
+        const AnimationClip* Clip;
+        const Skeleton* Rig;
+        int64_t Step; // Clip time / pose cache step, rounded
+
+        bool operator==(const PoseCacheKey& other) const { return Clip == other.Clip && Rig == other.Rig && Step == other.Step; }
+    };
+    struct PoseCacheKeyHash {
+        size_t operator()(const PoseCacheKey& key) const {
+            size_t hash = std::hash<const void*>()(key.Clip);
+            hash ^= std::hash<const void*>()(key.Rig) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            return hash ^ (std::hash<int64_t>()(key.Step) + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+        }
+    };
+    // One shared pose: kept while some instance uses it, so a pose whose key repeats next frame
+    // (a step longer than the frame) is not evaluated again
+    struct CachedPose {
+        PoseCacheKey Key{};
+        const AnimationSampler* Sampler = nullptr;
+        const PoseEvaluator* Evaluator = nullptr;
+        float Time = 0.0f;
+        bool Used = false;           // By an instance this frame
+        bool NeedsEvaluation = false;
+        size_t PaletteOffset = 0;
+        LocalPose Pose;
+        std::vector<DirectX::XMFLOAT4X4A> Model;
+        std::vector<DirectX::XMFLOAT4X4A> Skinning;
+        std::vector<DualQuaternion> ModelDualQuaternions; // SkinningMode::DualQuaternion
+        std::vector<DualQuaternion> SkinningDualQuaternions;
+    };
+    struct SharedEvaluator {
+        std::unique_ptr<PoseEvaluator> Evaluator;
+        std::vector<uint8_t> LeafJointMask;
+        size_t Users = 0;
+    };
+
+    JobSystem* m_jobSystem = nullptr;
+    size_t m_batchSize = 4;
+    std::vector<Instance> m_instances;
+    std::vector<AnimationInstanceId> m_freeInstances;
+    std::vector<AnimationInstanceId> m_active; // Alive instances in palette order
+    bool m_layoutDirty = false;
+    std::unordered_map<const Skeleton*, SharedEvaluator> m_evaluators;
+    std::vector<DirectX::XMFLOAT4X4A> m_palette;
+    std::vector<DualQuaternion> m_dualQuaternionPalette;
+    SkinningMode m_skinningMode = SkinningMode::Linear;
+    AnimationSystemStats m_stats;
+    AnimationLodSettings m_lodSettings;
+    std::vector<AnimationLodView> m_lodViews;
+    uint32_t m_frame = 0; // Staggers the evaluations of throttled instances
+    float m_poseCacheTolerance = 0.005f;
+    std::unordered_map<PoseCacheKey, float, PoseCacheKeyHash> m_poseCacheSteps; // (clip, skeleton, 0) -> time step
+    std::unordered_map<PoseCacheKey, uint32_t, PoseCacheKeyHash> m_poseCacheIndex;
+    std::vector<CachedPose> m_poseCache;
+    std::vector<uint32_t> m_freePoseCache;
+    std::vector<uint32_t> m_usedPoseCache; // Entries used this frame, in palette order
+    std::vector<AnimationInstanceId> m_evaluated; // Instances with their own pose this frame
+
+    void RebuildLayout();
+    bool UsePoseCache(Instance& instance, float deltaTime, size_t& hits, size_t& misses);
+    float GetPoseCacheStep(const AnimationSampler& sampler, const Instance& instance);
+    void EvictPoseCache(const Skeleton* rig); // Null: every entry
+    void SelectLod(Instance& instance, AnimationInstanceId id, float deltaTime);
+    void SampleMotion(Instance& instance);
+    void UpdateInstance(Instance& instance, AnimationInstanceId id, float deltaTime);
+    void EvaluateTrees(Instance& instance, float deltaTime, float previousDeltaTime);
+    void UpdateWeights(const Instance& instance, Playback& playback) const;
+    void SkipNegligibleLayers(Instance& instance, Playback& playback) const;
+    float GetDuration(const Playback& playback, uint32_t node) const;
+    void AdvanceNode(Playback& playback, uint32_t node, float deltaTime, const float* syncPhase) const;
+    void EvaluateNode(Instance& instance, Playback& playback, uint32_t node, LocalPose& outPose, LocalPose* scratch) const;
+};
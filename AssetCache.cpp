@@ -0,0 +1,118 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "AssetCache.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+AssetCache::AssetCache() {}
+
+bool AssetCache::Initialize(const std::wstring& cacheDirectory) {
+    std::error_code ec;
+    m_directory = std::filesystem::path(cacheDirectory);
+    std::filesystem::create_directories(m_directory, ec);
+    if (ec || !std::filesystem::is_directory(m_directory)) {
+        std::cerr << "Asset Cache: Failed to create cache directory " << m_directory.string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+Hash128 AssetCache::MakeKey(const Hash128& sourceHash, uint32_t cookerVersion, const Hash128& settingsHash) {
+    ContentHasher hasher;
+    uint32_t versions[2] = { ASSET_CACHE_VERSION, cookerVersion };
+    hasher.Update(&sourceHash, sizeof(sourceHash));
+    hasher.Update(versions, sizeof(versions));
+    hasher.Update(&settingsHash, sizeof(settingsHash));
+    return hasher.Finalize();
+}
+
+std::filesystem::path AssetCache::GetEntryPath(const Hash128& key) const {
+    // Two-level layout keeps directories small
+    std::string name = key.ToString();
+    return m_directory / name.substr(0, 2) / (name + ".bin");
+}
+
+bool AssetCache::ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& outData) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    if (size < 0) {
+        return false;
+    }
+    file.seekg(0, std::ios::beg);
+    outData.resize(static_cast<size_t>(size));
+    return size == 0 || static_cast<bool>(file.read(reinterpret_cast<char*>(outData.data()), size));
+}
+
+bool AssetCache::WriteFileAtomic(const std::filesystem::path& path, const void* data, size_t size) {
+    static std::atomic<uint32_t> s_tempCounter{ 0 };
+
+    std::error_code ec;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+
+    std::ostringstream tempName;
+    tempName << path.filename().string() << "." << std::this_thread::get_id() << "." << s_tempCounter.fetch_add(1) << ".tmp";
+    std::filesystem::path tempPath = path.parent_path() / tempName.str();
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!file.good()) {
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool AssetCache::Load(const Hash128& key, std::vector<uint8_t>& outData, double* outCookSeconds) const {
+    std::vector<uint8_t> file;
+    if (!ReadFile(GetEntryPath(key), file) || file.size() < sizeof(AssetCacheEntryHeader)) {
+        return false;
+    }
+
+    AssetCacheEntryHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (header.Magic != ASSET_CACHE_MAGIC || header.Version != ASSET_CACHE_VERSION || header.Key != key ||
+        header.PayloadBytes != file.size() - sizeof(AssetCacheEntryHeader)) {
+        OutputDebugStringA(("Asset Cache: Ignoring damaged entry " + key.ToString() + "\n").c_str());
+        return false;
+    }
+
+    outData.assign(file.begin() + sizeof(AssetCacheEntryHeader), file.end());
+    if (outCookSeconds) {
+        *outCookSeconds = header.CookSeconds;
+    }
+    return true;
+}
+
+bool AssetCache::Store(const Hash128& key, const std::vector<uint8_t>& data, double cookSeconds) {
+    AssetCacheEntryHeader header;
+    header.Key = key;
+    header.CookSeconds = cookSeconds;
+    header.PayloadBytes = data.size();
+
+    std::vector<uint8_t> file(sizeof(header) + data.size());
+    memcpy(file.data(), &header, sizeof(header));
+    if (!data.empty()) {
+        memcpy(file.data() + sizeof(header), data.data(), data.size());
+    }
+    return WriteFileAtomic(GetEntryPath(key), file.data(), file.size());
+}
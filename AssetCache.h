@@ -0,0 +1,49 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "ContentHash.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+constexpr uint32_t ASSET_CACHE_MAGIC = 0x45434741; // "AGCE"
+constexpr uint32_t ASSET_CACHE_VERSION = 1;
+
+// Header of one cache entry file (<cache dir>/<2 hex>/<32 hex>.bin)
+struct AssetCacheEntryHeader {
+    uint32_t Magic = ASSET_CACHE_MAGIC;
+    uint32_t Version = ASSET_CACHE_VERSION;
+    Hash128 Key;
+    double CookSeconds = 0.0; // How long the cook that produced this entry took (for "time saved" stats)
+    uint64_t PayloadBytes = 0;
+};
+
+// Local on-disk cache of cooked outputs, keyed by a hash of source content + cooker version + settings.
+// Entries are immutable and written atomically (temp file + rename), so concurrent cooks are safe.
+class AssetCache {
+public:
+    AssetCache();
+
+    bool Initialize(const std::wstring& cacheDirectory);
+
+    static Hash128 MakeKey(const Hash128& sourceHash, uint32_t cookerVersion, const Hash128& settingsHash);
+
+    // Returns false on a miss or a damaged entry
+    bool Load(const Hash128& key, std::vector<uint8_t>& outData, double* outCookSeconds = nullptr) const;
+    bool Store(const Hash128& key, const std::vector<uint8_t>& data, double cookSeconds);
+
+    std::filesystem::path GetEntryPath(const Hash128& key) const;
+    const std::filesystem::path& GetDirectory() const { return m_directory; }
+
+    // Writes 'data' to a temporary file next to 'path' and renames it over 'path'
+    static bool WriteFileAtomic(const std::filesystem::path& path, const void* data, size_t size);
+    static bool ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& outData);
+
+private:
+    std::filesystem::path m_directory;
+};
@@ -0,0 +1,403 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "AssetCooker.h"
+#include "Timing.h"
+#include "AudioManager.h"
+#include "BlockCompression.h"
+#include "ColladaParser.h"
+#include "ModelSerializer.h"
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+
+std::string CookReport::ToString() const {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << Hits << " hits, " << Misses << " misses, " << Failures << " failed";
+    if (Unsupported > 0) {
+        ss << ", " << Unsupported << " unsupported";
+    }
+    ss << "; "
+       << "cooked " << CookSeconds << "s, saved ~" << SavedSeconds << "s, wall " << WallSeconds << "s";
+    if (SharedMeshes > 0) {
+        ss << "; " << SharedMeshes << " meshes share " << GeometryFiles << " geometry files";
+    }
+    return ss.str();
+}
+
+
+AssetCooker::AssetCooker(JobSystem& jobSystem, const CookSettings& settings, const TextureCookSettings& textureSettings)
+    : m_jobSystem(jobSystem), m_settings(settings), m_textureSettings(textureSettings) {}
+
+bool AssetCooker::Initialize(const std::wstring& cacheDirectory) {
+    return m_cache.Initialize(cacheDirectory);
+}
+
+CookItem AssetCooker::MakeCookItem(const std::filesystem::path& sourcePath, const std::filesystem::path& sourceRoot, const std::filesystem::path& outputRoot) {
+    CookItem item;
+    item.Kind = GetAssetKind(sourcePath);
+    item.SourcePath = sourcePath.wstring();
+
+    std::error_code ec;
+    std::filesystem::path relative = std::filesystem::relative(sourcePath, sourceRoot, ec);
+    if (ec || relative.empty()) {
+        relative = sourcePath.filename();
+    }
+    std::filesystem::path outputPath = outputRoot / relative;
+    outputPath.replace_extension(GetCookedExtension(item.Kind));
+    item.OutputPath = outputPath.wstring();
+    if (item.Kind == AssetKind::Model) {
+        item.GeometryDirectory = (outputRoot / L"Geometry").wstring();
+    }
+    return item;
+}
+
+AssetKind AssetCooker::GetAssetKind(const std::filesystem::path& sourcePath) {
+    std::wstring extension = sourcePath.extension().wstring();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+    if (extension == L".dae") return AssetKind::Model;
+    if (extension == L".wav") return AssetKind::Wave;
+    if (extension == L".png" || extension == L".jpg" || extension == L".jpeg" || extension == L".bmp" ||
+        extension == L".tif" || extension == L".tiff") {
+        return AssetKind::Texture;
+    }
+    return AssetKind::Unknown;
+}
+
+std::wstring AssetCooker::GetCookedExtension(AssetKind kind) {
+    switch (kind) {
+    case AssetKind::Model: return L".agm";
+    case AssetKind::Wave: return L".agw";
+    case AssetKind::Texture: return L".dds";
+    default: return L"";
+    }
+}
+
+Hash128 AssetCooker::GetSettingsHash(AssetKind kind) const {
+    // Fields are hashed one by one (not the raw struct) so padding bytes never leak into the key.
+    // Any new CookSettings field that changes the cooked output must be added here.
+    ContentHasher hasher;
+    uint32_t kindValue = static_cast<uint32_t>(kind);
+    hasher.Update(&kindValue, sizeof(kindValue));
+    if (kind == AssetKind::Model || kind == AssetKind::Wave) {
+        uint8_t compress = static_cast<uint8_t>(m_settings.CompressPayloads);
+        hasher.Update(&compress, sizeof(compress));
+    }
+
+    if (kind == AssetKind::Model) {
+        const CookSettings& s = m_settings;
+        uint8_t flags[8] = {
+            static_cast<uint8_t>(s.OptimizeMeshes),
+            static_cast<uint8_t>(s.GenerateLods),
+            static_cast<uint8_t>(s.BuildMeshlets),
+            static_cast<uint8_t>(s.VertexPacking),
+            static_cast<uint8_t>(STRING_ID_KEEP_NAMES), // Debug cooks carry the name table
+            static_cast<uint8_t>(s.ShareGeometry),
+            static_cast<uint8_t>(s.CompressAnimations),
+            static_cast<uint8_t>(s.DualQuaternionKeys),
+        };
+        hasher.Update(flags, sizeof(flags));
+        hasher.Update(&s.OverdrawThreshold, sizeof(s.OverdrawThreshold));
+        float animationTolerances[2] = { s.Animation.Tolerance, s.Animation.SkinDistance };
+        hasher.Update(animationTolerances, sizeof(animationTolerances));
+        uint64_t lodCounts[2] = { static_cast<uint64_t>(s.Lods.MaxLodCount), static_cast<uint64_t>(s.Lods.MinTriangles) };
+        float lodRatios[2] = { s.Lods.TriangleRatio, s.Lods.MaxRelativeError };
+        hasher.Update(lodCounts, sizeof(lodCounts));
+        hasher.Update(lodRatios, sizeof(lodRatios));
+    } else if (kind == AssetKind::Texture) {
+        const TextureCookSettings& t = m_textureSettings;
+        uint8_t flags[6] = {
+            static_cast<uint8_t>(t.Format),
+            static_cast<uint8_t>(t.UseBC1WhenOpaque),
+            static_cast<uint8_t>(t.GenerateMips),
+            static_cast<uint8_t>(t.Filter),
+            static_cast<uint8_t>(t.SRGB),
+            static_cast<uint8_t>(t.Premultiply),
+        };
+        hasher.Update(flags, sizeof(flags));
+    }
+    return hasher.Finalize();
+}
+
+bool AssetCooker::CookModel(const CookItem& item, Model& model) {
+    GeometryFiles geometryFiles;
+    std::vector<uint8_t> cooked;
+    bool ok = CookModel(item, model, geometryFiles, cooked);
+    if (ok && m_settings.CompressPayloads) {
+        std::vector<uint8_t> compressed;
+        ok = BlockCompressor::Compress(cooked.data(), cooked.size(), compressed, &m_jobSystem);
+        cooked.swap(compressed);
+    }
+    if (!ok || !AssetCache::WriteFileAtomic(item.OutputPath, cooked.data(), cooked.size())) {
+        LogMessage("Failed to cook " + std::filesystem::path(item.OutputPath).string());
+        return false;
+    }
+    return true;
+}
+
+bool AssetCooker::CookModel(const CookItem& item, Model& model, GeometryFiles& geometryFiles, std::vector<uint8_t>& outData) {
+    CookSettings settings = m_settings;
+    settings.PrintStats = false; // Per-mesh output from parallel jobs would interleave
+    ModelCooker cooker(settings);
+    std::string modelName = std::filesystem::path(item.SourcePath).filename().string();
+    if (!cooker.Cook(model, modelName)) {
+        return false;
+    }
+
+    std::wstring sharedDirectory;
+    if (m_settings.ShareGeometry && !item.GeometryDirectory.empty()) {
+        // Stored relative to the model, so the cooked tree (or a pack of it) can move as a whole
+        std::filesystem::path outputDirectory = std::filesystem::path(item.OutputPath).parent_path();
+        sharedDirectory = std::filesystem::path(item.GeometryDirectory).lexically_relative(outputDirectory).wstring();
+    }
+    if (!ModelSerializer::Serialize(model, outData, STRING_ID_KEEP_NAMES, sharedDirectory)) {
+        return false;
+    }
+    if (!sharedDirectory.empty()) {
+        for (const Mesh& mesh : model.Meshes) {
+            if (!WriteSharedGeometry(item.GeometryDirectory, mesh, geometryFiles)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+Hash128 AssetCooker::GetGeometryKey(const Hash128& contentHash) const {
+    static const char tag[] = "SharedGeometry"; // Keeps geometry entries apart from whole-file entries
+    Hash128 settingsHash = ContentHasher::Combine(GetSettingsHash(AssetKind::Model), ContentHasher::Hash(tag, sizeof(tag) - 1));
+    return AssetCache::MakeKey(contentHash, MODEL_COOKER_VERSION, settingsHash);
+}
+
+bool AssetCooker::WriteSharedGeometry(const std::filesystem::path& directory, const Mesh& mesh, GeometryFiles& geometryFiles) {
+    std::filesystem::path path = (directory / ModelSerializer::GetGeometryFileName(mesh.ContentHash)).lexically_normal();
+    geometryFiles.SharedMeshes.fetch_add(1);
+    {
+        // Content addressed: the first model with this mesh writes the file, the others only reference it
+        std::lock_guard<std::mutex> lock(geometryFiles.Mutex);
+        if (!geometryFiles.Paths.insert(path.wstring()).second) {
+            return true;
+        }
+    }
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec)) {
+        return true; // From an earlier cook; same name, same content
+    }
+
+    std::vector<uint8_t> geometry;
+    bool ok = ModelSerializer::SerializeGeometry(mesh, geometry);
+    if (ok && m_settings.CompressPayloads) {
+        std::vector<uint8_t> compressed;
+        ok = BlockCompressor::Compress(geometry.data(), geometry.size(), compressed, &m_jobSystem);
+        geometry.swap(compressed);
+    }
+    if (ok && !m_cache.Store(GetGeometryKey(mesh.ContentHash), geometry, 0.0)) {
+        LogMessage("Failed to store shared geometry " + mesh.ContentHash.ToString()); // Not fatal, same as models
+    }
+    if (!ok || !AssetCache::WriteFileAtomic(path, geometry.data(), geometry.size())) {
+        LogMessage("Failed to write shared geometry " + path.string());
+        std::lock_guard<std::mutex> lock(geometryFiles.Mutex);
+        geometryFiles.Paths.erase(path.wstring());
+        return false;
+    }
+    return true;
+}
+
+bool AssetCooker::RestoreSharedGeometry(const CookItem& item, const std::vector<uint8_t>& cooked, GeometryFiles& geometryFiles) {
+    if (item.Kind != AssetKind::Model) {
+        return true;
+    }
+    std::vector<uint8_t> decompressed;
+    const std::vector<uint8_t>* data = &cooked;
+    if (BlockCompressor::IsCompressed(cooked.data(), cooked.size())) {
+        if (!BlockCompressor::Decompress(cooked.data(), cooked.size(), decompressed, &m_jobSystem)) {
+            return false;
+        }
+        data = &decompressed;
+    }
+    std::vector<SharedGeometryRef> refs;
+    if (!ModelSerializer::GetSharedGeometry(data->data(), data->size(), refs)) {
+        return false;
+    }
+
+    std::filesystem::path outputDirectory = std::filesystem::path(item.OutputPath).parent_path();
+    for (const SharedGeometryRef& ref : refs) {
+        std::filesystem::path path = (outputDirectory / ref.Path).lexically_normal();
+        {
+            std::lock_guard<std::mutex> lock(geometryFiles.Mutex);
+            if (!geometryFiles.Paths.insert(path.wstring()).second) {
+                continue;
+            }
+        }
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec)) {
+            continue;
+        }
+        std::vector<uint8_t> geometry;
+        if (!m_cache.Load(GetGeometryKey(ref.ContentHash), geometry) ||
+            !AssetCache::WriteFileAtomic(path, geometry.data(), geometry.size())) {
+            LogMessage("Shared geometry " + path.string() + " is not cached, cooking " +
+                       std::filesystem::path(item.SourcePath).filename().string() + " again");
+            std::lock_guard<std::mutex> lock(geometryFiles.Mutex);
+            geometryFiles.Paths.erase(path.wstring());
+            return false;
+        }
+    }
+    geometryFiles.SharedMeshes.fetch_add(refs.size());
+    return true;
+}
+
+bool AssetCooker::CookWave(const std::vector<uint8_t>& source, std::vector<uint8_t>& outData) {
+    WaveData waveData;
+    if (!AudioManager::ParseWaveFile(source.data(), source.size(), waveData)) {
+        return false;
+    }
+    return AudioManager::SerializeCookedWave(waveData, outData);
+}
+
+bool AssetCooker::CookTexture(const CookItem& item, const std::vector<uint8_t>& source, std::vector<uint8_t>& outData) {
+    DecodedImage image;
+    if (!TextureCooker::DecodeSourceImage(source, image)) {
+        return false;
+    }
+
+    TextureCookSettings settings = m_textureSettings;
+    settings.PrintStats = false; // Same as models, parallel jobs would interleave
+    TextureCooker cooker(settings);
+    CookedTexture texture;
+    if (!cooker.Cook(image, texture, std::filesystem::path(item.SourcePath).filename().string())) {
+        return false;
+    }
+    return TextureSerializer::Serialize(texture, outData);
+}
+
+AssetCooker::ItemResult AssetCooker::CookItemCached(const CookItem& item, GeometryFiles& geometryFiles, double& outCookSeconds, double& outSavedSeconds) {
+    outCookSeconds = 0.0;
+    outSavedSeconds = 0.0;
+
+    if (item.Kind == AssetKind::Model && !ColladaParser::IsImplemented) {
+        LogMessage("Skipped " + std::filesystem::path(item.SourcePath).string() + ": model cooking unsupported (ColladaParser is a placeholder)");
+        return ItemResult::Unsupported;
+    }
+
+    std::vector<uint8_t> source;
+    if (!AssetCache::ReadFile(item.SourcePath, source)) {
+        LogMessage("Failed to read " + std::filesystem::path(item.SourcePath).string());
+        return ItemResult::Failed;
+    }
+
+    uint32_t cookerVersion = item.Kind == AssetKind::Model ? MODEL_COOKER_VERSION :
+                             item.Kind == AssetKind::Texture ? TEXTURE_COOKER_VERSION : WAVE_COOKER_VERSION;
+    Hash128 sourceHash = ContentHasher::Hash(source.data(), source.size());
+    Hash128 key = AssetCache::MakeKey(sourceHash, cookerVersion, GetSettingsHash(item.Kind));
+
+    std::vector<uint8_t> cooked;
+    double recordedSeconds = 0.0;
+    if (m_cache.Load(key, cooked, &recordedSeconds) && RestoreSharedGeometry(item, cooked, geometryFiles)) {
+        if (!AssetCache::WriteFileAtomic(item.OutputPath, cooked.data(), cooked.size())) {
+            LogMessage("Failed to write " + std::filesystem::path(item.OutputPath).string());
+            return ItemResult::Failed;
+        }
+        outSavedSeconds = recordedSeconds;
+        return ItemResult::Hit;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool cookedOk = false;
+    switch (item.Kind) {
+    case AssetKind::Model: {
+        ColladaParser parser; // Not thread safe, one per job
+        Model model;
+        cookedOk = parser.ParseFile(item.SourcePath, model) && CookModel(item, model, geometryFiles, cooked);
+        break;
+    }
+    case AssetKind::Wave: cookedOk = CookWave(source, cooked); break;
+    case AssetKind::Texture: cookedOk = CookTexture(item, source, cooked); break;
+    default: break;
+    }
+    if (cookedOk && m_settings.CompressPayloads && item.Kind != AssetKind::Texture) {
+        // Loaders decode the blocks in parallel (AssetManager, VirtualFileSystem). Textures stay plain DDS.
+        std::vector<uint8_t> compressed;
+        cookedOk = BlockCompressor::Compress(cooked.data(), cooked.size(), compressed, &m_jobSystem);
+        cooked.swap(compressed);
+    }
+    outCookSeconds = SecondsSince(start);
+
+    if (!cookedOk) {
+        LogMessage("Failed to cook " + std::filesystem::path(item.SourcePath).string());
+        return ItemResult::Failed;
+    }
+
+    if (!m_cache.Store(key, cooked, outCookSeconds)) {
+        LogMessage("Failed to store cache entry " + key.ToString()); // Not fatal, output is still written
+    }
+    if (!AssetCache::WriteFileAtomic(item.OutputPath, cooked.data(), cooked.size())) {
+        LogMessage("Failed to write " + std::filesystem::path(item.OutputPath).string());
+        return ItemResult::Failed;
+    }
+    return ItemResult::Miss;
+}
+
+CookReport AssetCooker::CookItems(const std::vector<CookItem>& items) {
+    CookReport report;
+    std::mutex reportMutex;
+    auto start = std::chrono::high_resolution_clock::now();
+    GeometryFiles geometryFiles;
+
+    // One item per job: items are coarse (whole files) and vary a lot in cost
+    m_jobSystem.ParallelFor(items.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            double cookSeconds = 0.0, savedSeconds = 0.0;
+            ItemResult result = CookItemCached(items[i], geometryFiles, cookSeconds, savedSeconds);
+
+            std::lock_guard<std::mutex> lock(reportMutex);
+            switch (result) {
+            case ItemResult::Hit: report.Hits++; break;
+            case ItemResult::Miss: report.Misses++; break;
+            case ItemResult::Failed: report.Failures++; break;
+            case ItemResult::Unsupported: report.Unsupported++; break;
+            }
+            report.CookSeconds += cookSeconds;
+            report.SavedSeconds += savedSeconds;
+        }
+    });
+
+    report.WallSeconds = SecondsSince(start);
+    report.SharedMeshes = geometryFiles.SharedMeshes.load();
+    report.GeometryFiles = geometryFiles.Paths.size(); // Every job has finished
+    LogMessage(report.ToString());
+    return report;
+}
+
+CookReport AssetCooker::CookDirectory(const std::wstring& sourceDirectory, const std::wstring& outputDirectory) {
+    std::vector<CookItem> items;
+    std::filesystem::path sourceRoot(sourceDirectory);
+    std::filesystem::path outputRoot(outputDirectory);
+
+    std::error_code ec;
+    for (std::filesystem::recursive_directory_iterator it(sourceRoot, ec), endIt; !ec && it != endIt; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        AssetKind kind = GetAssetKind(it->path());
+        if (kind == AssetKind::Unknown) {
+            continue;
+        }
+
+        items.push_back(MakeCookItem(it->path(), sourceRoot, outputRoot));
+    }
+    if (ec) {
+        LogMessage("Failed to enumerate " + sourceRoot.string());
+    }
+
+    return CookItems(items);
+}
+
+void AssetCooker::LogMessage(const std::string& message) {
+    std::string line = "Asset Cooker: " + message + "\n";
+    std::cout << line;
+    OutputDebugStringA(line.c_str());
+}
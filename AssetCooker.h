@@ -0,0 +1,102 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+#include "ModelCooker.h"
+#include "TextureCooker.h"
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Bump when a cook stage changes its output so stale cache entries are never reused
+constexpr uint32_t MODEL_COOKER_VERSION = 8;
+constexpr uint32_t WAVE_COOKER_VERSION = 1;
+constexpr uint32_t TEXTURE_COOKER_VERSION = 1;
+
+enum class AssetKind {
+    Unknown,
+    Model, // .dae -> .agm (ColladaParser + ModelCooker + ModelSerializer)
+    Wave,  // .wav -> .agw (AudioManager cooked wave)
+    Texture, // .png/.jpg/.bmp/.tif -> .dds (WIC + TextureCooker + TextureSerializer)
+};
+
+struct CookItem {
+    std::wstring SourcePath;
+    std::wstring OutputPath;
+    AssetKind Kind = AssetKind::Unknown;
+    std::wstring GeometryDirectory; // Models: where shared geometry (.agg) goes, empty = meshes stay inline
+};
+
+struct CookReport {
+    size_t Hits = 0;
+    size_t Misses = 0;         // Cooked because content, cooker version or settings changed
+    size_t Failures = 0;
+    size_t Unsupported = 0;    // Skipped, no working importer for the kind (models while ColladaParser::IsImplemented is false)
+    double CookSeconds = 0.0;  // Cook time spent on misses (summed over workers)
+    double SavedSeconds = 0.0; // Recorded cook time of the entries that were hits
+    double WallSeconds = 0.0;
+    size_t SharedMeshes = 0;   // Mesh references in the cooked models
+    size_t GeometryFiles = 0;  // Distinct shared geometry files they point to (the rest were deduplicated)
+
+    std::string ToString() const;
+};
+
+// Incremental asset cook: unchanged inputs are served from the AssetCache,
+// changed inputs are cooked in parallel on the JobSystem.
+class AssetCooker {
+public:
+    AssetCooker(JobSystem& jobSystem, const CookSettings& settings, const TextureCookSettings& textureSettings = TextureCookSettings());
+
+    bool Initialize(const std::wstring& cacheDirectory);
+
+    // Cooks every supported file below 'sourceDirectory' into 'outputDirectory', keeping the relative layout
+    CookReport CookDirectory(const std::wstring& sourceDirectory, const std::wstring& outputDirectory);
+    CookReport CookItems(const std::vector<CookItem>& items);
+    // Cooks a model that is already in memory (built by code or another importer) to 'item.OutputPath'
+    // and its shared geometry, like a parsed source. Not cached: there are no source bytes to key on.
+    bool CookModel(const CookItem& item, Model& model);
+
+    // Item cooking 'sourcePath' (below 'sourceRoot') to the matching path below 'outputRoot'.
+    // Models share one geometry directory, '<outputRoot>/Geometry'.
+    static CookItem MakeCookItem(const std::filesystem::path& sourcePath, const std::filesystem::path& sourceRoot, const std::filesystem::path& outputRoot);
+    static AssetKind GetAssetKind(const std::filesystem::path& sourcePath);
+    static std::wstring GetCookedExtension(AssetKind kind);
+
+    // Hash of every setting that affects the output of 'kind'
+    Hash128 GetSettingsHash(AssetKind kind) const;
+
+private:
+    enum class ItemResult { Hit, Miss, Failed, Unsupported };
+
+    JobSystem& m_jobSystem;
+    CookSettings m_settings;
+    TextureCookSettings m_textureSettings;
+    AssetCache m_cache;
+
+    // Shared geometry files written or verified by one CookItems call. Each call has its own, so
+    // concurrent calls (hot reload cooks one item per job) don't reset each other's counts.
+    struct GeometryFiles {
+        std::mutex Mutex;
+        std::set<std::wstring> Paths;
+        std::atomic<size_t> SharedMeshes{ 0 };
+    };
+
+    ItemResult CookItemCached(const CookItem& item, GeometryFiles& geometryFiles, double& outCookSeconds, double& outSavedSeconds);
+    bool CookModel(const CookItem& item, Model& model, GeometryFiles& geometryFiles, std::vector<uint8_t>& outData);
+    bool WriteSharedGeometry(const std::filesystem::path& directory, const Mesh& mesh, GeometryFiles& geometryFiles);
+    // Cache hit of a model: puts back referenced geometry files that are missing. False = cook again.
+    bool RestoreSharedGeometry(const CookItem& item, const std::vector<uint8_t>& cooked, GeometryFiles& geometryFiles);
+    Hash128 GetGeometryKey(const Hash128& contentHash) const;
+    bool CookWave(const std::vector<uint8_t>& source, std::vector<uint8_t>& outData);
+    bool CookTexture(const CookItem& item, const std::vector<uint8_t>& source, std::vector<uint8_t>& outData);
+
+    void LogMessage(const std::string& message);
+};
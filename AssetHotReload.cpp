@@ -0,0 +1,212 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "AssetHotReload.h"
+#include "Timing.h"
+#include <iomanip>
+
+namespace {
+
+// Height field grid: one mesh placed twice, with the material 'materialName'
+Model MakeTestModel(float height, const wchar_t* materialName) {
+    const uint32_t size = 32;
+    Model model;
+    model.Meshes.emplace_back();
+    Mesh& mesh = model.Meshes.back();
+    for (uint32_t z = 0; z <= size; ++z) {
+        for (uint32_t x = 0; x <= size; ++x) {
+            Vertex vertex = {};
+            float u = static_cast<float>(x) / size, v = static_cast<float>(z) / size;
+            vertex.Position = { u * 4.0f, height * sinf(u * DirectX::XM_PI) * sinf(v * DirectX::XM_PI), v * 4.0f };
+            vertex.Normal = { 0.0f, 1.0f, 0.0f };
+            vertex.TexCoord = { u, v };
+            mesh.Vertices.push_back(vertex);
+        }
+    }
+    for (uint32_t z = 0; z < size; ++z) {
+        for (uint32_t x = 0; x < size; ++x) {
+            uint32_t a = z * (size + 1) + x, b = a + 1, c = a + size + 1, d = c + 1;
+            mesh.Indices.insert(mesh.Indices.end(), { a, c, b, b, c, d });
+        }
+    }
+    mesh.MaterialName = materialName;
+    model.Materials.emplace_back();
+    model.Materials.back().Name = materialName;
+    for (float offset : { 0.0f, 5.0f }) {
+        MeshInstance instance;
+        DirectX::XMStoreFloat4x4(&instance.Transform, DirectX::XMMatrixTranslation(offset, 0.0f, 0.0f));
+        model.Instances.push_back(instance);
+    }
+    return model;
+}
+
+size_t CountGeometryFiles(const std::filesystem::path& directory) {
+    size_t count = 0;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory, ec), endIt; !ec && it != endIt; it.increment(ec)) {
+        count += it->path().extension() == L".agg" ? 1 : 0;
+    }
+    return count;
+}
+
+} // namespace
+
+AssetHotReloader::AssetHotReloader(AssetManager& assetManager, JobSystem& jobSystem)
+    : m_assetManager(assetManager), m_jobSystem(jobSystem) {}
+
+AssetHotReloader::~AssetHotReloader() {
+    Stop();
+}
+
+bool AssetHotReloader::Start(const std::wstring& sourceDirectory, AssetCooker* cooker, const std::wstring& cookedDirectory) {
+    m_sourceDirectory = sourceDirectory;
+    m_cookedDirectory = cookedDirectory;
+    m_cooker = cookedDirectory.empty() ? nullptr : cooker;
+
+    if (!m_watcher.Start(sourceDirectory)) {
+        LogMessage("Failed to watch " + std::filesystem::path(sourceDirectory).string());
+        return false;
+    }
+    LogMessage("Watching " + std::filesystem::path(sourceDirectory).string());
+    return true;
+}
+
+void AssetHotReloader::Stop() {
+    m_watcher.Stop();
+    m_jobSystem.Wait(m_cookCounter); // Cook jobs reference this object
+    m_cooking.clear();
+    m_changedAgain.clear();
+    m_finished.clear();
+}
+
+void AssetHotReloader::StartCook(const std::wstring& sourcePath) {
+    CookItem item = AssetCooker::MakeCookItem(sourcePath, m_sourceDirectory, m_cookedDirectory);
+    m_cooking.insert(sourcePath);
+
+    m_jobSystem.Submit([this, item]() {
+        // Content hashed: re-saving an unchanged file is a cache hit
+        CookReport report = m_cooker->CookItems({ item });
+
+        FinishedCook finished;
+        finished.SourcePath = item.SourcePath;
+        finished.OutputPath = item.OutputPath;
+        finished.Succeeded = report.Failures == 0 && report.Unsupported == 0;
+        finished.Unsupported = report.Unsupported > 0;
+        std::lock_guard<std::mutex> lock(m_finishedMutex);
+        m_finished.push_back(std::move(finished));
+    }, &m_cookCounter);
+}
+
+void AssetHotReloader::Update() {
+    std::vector<std::wstring> changed;
+    m_watcher.PollChanges(changed);
+
+    for (const std::wstring& path : changed) {
+        // Files loaded straight from the source directory (images, raw data, uncooked waves)
+        m_assetManager.Reload(path);
+
+        if (m_cooker && AssetCooker::GetAssetKind(path) != AssetKind::Unknown) {
+            if (m_cooking.count(path)) {
+                m_changedAgain.insert(path); // Don't race two cooks of the same output
+            } else {
+                StartCook(path);
+            }
+        }
+    }
+
+    std::vector<FinishedCook> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_finishedMutex);
+        finished.swap(m_finished);
+    }
+    for (const FinishedCook& cook : finished) {
+        m_cooking.erase(cook.SourcePath);
+        if (cook.Succeeded) {
+            m_assetManager.Reload(cook.OutputPath);
+        } else if (!cook.Unsupported) {
+            LogMessage("Re-cook failed: " + std::filesystem::path(cook.SourcePath).string());
+        }
+        if (m_changedAgain.erase(cook.SourcePath)) {
+            StartCook(cook.SourcePath);
+        }
+    }
+}
+
+void AssetHotReloader::LogMessage(const std::string& message) {
+    std::string line = "Hot Reload: " + message + "\n";
+    std::cout << line;
+    OutputDebugStringA(line.c_str());
+}
+
+bool AssetHotReloader::RunModelReloadTest(const std::wstring& directory, JobSystem& jobSystem) {
+    std::filesystem::path root(directory);
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3) << "Model reload test:\n";
+    auto check = [&report](bool passed, const char* what) {
+        report << "  " << (passed ? "ok     " : "FAILED ") << what << "\n";
+        return passed;
+    };
+
+    CookSettings settings;
+    settings.PrintStats = false;
+    AssetCooker cooker(jobSystem, settings);
+    bool ok = check(cooker.Initialize((root / L"Cache").wstring()), "cook cache created");
+
+    // Two models with the same geometry under different materials: one shared geometry file
+    CookItem first = AssetCooker::MakeCookItem(root / L"Source/first.dae", root / L"Source", root / L"Cooked");
+    CookItem second = AssetCooker::MakeCookItem(root / L"Source/second.dae", root / L"Source", root / L"Cooked");
+    std::filesystem::path geometryDirectory(first.GeometryDirectory);
+    Model firstModel = MakeTestModel(1.0f, L"Grass");
+    Model secondModel = MakeTestModel(1.0f, L"Rock");
+    const size_t indexCount = firstModel.Meshes[0].Indices.size();
+    ok = check(cooker.CookModel(first, firstModel) && cooker.CookModel(second, secondModel), "hand-built models cooked") && ok;
+    ok = check(CountGeometryFiles(geometryDirectory) == 1, "both models reference one geometry file") && ok;
+
+    AssetManager assetManager;
+    assetManager.Initialize(&jobSystem);
+    size_t reloads = 0;
+    assetManager.SetReloadCallback([&reloads](const AssetHandle&) { reloads++; });
+    // Frames until 'done' (or about five seconds)
+    auto runFrames = [&assetManager](auto done) {
+        auto start = std::chrono::high_resolution_clock::now();
+        while (!done() && SecondsSince(start) < 5.0) {
+            assetManager.Update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return done();
+    };
+
+    AssetHandle handle = assetManager.Load(first.OutputPath, AssetType::Model);
+    runFrames([&handle] { return handle.GetState() == AssetState::Ready || handle.GetState() == AssetState::Failed; });
+    std::shared_ptr<const Model> loaded = handle.GetModel();
+    const float loadedHeight = loaded && !loaded->Meshes.empty() ? loaded->Meshes[0].Bounds.Max.y : 0.0f;
+    ok = check(loaded && loaded->Meshes.size() == 1 && loaded->Instances.size() == 2 &&
+               loaded->Meshes[0].Indices.size() == indexCount, "cooked model loaded with its shared mesh and instances") && ok;
+    ok = check(std::abs(loadedHeight - 1.0f) < 0.01f, "loaded geometry matches the source") && ok;
+
+    // Edit: a higher grid cooked over the first model, then reloaded behind the same handle
+    Model editedModel = MakeTestModel(2.0f, L"Grass");
+    ok = check(cooker.CookModel(first, editedModel), "edited model cooked") && ok;
+    ok = check(CountGeometryFiles(geometryDirectory) == 2, "edited geometry written to its own file") && ok;
+    ok = check(assetManager.Reload(first.OutputPath), "reload requested") && ok;
+    runFrames([&handle] { return handle.GetVersion() > 0; });
+    std::shared_ptr<const Model> reloaded = handle.GetModel();
+    const float reloadedHeight = reloaded && !reloaded->Meshes.empty() ? reloaded->Meshes[0].Bounds.Max.y : 0.0f;
+    ok = check(handle.GetVersion() == 1 && reloads == 1, "reload swapped in behind the existing handle") && ok;
+    ok = check(std::abs(reloadedHeight - 2.0f) < 0.02f, "reloaded geometry matches the edit") && ok;
+    // The previous version is still held here, so it must not have been freed by the swap
+    ok = check(loaded && loaded != reloaded && loaded->Meshes[0].Bounds.Max.y == loadedHeight, "model fetched before the reload still alive") && ok;
+    report << "  Height " << loadedHeight << " -> " << reloadedHeight << ", "
+           << CountGeometryFiles(geometryDirectory) << " geometry files\n";
+
+    handle.Reset();
+    assetManager.Shutdown();
+    report << (ok ? "  PASSED\n" : "  FAILED\n");
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
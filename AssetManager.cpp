@@ -0,0 +1,674 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "AssetManager.h"
+#include "Timing.h"
+#include "BlockCompression.h"
+#include "Camera.h"
+#include "ModelSerializer.h"
+#include "VirtualFileSystem.h"
+#include <cstring>
+#include <iomanip>
+#include <random>
+
+namespace {
+
+constexpr size_t IO_ALIGNMENT = 4096;     // Sector / page alignment for unbuffered reads
+constexpr size_t IO_CHUNK_SIZE = 1 << 20; // 1 MB per ReadFile call
+
+// Payload replaced by a hot reload, destroyed on a worker thread (the model only once the last
+// reference from AssetHandle::GetModel is gone)
+struct RetiredPayload {
+    std::shared_ptr<const Model> ModelData;
+    AlignedBuffer Bytes;
+    WaveData Wave;
+    DecodedImage Image;
+};
+
+bool IsDdsPath(const std::wstring& path) {
+    std::wstring extension = std::filesystem::path(path).extension().wstring();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+    return extension == L".dds";
+}
+
+} // namespace
+
+
+// --- AlignedBuffer ---
+
+AlignedBuffer::AlignedBuffer(size_t capacity, size_t alignment) {
+    if (capacity > 0) {
+        m_data = static_cast<uint8_t*>(_aligned_malloc(capacity, alignment));
+        m_capacity = m_data ? capacity : 0;
+    }
+}
+
+AlignedBuffer::~AlignedBuffer() {
+    if (m_data) {
+        _aligned_free(m_data);
+    }
+}
+
+AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept
+    : m_data(other.m_data), m_size(other.m_size), m_capacity(other.m_capacity) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+}
+
+AlignedBuffer& AlignedBuffer::operator=(AlignedBuffer&& other) noexcept {
+    if (this != &other) {
+        if (m_data) {
+            _aligned_free(m_data);
+        }
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_capacity = 0;
+    }
+    return *this;
+}
+
+
+// --- AssetHandle ---
+
+const std::wstring& AssetHandle::GetPath() const {
+    static const std::wstring s_empty;
+    return m_entry ? m_entry->Path : s_empty;
+}
+
+
+// --- AssetManager ---
+
+AssetManager::AssetManager() {}
+
+AssetManager::~AssetManager() {
+    Shutdown();
+}
+
+bool AssetManager::Initialize(JobSystem* jobSystem, AudioManager* audioManager, D2DRenderer* d2dRenderer) {
+    if (m_ioThread.joinable()) {
+        return true;
+    }
+    m_jobSystem = jobSystem;
+    m_audioManager = audioManager;
+    m_d2dRenderer = d2dRenderer;
+    m_shutdown = false;
+
+    try {
+        m_ioThread = std::thread(&AssetManager::IoThreadLoop, this);
+    } catch (const std::system_error&) {
+        LogMessage("Failed to create I/O thread.");
+        return false;
+    }
+    return true;
+}
+
+void AssetManager::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_shutdown = true;
+        m_queue.clear();
+    }
+    m_queueCondition.notify_all();
+    if (m_ioThread.joinable()) {
+        m_ioThread.join();
+    }
+
+    // Decode jobs reference this manager, let them finish
+    if (m_jobSystem) {
+        m_jobSystem->Wait(m_decodeCounter);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        m_completed.clear();
+    }
+    m_reloads.clear();
+    m_assets.clear();
+    m_jobSystem = nullptr;
+}
+
+AssetType AssetManager::GetTypeFromExtension(const std::wstring& path) {
+    std::wstring extension = std::filesystem::path(path).extension().wstring();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+
+    if (extension == L".agm" || extension == L".agg") return AssetType::Model; // .agg: shared geometry, a one-mesh model
+    if (extension == L".wav" || extension == L".agw") return AssetType::Wave;
+    if (extension == L".png" || extension == L".jpg" || extension == L".jpeg" || extension == L".bmp" ||
+        extension == L".gif" || extension == L".tif" || extension == L".tiff" || extension == L".dds") {
+        return AssetType::Image;
+    }
+    return AssetType::Raw;
+}
+
+float AssetManager::ComputePriority(const Camera& camera, const DirectX::XMFLOAT3& position, float radius, float viewportHeight) {
+    // Projected diameter in pixels, offset so anything on screen outranks normal background loads
+    return ASSET_PRIORITY_NORMAL + camera.GetProjectedSize(radius * 2.0f, position, viewportHeight);
+}
+
+AssetHandle AssetManager::Load(const std::wstring& path, float priority) {
+    return Load(path, GetTypeFromExtension(path), priority);
+}
+
+std::wstring AssetManager::NormalizePath(const std::wstring& path) {
+    // Same file, same key, whether it was named relative (Load) or absolute (file watcher)
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    return (ec ? std::filesystem::path(path) : absolute).lexically_normal().wstring();
+}
+
+AssetHandle AssetManager::Load(const std::wstring& requestedPath, AssetType type, float priority, const std::string& name) {
+    std::wstring path = NormalizePath(requestedPath);
+    auto it = m_assets.find(path);
+    if (it != m_assets.end()) {
+        std::shared_ptr<AssetEntry> existing = it->second.lock();
+        if (existing) {
+            AssetHandle handle(existing);
+            bool raise = false;
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                raise = priority > existing->Priority;
+            }
+            if (raise) {
+                SetPriority(handle, priority);
+            }
+            return handle;
+        }
+    }
+
+    auto entry = std::make_shared<AssetEntry>();
+    entry->Path = path;
+    entry->Name = name.empty() ? std::filesystem::path(path).filename().string() : name;
+    entry->NameId = StringId::Intern(entry->Name);
+    entry->Type = type;
+    entry->Priority = priority;
+    entry->RequestTime = std::chrono::high_resolution_clock::now();
+    m_assets[path] = entry;
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.Requested++;
+    }
+    Enqueue(entry, priority);
+    return AssetHandle(entry);
+}
+
+void AssetManager::Enqueue(const std::shared_ptr<AssetEntry>& entry, float priority) {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back({ priority, m_nextSequence++, entry });
+        if (!m_queueDirty) {
+            std::push_heap(m_queue.begin(), m_queue.end());
+        }
+    }
+    m_queueCondition.notify_one();
+}
+
+bool AssetManager::Reload(const std::wstring& path, float priority) {
+    auto it = m_assets.find(NormalizePath(path));
+    std::shared_ptr<AssetEntry> target = it != m_assets.end() ? it->second.lock() : nullptr;
+    if (!target) {
+        return false;
+    }
+    if (target->State.load() == AssetState::Queued) {
+        return true; // Not read yet, the pending load picks up the new file
+    }
+
+    auto staging = std::make_shared<AssetEntry>();
+    staging->Path = target->Path;
+    staging->Name = target->Name;
+    staging->NameId = target->NameId;
+    staging->Type = target->Type;
+    staging->Priority = priority;
+    staging->RequestTime = std::chrono::high_resolution_clock::now();
+    staging->ReloadTarget = target;
+    staging->ReloadSequence = ++m_nextReloadSequence;
+    m_reloads.push_back(staging); // Keeps it alive, the queue only holds weak references
+
+    Enqueue(staging, priority);
+    return true;
+}
+
+void AssetManager::SetPriority(const AssetHandle& handle, float priority) {
+    if (!handle.m_entry) return;
+
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    AssetEntry* entry = handle.m_entry.get();
+    if (entry->State.load() != AssetState::Queued || entry->Priority == priority) {
+        return;
+    }
+    entry->Priority = priority;
+    for (QueueItem& item : m_queue) {
+        if (!item.Entry.owner_before(handle.m_entry) && !handle.m_entry.owner_before(item.Entry)) {
+            item.Priority = priority;
+            m_queueDirty = true; // Re-heaped once before the next pop
+            break;
+        }
+    }
+}
+
+void AssetManager::OnReady(const AssetHandle& handle, std::function<void(const AssetHandle&)> callback) {
+    if (!handle.m_entry || !callback) return;
+
+    AssetState state = handle.GetState();
+    if (state == AssetState::Ready || state == AssetState::Failed) {
+        callback(handle);
+        return;
+    }
+    // Only Update() (same thread) consumes OnReady, so no lock is needed
+    handle.m_entry->OnReady.push_back(std::move(callback));
+}
+
+void AssetManager::IoThreadLoop() {
+    for (;;) {
+        std::shared_ptr<AssetEntry> entry;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCondition.wait(lock, [this]() {
+                return m_shutdown || (!m_queue.empty() && m_decoding.load() < MAX_DECODES_IN_FLIGHT);
+            });
+            if (m_shutdown) {
+                return;
+            }
+
+            if (m_queueDirty) {
+                std::make_heap(m_queue.begin(), m_queue.end());
+                m_queueDirty = false;
+            }
+            std::pop_heap(m_queue.begin(), m_queue.end());
+            QueueItem item = std::move(m_queue.back());
+            m_queue.pop_back();
+
+            entry = item.Entry.lock();
+            if (!entry) {
+                // Every handle was dropped while queued
+                std::lock_guard<std::mutex> statsLock(m_statsMutex);
+                m_stats.Cancelled++;
+                continue;
+            }
+            entry->State.store(AssetState::Reading);
+            m_reading = true;
+        }
+
+        auto readStart = std::chrono::high_resolution_clock::now();
+        auto fileData = std::make_shared<AlignedBuffer>();
+        bool readOk = ReadFileAligned(entry->Path, *fileData);
+        entry->ReadSeconds = SecondsSince(readStart);
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.BytesRead += fileData->Size();
+            m_stats.ReadSeconds += entry->ReadSeconds;
+        }
+
+        if (!readOk) {
+            LogMessage("Failed to read " + std::filesystem::path(entry->Path).string());
+            Complete(entry, false);
+        } else {
+            entry->State.store(AssetState::Decoding);
+            m_decoding.fetch_add(1);
+            if (m_jobSystem) {
+                m_jobSystem->Submit([this, entry, fileData]() { Decode(entry, *fileData); }, &m_decodeCounter);
+            } else {
+                Decode(entry, *fileData);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_reading = false;
+    }
+}
+
+bool AssetManager::ReadFileAligned(const std::wstring& path, AlignedBuffer& outBuffer) {
+    // Packed assets are a copy out of the pack mapping; no open per file
+    FileView packed;
+    if (VirtualFileSystem::Get().ReadPacked(path, packed)) {
+        outBuffer = AlignedBuffer(packed.Size(), IO_ALIGNMENT);
+        if (packed.Size() > 0 && !outBuffer.Data()) {
+            return false;
+        }
+        std::memcpy(outBuffer.Data(), packed.Data(), packed.Size());
+        outBuffer.SetSize(packed.Size());
+        return true;
+    }
+
+    // Unbuffered reads skip the system cache copy; they need sector aligned buffers and sizes,
+    // so the buffer is rounded up and every request is a whole number of sectors.
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        // E.g. network shares that don't support unbuffered I/O
+        file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+    }
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(fileSize.QuadPart);
+    size_t capacity = (size + IO_ALIGNMENT - 1) & ~(IO_ALIGNMENT - 1);
+    outBuffer = AlignedBuffer(capacity, IO_ALIGNMENT);
+    if (capacity > 0 && !outBuffer.Data()) {
+        CloseHandle(file);
+        return false;
+    }
+
+    size_t offset = 0;
+    bool ok = true;
+    while (offset < capacity) {
+        DWORD request = static_cast<DWORD>(std::min(IO_CHUNK_SIZE, capacity - offset));
+        DWORD bytesRead = 0;
+        if (!ReadFile(file, outBuffer.Data() + offset, request, &bytesRead, nullptr)) {
+            ok = false;
+            break;
+        }
+        offset += bytesRead;
+        if (bytesRead < request) {
+            break; // End of file
+        }
+    }
+    CloseHandle(file);
+
+    outBuffer.SetSize(std::min(offset, size));
+    return ok && outBuffer.Size() == size;
+}
+
+void AssetManager::Decode(const std::shared_ptr<AssetEntry>& entry, AlignedBuffer& fileData) {
+    auto start = std::chrono::high_resolution_clock::now();
+    bool ok = DecodePayload(entry, fileData);
+
+    entry->DecodeSeconds = SecondsSince(start);
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.DecodeSeconds += entry->DecodeSeconds;
+    }
+    Complete(entry, ok);
+
+    m_decoding.fetch_sub(1);
+    {
+        // I/O thread may be waiting for a free decode slot
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+    }
+    m_queueCondition.notify_all();
+}
+
+bool AssetManager::DecodePayload(const std::shared_ptr<AssetEntry>& entry, AlignedBuffer& fileData) {
+    // Block compressed cooked payloads decode first, their blocks in parallel on the job system
+    if (BlockCompressor::IsCompressed(fileData.Data(), fileData.Size())) {
+        size_t size = static_cast<size_t>(BlockCompressor::GetUncompressedSize(fileData.Data(), fileData.Size()));
+        AlignedBuffer decompressed(size, IO_ALIGNMENT);
+        if ((size > 0 && !decompressed.Data()) ||
+            !BlockCompressor::Decompress(fileData.Data(), fileData.Size(), decompressed.Data(), size, m_jobSystem)) {
+            LogMessage("Corrupt compressed payload: " + std::filesystem::path(entry->Path).string());
+            return false;
+        }
+        decompressed.SetSize(size);
+        fileData = std::move(decompressed);
+    }
+
+    bool ok = false;
+    switch (entry->Type) {
+    case AssetType::Raw:
+        entry->Bytes = std::move(fileData);
+        ok = true;
+        break;
+
+    case AssetType::Model: {
+        auto model = std::make_shared<Model>();
+        ok = ModelSerializer::Deserialize(fileData.Data(), fileData.Size(), *model, true, entry->Path);
+        if (ok) {
+            entry->ModelData = std::move(model);
+        } else {
+            LogMessage("Not a cooked model (cook .dae files with AssetCooker): " + std::filesystem::path(entry->Path).string());
+        }
+        break;
+    }
+
+    case AssetType::Wave:
+        ok = AudioManager::DecodeWave(fileData.Data(), fileData.Size(), entry->Wave);
+        break;
+
+    case AssetType::Image: {
+        if (IsDdsPath(entry->Path)) {
+            ok = D2DRenderer::DecodeDds(fileData.Data(), fileData.Size(), entry->Image); // Cooked texture, no WIC
+            break;
+        }
+        IWICImagingFactory* wicFactory = m_d2dRenderer ? m_d2dRenderer->GetWICFactory() : nullptr;
+        if (!wicFactory) {
+            LogMessage("Image decoding needs a D2DRenderer: " + std::filesystem::path(entry->Path).string());
+            break;
+        }
+        // WIC needs COM on this thread. Fails harmlessly (RPC_E_CHANGED_MODE) on the STA main thread
+        // when it helps out with jobs while waiting.
+        HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        ok = D2DRenderer::DecodeImage(wicFactory, fileData.Data(), fileData.Size(), entry->Image);
+        if (SUCCEEDED(hrCom)) {
+            CoUninitialize();
+        }
+        break;
+    }
+    }
+    return ok;
+}
+
+void AssetManager::Complete(const std::shared_ptr<AssetEntry>& entry, bool success) {
+    entry->LoadSucceeded = success;
+    std::lock_guard<std::mutex> lock(m_completedMutex);
+    m_completed.push_back(entry);
+}
+
+void AssetManager::PublishReload(const std::shared_ptr<AssetEntry>& staging) {
+    m_reloads.erase(std::remove(m_reloads.begin(), m_reloads.end(), staging), m_reloads.end());
+
+    std::shared_ptr<AssetEntry> target = staging->ReloadTarget.lock();
+    std::string fileName = std::filesystem::path(staging->Path).filename().string();
+    if (!target || staging->ReloadSequence < target->ReloadSequence) {
+        return; // Every handle was dropped, or a newer reload already landed
+    }
+    if (!staging->LoadSucceeded) {
+        LogMessage("Reload of " + fileName + " failed, keeping the previous version.");
+        return;
+    }
+
+    // Swap the payloads: handles see the new data from now on, the staging entry keeps the old one
+    bool success = true;
+    if (target->Type == AssetType::Wave && m_audioManager) {
+        m_audioManager->AddWaveData(target->NameId, std::move(staging->Wave));
+        staging->Wave = WaveData();
+    } else if (target->Type == AssetType::Image && m_d2dRenderer) {
+        success = m_d2dRenderer->CreateImageFromPixels(staging->Image, target->NameId);
+    } else {
+        std::swap(target->ModelData, staging->ModelData);
+        std::swap(target->Bytes, staging->Bytes);
+        std::swap(target->Wave, staging->Wave);
+        std::swap(target->Image, staging->Image);
+    }
+    if (!success) {
+        LogMessage("Reload of " + fileName + " failed, keeping the previous version.");
+        return;
+    }
+
+    target->ReloadSequence = staging->ReloadSequence;
+    target->Version++;
+    target->State.store(AssetState::Ready, std::memory_order_release); // Also repairs assets whose first load failed
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.Reloaded++;
+    }
+    LogMessage("Reloaded " + fileName + " (version " + std::to_string(target->Version) + ")");
+
+    // Free the old payload on a worker rather than stalling the frame. Callers still holding the old
+    // model from GetModel keep it alive; it is freed with their last reference.
+    if (m_jobSystem && m_jobSystem->GetWorkerCount() > 0) {
+        auto oldPayload = std::make_shared<RetiredPayload>();
+        oldPayload->ModelData = std::move(staging->ModelData);
+        oldPayload->Bytes = std::move(staging->Bytes);
+        oldPayload->Wave = std::move(staging->Wave);
+        oldPayload->Image = std::move(staging->Image);
+        m_jobSystem->Submit([payload = std::move(oldPayload)]() mutable { payload.reset(); });
+    }
+
+    if (m_reloadCallback) {
+        m_reloadCallback(AssetHandle(target));
+    }
+}
+
+void AssetManager::Publish(const std::shared_ptr<AssetEntry>& entry) {
+    if (std::find(m_reloads.begin(), m_reloads.end(), entry) != m_reloads.end()) {
+        PublishReload(entry);
+        return;
+    }
+
+    bool success = entry->LoadSucceeded;
+
+    if (success && entry->Type == AssetType::Wave && m_audioManager) {
+        m_audioManager->AddWaveData(entry->NameId, std::move(entry->Wave));
+        entry->Wave = WaveData();
+    } else if (success && entry->Type == AssetType::Image && m_d2dRenderer) {
+        success = m_d2dRenderer->CreateImageFromPixels(entry->Image, entry->NameId);
+        entry->Image = DecodedImage(); // GPU owns it now
+    }
+
+    entry->State.store(success ? AssetState::Ready : AssetState::Failed, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if (success) m_stats.Completed++;
+        else m_stats.Failed++;
+    }
+
+    std::vector<std::function<void(const AssetHandle&)>> callbacks;
+    callbacks.swap(entry->OnReady);
+    AssetHandle handle(entry);
+    for (auto& callback : callbacks) {
+        callback(handle);
+    }
+}
+
+void AssetManager::Update() {
+    std::vector<std::shared_ptr<AssetEntry>> completed;
+    {
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        completed.swap(m_completed);
+    }
+    for (const auto& entry : completed) {
+        Publish(entry);
+    }
+
+    // Forget assets nobody references any more (every ~second at 60 fps)
+    if (++m_updateCount % 64 == 0) {
+        for (auto it = m_assets.begin(); it != m_assets.end();) {
+            if (it->second.expired()) it = m_assets.erase(it);
+            else ++it;
+        }
+    }
+}
+
+bool AssetManager::IsIdle() const {
+    // Order matters: an asset moves queue/reading -> decoding -> completed
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (m_reading) return false;
+        for (const QueueItem& item : m_queue) {
+            if (!item.Entry.expired()) return false;
+        }
+    }
+    if (m_decoding.load() > 0) return false;
+    std::lock_guard<std::mutex> lock(m_completedMutex);
+    return m_completed.empty();
+}
+
+AssetManagerStats AssetManager::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+bool AssetManager::RunThroughputTest(const std::wstring& directory, JobSystem* jobSystem) {
+    std::vector<std::wstring> files;
+    std::error_code ec;
+    for (std::filesystem::recursive_directory_iterator it(directory, ec), endIt; !ec && it != endIt; it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            files.push_back(it->path().wstring());
+        }
+    }
+
+    AssetManager manager;
+    if (files.empty() || !manager.Initialize(jobSystem)) {
+        manager.LogMessage("Throughput test: no files found in " + std::filesystem::path(directory).string());
+        return false;
+    }
+
+    struct Request {
+        AssetHandle Handle;
+        float Priority = 0.0f;
+        size_t CompletionIndex = 0;
+    };
+    std::vector<Request> requests(files.size());
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> priorityDistribution(0.0f, 100.0f);
+    size_t completionCounter = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < files.size(); ++i) {
+        AssetType type = GetTypeFromExtension(files[i]);
+        if (type == AssetType::Image) {
+            type = AssetType::Raw; // No D2DRenderer (WIC factory) in test mode
+        }
+        requests[i].Priority = priorityDistribution(rng);
+        requests[i].Handle = manager.Load(files[i], type, requests[i].Priority);
+        manager.OnReady(requests[i].Handle, [&requests, &completionCounter, i](const AssetHandle&) {
+            requests[i].CompletionIndex = completionCounter++;
+        });
+    }
+
+    // Poll like the game loop would
+    size_t frames = 0;
+    while (!manager.IsIdle()) {
+        manager.Update();
+        ++frames;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    manager.Update();
+    double seconds = SecondsSince(start);
+
+    AssetManagerStats stats = manager.GetStats();
+    double megabytes = static_cast<double>(stats.BytesRead) / (1024.0 * 1024.0);
+
+    // Priority ordering: mean completion rank of the highest vs lowest priority quarter
+    std::vector<const Request*> sorted;
+    for (const Request& request : requests) sorted.push_back(&request);
+    std::sort(sorted.begin(), sorted.end(), [](const Request* a, const Request* b) { return a->Priority > b->Priority; });
+    size_t quarter = std::max<size_t>(sorted.size() / 4, 1);
+    double highRank = 0.0, lowRank = 0.0;
+    for (size_t i = 0; i < quarter; ++i) {
+        highRank += static_cast<double>(sorted[i]->CompletionIndex);
+        lowRank += static_cast<double>(sorted[sorted.size() - 1 - i]->CompletionIndex);
+    }
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Throughput test: " << files.size() << " files (" << stats.Completed << " ok, " << stats.Failed << " failed), "
+       << megabytes << " MB in " << seconds * 1000.0 << " ms over " << frames << " polls: "
+       << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s, "
+       << (seconds > 0.0 ? files.size() / seconds : 0.0) << " files/s; "
+       << "avg read " << stats.ReadSeconds * 1000.0 / files.size() << " ms, "
+       << "avg decode " << stats.DecodeSeconds * 1000.0 / files.size() << " ms; "
+       << "mean completion rank high/low priority quarter " << highRank / quarter << " / " << lowRank / quarter;
+    manager.LogMessage(ss.str());
+
+    return stats.Failed == 0;
+}
+
+void AssetManager::LogMessage(const std::string& message) {
+    std::string line = "Asset Manager: " + message + "\n";
+    std::cout << line;
+    OutputDebugStringA(line.c_str());
+}
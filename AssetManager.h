@@ -0,0 +1,241 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include "AudioManager.h"
+#include "D2DRenderer.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Camera;
+
+enum class AssetType : uint8_t {
+    Raw,   // File bytes only
+    Model, // Cooked model (.agm)
+    Wave,  // Cooked wave (.agw) or RIFF WAV
+    Image, // Anything WIC decodes (png, jpg, bmp, ...) and cooked .dds textures
+};
+
+enum class AssetState : uint8_t {
+    Queued,   // Waiting for the I/O thread
+    Reading,
+    Decoding, // On a worker thread
+    Ready,    // Set by AssetManager::Update on the main thread
+    Failed,
+};
+
+// Higher priorities are read first
+constexpr float ASSET_PRIORITY_BACKGROUND = 0.0f;
+constexpr float ASSET_PRIORITY_NORMAL = 1.0f;
+constexpr float ASSET_PRIORITY_HIGH = 100.0f;
+constexpr float ASSET_PRIORITY_CRITICAL = 1.0e6f; // Needed this frame (UI, player)
+
+// Heap block with the alignment unbuffered file reads require
+class AlignedBuffer {
+public:
+    AlignedBuffer() = default;
+    AlignedBuffer(size_t capacity, size_t alignment);
+    ~AlignedBuffer();
+    AlignedBuffer(AlignedBuffer&& other) noexcept;
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }         // Valid bytes
+    size_t Capacity() const { return m_capacity; }
+    void SetSize(size_t size) { m_size = std::min(size, m_capacity); }
+
+private:
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+};
+
+class AssetHandle;
+
+// Shared state of one asset. Payload fields are written by the decode job and only read
+// by the main thread once Update() has moved the asset to Ready.
+struct AssetEntry {
+    std::wstring Path;
+    std::string Name; // Sound / image name registered with AudioManager / D2DRenderer
+    StringId NameId;  // Interned Name
+    AssetType Type = AssetType::Raw;
+    std::atomic<AssetState> State{ AssetState::Queued };
+    float Priority = ASSET_PRIORITY_NORMAL; // Guarded by the AssetManager queue mutex
+    bool LoadSucceeded = false;             // Written by the decode job, read by Update()
+
+    // Hot reload (main thread only). A reload loads into a staging entry whose payload is swapped
+    // into ReloadTarget by Update(); Version counts the swaps so users can rebuild derived data.
+    std::weak_ptr<AssetEntry> ReloadTarget;
+    uint64_t ReloadSequence = 0; // Staging: request number. Target: last applied request.
+    uint32_t Version = 0;
+
+    // Payload
+    AlignedBuffer Bytes;                     // Raw assets
+    std::shared_ptr<const Model> ModelData;  // Model assets, shared with GetModel callers
+    WaveData Wave;                           // Wave assets not handed to an AudioManager
+    DecodedImage Image;                      // Image assets not handed to a D2DRenderer
+
+    // Timing (seconds)
+    double ReadSeconds = 0.0;
+    double DecodeSeconds = 0.0;
+    std::chrono::high_resolution_clock::time_point RequestTime;
+
+    std::vector<std::function<void(const AssetHandle&)>> OnReady; // Run by Update() on the main thread
+};
+
+// Refcounted reference to an asset. The asset is released when the last handle goes away;
+// assets whose handles are all dropped before they were read are skipped.
+class AssetHandle {
+public:
+    AssetHandle() = default;
+
+    bool IsValid() const { return m_entry != nullptr; }
+    bool IsReady() const { return m_entry && m_entry->State.load(std::memory_order_acquire) == AssetState::Ready; }
+    AssetState GetState() const { return m_entry ? m_entry->State.load(std::memory_order_acquire) : AssetState::Failed; }
+    const std::wstring& GetPath() const;
+
+    // Null until ready or when the payload was handed over to another manager. A hot reload swaps the
+    // payload during AssetManager::Update(): the returned model stays alive (the version it was when
+    // fetched) for as long as the caller keeps the pointer, so fetch it again when GetVersion changes.
+    // The other pointers are only valid until the next Update(). Main thread only, like Update().
+    std::shared_ptr<const Model> GetModel() const { return IsReady() ? m_entry->ModelData : nullptr; }
+    const WaveData* GetWave() const { return IsReady() && !m_entry->Wave.AudioData.empty() ? &m_entry->Wave : nullptr; }
+    const DecodedImage* GetImage() const { return IsReady() && !m_entry->Image.Pixels.empty() ? &m_entry->Image : nullptr; }
+    const AlignedBuffer* GetBytes() const { return IsReady() ? &m_entry->Bytes : nullptr; }
+
+    // Incremented each time a hot reload swaps in new data (GPU buffers etc. need rebuilding)
+    uint32_t GetVersion() const { return m_entry ? m_entry->Version : 0; }
+
+    void Reset() { m_entry.reset(); }
+    long GetRefCount() const { return m_entry ? m_entry.use_count() : 0; }
+
+private:
+    friend class AssetManager;
+    explicit AssetHandle(std::shared_ptr<AssetEntry> entry) : m_entry(std::move(entry)) {}
+    std::shared_ptr<AssetEntry> m_entry;
+};
+
+struct AssetManagerStats {
+    size_t Requested = 0;
+    size_t Completed = 0;
+    size_t Failed = 0;
+    size_t Cancelled = 0;      // All handles dropped before the read started
+    size_t Reloaded = 0;       // Hot reloads swapped in
+    uint64_t BytesRead = 0;
+    double ReadSeconds = 0.0;  // Summed over files (I/O thread)
+    double DecodeSeconds = 0.0; // Summed over decode jobs
+};
+
+// Asynchronous asset loading: one I/O thread reads whole files in large aligned chunks in priority
+// order, decode jobs run on the JobSystem, and Update() (once per frame, never blocks on I/O)
+// publishes finished assets on the main thread.
+class AssetManager {
+public:
+    AssetManager();
+    ~AssetManager();
+
+    // 'jobSystem' null = decode on the I/O thread. Audio / 2D managers are optional; when set,
+    // named waves and images are registered with them on completion.
+    bool Initialize(JobSystem* jobSystem, AudioManager* audioManager = nullptr, D2DRenderer* d2dRenderer = nullptr);
+    void Shutdown();
+
+    // Requests an asset. Loading the same path again returns the existing asset (raising its priority
+    // if higher). 'name' is the key for AudioManager / D2DRenderer, defaults to the file name.
+    AssetHandle Load(const std::wstring& path, AssetType type, float priority = ASSET_PRIORITY_NORMAL, const std::string& name = "");
+    AssetHandle Load(const std::wstring& path, float priority = ASSET_PRIORITY_NORMAL); // Type from extension
+
+    // Changes the read priority of an asset that is still queued
+    void SetPriority(const AssetHandle& handle, float priority);
+
+    // Runs 'callback' on the main thread when the asset is ready or failed (immediately if already done)
+    void OnReady(const AssetHandle& handle, std::function<void(const AssetHandle&)> callback);
+
+    // Re-reads and decodes 'path' in the background if it is loaded; Update() then swaps the new data in
+    // behind the existing handles. On failure the old data stays. Returns false if the path isn't loaded.
+    bool Reload(const std::wstring& path, float priority = ASSET_PRIORITY_HIGH);
+    // Called on the main thread after a reload was swapped in
+    void SetReloadCallback(std::function<void(const AssetHandle&)> callback) { m_reloadCallback = std::move(callback); }
+
+    // Per frame: publishes completed assets. Never waits for I/O or decoding.
+    void Update();
+
+    // True when nothing is queued, reading or decoding
+    bool IsIdle() const;
+    AssetManagerStats GetStats() const;
+
+    static AssetType GetTypeFromExtension(const std::wstring& path);
+    static std::wstring NormalizePath(const std::wstring& path); // Absolute, lexically normal
+    // Priority from the asset's projected screen size; nearer / bigger assets load first
+    static float ComputePriority(const Camera& camera, const DirectX::XMFLOAT3& position, float radius, float viewportHeight);
+
+    // Test mode: loads every file below 'directory' with random priorities and reports throughput
+    static bool RunThroughputTest(const std::wstring& directory, JobSystem* jobSystem);
+
+private:
+    struct QueueItem {
+        float Priority;
+        uint64_t Sequence;
+        std::weak_ptr<AssetEntry> Entry;
+        bool operator<(const QueueItem& other) const {
+            // Highest priority first, FIFO among equal priorities
+            return Priority < other.Priority || (Priority == other.Priority && Sequence > other.Sequence);
+        }
+    };
+
+    JobSystem* m_jobSystem = nullptr;
+    AudioManager* m_audioManager = nullptr;
+    D2DRenderer* m_d2dRenderer = nullptr;
+
+    std::map<std::wstring, std::weak_ptr<AssetEntry>> m_assets; // Main thread only
+    std::vector<std::shared_ptr<AssetEntry>> m_reloads;         // Staging entries in flight (main thread only)
+    uint64_t m_nextReloadSequence = 0;
+    std::function<void(const AssetHandle&)> m_reloadCallback;
+
+    // I/O queue: binary heap (std::push_heap / pop_heap), one item per queued asset.
+    // SetPriority edits items in place and marks the heap dirty; it's rebuilt before the next pop.
+    mutable std::mutex m_queueMutex;
+    std::condition_variable m_queueCondition;
+    std::vector<QueueItem> m_queue;
+    bool m_queueDirty = false;
+    uint64_t m_nextSequence = 0;
+    bool m_shutdown = false;
+    bool m_reading = false; // I/O thread owns an asset (guarded by m_queueMutex)
+    std::thread m_ioThread;
+
+    // Decoded assets waiting for Update()
+    mutable std::mutex m_completedMutex;
+    std::vector<std::shared_ptr<AssetEntry>> m_completed;
+
+    std::atomic<int> m_decoding{ 0 }; // Bounded so the I/O thread can't run far ahead of the workers
+    JobCounter m_decodeCounter;
+    static constexpr int MAX_DECODES_IN_FLIGHT = 16;
+    unsigned int m_updateCount = 0;
+
+    mutable std::mutex m_statsMutex;
+    AssetManagerStats m_stats;
+
+    void IoThreadLoop();
+    static bool ReadFileAligned(const std::wstring& path, AlignedBuffer& outBuffer);
+    void Decode(const std::shared_ptr<AssetEntry>& entry, AlignedBuffer& fileData);
+    bool DecodePayload(const std::shared_ptr<AssetEntry>& entry, AlignedBuffer& fileData);
+    void Complete(const std::shared_ptr<AssetEntry>& entry, bool success);
+    void Publish(const std::shared_ptr<AssetEntry>& entry);
+    void PublishReload(const std::shared_ptr<AssetEntry>& staging);
+    void Enqueue(const std::shared_ptr<AssetEntry>& entry, float priority);
+
+    void LogMessage(const std::string& message);
+};
@@ -4,10 +4,31 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <map>
+#include <memory_resource>
+#include <unordered_map>
 #include <directxmath.h>
+#ifdef _WIN32
+#include <wrl/client.h>
+#include <d3d11.h>
+#endif
+#include "StringId.h"
+#include "ContentHash.h"
+#include "ModelArena.h"
+
+// Model data containers take a memory resource so a cooked model can live in one ModelArena.
+// Default constructed they use the default (heap) resource like std::vector / std::wstring.
+// The structs holding them are allocator aware: nested in an arena backed container, they
+// allocate from the same arena.
+template <typename T>
+using AssetVector = std::pmr::vector<T>;
+using AssetString = std::pmr::wstring;
+using AssetAllocator = std::pmr::polymorphic_allocator<std::byte>;
+template <typename T>
+using AssetIdMap = std::pmr::unordered_map<StringId, T, StringIdHasher>;
 
 // Basic Vertex structure - Customize as needed (e.g., add tangent, bitangent)
 struct Vertex {
@@ -25,30 +46,124 @@ struct DualQuaternion {
 };
 
 struct Material {
-    std::wstring Name;
+    using allocator_type = AssetAllocator;
+
+    AssetString Name; // Source name; empty for cooked models unless the file kept its names
+    StringId NameId;  // What runtime lookups and cooked files use
     DirectX::XMFLOAT4 DiffuseColor = { 1.0f, 1.0f, 1.0f, 1.0f };
     DirectX::XMFLOAT4 SpecularColor = { 1.0f, 1.0f, 1.0f, 1.0f };
     float SpecularPower = 32.0f;
-    std::wstring DiffuseTexturePath;
+    AssetString DiffuseTexturePath;
     // Add paths for normal maps, specular maps etc.
     // ComPtr<ID3D11ShaderResourceView> pDiffuseTextureView; // Loaded texture
+
+    Material() = default;
+    explicit Material(const allocator_type& alloc) : Name(alloc), DiffuseTexturePath(alloc) {}
+    Material(const Material& other, const allocator_type& alloc) : Material(alloc) { *this = other; }
+    Material(Material&& other, const allocator_type& alloc) : Material(alloc) { *this = std::move(other); }
+    Material(const Material&) = default;
+    Material(Material&&) = default;
+    Material& operator=(const Material&) = default;
+    Material& operator=(Material&&) = default;
+};
+
+// Cooked GPU vertex layouts (see VertexQuantization.h)
+enum class VertexFormat : uint8_t {
+    Full = 0,       // 'Vertex' as-is (64 bytes)
+    StaticHalf,     // Half positions (relative to bounds center), octahedral normal, half UVs (16 bytes)
+    StaticUNorm16,  // UNorm16 positions (normalized to bounds), octahedral normal, half UVs (16 bytes)
+    SkinnedHalf,    // StaticHalf + 8-bit bone indices and weights (24 bytes)
+    SkinnedUNorm16, // StaticUNorm16 + 8-bit bone indices and weights (24 bytes)
+};
+
+// Axis aligned box plus bounding sphere (model space), see ModelBounds.h
+struct BoundingVolume {
+    DirectX::XMFLOAT3 Min = { 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT3 Max = { 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT3 Center = { 0.0f, 0.0f, 0.0f }; // Sphere center
+    float Radius = 0.0f;
+    bool IsValid = false; // False until computed (e.g. empty mesh)
 };
 
+// A simplified level of detail. LOD 0 is Mesh::Indices; LODs 1..N live in Mesh::LodIndices.
+struct MeshLod {
+    uint32_t IndexOffset = 0; // Into Mesh::LodIndices
+    uint32_t IndexCount = 0;
+    float Error = 0.0f;       // Max geometric deviation from LOD 0 in model units (projected to pixels at runtime)
+};
+
+// Cluster of at most 64 vertices / 124 triangles for fine-grained culling (see Meshlets.h)
+struct Meshlet {
+    uint32_t VertexOffset = 0;   // Into Mesh::MeshletVertices
+    uint32_t TriangleOffset = 0; // Into Mesh::MeshletTriangles (in triangles, 3 local indices each)
+    uint32_t VertexCount = 0;
+    uint32_t TriangleCount = 0;
+    // Bounding sphere (model space)
+    DirectX::XMFLOAT3 Center = { 0.0f, 0.0f, 0.0f };
+    float Radius = 0.0f;
+    // Backface normal cone: culled when dot(normalize(ConeApex - eye), ConeAxis) >= ConeCutoff
+    DirectX::XMFLOAT3 ConeApex = { 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT3 ConeAxis = { 0.0f, 0.0f, 1.0f };
+    float ConeCutoff = 2.0f; // > 1 disables cone culling
+};
+
+// Geometry is shared and immutable once cooked: scene nodes reference a mesh through a
+// MeshInstance instead of copying it, and content-identical meshes share a ContentHash.
 struct Mesh {
-    std::vector<Vertex> Vertices;
-    std::vector<uint32_t> Indices;
-    std::wstring MaterialName; // Link to a material
-    // D3D Buffers - To be created after loading
+    using allocator_type = AssetAllocator;
+
+    AssetVector<Vertex> Vertices; // CPU-side source data (kept for physics, bounds, skinning etc.)
+    AssetVector<uint32_t> Indices;
+    AssetString MaterialName; // Link to a material
+    StringId MaterialNameId;
+    // Simplified LOD chain (see MeshSimplifier.h). GPU index buffer = Indices followed by LodIndices.
+    AssetVector<MeshLod> Lods;
+    AssetVector<uint32_t> LodIndices;
+    // Meshlets built from LOD 0
+    AssetVector<Meshlet> Meshlets;
+    AssetVector<uint32_t> MeshletVertices; // Mesh vertex index per meshlet vertex
+    AssetVector<uint8_t> MeshletTriangles; // Meshlet-local vertex indices, 3 per triangle
+    BoundingVolume Bounds; // Bind pose bounds of Vertices
+    // Cooked vertex stream, used for the GPU vertex buffer when PackedFormat != Full
+    VertexFormat PackedFormat = VertexFormat::Full;
+    AssetVector<uint8_t> PackedVertices;
+    DirectX::XMFLOAT3 PositionScale = { 1.0f, 1.0f, 1.0f };  // Decoded position = packed * scale + offset
+    DirectX::XMFLOAT3 PositionOffset = { 0.0f, 0.0f, 0.0f };
+    Hash128 ContentHash; // Cooked geometry (everything above except the material), see ModelCooker::ComputeMeshHash
+    // D3D Buffers - To be created after loading (the cooking and parsing tools build without them)
+#ifdef _WIN32
     Microsoft::WRL::ComPtr<ID3D11Buffer> pVertexBuffer;
     Microsoft::WRL::ComPtr<ID3D11Buffer> pIndexBuffer;
-    UINT IndexCount = 0;
-    UINT VertexStride = sizeof(Vertex);
-    UINT VertexOffset = 0;
+#endif
+    uint32_t IndexCount = 0;
+    uint32_t VertexStride = sizeof(Vertex);
+    uint32_t VertexOffset = 0;
+
+    Mesh() = default;
+    explicit Mesh(const allocator_type& alloc)
+        : Vertices(alloc), Indices(alloc), MaterialName(alloc), Lods(alloc), LodIndices(alloc), Meshlets(alloc),
+          MeshletVertices(alloc), MeshletTriangles(alloc), PackedVertices(alloc) {}
+    Mesh(const Mesh& other, const allocator_type& alloc) : Mesh(alloc) { *this = other; }
+    Mesh(Mesh&& other, const allocator_type& alloc) : Mesh(alloc) { *this = std::move(other); }
+    Mesh(const Mesh&) = default;
+    Mesh(Mesh&&) = default;
+    Mesh& operator=(const Mesh&) = default;
+    Mesh& operator=(Mesh&&) = default;
+};
+
+// Placement of a shared Mesh by a scene node (<node> / <instance_geometry>)
+struct MeshInstance {
+    DirectX::XMFLOAT4X4 Transform; // Node to model space (row vectors, like every other matrix here)
+    uint32_t MeshIndex = 0;        // Into Model::Meshes
+    StringId NodeNameId;
 };
 
 // Represents a joint in the skeleton
 struct Joint {
-    std::wstring Name;
+    using allocator_type = AssetAllocator;
+
+    AssetString Name;
+    StringId NameId;
     int ParentIndex = -1; // Index of the parent joint in the skeleton's joint list, -1 for root
     DirectX::XMFLOAT4X4 InverseBindPoseMatrix; // Matrix to transform vertex from model space to joint space
     DirectX::XMFLOAT4X4 LocalBindTransform;    // Transform relative to parent in bind pose
@@ -58,41 +173,121 @@ struct Joint {
     DirectX::XMFLOAT3 Scale = {1,1,1};
     // Or use Dual Quaternions for animation:
     // DualQuaternion AnimationDQ;
+
+    Joint() = default;
+    explicit Joint(const allocator_type& alloc) : Name(alloc) {}
+    Joint(const Joint& other, const allocator_type& alloc) : Joint(alloc) { *this = other; }
+    Joint(Joint&& other, const allocator_type& alloc) : Joint(alloc) { *this = std::move(other); }
+    Joint(const Joint&) = default;
+    Joint(Joint&&) = default;
+    Joint& operator=(const Joint&) = default;
+    Joint& operator=(Joint&&) = default;
 };
 
 struct Skeleton {
-    std::vector<Joint> Joints;
-    std::map<std::wstring, int> JointNameToIndex; // Quick lookup
+    AssetVector<Joint> Joints;
+    AssetIdMap<int> JointNameToIndex; // Quick lookup by Joint::NameId
+
+    Skeleton() = default;
+    explicit Skeleton(const AssetAllocator& alloc) : Joints(alloc), JointNameToIndex(alloc) {}
 };
 
 // Animation keyframes for a single joint/node
 struct AnimationChannel {
-    std::wstring TargetNodeName; // Name of the Joint or Node being animated
-    std::vector<float> PositionTimestamps;
-    std::vector<DirectX::XMFLOAT3> Positions;
-    std::vector<float> RotationTimestamps;
-    std::vector<DirectX::XMFLOAT4> Rotations; // Quaternions
-    std::vector<float> ScaleTimestamps;
-    std::vector<DirectX::XMFLOAT3> Scales;
-    // Add Dual Quaternion keys if using DQ skinning
-    // std::vector<float> DQTimestamps;
-    // std::vector<DualQuaternion> DQs;
+    using allocator_type = AssetAllocator;
+
+    AssetString TargetNodeName; // Name of the Joint or Node being animated
+    StringId TargetNodeId;
+    AssetVector<float> PositionTimestamps;
+    AssetVector<DirectX::XMFLOAT3> Positions;
+    AssetVector<float> RotationTimestamps;
+    AssetVector<DirectX::XMFLOAT4> Rotations; // Quaternions
+    AssetVector<float> ScaleTimestamps;
+    AssetVector<DirectX::XMFLOAT3> Scales;
+    // Rigid joints (cooked, AnimationCompressor::ConvertToDualQuaternionKeys): translation and rotation as
+    // one unit dual quaternion per key; the position and rotation keys are then empty
+    AssetVector<float> DQTimestamps;
+    AssetVector<DualQuaternion> DQs;
+
+    AnimationChannel() = default;
+    explicit AnimationChannel(const allocator_type& alloc)
+        : TargetNodeName(alloc), PositionTimestamps(alloc), Positions(alloc), RotationTimestamps(alloc),
+          Rotations(alloc), ScaleTimestamps(alloc), Scales(alloc), DQTimestamps(alloc), DQs(alloc) {}
+    AnimationChannel(const AnimationChannel& other, const allocator_type& alloc) : AnimationChannel(alloc) { *this = other; }
+    AnimationChannel(AnimationChannel&& other, const allocator_type& alloc) : AnimationChannel(alloc) { *this = std::move(other); }
+    AnimationChannel(const AnimationChannel&) = default;
+    AnimationChannel(AnimationChannel&&) = default;
+    AnimationChannel& operator=(const AnimationChannel&) = default;
+    AnimationChannel& operator=(AnimationChannel&&) = default;
+};
+
+// One track of a compressed clip (see AnimationCompression.h). Keys are [FirstKey, FirstKey + KeyCount)
+// of AnimationClip::KeyTimes, with 3 uint16 values each in AnimationClip::KeyValues.
+struct CompressedTrack {
+    uint32_t FirstKey = 0;
+    uint32_t KeyCount = 0; // 0 = the channel's float keys of this track, bind pose without them
+    DirectX::XMFLOAT3 RangeMin = { 0.0f, 0.0f, 0.0f };    // Positions / scales: value = min + extent * q / 65535
+    DirectX::XMFLOAT3 RangeExtent = { 0.0f, 0.0f, 0.0f }; // Rotations: unused (smallest three)
 };
 
 struct AnimationClip {
-    std::wstring Name;
+    using allocator_type = AssetAllocator;
+
+    AssetString Name;
+    StringId NameId;
     float Duration = 0.0f; // Duration in seconds (or ticks, need consistency)
     float TicksPerSecond = 24.0f; // Default, should be read from file
-    std::vector<AnimationChannel> Channels;
+    AssetVector<AnimationChannel> Channels;
+    BoundingVolume Bounds; // Conservative skinned bounds over the whole clip
+    // Cooked clips: reduced, quantized keys. The channels keep their targets; their key arrays are empty
+    // except for tracks whose quantized keys would miss the compression tolerance.
+    AssetVector<CompressedTrack> CompressedTracks; // Position, rotation, scale per channel
+    AssetVector<uint16_t> KeyTimes;  // Time / Duration * 65535
+    AssetVector<uint16_t> KeyValues; // 3 per key: range reduced position / scale, or smallest-three quaternion
+
+    bool IsCompressed() const { return !CompressedTracks.empty(); }
+
+    AnimationClip() = default;
+    explicit AnimationClip(const allocator_type& alloc)
+        : Name(alloc), Channels(alloc), CompressedTracks(alloc), KeyTimes(alloc), KeyValues(alloc) {}
+    AnimationClip(const AnimationClip& other, const allocator_type& alloc) : AnimationClip(alloc) { *this = other; }
+    AnimationClip(AnimationClip&& other, const allocator_type& alloc) : AnimationClip(alloc) { *this = std::move(other); }
+    AnimationClip(const AnimationClip&) = default;
+    AnimationClip(AnimationClip&&) = default;
+    AnimationClip& operator=(const AnimationClip&) = default;
+    AnimationClip& operator=(AnimationClip&&) = default;
 };
 
 // Represents a loaded model potentially with multiple meshes and a skeleton
 struct Model {
-    std::vector<Mesh> Meshes;
-    std::vector<Material> Materials; // Materials used by meshes in this model
-    std::map<std::wstring, int> MaterialNameToIndex;
+    ModelArenaPtr Arena; // Optional, declared first so it outlives everything allocated from it
+    AssetVector<Mesh> Meshes; // Unique geometry
+    AssetVector<MeshInstance> Instances; // Scene nodes; empty = every mesh once, untransformed
+    AssetVector<Material> Materials; // Materials used by meshes in this model
+    AssetIdMap<int> MaterialNameToIndex; // By Material::NameId
     std::unique_ptr<Skeleton> pSkeleton = nullptr; // Optional skeleton
-    std::vector<AnimationClip> Animations; // Optional animations
-    // Add bounding box, etc.
+    AssetVector<AnimationClip> Animations; // Optional animations
+    BoundingVolume Bounds;         // Union of all mesh bounds (bind pose)
+    BoundingVolume AnimatedBounds; // Bounds + every clip's bounds; use for culling animated instances
+
+    Model() = default;
+    // Containers (and a skeleton created with GetAllocator()) allocate from 'arena'
+    explicit Model(ModelArenaPtr arena)
+        : Arena(std::move(arena)), Meshes(GetAllocator()), Instances(GetAllocator()), Materials(GetAllocator()),
+          MaterialNameToIndex(GetAllocator()), Animations(GetAllocator()) {}
+    Model(Model&&) = default;
+    // Member-wise move assignment would free the old arena before the containers using it, and
+    // containers with different arenas copy instead of stealing. Rebuild in place instead.
+    Model& operator=(Model&& other) noexcept {
+        if (this != &other) {
+            this->~Model();
+            new (this) Model(std::move(other));
+        }
+        return *this;
+    }
+
+    AssetAllocator GetAllocator() const {
+        return AssetAllocator(Arena ? static_cast<std::pmr::memory_resource*>(Arena.get()) : std::pmr::get_default_resource());
+    }
 };
 
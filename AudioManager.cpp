@@ -4,6 +4,11 @@
 
 #include "pch.h"
 #include "AudioManager.h"
+#include "Timing.h"
+#include "VirtualFileSystem.h"
+#include <iomanip>
+#include <random>
+#include <thread>
 
 #pragma pack(push, 1) // Ensure compiler doesn't add padding
 struct RiffChunkHeader {
@@ -30,8 +35,54 @@ struct FmtSubchunk {
 struct DataSubchunkHeader {
      RiffChunkHeader Header; // Contains "data", size of audio data
 };
+
+struct CookedWaveHeader {
+    uint32_t Magic;      // COOKED_WAVE_MAGIC
+    uint32_t Version;    // COOKED_WAVE_VERSION
+    WAVEFORMATEX Format; // cbSize is always 0 (PCM only)
+    uint32_t DataSize;   // PCM bytes following the header
+};
 #pragma pack(pop)
 
+namespace {
+
+bool SameFormat(const AudioFormat& a, const AudioFormat& b) {
+    return a.FormatTag == b.FormatTag && a.Channels == b.Channels && a.SampleRate == b.SampleRate &&
+           a.BitsPerSample == b.BitsPerSample && a.BlockAlign == b.BlockAlign;
+}
+
+// XAudio2 (and the cooked wave header) take the Windows struct
+WAVEFORMATEX ToWaveFormatEx(const AudioFormat& format) {
+    WAVEFORMATEX result = {};
+    result.wFormatTag = format.FormatTag;
+    result.nChannels = format.Channels;
+    result.nSamplesPerSec = format.SampleRate;
+    result.nAvgBytesPerSec = format.ByteRate;
+    result.nBlockAlign = format.BlockAlign;
+    result.wBitsPerSample = format.BitsPerSample;
+    result.cbSize = 0; // PCM only
+    return result;
+}
+
+AudioFormat FromWaveFormatEx(const WAVEFORMATEX& format) {
+    AudioFormat result;
+    result.FormatTag = format.wFormatTag;
+    result.Channels = format.nChannels;
+    result.SampleRate = format.nSamplesPerSec;
+    result.ByteRate = format.nAvgBytesPerSec;
+    result.BlockAlign = format.nBlockAlign;
+    result.BitsPerSample = format.wBitsPerSample;
+    return result;
+}
+
+} // namespace
+
+AudioSettings::AudioSettings() {
+    for (uint32_t sampleRate : { 44100u, 48000u }) {
+        Formats.push_back(MakePcmFormat(1, sampleRate));
+        Formats.push_back(MakePcmFormat(2, sampleRate));
+    }
+}
 
 AudioManager::AudioManager() : m_pMasterVoice(nullptr), m_pMusicVoice(nullptr) {}
 
@@ -39,7 +90,7 @@ AudioManager::~AudioManager() {
     Shutdown();
 }
 
-bool AudioManager::Initialize() {
+bool AudioManager::Initialize(const AudioSettings& settings) {
     HRESULT hr = S_OK;
 
     // Required for XAudio2
@@ -67,6 +118,16 @@ bool AudioManager::Initialize() {
         return false;
     }
 
+    // Every play ends in at most one buffer end per voice between two Updates, plus the flushes of
+    // stolen voices; a full queue only makes Update poll the voices instead
+    m_settings = settings;
+    m_settings.MaxVoices = std::max(m_settings.MaxVoices, 1u);
+    m_finishedVoices.Reset(std::max<size_t>(1024, m_settings.MaxVoices * 16));
+    m_finishedOverflow.store(false);
+    for (const AudioFormat& format : m_settings.Formats) {
+        GetPool(format);
+    }
+
     return true;
 }
 
@@ -80,16 +141,12 @@ void AudioManager::Shutdown() {
         m_pMusicVoice = nullptr;
     }
 
-    // Destroy all active sound effect voices
-    for (auto& voice : m_activeSoundEffects) {
-        if (voice) {
-            voice->DestroyVoice();
-        }
-    }
-    m_activeSoundEffects.clear();
+    // Destroy all pooled sound effect voices
+    DestroyPools();
 
     // Clear loaded data (vectors will clean up themselves)
     m_loadedSounds.clear();
+    m_retiredSounds.clear();
 
     // Destroy mastering voice (implicitly destroyed when engine releases, but good practice)
     if (m_pMasterVoice) {
@@ -180,14 +237,13 @@ bool AudioManager::ParseWaveFile(const BYTE* fileData, size_t fileSize, WaveData
     }
 
     // Copy format information
-    memset(&outWaveData.WaveFormat, 0, sizeof(WAVEFORMATEX));
-    outWaveData.WaveFormat.wFormatTag = fmtChunk->AudioFormat;
-    outWaveData.WaveFormat.nChannels = fmtChunk->NumChannels;
-    outWaveData.WaveFormat.nSamplesPerSec = fmtChunk->SampleRate;
-    outWaveData.WaveFormat.nAvgBytesPerSec = fmtChunk->ByteRate;
-    outWaveData.WaveFormat.nBlockAlign = fmtChunk->BlockAlign;
-    outWaveData.WaveFormat.wBitsPerSample = fmtChunk->BitsPerSample;
-    outWaveData.WaveFormat.cbSize = 0; // No extra format info for PCM
+    outWaveData.WaveFormat = AudioFormat();
+    outWaveData.WaveFormat.FormatTag = fmtChunk->AudioFormat;
+    outWaveData.WaveFormat.Channels = fmtChunk->NumChannels;
+    outWaveData.WaveFormat.SampleRate = fmtChunk->SampleRate;
+    outWaveData.WaveFormat.ByteRate = fmtChunk->ByteRate;
+    outWaveData.WaveFormat.BlockAlign = fmtChunk->BlockAlign;
+    outWaveData.WaveFormat.BitsPerSample = fmtChunk->BitsPerSample;
 
     // Copy audio data
     outWaveData.AudioData.resize(audioDataSize);
@@ -197,129 +253,371 @@ bool AudioManager::ParseWaveFile(const BYTE* fileData, size_t fileSize, WaveData
 }
 
 
-bool AudioManager::LoadWaveFile(const std::wstring& filename, const std::string& soundName) {
-    if (m_loadedSounds.count(soundName)) {
-        // Already loaded
-        return true;
+bool AudioManager::SerializeCookedWave(const WaveData& waveData, std::vector<uint8_t>& outData) {
+    if (waveData.AudioData.empty() || waveData.AudioData.size() > UINT32_MAX) {
+        return false;
     }
 
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        OutputDebugString((L"Failed to open WAV file: " + filename + L"\n").c_str());
+    CookedWaveHeader header = {};
+    header.Magic = COOKED_WAVE_MAGIC;
+    header.Version = COOKED_WAVE_VERSION;
+    header.Format = ToWaveFormatEx(waveData.WaveFormat);
+    header.DataSize = static_cast<uint32_t>(waveData.AudioData.size());
+
+    outData.resize(sizeof(CookedWaveHeader) + waveData.AudioData.size());
+    memcpy(outData.data(), &header, sizeof(header));
+    memcpy(outData.data() + sizeof(header), waveData.AudioData.data(), waveData.AudioData.size());
+    return true;
+}
+
+bool AudioManager::ParseCookedWave(const BYTE* fileData, size_t fileSize, WaveData& outWaveData) {
+    if (!fileData || fileSize < sizeof(CookedWaveHeader)) {
+        return false;
+    }
+
+    CookedWaveHeader header;
+    memcpy(&header, fileData, sizeof(header));
+    if (header.Magic != COOKED_WAVE_MAGIC || header.Version != COOKED_WAVE_VERSION) {
         return false;
     }
+    if (header.DataSize == 0 || header.DataSize > fileSize - sizeof(CookedWaveHeader)) {
+        OutputDebugString(L"Cooked wave data size mismatch or corrupted file.\n");
+        return false;
+    }
+
+    outWaveData.WaveFormat = FromWaveFormatEx(header.Format);
+    outWaveData.AudioData.assign(fileData + sizeof(CookedWaveHeader), fileData + sizeof(CookedWaveHeader) + header.DataSize);
+    return true;
+}
+
+bool AudioManager::DecodeWave(const BYTE* fileData, size_t fileSize, WaveData& outWaveData) {
+    return ParseCookedWave(fileData, fileSize, outWaveData) || ParseWaveFile(fileData, fileSize, outWaveData);
+}
+
+void AudioManager::AddWaveData(StringId soundId, WaveData&& waveData) {
+    auto it = m_loadedSounds.find(soundId);
+    if (it != m_loadedSounds.end()) {
+        // Voices may still be playing from the old buffer, keep it alive until Update sees them end
+        m_retiredSounds.push_back(std::move(it->second));
+        it->second = std::move(waveData);
+        return;
+    }
+    GetPool(waveData.WaveFormat);
+    m_loadedSounds[soundId] = std::move(waveData);
+}
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
 
-    std::vector<char> buffer(static_cast<size_t>(size));
-    if (!file.read(buffer.data(), size)) {
-        OutputDebugString((L"Failed to read WAV file: " + filename + L"\n").c_str());
+bool AudioManager::LoadWaveFile(const std::wstring& filename, const std::string& soundName) {
+    StringId soundId = StringId::Intern(soundName);
+    if (m_loadedSounds.count(soundId)) {
+        // Already loaded
+        return true;
+    }
+
+    // Packed sounds decode straight from the pack mapping
+    FileView file;
+    if (!VirtualFileSystem::Get().ReadFile(filename, file)) {
+        OutputDebugString((L"Failed to open WAV file: " + filename + L"\n").c_str());
         return false;
     }
-    file.close();
 
     WaveData waveData;
-    if (!ParseWaveFile(reinterpret_cast<const BYTE*>(buffer.data()), buffer.size(), waveData)) {
+    if (!DecodeWave(file.Data(), file.Size(), waveData)) {
         OutputDebugString((L"Failed to parse WAV file: " + filename + L"\n").c_str());
         return false;
     }
 
-    m_loadedSounds[soundName] = std::move(waveData);
+    GetPool(waveData.WaveFormat); // Voices for the format now rather than at the first play
+    m_loadedSounds[soundId] = std::move(waveData);
     return true;
 }
 
-IXAudio2SourceVoice* AudioManager::PlaySoundEffect(const std::string& soundName, float volume, float pitch, bool loop) {
-    auto it = m_loadedSounds.find(soundName);
-    if (it == m_loadedSounds.end()) {
-        OutputDebugStringA(("Sound not loaded: " + soundName + "\n").c_str());
-        return nullptr;
+uint32_t AudioManager::FindPool(const AudioFormat& format) const {
+    for (size_t i = 0; i < m_pools.size(); ++i) {
+        if (SameFormat(m_pools[i].Format, format)) {
+            return static_cast<uint32_t>(i);
+        }
     }
+    return UINT32_MAX;
+}
 
-    const WaveData& waveData = it->second;
+uint32_t AudioManager::GetPool(const AudioFormat& format) {
+    uint32_t pool = FindPool(format);
+    if (pool != UINT32_MAX || !m_pXAudio2) {
+        return pool;
+    }
+
+    pool = static_cast<uint32_t>(m_pools.size());
+    m_pools.emplace_back();
+    m_pools.back().Format = format;
+    m_pools.back().Free.reserve(m_settings.VoicesPerFormat);
+    const WAVEFORMATEX voiceFormat = ToWaveFormatEx(format);
+    for (uint32_t i = 0; i < m_settings.VoicesPerFormat; ++i) {
+        const uint32_t index = static_cast<uint32_t>(m_voices.size());
+        PooledVoice voice;
+        voice.Callback = std::make_unique<VoiceCallback>(this, index);
+        voice.Pool = pool;
+        HRESULT hr = m_pXAudio2->CreateSourceVoice(&voice.Voice, &voiceFormat, 0, XAUDIO2_DEFAULT_FREQ_RATIO, voice.Callback.get());
+        if (FAILED(hr) || !voice.Voice) {
+            break;
+        }
+        m_voices.push_back(std::move(voice));
+        m_pools.back().Free.push_back(index);
+    }
+
+    const size_t created = m_pools.back().Free.size();
+    if (created == 0) {
+        OutputDebugStringA(("Failed to create source voices for a " + std::to_string(format.Channels) + " channel " +
+                            std::to_string(format.SampleRate) + " Hz format\n").c_str());
+        m_pools.pop_back();
+        return UINT32_MAX;
+    }
+    m_activeVoices.reserve(m_voices.size());
+    m_stats.PooledVoices += created;
+    return pool;
+}
+
+void AudioManager::DestroyPools() {
+    // DestroyVoice waits for the voice's callbacks, so nothing pushes to the queue afterwards
+    for (PooledVoice& voice : m_voices) {
+        voice.Voice->DestroyVoice();
+    }
+    m_voices.clear();
+    m_pools.clear();
+    m_activeVoices.clear();
+    FinishedVoice finished;
+    while (m_finishedVoices.TryPop(finished)) {}
+    m_finishedOverflow.store(false);
+    m_stats.ActiveVoices = 0;
+}
+
+void STDMETHODCALLTYPE AudioManager::VoiceCallback::OnBufferEnd(void* context) {
+    FinishedVoice finished;
+    finished.Voice = m_voice;
+    finished.Generation = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(context));
+    if (!m_owner->m_finishedVoices.TryPush(finished)) {
+        m_owner->m_finishedOverflow.store(true, std::memory_order_release);
+    }
+}
+
+void AudioManager::Update() {
+    // Buffer ends of earlier plays (a stolen voice's flush, say) carry an old generation and are skipped
+    FinishedVoice finished;
+    while (m_finishedVoices.TryPop(finished)) {
+        if (finished.Voice >= m_voices.size()) {
+            continue;
+        }
+        // Buffer ends arrive in submission order, so this one also ends every older buffer
+        PooledVoice& voice = m_voices[finished.Voice];
+        uint32_t ended = 0;
+        while (ended < voice.QueuedCount && static_cast<int32_t>(voice.GetQueued(ended).Generation - finished.Generation) <= 0) {
+            ++ended;
+        }
+        voice.PopQueued(ended);
+        if (voice.Playing && voice.Generation == finished.Generation) {
+            ReleaseVoice(finished.Voice, false);
+            ++m_stats.Reclaimed;
+        }
+    }
+
+    if (m_finishedOverflow.exchange(false, std::memory_order_acquire)) {
+        // Some buffer ends were dropped: ask the voices still holding buffers
+        for (uint32_t index = 0; index < m_voices.size(); ++index) {
+            PooledVoice& voice = m_voices[index];
+            if (!voice.Playing && voice.QueuedCount == 0) {
+                continue;
+            }
+            XAUDIO2_VOICE_STATE state;
+            voice.Voice->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED);
+            if (state.BuffersQueued == 0) {
+                voice.PopQueued(voice.QueuedCount);
+                if (voice.Playing) {
+                    ReleaseVoice(index, false);
+                    ++m_stats.Reclaimed;
+                }
+            }
+        }
+    }
+
+    if (!m_retiredSounds.empty()) {
+        FreeRetiredSounds();
+    }
+}
+
+void AudioManager::FreeRetiredSounds() {
+    auto queued = [this](const WaveData& sound) {
+        const BYTE* data = sound.AudioData.data();
+        if (data == m_musicBuffer) {
+            return true;
+        }
+        for (const PooledVoice& voice : m_voices) {
+            for (uint32_t i = 0; i < voice.QueuedCount; ++i) {
+                if (voice.GetQueued(i).Data == data) return true;
+            }
+        }
+        return false;
+    };
+    m_retiredSounds.erase(std::remove_if(m_retiredSounds.begin(), m_retiredSounds.end(),
+                                         [&queued](const WaveData& sound) { return !queued(sound); }),
+                          m_retiredSounds.end());
+}
 
-    IXAudio2SourceVoice* pSourceVoice = nullptr;
-    HRESULT hr = m_pXAudio2->CreateSourceVoice(&pSourceVoice, &(waveData.WaveFormat));
-    if (FAILED(hr) || !pSourceVoice) {
-        OutputDebugStringA(("Failed to create source voice for: " + soundName + "\n").c_str());
-        return nullptr;
+uint32_t AudioManager::FindVictim(uint32_t pool, uint8_t priority) const {
+    uint32_t victim = UINT32_MAX;
+    for (uint32_t index : m_activeVoices) {
+        const PooledVoice& voice = m_voices[index];
+        if ((pool != UINT32_MAX && voice.Pool != pool) || voice.Priority > priority) {
+            continue;
+        }
+        if (victim == UINT32_MAX || voice.Priority < m_voices[victim].Priority ||
+            (voice.Priority == m_voices[victim].Priority && voice.StartSequence < m_voices[victim].StartSequence)) {
+            victim = index;
+        }
+    }
+    return victim;
+}
+
+void AudioManager::ReleaseVoice(uint32_t index, bool stop) {
+    PooledVoice& voice = m_voices[index];
+    if (stop) {
+        voice.Voice->Stop(0);
+        voice.Voice->FlushSourceBuffers();
     }
+    const uint32_t last = m_activeVoices.back();
+    m_activeVoices[voice.ActiveIndex] = last;
+    m_voices[last].ActiveIndex = voice.ActiveIndex;
+    m_activeVoices.pop_back();
+    voice.Playing = false;
+    m_pools[voice.Pool].Free.push_back(index);
+    m_stats.ActiveVoices = m_activeVoices.size();
+}
 
+HRESULT AudioManager::SubmitAndStart(IXAudio2SourceVoice* voice, const WaveData& waveData, float volume, float pitch, bool loop, void* context) {
     XAUDIO2_BUFFER buffer = {0};
     buffer.AudioBytes = static_cast<UINT32>(waveData.AudioData.size());
     buffer.pAudioData = waveData.AudioData.data();
     buffer.Flags = XAUDIO2_END_OF_STREAM; // Tell the source voice not to expect any data after this buffer
+    buffer.pContext = context;
     if (loop) {
         buffer.LoopCount = XAUDIO2_LOOP_INFINITE;
     }
 
-    hr = pSourceVoice->SubmitSourceBuffer(&buffer);
-    if (FAILED(hr)) {
-        OutputDebugStringA(("Failed to submit source buffer for: " + soundName + "\n").c_str());
-        pSourceVoice->DestroyVoice(); // Clean up created voice
-        return nullptr;
+    voice->SetVolume(volume);
+    voice->SetFrequencyRatio(pitch);
+    HRESULT hr = voice->SubmitSourceBuffer(&buffer);
+    if (SUCCEEDED(hr)) {
+        hr = voice->Start(0);
     }
+    return hr;
+}
 
-    hr = pSourceVoice->SetVolume(volume);
-    // Ignore volume failure?
+SoundHandle AudioManager::PlaySoundEffect(StringId soundId, float volume, float pitch, bool loop, uint8_t priority) {
+    auto it = m_loadedSounds.find(soundId);
+    if (it == m_loadedSounds.end()) {
+        OutputDebugStringA(("Sound not loaded: " + soundId.ToString() + "\n").c_str());
+        return SoundHandle();
+    }
 
-    hr = pSourceVoice->SetFrequencyRatio(pitch);
-    // Ignore pitch failure?
+    const WaveData& waveData = it->second;
+    const uint32_t pool = FindPool(waveData.WaveFormat);
+    if (pool == UINT32_MAX) {
+        OutputDebugStringA(("No source voices for the format of: " + soundId.ToString() + "\n").c_str());
+        return SoundHandle();
+    }
 
-    hr = pSourceVoice->Start(0);
-    if (FAILED(hr)) {
-         OutputDebugStringA(("Failed to start source voice for: " + soundName + "\n").c_str());
-         pSourceVoice->DestroyVoice();
-         return nullptr;
+    // Over the voice limit any voice may make room; with the pool empty only one of its own can
+    VoicePool& voicePool = m_pools[pool];
+    if (m_activeVoices.size() >= m_settings.MaxVoices || voicePool.Free.empty()) {
+        const uint32_t victim = FindVictim(voicePool.Free.empty() ? pool : UINT32_MAX, priority);
+        if (victim == UINT32_MAX) {
+            ++m_stats.Rejected;
+            return SoundHandle();
+        }
+        ReleaseVoice(victim, true);
+        ++m_stats.Steals;
     }
+    const uint32_t index = voicePool.Free.back();
+    PooledVoice& voice = m_voices[index];
+    if (voice.IsQueueFull()) {
+        // Flushed plays whose buffer ends haven't arrived yet; XAudio2 would refuse the buffer too
+        ++m_stats.Rejected;
+        return SoundHandle();
+    }
+    voicePool.Free.pop_back();
 
-    // Add to active list (consider removing finished voices periodically)
-    m_activeSoundEffects.push_back(pSourceVoice);
+    ++voice.Generation;
+    // Recorded even if the submit fails; the voice's next buffer end clears it
+    voice.PushQueued({ voice.Generation, waveData.AudioData.data() });
+    HRESULT hr = SubmitAndStart(voice.Voice, waveData, volume, pitch, loop, reinterpret_cast<void*>(static_cast<uintptr_t>(voice.Generation)));
+    if (FAILED(hr)) {
+        OutputDebugStringA(("Failed to start source voice for: " + soundId.ToString() + "\n").c_str());
+        voice.Voice->Stop(0);
+        voice.Voice->FlushSourceBuffers();
+        voicePool.Free.push_back(index);
+        return SoundHandle();
+    }
 
-    return pSourceVoice;
+    voice.Playing = true;
+    voice.Priority = priority;
+    voice.StartSequence = ++m_playSequence;
+    voice.ActiveIndex = static_cast<uint32_t>(m_activeVoices.size());
+    m_activeVoices.push_back(index);
+    ++m_stats.Plays;
+    m_stats.ActiveVoices = m_activeVoices.size();
+    m_stats.PeakActiveVoices = std::max(m_stats.PeakActiveVoices, m_stats.ActiveVoices);
+
+    SoundHandle handle;
+    handle.Voice = index;
+    handle.Generation = voice.Generation;
+    return handle;
 }
 
-void AudioManager::StopSoundEffect(IXAudio2SourceVoice*& pSourceVoice) {
-     if (!pSourceVoice) return;
-
-     pSourceVoice->Stop();
-     pSourceVoice->FlushSourceBuffers(); // Clear submitted buffers
-     pSourceVoice->DestroyVoice();       // Release the voice object
-     pSourceVoice = nullptr;             // Null out the caller's pointer
+bool AudioManager::IsPlaying(const SoundHandle& handle) const {
+    return handle.Voice < m_voices.size() && m_voices[handle.Voice].Playing && m_voices[handle.Voice].Generation == handle.Generation;
+}
 
-     // Remove from active list (can be inefficient with vector, consider list or map if many voices)
-     m_activeSoundEffects.erase(std::remove(m_activeSoundEffects.begin(), m_activeSoundEffects.end(), nullptr), m_activeSoundEffects.end());
-     // This cleanup assumes the pointer passed in was previously in the vector, which might not be true
-     // A safer approach is to find the pointer in the vector and remove it specifically
-     auto it = std::find(m_activeSoundEffects.begin(), m_activeSoundEffects.end(), pSourceVoice); // Find the pointer before destroying
-     if (it != m_activeSoundEffects.end()) {
-         (*it)->Stop();
-         (*it)->FlushSourceBuffers();
-         (*it)->DestroyVoice();
-         m_activeSoundEffects.erase(it);
-     }
-     pSourceVoice = nullptr; // Null out caller's pointer regardless
+void AudioManager::StopSoundEffect(SoundHandle& handle) {
+    if (IsPlaying(handle)) {
+        ReleaseVoice(handle.Voice, true);
+    }
+    handle = SoundHandle(); // Invalidate the caller's handle regardless
 }
 
-void AudioManager::PlayMusic(const std::string& soundName, float volume) {
+void AudioManager::PlayMusic(StringId soundId, float volume) {
     StopMusic(); // Stop previous music if any
 
-    m_pMusicVoice = PlaySoundEffect(soundName, volume, 1.0f, true); // Loop music
-    if (m_pMusicVoice) {
-        m_currentMusicName = soundName;
-    } else {
-        m_currentMusicName.clear();
+    // Music keeps a voice of its own, outside the sound effect pools and their stealing
+    auto it = m_loadedSounds.find(soundId);
+    if (it == m_loadedSounds.end() || !m_pXAudio2) {
+        OutputDebugStringA(("Music not loaded: " + soundId.ToString() + "\n").c_str());
+        return;
+    }
+    const WAVEFORMATEX musicFormat = ToWaveFormatEx(it->second.WaveFormat);
+    HRESULT hr = m_pXAudio2->CreateSourceVoice(&m_pMusicVoice, &musicFormat);
+    if (FAILED(hr) || !m_pMusicVoice) {
+        OutputDebugStringA(("Failed to create music voice for: " + soundId.ToString() + "\n").c_str());
+        m_pMusicVoice = nullptr;
+        return;
+    }
+    hr = SubmitAndStart(m_pMusicVoice, it->second, volume, 1.0f, true, nullptr); // Loop music
+    if (FAILED(hr)) {
+        OutputDebugStringA(("Failed to start music: " + soundId.ToString() + "\n").c_str());
+        m_pMusicVoice->DestroyVoice();
+        m_pMusicVoice = nullptr;
+        return;
     }
+    m_currentMusicId = soundId;
+    m_musicBuffer = it->second.AudioData.data();
 }
 
 void AudioManager::StopMusic() {
     if (m_pMusicVoice) {
-        // We don't use StopSoundEffect here because music voice is managed separately
         m_pMusicVoice->Stop();
         m_pMusicVoice->FlushSourceBuffers();
-        m_pMusicVoice->DestroyVoice();
+        m_pMusicVoice->DestroyVoice(); // Releases its buffer
         m_pMusicVoice = nullptr;
-        m_currentMusicName.clear();
+        m_currentMusicId = StringId();
+        m_musicBuffer = nullptr;
     }
 }
 
@@ -346,3 +644,121 @@ void AudioManager::Resume() {
         m_pXAudio2->StartEngine();
     }
 }
+
+bool AudioManager::RunStressTest(size_t playsPerSecond, float seconds) {
+    playsPerSecond = std::max<size_t>(playsPerSecond, 1);
+    const size_t playCount = std::max<size_t>(static_cast<size_t>(playsPerSecond * std::max(seconds, 0.0f)), 1);
+
+    AudioManager audio;
+    if (!audio.Initialize()) {
+        std::cerr << "Audio stress test: XAudio2 initialization failed." << std::endl;
+        return false;
+    }
+    audio.SetMasterVolume(0.0f); // Silent; the voices still run and end on time
+
+    // Decaying tones of 50 to 400 ms: two formats pooled at Initialize, one pooled when loaded
+    const AudioFormat formats[] = { MakePcmFormat(1, 44100), MakePcmFormat(2, 48000), MakePcmFormat(1, 22050) };
+    const float durations[] = { 0.05f, 0.1f, 0.2f, 0.4f };
+    std::vector<StringId> sounds;
+    for (size_t f = 0; f < 3; ++f) {
+        for (size_t d = 0; d < 4; ++d) {
+            WaveData wave;
+            wave.WaveFormat = formats[f];
+            const size_t frames = static_cast<size_t>(durations[d] * formats[f].SampleRate);
+            std::vector<int16_t> samples(frames * formats[f].Channels);
+            for (size_t i = 0; i < frames; ++i) {
+                float t = static_cast<float>(i) / formats[f].SampleRate;
+                float value = std::sin(6.2831853f * (220.0f + 110.0f * d) * t) * (1.0f - static_cast<float>(i) / frames);
+                for (size_t c = 0; c < formats[f].Channels; ++c) {
+                    samples[i * formats[f].Channels + c] = static_cast<int16_t>(value * 16000.0f);
+                }
+            }
+            wave.AudioData.resize(samples.size() * sizeof(int16_t));
+            memcpy(wave.AudioData.data(), samples.data(), wave.AudioData.size());
+            sounds.push_back(StringId::Intern("stress_" + std::to_string(f) + "_" + std::to_string(d)));
+            audio.AddWaveData(sounds.back(), std::move(wave));
+        }
+    }
+    const size_t pooledVoices = audio.m_stats.PooledVoices;
+
+    // The previous path: a new voice for every play
+    const size_t baselineCount = std::min<size_t>(playCount, 256);
+    std::vector<IXAudio2SourceVoice*> created;
+    created.reserve(baselineCount);
+    double createSeconds = 0.0;
+    for (size_t i = 0; i < baselineCount; ++i) {
+        const WaveData& wave = audio.m_loadedSounds.find(sounds[i % sounds.size()])->second;
+        const WAVEFORMATEX format = ToWaveFormatEx(wave.WaveFormat);
+        auto start = std::chrono::high_resolution_clock::now();
+        IXAudio2SourceVoice* voice = nullptr;
+        if (SUCCEEDED(audio.m_pXAudio2->CreateSourceVoice(&voice, &format)) && voice) {
+            SubmitAndStart(voice, wave, 1.0f, 1.0f, false, nullptr);
+            created.push_back(voice);
+        }
+        createSeconds += SecondsSince(start);
+    }
+    for (IXAudio2SourceVoice* voice : created) {
+        voice->DestroyVoice();
+    }
+
+    // Plays on schedule, Update at 60 Hz
+    const uint8_t priorities[] = { SOUND_PRIORITY_LOW, SOUND_PRIORITY_NORMAL, SOUND_PRIORITY_HIGH };
+    std::mt19937 random(49);
+    std::uniform_real_distribution<float> pitch(0.8f, 1.2f);
+    const double frameTime = 1.0 / 60.0;
+    double playSeconds = 0.0, maxPlaySeconds = 0.0, nextFrame = 0.0;
+    size_t fired = 0, frames = 0;
+    const auto begin = std::chrono::high_resolution_clock::now();
+    while (fired < playCount) {
+        const double now = SecondsSince(begin);
+        while (fired < playCount && static_cast<double>(fired) / playsPerSecond <= now) {
+            StringId sound = sounds[std::uniform_int_distribution<size_t>(0, sounds.size() - 1)(random)];
+            uint8_t priority = priorities[std::uniform_int_distribution<size_t>(0, 2)(random)];
+            float ratio = pitch(random);
+            auto start = std::chrono::high_resolution_clock::now();
+            audio.PlaySoundEffect(sound, 1.0f, ratio, false, priority);
+            double elapsed = SecondsSince(start);
+            playSeconds += elapsed;
+            maxPlaySeconds = std::max(maxPlaySeconds, elapsed);
+            ++fired;
+        }
+        if (now >= nextFrame) {
+            audio.Update();
+            ++frames;
+            nextFrame += frameTime;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+
+    // Let the last sounds end (the longest at the lowest pitch) and reclaim them
+    const auto drainStart = std::chrono::high_resolution_clock::now();
+    while (audio.m_stats.ActiveVoices > 0 && SecondsSince(drainStart) < durations[3] / 0.8f + 1.0f) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        audio.Update();
+    }
+
+    const AudioStats& stats = audio.GetStats();
+    size_t freeVoices = 0;
+    for (const VoicePool& pool : audio.m_pools) {
+        freeVoices += pool.Free.size();
+    }
+    const bool ok = stats.PooledVoices == pooledVoices && stats.ActiveVoices == 0 && freeVoices == audio.m_voices.size() &&
+                    stats.PeakActiveVoices <= audio.m_settings.MaxVoices && stats.Plays + stats.Rejected == fired &&
+                    stats.Plays > 0 && stats.Reclaimed > 0;
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    report << "Audio stress test: " << fired << " plays at " << playsPerSecond << "/s, " << frames << " updates, "
+           << audio.m_pools.size() << " voice pools, " << stats.PooledVoices << " pooled voices, limit " << audio.m_settings.MaxVoices << "\n"
+           << std::setprecision(2)
+           << "  Play: " << playSeconds * 1e6 / fired << " us average, " << maxPlaySeconds * 1e6 << " us worst (voice per play: "
+           << createSeconds * 1e6 / std::max<size_t>(created.size(), 1) << " us average)\n"
+           << "  Steals " << stats.Steals << ", rejected " << stats.Rejected << ", reclaimed " << stats.Reclaimed
+           << ", peak active " << stats.PeakActiveVoices << "\n";
+    if (!ok) {
+        report << "  FAILED: voices created while playing, not reclaimed, or over the limit\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
@@ -5,37 +5,79 @@
 #pragma once
 
 #include "pch.h"
-#include <map>
+#include "AudioTypes.h"
+#include "SpscQueue.h"
+#include "StringId.h"
+#include <array>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
-// Structure to hold loaded wave data
-struct WaveData {
-    WAVEFORMATEX WaveFormat;
-    std::vector<BYTE> AudioData;
+constexpr uint32_t COOKED_WAVE_MAGIC = 0x57574741; // "AGWW"
+constexpr uint32_t COOKED_WAVE_VERSION = 1;
+
+constexpr uint8_t SOUND_PRIORITY_LOW = 64;
+constexpr uint8_t SOUND_PRIORITY_NORMAL = 128;
+constexpr uint8_t SOUND_PRIORITY_HIGH = 192;
+
+struct AudioSettings {
+    uint32_t VoicesPerFormat = 32; // Source voices created up front for each pooled format
+    uint32_t MaxVoices = 64;       // Sound effects playing at once over all pools; beyond it a voice is stolen
+    // Formats pooled at Initialize (16 bit PCM, mono and stereo, 44.1 and 48 kHz by default). A sound
+    // loaded in another format gets its pool when it is loaded, never when it is played.
+    std::vector<AudioFormat> Formats;
+
+    AudioSettings();
 };
 
+struct AudioStats {
+    size_t Plays = 0;
+    size_t Steals = 0;          // Playing voices cut off for a sound of the same or higher priority
+    size_t Rejected = 0;        // Plays dropped: every candidate voice had a higher priority, or its buffer queue was full
+    size_t Reclaimed = 0;       // Finished voices returned to their pool by Update
+    size_t PooledVoices = 0;    // Source voices created (at Initialize and when new formats load)
+    size_t ActiveVoices = 0;
+    size_t PeakActiveVoices = 0;
+};
+
+// XAudio2 playback. Sound effects play on source voices pooled per wave format and created up front,
+// so firing a sound is a pool pop, a buffer submit and a start: no voice creation, no allocation.
+// A voice's buffer end callback (XAudio2 thread) pushes it to a lock-free queue; Update (main
+// thread) returns the finished voices to their pools. When MaxVoices sounds play, or the sound's
+// pool is empty, the lowest priority (then oldest) voice of the same or lower priority is stolen.
 class AudioManager {
 public:
     AudioManager();
     ~AudioManager();
 
-    bool Initialize();
+    bool Initialize(const AudioSettings& settings = AudioSettings());
     void Shutdown();
 
-    // Load a WAV file (basic RIFF/WAV parsing without external libs)
-    // Returns true on success, false on failure
+    // Returns finished sound effect voices to their pools; call once per frame
+    void Update();
+
+    // Load a WAV file (basic RIFF/WAV parsing without external libs) or a cooked wave (.agw)
+    // Returns true on success, false on failure. 'soundName' is interned; play it by StringId.
     bool LoadWaveFile(const std::wstring& filename, const std::string& soundName);
 
-    // Play a loaded sound effect
-    // Returns the source voice used, or nullptr on failure
-    IXAudio2SourceVoice* PlaySoundEffect(const std::string& soundName, float volume = 1.0f, float pitch = 1.0f, bool loop = false);
+    // Registers wave data decoded elsewhere (e.g. by the AssetManager on a worker thread).
+    // Replaces any sound already loaded under 'soundId'.
+    void AddWaveData(StringId soundId, WaveData&& waveData);
+
+    // Play a loaded sound effect on a pooled voice. 'pitch' is a frequency ratio up to 2.
+    // Returns an invalid handle on failure or when no voice could be stolen. Literal names ("shoot")
+    // hash at compile time.
+    SoundHandle PlaySoundEffect(StringId soundId, float volume = 1.0f, float pitch = 1.0f, bool loop = false,
+                                uint8_t priority = SOUND_PRIORITY_NORMAL);
 
-    // Stop a specific sound effect instance (requires the pointer returned by PlaySoundEffect)
-    void StopSoundEffect(IXAudio2SourceVoice*& pSourceVoice); // Pass by ref to null it out
+    // Stop a specific sound effect instance; stale handles are ignored
+    void StopSoundEffect(SoundHandle& handle); // Pass by ref to invalidate it
+    // True until the sound is stopped, stolen, or has ended and been reclaimed by Update
+    bool IsPlaying(const SoundHandle& handle) const;
 
     // Functions for background music (can reuse PlaySoundEffect with looping, or add dedicated streaming)
-    void PlayMusic(const std::string& soundName, float volume = 0.7f);
+    void PlayMusic(StringId soundId, float volume = 0.7f);
     void StopMusic();
     void SetMusicVolume(float volume);
 
@@ -46,23 +88,109 @@ public:
     void Suspend();
     void Resume();
 
+    // Basic WAV file parser (static so the offline cooker can use it without an audio engine)
+    static bool ParseWaveFile(const BYTE* fileData, size_t fileSize, WaveData& outWaveData);
+
+    // Cooked wave: small header, WAVEFORMATEX and the PCM data, no chunk walking at load time
+    static bool SerializeCookedWave(const WaveData& waveData, std::vector<uint8_t>& outData);
+    static bool ParseCookedWave(const BYTE* fileData, size_t fileSize, WaveData& outWaveData);
+    // Cooked wave or RIFF WAV, whichever 'fileData' contains
+    static bool DecodeWave(const BYTE* fileData, size_t fileSize, WaveData& outWaveData);
+
+    const AudioStats& GetStats() const { return m_stats; }
+
+    // Fires 'playsPerSecond' short synthetic sounds in three formats with random priorities for
+    // 'seconds' on a real engine, updating at 60 Hz (WinMain "-audiostress"). Reports the cost of a
+    // play against creating a voice per play, steals and reclaims, and checks that no voice was
+    // created after Initialize and every voice is back in its pool at the end.
+    static bool RunStressTest(size_t playsPerSecond = 1000, float seconds = 5.0f);
+
 private:
+    // Pushes its voice's index and play generation to the finished queue when the buffer ends
+    class VoiceCallback : public IXAudio2VoiceCallback {
+    public:
+        VoiceCallback(AudioManager* owner, uint32_t voice) : m_owner(owner), m_voice(voice) {}
+        void STDMETHODCALLTYPE OnVoiceProcessingPassStart(UINT32) override {}
+        void STDMETHODCALLTYPE OnVoiceProcessingPassEnd() override {}
+        void STDMETHODCALLTYPE OnStreamEnd() override {}
+        void STDMETHODCALLTYPE OnBufferStart(void*) override {}
+        void STDMETHODCALLTYPE OnBufferEnd(void* context) override;
+        void STDMETHODCALLTYPE OnLoopEnd(void*) override {}
+        void STDMETHODCALLTYPE OnVoiceError(void*, HRESULT) override {}
+
+    private:
+        AudioManager* m_owner;
+        uint32_t m_voice;
+    };
+    // A buffer submitted to a voice; XAudio2 reads it until its buffer end, which for a stopped or
+    // stolen play comes after the flush, possibly when the voice is already playing something else
+    struct QueuedBuffer {
+        uint32_t Generation = 0;
+        const BYTE* Data = nullptr;
+    };
+    struct PooledVoice {
+        IXAudio2SourceVoice* Voice = nullptr;
+        std::unique_ptr<VoiceCallback> Callback;
+        uint32_t Pool = 0;
+        uint32_t Generation = 0;    // Bumped by every play; buffer contexts carry it
+        uint32_t ActiveIndex = 0;   // In m_activeVoices while playing
+        uint64_t StartSequence = 0; // Play order, for stealing the oldest
+        uint8_t Priority = 0;
+        bool Playing = false;
+        // Ring of the buffers XAudio2 still reads, oldest first; buffer ends retire them in order. Sized to
+        // the most a voice can queue, so plays never allocate.
+        std::array<QueuedBuffer, XAUDIO2_MAX_QUEUED_BUFFERS> Queued;
+        uint32_t QueuedFirst = 0;
+        uint32_t QueuedCount = 0;
+
+        const QueuedBuffer& GetQueued(uint32_t i) const { return Queued[(QueuedFirst + i) % Queued.size()]; }
+        bool IsQueueFull() const { return QueuedCount == Queued.size(); }
+        void PushQueued(const QueuedBuffer& buffer) { Queued[(QueuedFirst + QueuedCount++) % Queued.size()] = buffer; }
+        void PopQueued(uint32_t count) {
+            QueuedFirst = (QueuedFirst + count) % Queued.size();
+            QueuedCount -= count;
+        }
+    };
+    struct VoicePool {
+        AudioFormat Format;
+        std::vector<uint32_t> Free; // Reserved for every voice of the pool
+    };
+    struct FinishedVoice {
+        uint32_t Voice = 0;
+        uint32_t Generation = 0;
+    };
+
+    AudioSettings m_settings;
     Microsoft::WRL::ComPtr<IXAudio2> m_pXAudio2;
     IXAudio2MasteringVoice* m_pMasterVoice = nullptr; // Not a ComPtr, managed by XAudio2 engine lifetime
 
     // Store loaded wave data
-    std::map<std::string, WaveData> m_loadedSounds;
-
-    // Store active sound effect voices (could manage pooling later)
-    std::vector<IXAudio2SourceVoice*> m_activeSoundEffects;
+    StringIdMap<WaveData> m_loadedSounds;
+    std::vector<WaveData> m_retiredSounds; // Replaced sounds still queued on a voice; Update frees the rest
+
+    // Pooled sound effect voices; indices are stable, pools only grow at Initialize and load time
+    std::vector<PooledVoice> m_voices;
+    std::vector<VoicePool> m_pools;
+    std::vector<uint32_t> m_activeVoices; // Playing, reserved for every pooled voice
+    SpscQueue<FinishedVoice> m_finishedVoices;
+    std::atomic<bool> m_finishedOverflow{ false }; // A callback found the queue full: Update polls the voices
+    uint64_t m_playSequence = 0;
+    AudioStats m_stats;
 
     // Background music voice
     IXAudio2SourceVoice* m_pMusicVoice = nullptr;
-    std::string m_currentMusicName;
-
-    // Helper to find existing voice playing a specific sound (if needed)
-    // IXAudio2SourceVoice* FindExistingVoice(const std::string& soundName);
-
-    // Basic WAV file parser helper
-    bool ParseWaveFile(const BYTE* fileData, size_t fileSize, WaveData& outWaveData);
+    StringId m_currentMusicId;
+    const BYTE* m_musicBuffer = nullptr;
+
+    // Pool of the format, created (with its voices) if there is none; UINT32_MAX on failure
+    uint32_t GetPool(const AudioFormat& format);
+    uint32_t FindPool(const AudioFormat& format) const;
+    // Lowest priority, oldest playing voice of 'pool' (any pool for UINT32_MAX) that 'priority' may steal
+    uint32_t FindVictim(uint32_t pool, uint8_t priority) const;
+    // Stops the voice if asked and returns it to its pool
+    void ReleaseVoice(uint32_t voice, bool stop);
+    // Frees the retired sounds no queued buffer (sound effect or music) points into
+    void FreeRetiredSounds();
+    void DestroyPools();
+    static HRESULT SubmitAndStart(IXAudio2SourceVoice* voice, const WaveData& waveData, float volume, float pitch, bool loop, void* context);
 };
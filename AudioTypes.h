@@ -0,0 +1,47 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+// Platform neutral audio types, shared by the XAudio2 AudioManager and the SoftwareMixer
+#include <cstdint>
+#include <vector>
+
+constexpr uint16_t AUDIO_FORMAT_PCM = 1; // WAVE_FORMAT_PCM
+
+// Wave format, laid out like the RIFF "fmt " chunk of a PCM file (WAVEFORMATEX without cbSize)
+struct AudioFormat {
+    uint16_t FormatTag = AUDIO_FORMAT_PCM;
+    uint16_t Channels = 0;
+    uint32_t SampleRate = 0;
+    uint32_t ByteRate = 0;
+    uint16_t BlockAlign = 0;
+    uint16_t BitsPerSample = 0;
+};
+static_assert(sizeof(AudioFormat) == 16, "AudioFormat must match the RIFF fmt chunk");
+
+inline AudioFormat MakePcmFormat(uint16_t channels, uint32_t sampleRate) {
+    AudioFormat format;
+    format.Channels = channels;
+    format.SampleRate = sampleRate;
+    format.BitsPerSample = 16;
+    format.BlockAlign = static_cast<uint16_t>(channels * 2);
+    format.ByteRate = sampleRate * format.BlockAlign;
+    return format;
+}
+
+// Structure to hold loaded wave data
+struct WaveData {
+    AudioFormat WaveFormat;
+    std::vector<uint8_t> AudioData;
+};
+
+// A playing sound effect: the voice and the play it belongs to. Stale once the sound ends or
+// its voice is stolen, so it can never stop someone else's sound.
+struct SoundHandle {
+    uint32_t Voice = UINT32_MAX;
+    uint32_t Generation = 0;
+
+    bool IsValid() const { return Voice != UINT32_MAX; }
+};
@@ -0,0 +1,567 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "BlockCompression.h"
+#include "Timing.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5; // Blocks end with at least this many literals
+constexpr size_t MATCH_FIND_LIMIT = 12; // No match starts in the last 12 bytes of a block
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 14;
+constexpr int SKIP_TRIGGER = 6; // Misses before the match finder starts skipping ahead
+
+inline uint32_t Read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t Read64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Unaligned 16 byte copy (a single SSE load/store)
+inline void Copy16(uint8_t* dst, const uint8_t* src) {
+    std::memcpy(dst, src, 16);
+}
+
+inline void Copy8(uint8_t* dst, const uint8_t* src) {
+    std::memcpy(dst, src, 8);
+}
+
+inline uint32_t HashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+inline unsigned CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+// Length of the common prefix of 'a' and 'b' ('b' behind 'a'), 'a' stops at 'limit'
+inline size_t CountMatch(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+    const uint8_t* start = a;
+    while (a + 8 <= limit) {
+        uint64_t difference = Read64(a) ^ Read64(b);
+        if (difference) {
+            return static_cast<size_t>(a - start) + (CountTrailingZeros(difference) >> 3);
+        }
+        a += 8;
+        b += 8;
+    }
+    while (a < limit && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return static_cast<size_t>(a - start);
+}
+
+inline uint8_t* WriteLength(uint8_t* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+inline bool ReadLength(const uint8_t*& ip, const uint8_t* iend, size_t& length) {
+    uint8_t value;
+    do {
+        if (ip >= iend) {
+            return false;
+        }
+        value = *ip++;
+        length += value;
+    } while (value == 255);
+    return true;
+}
+
+// Worst case bytes of a sequence header + literals + offset + match length
+inline size_t SequenceBound(size_t literalLength, size_t matchLength) {
+    return 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+}
+
+inline size_t GetBlockRawSize(size_t blockIndex, uint64_t uncompressedSize) {
+    uint64_t start = uint64_t(blockIndex) * COMPRESSION_BLOCK_SIZE;
+    return start >= uncompressedSize ? 0 : static_cast<size_t>(std::min<uint64_t>(COMPRESSION_BLOCK_SIZE, uncompressedSize - start));
+}
+
+// Header and block table of a container, null when 'data' is not a valid one
+const CompressedHeader* GetContainerHeader(const uint8_t* data, size_t size) {
+    if (!data || size < sizeof(CompressedHeader)) {
+        return nullptr;
+    }
+    const CompressedHeader* header = reinterpret_cast<const CompressedHeader*>(data);
+    uint64_t expectedBlocks = (header->UncompressedSize + COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE;
+    if (header->Magic != COMPRESSED_MAGIC || header->Version != COMPRESSED_VERSION || header->BlockSize != COMPRESSION_BLOCK_SIZE ||
+        header->BlockCount != expectedBlocks || uint64_t(header->BlockCount) * sizeof(CompressedBlock) > size - sizeof(CompressedHeader)) {
+        return nullptr;
+    }
+    return header;
+}
+
+} // namespace
+
+size_t BlockCompressor::GetMaxCompressedSize(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t BlockCompressor::CompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity) {
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* iend = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* oend = dst + dstCapacity;
+
+    if (srcSize > MATCH_FIND_LIMIT) {
+        const uint8_t* matchFindEnd = iend - MATCH_FIND_LIMIT;
+        const uint8_t* matchEnd = iend - LAST_LITERALS;
+        uint32_t table[1 << HASH_BITS] = {}; // Last position of each hashed 4 byte sequence
+        table[HashSequence(Read32(ip))] = 0;
+        ++ip;
+
+        while (ip < matchFindEnd) {
+            // Greedy match search; the step grows with consecutive misses so incompressible data goes fast
+            const uint8_t* match = nullptr;
+            uint32_t attempts = 1u << SKIP_TRIGGER;
+            for (;;) {
+                uint32_t sequence = Read32(ip);
+                uint32_t hash = HashSequence(sequence);
+                const uint8_t* candidate = src + table[hash];
+                table[hash] = static_cast<uint32_t>(ip - src);
+                if (candidate < ip && static_cast<size_t>(ip - candidate) <= MAX_OFFSET && Read32(candidate) == sequence) {
+                    match = candidate;
+                    break;
+                }
+                ip += attempts++ >> SKIP_TRIGGER;
+                if (ip >= matchFindEnd) {
+                    break;
+                }
+            }
+            if (!match) {
+                break;
+            }
+
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                --ip;
+                --match;
+            }
+            size_t literalLength = static_cast<size_t>(ip - anchor);
+            size_t matchLength = MIN_MATCH + CountMatch(ip + MIN_MATCH, match + MIN_MATCH, matchEnd);
+            if (SequenceBound(literalLength, matchLength) > static_cast<size_t>(oend - op)) {
+                return 0;
+            }
+
+            uint8_t* token = op++;
+            *token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+            if (literalLength >= 15) {
+                op = WriteLength(op, literalLength - 15);
+            }
+            std::memcpy(op, anchor, literalLength);
+            op += literalLength;
+
+            size_t offset = static_cast<size_t>(ip - match);
+            *op++ = static_cast<uint8_t>(offset & 0xFF);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            size_t matchCode = matchLength - MIN_MATCH;
+            *token |= static_cast<uint8_t>(std::min<size_t>(matchCode, 15));
+            if (matchCode >= 15) {
+                op = WriteLength(op, matchCode - 15);
+            }
+
+            ip += matchLength;
+            anchor = ip;
+            if (ip < matchFindEnd) {
+                table[HashSequence(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+            }
+        }
+    }
+
+    // Last sequence: literals only
+    size_t literalLength = static_cast<size_t>(iend - anchor);
+    if (1 + literalLength / 255 + 1 + literalLength > static_cast<size_t>(oend - op)) {
+        return 0;
+    }
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+    if (literalLength >= 15) {
+        op = WriteLength(op, literalLength - 15);
+    }
+    std::memcpy(op, anchor, literalLength);
+    op += literalLength;
+    return static_cast<size_t>(op - dst);
+}
+
+bool BlockCompressor::DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    const uint8_t* ip = src;
+    const uint8_t* iend = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* oend = dst + dstSize;
+
+    while (ip < iend) {
+        unsigned token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(ip, iend, literalLength)) {
+            return false;
+        }
+        if (literalLength > static_cast<size_t>(iend - ip) || literalLength > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+        if (static_cast<size_t>(iend - ip) >= literalLength + 15 && static_cast<size_t>(oend - op) >= literalLength + 15) {
+            // 16 byte chunks, the extra bytes are overwritten by the next sequence
+            for (size_t i = 0; i < literalLength; i += 16) Copy16(op + i, ip + i);
+        } else if (literalLength > 0) {
+            std::memcpy(op, ip, literalLength);
+        }
+        ip += literalLength;
+        op += literalLength;
+        if (ip == iend) {
+            break; // Last sequence has no match
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) {
+            return false;
+        }
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(ip, iend, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        size_t space = static_cast<size_t>(oend - op);
+        if (matchLength > space) {
+            return false;
+        }
+
+        // Chunked copies only read bytes already written when the offset is at least the chunk size;
+        // overlapping short offsets (runs) copy bytewise
+        const uint8_t* match = op - offset;
+        if (offset >= 16 && space >= matchLength + 15) {
+            for (size_t i = 0; i < matchLength; i += 16) Copy16(op + i, match + i);
+        } else if (offset >= 8 && space >= matchLength + 7) {
+            for (size_t i = 0; i < matchLength; i += 8) Copy8(op + i, match + i);
+        } else {
+            for (size_t i = 0; i < matchLength; ++i) op[i] = match[i];
+        }
+        op += matchLength;
+    }
+    return op == oend;
+}
+
+void BlockCompressor::CompressBlocks(const uint8_t* data, size_t size, uint64_t baseOffset,
+                                     std::vector<CompressedBlock>& outBlocks, std::vector<uint8_t>& outData, JobSystem* jobSystem) {
+    size_t blockCount = (size + COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE;
+    std::vector<std::vector<uint8_t>> compressed(blockCount);
+    auto compress = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const uint8_t* block = data + i * COMPRESSION_BLOCK_SIZE;
+            size_t rawSize = GetBlockRawSize(i, size);
+            compressed[i].resize(GetMaxCompressedSize(rawSize));
+            size_t storedSize = rawSize > 0 ? CompressBlock(block, rawSize, compressed[i].data(), rawSize - 1) : 0;
+            if (storedSize == 0) {
+                compressed[i].assign(block, block + rawSize); // Incompressible, stored raw
+            } else {
+                compressed[i].resize(storedSize);
+            }
+        }
+    };
+    if (jobSystem && blockCount > 1) {
+        jobSystem->ParallelFor(blockCount, 1, compress);
+    } else {
+        compress(0, blockCount);
+    }
+
+    size_t firstBlock = outBlocks.size();
+    outBlocks.resize(firstBlock + blockCount);
+    for (size_t i = 0; i < blockCount; ++i) {
+        CompressedBlock& block = outBlocks[firstBlock + i];
+        block.Offset = baseOffset + outData.size();
+        block.StoredSize = static_cast<uint32_t>(compressed[i].size());
+        outData.insert(outData.end(), compressed[i].begin(), compressed[i].end());
+    }
+}
+
+bool BlockCompressor::DecompressBlocks(const uint8_t* base, size_t baseSize, const CompressedBlock* blocks, size_t firstBlock,
+                                       size_t blockCount, uint64_t uncompressedSize, uint8_t* out, JobSystem* jobSystem) {
+    std::atomic<bool> ok{ true };
+    auto decode = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end && ok.load(std::memory_order_relaxed); ++i) {
+            const CompressedBlock& block = blocks[firstBlock + i];
+            size_t rawSize = GetBlockRawSize(firstBlock + i, uncompressedSize);
+            uint8_t* target = out + i * COMPRESSION_BLOCK_SIZE;
+            if (rawSize == 0 || block.Offset > baseSize || block.StoredSize > baseSize - block.Offset) {
+                ok = false;
+            } else if (block.StoredSize == rawSize) {
+                std::memcpy(target, base + block.Offset, rawSize);
+            } else if (!DecompressBlock(base + block.Offset, block.StoredSize, target, rawSize)) {
+                ok = false;
+            }
+        }
+    };
+    if (jobSystem && blockCount > 1) {
+        jobSystem->ParallelFor(blockCount, 1, decode);
+    } else {
+        decode(0, blockCount);
+    }
+    return ok;
+}
+
+bool BlockCompressor::DecompressRange(const uint8_t* base, size_t baseSize, const CompressedBlock* blocks, size_t blockCount,
+                                      uint64_t uncompressedSize, uint64_t offset, size_t length, uint8_t* out, JobSystem* jobSystem) {
+    if (offset > uncompressedSize || length > uncompressedSize - offset) {
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+    size_t firstBlock = static_cast<size_t>(offset / COMPRESSION_BLOCK_SIZE);
+    size_t lastBlock = static_cast<size_t>((offset + length - 1) / COMPRESSION_BLOCK_SIZE);
+    if (lastBlock >= blockCount) {
+        return false;
+    }
+
+    // Blocks fully inside the range decode in place, the (at most two) partial ones through a scratch block
+    std::atomic<bool> ok{ true };
+    auto decode = [&](size_t begin, size_t end) {
+        std::vector<uint8_t> scratch;
+        for (size_t i = begin; i < end && ok.load(std::memory_order_relaxed); ++i) {
+            size_t blockIndex = firstBlock + i;
+            uint64_t blockStart = uint64_t(blockIndex) * COMPRESSION_BLOCK_SIZE;
+            size_t rawSize = GetBlockRawSize(blockIndex, uncompressedSize);
+            uint64_t copyStart = std::max(offset, blockStart);
+            uint64_t copyEnd = std::min(offset + length, blockStart + rawSize);
+            uint8_t* target = out + (copyStart - offset);
+            if (copyStart == blockStart && copyEnd == blockStart + rawSize) {
+                ok = ok && DecompressBlocks(base, baseSize, blocks, blockIndex, 1, uncompressedSize, target, nullptr);
+                continue;
+            }
+            scratch.resize(rawSize);
+            if (!DecompressBlocks(base, baseSize, blocks, blockIndex, 1, uncompressedSize, scratch.data(), nullptr)) {
+                ok = false;
+                continue;
+            }
+            std::memcpy(target, scratch.data() + (copyStart - blockStart), static_cast<size_t>(copyEnd - copyStart));
+        }
+    };
+    size_t rangeBlocks = lastBlock - firstBlock + 1;
+    if (jobSystem && rangeBlocks > 1) {
+        jobSystem->ParallelFor(rangeBlocks, 1, decode);
+    } else {
+        decode(0, rangeBlocks);
+    }
+    return ok;
+}
+
+// --- Container ---
+
+bool BlockCompressor::IsCompressed(const uint8_t* data, size_t size) {
+    return GetContainerHeader(data, size) != nullptr;
+}
+
+bool BlockCompressor::Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& outData, JobSystem* jobSystem) {
+    CompressedHeader header;
+    header.UncompressedSize = size;
+    header.BlockCount = static_cast<uint32_t>((size + COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE);
+    size_t tableEnd = sizeof(CompressedHeader) + header.BlockCount * sizeof(CompressedBlock);
+
+    std::vector<CompressedBlock> blocks;
+    std::vector<uint8_t> blockData;
+    CompressBlocks(data, size, tableEnd, blocks, blockData, jobSystem);
+
+    outData.resize(tableEnd + blockData.size());
+    std::memcpy(outData.data(), &header, sizeof(header));
+    if (!blocks.empty()) {
+        std::memcpy(outData.data() + sizeof(header), blocks.data(), blocks.size() * sizeof(CompressedBlock));
+    }
+    if (!blockData.empty()) {
+        std::memcpy(outData.data() + tableEnd, blockData.data(), blockData.size());
+    }
+    return true;
+}
+
+uint64_t BlockCompressor::GetUncompressedSize(const uint8_t* data, size_t size) {
+    const CompressedHeader* header = GetContainerHeader(data, size);
+    return header ? header->UncompressedSize : 0;
+}
+
+bool BlockCompressor::Decompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize, JobSystem* jobSystem) {
+    const CompressedHeader* header = GetContainerHeader(data, size);
+    if (!header || header->UncompressedSize != outSize) {
+        return false;
+    }
+    const CompressedBlock* blocks = reinterpret_cast<const CompressedBlock*>(data + sizeof(CompressedHeader));
+    return DecompressBlocks(data, size, blocks, 0, header->BlockCount, header->UncompressedSize, out, jobSystem);
+}
+
+bool BlockCompressor::Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& outData, JobSystem* jobSystem) {
+    const CompressedHeader* header = GetContainerHeader(data, size);
+    if (!header) {
+        return false;
+    }
+    outData.resize(static_cast<size_t>(header->UncompressedSize));
+    return Decompress(data, size, outData.data(), outData.size(), jobSystem);
+}
+
+bool BlockCompressor::DecompressRange(const uint8_t* data, size_t size, uint64_t offset, size_t length, uint8_t* out, JobSystem* jobSystem) {
+    const CompressedHeader* header = GetContainerHeader(data, size);
+    if (!header) {
+        return false;
+    }
+    const CompressedBlock* blocks = reinterpret_cast<const CompressedBlock*>(data + sizeof(CompressedHeader));
+    return DecompressRange(data, size, blocks, header->BlockCount, header->UncompressedSize, offset, length, out, jobSystem);
+}
+
+// --- Benchmark ---
+
+bool BlockCompressor::RunBenchmark(const std::wstring& path, JobSystem& jobSystem) {
+    std::vector<std::vector<uint8_t>> payloads;
+    std::error_code ec;
+    if (std::filesystem::is_directory(path, ec)) {
+        for (std::filesystem::recursive_directory_iterator it(path, ec), endIt; !ec && it != endIt; it.increment(ec)) {
+            std::vector<uint8_t> data;
+            if (it->is_regular_file(ec) && AssetCache::ReadFile(it->path(), data) && !IsCompressed(data.data(), data.size())) {
+                payloads.push_back(std::move(data));
+            }
+        }
+    } else {
+        std::vector<uint8_t> data;
+        if (AssetCache::ReadFile(path, data)) {
+            payloads.push_back(std::move(data));
+        }
+    }
+
+    if (payloads.empty()) {
+        // Shaped like cooked payloads: vertex stream of a terrain grid, its indices,
+        // sampled joint matrices and 16-bit PCM
+        std::cout << "LZ benchmark: No input files, using synthetic cooked data." << std::endl;
+        std::vector<uint8_t> data;
+        auto append = [&data](const void* value, size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(value);
+            data.insert(data.end(), bytes, bytes + size);
+        };
+        const int gridSize = 512;
+        for (int z = 0; z < gridSize; ++z) {
+            for (int x = 0; x < gridSize; ++x) {
+                float height = std::sin(x * 0.05f) * std::cos(z * 0.03f) * 4.0f;
+                float vertex[8] = { float(x), height, float(z), 0.0f, 1.0f, 0.0f, x / float(gridSize - 1), z / float(gridSize - 1) };
+                append(vertex, sizeof(vertex));
+            }
+        }
+        for (int z = 0; z + 1 < gridSize; ++z) {
+            for (int x = 0; x + 1 < gridSize; ++x) {
+                uint32_t i0 = z * gridSize + x;
+                uint32_t quad[6] = { i0, i0 + gridSize, i0 + 1, i0 + 1, i0 + gridSize, i0 + gridSize + 1 };
+                append(quad, sizeof(quad));
+            }
+        }
+        for (int joint = 0; joint < 200; ++joint) {
+            for (int frame = 0; frame < 1000; ++frame) {
+                float angle = std::sin(frame * 0.02f + joint) * 0.5f;
+                float matrix[16] = { std::cos(angle), 0, -std::sin(angle), 0, 0, 1, 0, 0, std::sin(angle), 0, std::cos(angle), 0, 0, float(joint) * 0.1f, 0, 1 };
+                append(matrix, sizeof(matrix));
+            }
+        }
+        std::mt19937 random(5);
+        std::normal_distribution<float> noise(0.0f, 200.0f);
+        for (int sample = 0; sample < 48000 * 10 * 2; ++sample) {
+            int16_t value = static_cast<int16_t>(std::sin(sample * 0.0287f) * 8000.0f + noise(random));
+            append(&value, sizeof(value));
+        }
+        payloads.push_back(std::move(data));
+    }
+
+    uint64_t rawBytes = 0, storedBytes = 0;
+    double compressSeconds = 0.0, singleSeconds = 1e30, parallelSeconds = 1e30, copySeconds = 1e30;
+    std::vector<std::vector<uint8_t>> compressed(payloads.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        Compress(payloads[i].data(), payloads[i].size(), compressed[i], &jobSystem);
+        rawBytes += payloads[i].size();
+        storedBytes += compressed[i].size();
+    }
+    compressSeconds = SecondsSince(start);
+
+    // Best of 5; also checks every round trip
+    bool ok = true;
+    std::vector<std::vector<uint8_t>> decoded(payloads.size());
+    for (size_t i = 0; i < payloads.size(); ++i) decoded[i].resize(payloads[i].size());
+    for (int run = 0; run < 5 && ok; ++run) {
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < payloads.size(); ++i) {
+            ok = ok && Decompress(compressed[i].data(), compressed[i].size(), decoded[i].data(), decoded[i].size(), nullptr);
+        }
+        singleSeconds = std::min(singleSeconds, SecondsSince(start));
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < payloads.size(); ++i) {
+            ok = ok && Decompress(compressed[i].data(), compressed[i].size(), decoded[i].data(), decoded[i].size(), &jobSystem);
+        }
+        parallelSeconds = std::min(parallelSeconds, SecondsSince(start));
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < payloads.size(); ++i) {
+            std::memcpy(decoded[i].data(), payloads[i].data(), payloads[i].size());
+        }
+        copySeconds = std::min(copySeconds, SecondsSince(start));
+    }
+    for (size_t i = 0; i < payloads.size() && ok; ++i) {
+        Decompress(compressed[i].data(), compressed[i].size(), decoded[i].data(), decoded[i].size(), &jobSystem);
+        ok = decoded[i] == payloads[i];
+    }
+
+    // Partial read of the middle of the largest payload
+    size_t largest = 0;
+    for (size_t i = 1; i < payloads.size(); ++i) {
+        if (payloads[i].size() > payloads[largest].size()) largest = i;
+    }
+    const std::vector<uint8_t>& source = payloads[largest];
+    size_t rangeOffset = source.size() / 3, rangeLength = std::min<size_t>(source.size() - rangeOffset, 100000);
+    std::vector<uint8_t> range(rangeLength);
+    ok = ok && DecompressRange(compressed[largest].data(), compressed[largest].size(), rangeOffset, rangeLength, range.data(), &jobSystem) &&
+         std::memcmp(range.data(), source.data() + rangeOffset, rangeLength) == 0;
+
+    double megabytes = rawBytes / (1024.0 * 1024.0);
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2);
+    report << "LZ block benchmark: " << payloads.size() << " payloads, " << megabytes << " MB -> " << storedBytes / (1024.0 * 1024.0)
+           << " MB (ratio " << (storedBytes ? double(rawBytes) / storedBytes : 0.0) << ")\n"
+           << "  Compress (" << jobSystem.GetWorkerCount() + 1 << " threads): " << megabytes / std::max(compressSeconds, 1e-9) << " MB/s\n"
+           << "  Decode 1 thread:  " << megabytes / std::max(singleSeconds, 1e-9) << " MB/s\n"
+           << "  Decode parallel:  " << megabytes / std::max(parallelSeconds, 1e-9) << " MB/s\n"
+           << "  memcpy reference: " << megabytes / std::max(copySeconds, 1e-9) << " MB/s\n";
+    if (!ok) {
+        report << "  FAILED: round trip mismatch\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
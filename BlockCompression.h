@@ -0,0 +1,74 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+// LZ77 byte codec (LZ4 style sequences: token, literals, 16-bit offset, match length) over
+// independent blocks, so blocks decode in parallel and a range of a payload decodes on its own.
+//
+// Cooked payload container (.agm / .agw when CookSettings::CompressPayloads is set):
+//   [CompressedHeader][CompressedBlock x BlockCount][block data]
+// Packs use the same block table for compressed entries (PackBlock).
+constexpr uint32_t COMPRESSED_MAGIC = 0x5A4C4741; // "AGLZ"
+constexpr uint32_t COMPRESSED_VERSION = 1;
+constexpr uint32_t COMPRESSION_BLOCK_SIZE = 256 * 1024; // Uncompressed bytes per block (the last may be shorter)
+
+#pragma pack(push, 1)
+struct CompressedHeader {
+    uint32_t Magic = COMPRESSED_MAGIC;
+    uint32_t Version = COMPRESSED_VERSION;
+    uint64_t UncompressedSize = 0;
+    uint32_t BlockSize = COMPRESSION_BLOCK_SIZE;
+    uint32_t BlockCount = 0;
+};
+
+struct CompressedBlock {
+    uint64_t Offset = 0;     // Container: from the start of the container. Pack: from the start of the pack.
+    uint32_t StoredSize = 0; // Equal to the uncompressed block size when the block is stored raw
+    uint32_t Reserved = 0;
+};
+#pragma pack(pop)
+
+class BlockCompressor {
+public:
+    // One block of at most COMPRESSION_BLOCK_SIZE bytes. Returns the compressed size, or 0 when the
+    // result would not fit 'dstCapacity' (callers pass srcSize - 1 to only keep blocks that shrink).
+    static size_t CompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity);
+    // Fails on malformed input or when the output is not exactly 'dstSize' bytes
+    static bool DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+    static size_t GetMaxCompressedSize(size_t size);
+
+    // Splits 'data' into COMPRESSION_BLOCK_SIZE blocks, compressed in parallel on 'jobSystem'
+    // (null = calling thread). Block data is appended to 'outData'; block offsets are
+    // 'baseOffset' + position in 'outData'. Blocks that don't shrink are stored raw.
+    static void CompressBlocks(const uint8_t* data, size_t size, uint64_t baseOffset,
+                               std::vector<CompressedBlock>& outBlocks, std::vector<uint8_t>& outData, JobSystem* jobSystem);
+    // Decodes blocks [firstBlock, firstBlock + blockCount) of a payload of 'uncompressedSize' bytes into
+    // 'out' (which receives the bytes from firstBlock * COMPRESSION_BLOCK_SIZE on). Block offsets are
+    // relative to 'base'; every block is checked against 'baseSize'.
+    static bool DecompressBlocks(const uint8_t* base, size_t baseSize, const CompressedBlock* blocks, size_t firstBlock,
+                                 size_t blockCount, uint64_t uncompressedSize, uint8_t* out, JobSystem* jobSystem);
+    // Decodes bytes [offset, offset + length) of a payload, touching only the blocks that overlap it
+    static bool DecompressRange(const uint8_t* base, size_t baseSize, const CompressedBlock* blocks, size_t blockCount,
+                                uint64_t uncompressedSize, uint64_t offset, size_t length, uint8_t* out, JobSystem* jobSystem);
+
+    // --- Container ---
+    static bool IsCompressed(const uint8_t* data, size_t size);
+    static bool Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& outData, JobSystem* jobSystem = nullptr);
+    static uint64_t GetUncompressedSize(const uint8_t* data, size_t size); // 0 when not a valid container
+    static bool Decompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize, JobSystem* jobSystem = nullptr);
+    static bool Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& outData, JobSystem* jobSystem = nullptr);
+    static bool DecompressRange(const uint8_t* data, size_t size, uint64_t offset, size_t length, uint8_t* out, JobSystem* jobSystem = nullptr);
+
+    // Compresses every file below 'path' (or the file itself; synthetic cooked-like data when empty) and
+    // reports ratio, compression speed and single-threaded / parallel decode throughput (WinMain "-lzbench")
+    static bool RunBenchmark(const std::wstring& path, JobSystem& jobSystem);
+};
@@ -257,3 +257,10 @@ XMFLOAT3 Camera::GetPosition() const {
 XMFLOAT3 Camera::GetLookDirection() const {
      return m_lookDirection;
 }
+
+float Camera::GetProjectedSize(float worldSize, const XMFLOAT3& worldPosition, float viewportHeight) const {
+    XMVECTOR toPoint = XMVectorSubtract(XMLoadFloat3(&worldPosition), XMLoadFloat3(&m_position));
+    float distance = std::max(XMVectorGetX(XMVector3Length(toPoint)), 0.0001f);
+    // _22 = 1 / tan(fovY / 2), maps view-space height at distance 1 to NDC [-1, 1]
+    return worldSize * m_projectionMatrix._22 * 0.5f * viewportHeight / distance;
+}
@@ -39,6 +39,9 @@ public:
     DirectX::XMFLOAT3 GetPosition() const;
     DirectX::XMFLOAT3 GetLookDirection() const;
 
+    // Projected height in pixels of a world-space length at 'worldPosition' (for LOD selection)
+    float GetProjectedSize(float worldSize, const DirectX::XMFLOAT3& worldPosition, float viewportHeight) const;
+
 
     // Camera Movement Parameters (tune these)
     float MoveSpeed = 10.0f;
@@ -0,0 +1,42 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Shape of a generated Collada file
+struct ColladaCorpusSettings {
+    size_t VertexCount = 10000;   // Laid out as a grid, two triangles per full cell
+    size_t JointCount = 64;       // Binary tree hierarchy; 0 = no skin, scene or animations
+    size_t ClipCount = 4;
+    size_t KeyframeCount = 60;    // Per joint and clip, one matrix per key
+    int InfluencesPerVertex = 4;
+    uint32_t Seed = 1;            // Same settings and seed give the same file
+};
+
+struct ColladaBenchmarkSettings {
+    int Iterations = 3;                  // Per file; the fastest run is reported
+    double MinMegabytesPerSecond = 0.0;  // Run() fails if any file parses slower (0 = report only)
+};
+
+// Synthetic Collada corpus and ColladaParser::ParseFile throughput benchmark. Reports MB/s, time
+// per library section and the process peak memory after each file. Sections without a real parser
+// yet are reported as scan only: their time is finding the element, not parsing it. Only uses the
+// standard library and the parser, so it runs headless (HEADLESS_TOOLS "-colladabench <directory>
+// [-min <MB/s>]", from the game or the ToolsMain console).
+class ColladaBenchmark {
+public:
+    static bool GenerateFile(const std::wstring& filePath, const ColladaCorpusSettings& settings);
+    // Writes a fixed set of files (static mesh, skinned character, animation heavy, large) to 'directory'
+    static bool GenerateCorpus(const std::wstring& directory);
+
+    // Parses every .dae file in 'directory' (generating the corpus first if there are none)
+    static bool Run(const std::wstring& directory, const ColladaBenchmarkSettings& settings = ColladaBenchmarkSettings());
+
+    static size_t GetPeakMemoryBytes();    // Process peak working set / max RSS (since startup, not per file)
+    static size_t GetCurrentMemoryBytes();
+};
@@ -2,90 +2,279 @@
 // Copyright (c) 2025 CGLJ08. All rights reserved.
 // This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
 
-#include "pch.h"
+#ifdef _WIN32
+#include "pch.h" // OutputDebugStringA; the parser itself builds anywhere
+#endif
 #include "ColladaParser.h"
+#include "Timing.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream> // For error logging
 
-ColladaParser::ColladaParser() : m_pCurrentModel(nullptr), m_lineNumber(0) {}
+ColladaParser::ColladaParser() : m_lineNumber(0), m_pCurrentModel(nullptr) {}
 
-ColladaParser::~ColladaParser() {
-    if (m_fileStream.is_open()) {
-        m_fileStream.close();
-    }
-}
+ColladaParser::~ColladaParser() {}
 
-// --- WARNING: THIS IS A NON-FUNCTIONAL PLACEHOLDER ---
+// --- WARNING: THE SECTION PARSERS ARE NON-FUNCTIONAL PLACEHOLDERS ---
 // --- A REAL IMPLEMENTATION REQUIRES EXTENSIVE MANUAL XML PARSING ---
 bool ColladaParser::ParseFile(const std::wstring& filePath, Model& outModel) {
+    using Clock = std::chrono::high_resolution_clock;
+    auto startTime = Clock::now();
+
     m_pCurrentModel = &outModel; // Store pointer to the output model
     m_lineNumber = 0;
     m_floatSources.clear();
     m_stringSources.clear();
     m_nodeTransforms.clear();
+    m_geometryMeshes.clear();
+    m_pendingInstances.clear();
+    m_stats = ColladaParseStats();
+    m_lastError.clear();
+    m_scanFailed = false;
     // Clear other temporary maps
 
-    m_fileStream.open(filePath);
-    if (!m_fileStream.is_open()) {
-        LogError("Failed to open file: " + std::string(filePath.begin(), filePath.end()));
+    // One read of the whole file; the section parsers work on the in-memory text
+    std::ifstream file(std::filesystem::path(filePath), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        LogError("Failed to open file: " + std::filesystem::path(filePath).string());
+        m_pCurrentModel = nullptr;
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    m_fileData.resize(static_cast<size_t>(size));
+    if (size > 0 && !file.read(&m_fileData[0], size)) {
+        LogError("Failed to read file: " + std::filesystem::path(filePath).string());
         m_pCurrentModel = nullptr;
         return false;
     }
+    file.close();
+    m_stats.FileBytes = m_fileData.size();
+    m_stats.ReadSeconds = SecondsSince(startTime);
+
+    // --- HIGH LEVEL PARSING FLOW ---
+    // Each child of <COLLADA> (<asset>, <library_images>, ..., <scene>) goes to its section parser
+    // with m_sectionBegin / m_sectionEnd bounding its text. Sections are timed for the benchmark,
+    // scan included: for a section without a parser the scan is all the time there is.
+    bool success = true;
+    size_t offset = 0;
+    size_t lineOffset = 0;
+    std::string name;
+    auto sectionStart = Clock::now();
+    while (success && FindNextSection(offset, name, m_sectionBegin, m_sectionEnd)) {
+        m_lineNumber += static_cast<int>(std::count(m_fileData.begin() + lineOffset, m_fileData.begin() + m_sectionBegin, '\n'));
+        lineOffset = m_sectionBegin;
+
+        success = ParseSection(name);
+        m_lineNumber += static_cast<int>(std::count(m_fileData.begin() + m_sectionBegin, m_fileData.begin() + m_sectionEnd, '\n'));
+        lineOffset = m_sectionEnd;
+        double seconds = SecondsSince(sectionStart);
+
+        auto it = std::find_if(m_stats.Sections.begin(), m_stats.Sections.end(),
+            [&name](const ColladaSectionStats& section) { return section.Name == name; });
+        if (it == m_stats.Sections.end()) {
+            m_stats.Sections.push_back({ name, 0, 0.0, !HasSectionParser(name) });
+            it = m_stats.Sections.end() - 1;
+        }
+        it->Bytes += m_sectionEnd - m_sectionBegin;
+        it->Seconds += seconds;
+        offset = m_sectionEnd;
+        sectionStart = Clock::now();
+    }
+
+    success = success && !m_scanFailed; // FindNextSection also stops on malformed text
+
+    // --- Post-processing ---
+    if (success) {
+        ResolveInstances();
+    }
+    // * Resolve material references in meshes
+    // * Build skeleton hierarchy (parent indices) based on node names
+    // * Apply skinning data to vertices
+    // * Create D3D Buffers for meshes (or do this elsewhere)
+    // * Validate data
 
-    // --- HIGH LEVEL PARSING FLOW (PSEUDOCODE/CONCEPT) ---
-    // This requires complex state management and string manipulation
+    m_stats.TotalSeconds = SecondsSince(startTime);
+    m_fileData.clear();
+    m_fileData.shrink_to_fit();
+    m_pCurrentModel = nullptr; // Clear pointer
 
-    /*
-    while (getline(m_fileStream, m_currentLine)) {
-        m_lineNumber++;
-        m_currentLine = Trim(m_currentLine);
-        if (m_currentLine.empty() || m_currentLine.rfind("<?xml", 0) == 0 || m_currentLine.rfind("<!--", 0) == 0) continue;
+    if (!success) {
+        return false;
+    }
+    m_stats.SectionsParsed = true;
+    LogError("ColladaParser::ParseFile is only a placeholder and does not perform actual parsing.");
+    return false; // Return false as it's not implemented
+}
 
-        if (FindElement("<COLLADA")) { // Check version etc.
-             // ...
+bool ColladaParser::FindNextSection(size_t offset, std::string& outName, size_t& outBegin, size_t& outEnd) {
+    const std::string& text = m_fileData;
+    while ((offset = text.find('<', offset)) != std::string::npos) {
+        if (text.compare(offset, 4, "<!--") == 0) {
+            offset = text.find("-->", offset);
+            if (offset == std::string::npos) {
+                LogError("Unterminated comment.");
+                m_scanFailed = true;
+                return false;
+            }
+            offset += 3;
+            continue;
         }
-        if (FindElement("<asset>")) {
-             if (!ParseAssetInfo()) return false; // Handle errors
+        if (offset + 1 < text.size() && (text[offset + 1] == '?' || text[offset + 1] == '!' || text[offset + 1] == '/')) {
+            offset = text.find('>', offset); // Declaration or </COLLADA>
+            if (offset == std::string::npos) {
+                LogError("Unterminated tag.");
+                m_scanFailed = true;
+                return false;
+            }
+            ++offset;
+            continue;
         }
-        if (FindElement("<library_images>")) {
-             if (!ParseLibraryImages()) return false;
+
+        size_t nameEnd = text.find_first_of(" \t\r\n/>", offset + 1);
+        size_t tagEnd = nameEnd == std::string::npos ? std::string::npos : text.find('>', nameEnd);
+        if (tagEnd == std::string::npos) {
+            LogError("Unterminated tag.");
+            m_scanFailed = true;
+            return false;
         }
-        if (FindElement("<library_materials>")) {
-             if (!ParseLibraryMaterials()) return false;
+        std::string name = text.substr(offset + 1, nameEnd - offset - 1);
+        if (name == "COLLADA") {
+            offset = tagEnd + 1; // Descend into the root element
+            continue;
         }
-        if (FindElement("<library_effects>")) {
-             if (!ParseLibraryEffects()) return false;
+
+        outName = name;
+        outBegin = offset;
+        if (text[tagEnd - 1] == '/') {
+            outEnd = tagEnd + 1; // <element ... />
+            return true;
         }
-        if (FindElement("<library_geometries>")) {
-             if (!ParseLibraryGeometries()) return false;
+        // Top level elements don't nest elements of their own name, the first end tag closes them
+        std::string endTag = "</" + name + ">";
+        size_t close = text.find(endTag, tagEnd);
+        if (close == std::string::npos) {
+            LogError("Missing " + endTag);
+            m_scanFailed = true;
+            return false;
+        }
+        outEnd = close + endTag.size();
+        return true;
+    }
+    return false;
+}
+
+bool ColladaParser::NextElement(size_t offset, size_t end, XmlElement& outElement) {
+    const std::string& text = m_fileData;
+    auto isNameEnd = [&text](size_t pos) {
+        return pos >= text.size() || strchr(" \t\r\n/>", text[pos]) != nullptr;
+    };
+    while ((offset = text.find('<', offset)) != std::string::npos && offset < end) {
+        if (text.compare(offset, 4, "<!--") == 0) {
+            offset = text.find("-->", offset);
+            if (offset == std::string::npos) return false;
+            offset += 3;
+            continue;
         }
-        if (FindElement("<library_controllers>")) {
-             if (!ParseLibraryControllers()) return false;
+        if (offset + 1 < text.size() && (text[offset + 1] == '?' || text[offset + 1] == '!' || text[offset + 1] == '/')) {
+            offset = text.find('>', offset); // Declaration or the parent's end tag
+            if (offset == std::string::npos) return false;
+            ++offset;
+            continue;
         }
-        if (FindElement("<library_visual_scenes>")) {
-             if (!ParseLibraryVisualScenes()) return false;
+
+        size_t nameEnd = text.find_first_of(" \t\r\n/>", offset + 1);
+        size_t tagEnd = nameEnd == std::string::npos ? std::string::npos : text.find('>', nameEnd);
+        if (tagEnd == std::string::npos || tagEnd >= end) {
+            LogError("Unterminated tag.");
+            return false;
         }
-        if (FindElement("<library_animations>")) {
-            if (!ParseLibraryAnimations()) return false;
+        outElement.Name = text.substr(offset + 1, nameEnd - offset - 1);
+        outElement.Begin = offset;
+        outElement.ContentBegin = tagEnd + 1;
+        if (text[tagEnd - 1] == '/') {
+            outElement.ContentEnd = outElement.ContentBegin;
+            outElement.End = outElement.ContentBegin;
+            return true;
         }
-        if (FindElement("<scene>")) {
-            // Instantiate visual scene etc.
+
+        // Match the end tag, counting nested start tags of the same name
+        const std::string startTag = "<" + outElement.Name;
+        const std::string endTag = "</" + outElement.Name + ">";
+        int depth = 1;
+        size_t pos = outElement.ContentBegin;
+        while (depth > 0) {
+            size_t nextStart = text.find(startTag, pos);
+            size_t nextEnd = text.find(endTag, pos);
+            if (nextEnd == std::string::npos || nextEnd >= end) {
+                LogError("Missing " + endTag);
+                return false;
+            }
+            if (nextStart < nextEnd && isNameEnd(nextStart + startTag.size())) {
+                size_t nestedTagEnd = text.find('>', nextStart);
+                if (nestedTagEnd == std::string::npos) return false;
+                if (text[nestedTagEnd - 1] != '/') ++depth;
+                pos = nestedTagEnd + 1;
+            } else if (nextStart < nextEnd) {
+                pos = nextStart + startTag.size(); // Longer name with the same prefix
+            } else {
+                --depth;
+                outElement.ContentEnd = nextEnd;
+                pos = nextEnd + endTag.size();
+            }
         }
-        // ... handle closing tags </...> ...
+        outElement.End = pos;
+        return true;
     }
+    return false;
+}
 
-    // --- Post-processing ---
-    // * Resolve material references in meshes
-    // * Build skeleton hierarchy (parent indices) based on node names
-    // * Apply skinning data to vertices
-    // * Create D3D Buffers for meshes (or do this elsewhere)
-    // * Validate data
-    */
+std::string ColladaParser::GetAttribute(const XmlElement& element, const std::string& attributeName) {
+    const std::string& text = m_fileData;
+    size_t tagEnd = element.ContentBegin - 1;
+    std::string pattern = attributeName + "=";
+    size_t pos = element.Begin + 1 + element.Name.size();
+    while ((pos = text.find(pattern, pos)) != std::string::npos && pos < tagEnd) {
+        if (strchr(" \t\r\n", text[pos - 1]) == nullptr) {
+            pos += pattern.size(); // Suffix of another attribute name ("sid=" in "xsid=")
+            continue;
+        }
+        size_t quote = pos + pattern.size();
+        char quoteChar = text[quote];
+        if (quoteChar != '"' && quoteChar != '\'') {
+            return "";
+        }
+        size_t close = text.find(quoteChar, quote + 1);
+        if (close == std::string::npos || close > tagEnd) {
+            return "";
+        }
+        return text.substr(quote + 1, close - quote - 1);
+    }
+    return "";
+}
 
-    LogError("ColladaParser::ParseFile is only a placeholder and does not perform actual parsing.");
+std::string ColladaParser::GetElementText(const XmlElement& element) {
+    return m_fileData.substr(element.ContentBegin, element.ContentEnd - element.ContentBegin);
+}
 
-    m_fileStream.close();
-    m_pCurrentModel = nullptr; // Clear pointer
-    return false; // Return false as it's not implemented
+bool ColladaParser::ParseSection(const std::string& name) {
+    if (name == "asset") return ParseAssetInfo();
+    if (name == "library_images") return ParseLibraryImages();
+    if (name == "library_materials") return ParseLibraryMaterials();
+    if (name == "library_effects") return ParseLibraryEffects();
+    if (name == "library_geometries") return ParseLibraryGeometries();
+    if (name == "library_controllers") return ParseLibraryControllers();
+    if (name == "library_visual_scenes") return ParseLibraryVisualScenes();
+    if (name == "library_animations") return ParseLibraryAnimations();
+    // <scene>, <library_animation_clips>, <library_cameras>, ... are skipped for now
+    return true;
+}
+
+bool ColladaParser::HasSectionParser(const std::string& name) {
+    // Update as the placeholders above get real implementations
+    return name == "library_visual_scenes";
 }
 
 
@@ -93,9 +282,9 @@ bool ColladaParser::ParseFile(const std::wstring& filePath, Model& outModel) {
 // --- THESE NEED REAL STRING/FILE PARSING LOGIC ---
 
 bool ColladaParser::FindElement(const std::string& elementName) {
-     // TODO: Implement logic to search for the start tag in m_fileStream or m_currentLine
+     // TODO: Implement logic to search for the start tag within [m_sectionBegin, m_sectionEnd) of m_fileData
      // Needs to handle attributes within the tag.
-     // Example: return m_currentLine.find(elementName + " ") != std::string::npos || m_currentLine.find(elementName + ">") != std::string::npos;
+     // Example: return m_fileData.find("<" + elementName, m_sectionBegin) < m_sectionEnd;
      LogError("FindElement not implemented.");
      return false;
 }
@@ -116,14 +305,46 @@ bool ColladaParser::ParseFloatArray(const std::string& text, std::vector<float>&
 }
 bool ColladaParser::ParseIntArray(const std::string& text, std::vector<uint32_t>& outInts) { LogError("ParseIntArray not implemented."); return false; }
 bool ColladaParser::ParseStringArray(const std::string& text, std::vector<std::string>& outStrings) { LogError("ParseStringArray not implemented."); return false; }
-bool ColladaParser::ParseMatrix(const std::string& text, DirectX::XMFLOAT4X4& outMatrix) { LogError("ParseMatrix not implemented."); return false; }
-bool ColladaParser::ParseDualQuaternion(const std::string& text, DualQuaternion& outDQ) { LogError("ParseDualQuaternion not implemented."); return false; }
+bool ColladaParser::ParseMatrix(const std::string& text, DirectX::XMFLOAT4X4& outMatrix) {
+    // Collada matrices are row-major for column vectors; transposed they are DirectXMath's row-vector form
+    std::vector<float> values;
+    if (!ParseFloatArray(text, values) || values.size() != 16) {
+        LogError("Expected 16 floats in <matrix>.");
+        return false;
+    }
+    DirectX::XMMATRIX rowMajor = DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(values.data()));
+    DirectX::XMStoreFloat4x4(&outMatrix, DirectX::XMMatrixTranspose(rowMajor));
+    return true;
+}
+bool ColladaParser::ParseDualQuaternion(const std::string& text, DualQuaternion& outDQ) {
+    using namespace DirectX;
+    std::vector<float> values;
+    if (!ParseFloatArray(text, values) || values.size() != 8) {
+        LogError("Expected 8 floats in a dual quaternion.");
+        return false;
+    }
+    XMVECTOR real = XMVectorSet(values[0], values[1], values[2], values[3]);
+    XMVECTOR dual = XMVectorSet(values[4], values[5], values[6], values[7]);
+    float length = XMVectorGetX(XMVector4Length(real));
+    if (length < 1e-6f) {
+        LogError("Dual quaternion with a zero rotation part.");
+        return false;
+    }
+    // Unit length, and the dual part orthogonal to the real part (exporters round both)
+    real = XMVectorScale(real, 1.0f / length);
+    dual = XMVectorScale(dual, 1.0f / length);
+    dual = XMVectorSubtract(dual, XMVectorScale(real, XMVectorGetX(XMVector4Dot(real, dual))));
+    XMStoreFloat4(&outDQ.Real, real);
+    XMStoreFloat4(&outDQ.Dual, dual);
+    return true;
+}
 
 bool ColladaParser::ParseAssetInfo() { LogError("ParseAssetInfo not implemented."); return true; } // Allow skipping optional sections
 bool ColladaParser::ParseLibraryImages() { LogError("ParseLibraryImages not implemented."); return true; }
 bool ColladaParser::ParseLibraryMaterials() { LogError("ParseLibraryMaterials not implemented."); return true; }
 bool ColladaParser::ParseLibraryEffects() { LogError("ParseLibraryEffects not implemented."); return true; }
 bool ColladaParser::ParseLibraryGeometries() { LogError("ParseLibraryGeometries not implemented."); return true; }
+// Once implemented: appends one Mesh per <triangles>/<polylist> and records the range in m_geometryMeshes[geometryId]
 bool ColladaParser::ParseGeometry(const std::string& geometryId) { LogError("ParseGeometry not implemented."); return true; }
 bool ColladaParser::ParseMesh(Mesh& outMesh) { LogError("ParseMesh not implemented."); return true; }
 bool ColladaParser::ParseSource(const std::string& sourceId) { LogError("ParseSource not implemented."); return true; }
@@ -137,9 +358,107 @@ bool ColladaParser::ParseJoints(Skeleton& skeleton) { LogError("ParseJoints not
 bool ColladaParser::ParseVertexWeights(std::map<int, std::vector<std::pair<int, float>>>& vertexWeights) { LogError("ParseVertexWeights not implemented."); return true; }
 void ColladaParser::ApplySkinningData(const std::map<int, std::vector<std::pair<int, float>>>& vertexWeights, Mesh& targetMesh) { LogError("ApplySkinningData not implemented."); }
 
-bool ColladaParser::ParseLibraryVisualScenes() { LogError("ParseLibraryVisualScenes not implemented."); return true; }
-bool ColladaParser::ParseNodeHierarchy(int parentJointIndex) { LogError("ParseNodeHierarchy not implemented."); return true; }
-bool ColladaParser::ParseNodeTransform(DirectX::XMFLOAT4X4& outTransform) { LogError("ParseNodeTransform not implemented."); return true; }
+bool ColladaParser::ParseLibraryVisualScenes() {
+    XmlElement library;
+    if (!NextElement(m_sectionBegin, m_sectionEnd, library)) {
+        return true; // <library_visual_scenes/>
+    }
+    XmlElement scene;
+    for (size_t offset = library.ContentBegin; NextElement(offset, library.ContentEnd, scene); offset = scene.End) {
+        if (scene.Name != "visual_scene") continue;
+        XmlElement node;
+        for (size_t nodeOffset = scene.ContentBegin; NextElement(nodeOffset, scene.ContentEnd, node); nodeOffset = node.End) {
+            if (node.Name == "node" && !ParseNodeHierarchy(node, DirectX::XMMatrixIdentity())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ColladaParser::ParseNodeHierarchy(const XmlElement& node, DirectX::FXMMATRIX parentTransform) {
+    using namespace DirectX;
+    std::string name = GetAttribute(node, "name");
+    if (name.empty()) name = GetAttribute(node, "id");
+    StringId nameId = name.empty() ? StringId() : StringId::Intern(name);
+
+    // Transform elements come before the instances and child nodes (schema order)
+    XMMATRIX local = XMMatrixIdentity();
+    XMMATRIX world = parentTransform;
+    XmlElement child;
+    for (size_t offset = node.ContentBegin; NextElement(offset, node.ContentEnd, child); offset = child.End) {
+        if (ParseNodeTransform(child, local)) {
+            world = XMMatrixMultiply(local, parentTransform);
+            if (!name.empty()) XMStoreFloat4x4(&m_nodeTransforms[name], world);
+        } else if (child.Name == "instance_geometry") {
+            // A reference only: the geometry's meshes are parsed once and shared by all its instances
+            PendingInstance instance;
+            instance.GeometryId = GetIdFromUri(GetAttribute(child, "url"));
+            XMStoreFloat4x4(&instance.Transform, world);
+            instance.NodeNameId = nameId;
+            m_pendingInstances.push_back(std::move(instance));
+        } else if (child.Name == "node") {
+            // Joints (type="JOINT") are walked like any node; the skeleton is built from <library_controllers>
+            if (!ParseNodeHierarchy(child, world)) return false;
+        }
+        // <instance_controller> (skinned meshes, bound through the skin), <instance_node>, <instance_light>, ... are skipped for now
+    }
+    return true;
+}
+
+bool ColladaParser::ParseNodeTransform(const XmlElement& element, DirectX::XMMATRIX& inOutLocal) {
+    using namespace DirectX;
+    // Collada composes transforms left to right for column vectors, so with row vectors each
+    // later element is applied before (multiplied in front of) the ones already read
+    std::vector<float> values;
+    XMMATRIX transform;
+    if (element.Name == "matrix") {
+        XMFLOAT4X4 matrix;
+        if (!ParseMatrix(GetElementText(element), matrix)) return true; // Logged, element ignored
+        transform = XMLoadFloat4x4(&matrix);
+    } else if (element.Name == "translate" || element.Name == "scale" || element.Name == "rotate") {
+        size_t expected = element.Name == "rotate" ? 4 : 3;
+        if (!ParseFloatArray(GetElementText(element), values) || values.size() != expected) {
+            LogError("Expected " + std::to_string(expected) + " floats in <" + element.Name + ">.");
+            return true;
+        }
+        if (element.Name == "translate") {
+            transform = XMMatrixTranslation(values[0], values[1], values[2]);
+        } else if (element.Name == "scale") {
+            transform = XMMatrixScaling(values[0], values[1], values[2]);
+        } else {
+            XMVECTOR axis = XMVectorSet(values[0], values[1], values[2], 0.0f);
+            if (XMVector3Equal(axis, XMVectorZero())) return true;
+            transform = XMMatrixRotationAxis(axis, XMConvertToRadians(values[3]));
+        }
+    } else {
+        return false; // <lookat> and <skew> are rare in exported files and not supported
+    }
+    inOutLocal = XMMatrixMultiply(transform, inOutLocal);
+    return true;
+}
+
+void ColladaParser::ResolveInstances() {
+    Model& model = *m_pCurrentModel;
+    for (const PendingInstance& pending : m_pendingInstances) {
+        auto it = m_geometryMeshes.find(pending.GeometryId);
+        if (it == m_geometryMeshes.end()) {
+            LogError("<instance_geometry> references unknown geometry '" + pending.GeometryId + "'.");
+            continue;
+        }
+        // One instance per primitive mesh of the geometry, all pointing at the same shared meshes
+        for (uint32_t i = 0; i < it->second.MeshCount; ++i) {
+            MeshInstance instance;
+            instance.Transform = pending.Transform;
+            instance.MeshIndex = it->second.FirstMesh + i;
+            instance.NodeNameId = pending.NodeNameId;
+            if (instance.MeshIndex < model.Meshes.size()) {
+                model.Instances.push_back(instance);
+            }
+        }
+    }
+    m_pendingInstances.clear();
+}
 
 bool ColladaParser::ParseLibraryAnimations() { LogError("ParseLibraryAnimations not implemented."); return true; }
 bool ColladaParser::ParseAnimation(AnimationClip& clip) { LogError("ParseAnimation not implemented."); return true; }
@@ -165,6 +484,12 @@ std::string ColladaParser::GetIdFromUri(const std::string& uri) {
 
 
 void ColladaParser::LogError(const std::string& message) {
+    m_lastError = message;
+    if (!m_logErrors) {
+        return;
+    }
     std::cerr << "Collada Parser Error (Line " << m_lineNumber << "): " << message << std::endl;
+#ifdef _WIN32
     OutputDebugStringA(("Collada Parser Error (Line " + std::to_string(m_lineNumber) + "): " + message + "\n").c_str());
+#endif
 }
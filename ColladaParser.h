@@ -4,7 +4,6 @@
 
 #pragma once
 
-#include "pch.h"
 #include "AssetTypes.h" // Includes Model, Mesh, Material, Skeleton, AnimationClip etc.
 #include <string>
 #include <vector>
@@ -34,6 +33,24 @@
  *  ****************************************************************************
 */
 
+// Time spent in one kind of top level element (<library_geometries>, <asset>, ...): finding the
+// element's bounds in the text, then its section parser
+struct ColladaSectionStats {
+    std::string Name;
+    size_t Bytes = 0;     // Summed over all elements of this name
+    double Seconds = 0.0;
+    bool ScanOnly = true; // No section parser yet (placeholder or skipped): Seconds is scanning alone
+};
+
+// Filled by every ParseFile call (see ColladaBenchmark)
+struct ColladaParseStats {
+    size_t FileBytes = 0;
+    double ReadSeconds = 0.0;  // Loading the file into memory
+    double TotalSeconds = 0.0; // Read + scan + all sections
+    bool SectionsParsed = false; // Read and every section parser succeeded (ParseFile still fails while IsImplemented is false)
+    std::vector<ColladaSectionStats> Sections; // In order of first appearance
+};
+
 class ColladaParser {
 public:
     ColladaParser();
@@ -44,12 +61,28 @@ public:
     // Fills the 'outModel' structure.
     bool ParseFile(const std::wstring& filePath, Model& outModel);
 
+    // False while the section parsers are placeholders: ParseFile never produces a model, so
+    // callers (AssetCooker) skip .dae input as unsupported instead of failing on every file
+    static constexpr bool IsImplemented = false;
+
+    const ColladaParseStats& GetLastStats() const { return m_stats; }
+
+    // Off: errors are only kept for GetLastError, nothing is written to the console or debugger.
+    // Benchmarks turn it off so the placeholder sections' messages stay out of the timed parse.
+    void SetLogErrors(bool logErrors) { m_logErrors = logErrors; }
+    const std::string& GetLastError() const { return m_lastError; }
+
 private:
     // --- Internal State (needed for manual parsing) ---
-    std::ifstream m_fileStream;
-    std::string m_currentLine;
+    std::string m_fileData;      // Whole file, read in one go
+    size_t m_sectionBegin = 0;   // Current top level element in m_fileData: [begin, end)
+    size_t m_sectionEnd = 0;
     int m_lineNumber = 0;
     Model* m_pCurrentModel = nullptr; // Pointer to the model being built
+    ColladaParseStats m_stats;
+    bool m_logErrors = true;
+    bool m_scanFailed = false; // FindNextSection stopped on malformed text rather than at the end
+    std::string m_lastError;
 
     // Temporary storage during parsing
     std::map<std::string, std::vector<float>> m_floatSources; // Store <source id="..."> data
@@ -57,6 +90,42 @@ private:
     std::map<std::string, DirectX::XMFLOAT4X4> m_nodeTransforms; // Store transforms from <visual_scene>
     // ... and many more maps to track IDs and resolve references ...
 
+    // Meshes the primitives of one <geometry> became (ParseGeometry appends them to the model)
+    struct GeometryMeshes {
+        uint32_t FirstMesh = 0;
+        uint32_t MeshCount = 0;
+    };
+    std::map<std::string, GeometryMeshes> m_geometryMeshes; // By geometry id
+    // <instance_geometry> references from the visual scene. Resolved to mesh indices after all
+    // sections are parsed, so every node using a geometry shares its meshes instead of copying them.
+    struct PendingInstance {
+        std::string GeometryId;
+        DirectX::XMFLOAT4X4 Transform;
+        StringId NodeNameId;
+    };
+    std::vector<PendingInstance> m_pendingInstances;
+
+    // One element inside m_fileData
+    struct XmlElement {
+        std::string Name;
+        size_t Begin = 0;        // '<' of the start tag
+        size_t ContentBegin = 0; // After the start tag
+        size_t ContentEnd = 0;   // '<' of the end tag (== ContentBegin for <element/>)
+        size_t End = 0;          // After the end tag
+    };
+
+
+    // Finds the next top level element (child of <COLLADA>) at or after 'offset'
+    bool FindNextSection(size_t offset, std::string& outName, size_t& outBegin, size_t& outEnd);
+    // Dispatches a top level element to its section parser
+    bool ParseSection(const std::string& name);
+    // False for sections ParseSection skips or hands to a placeholder
+    static bool HasSectionParser(const std::string& name);
+    // Next element starting in [offset, end), skipping comments and processing instructions. Nested
+    // elements of the same name (<node> in <node>) are matched, so 'outElement.End' skips the whole subtree.
+    bool NextElement(size_t offset, size_t end, XmlElement& outElement);
+    std::string GetAttribute(const XmlElement& element, const std::string& attributeName);
+    std::string GetElementText(const XmlElement& element);
 
     // --- Core Parsing Logic (Placeholders - These need FULL implementation) ---
 
@@ -74,7 +143,7 @@ private:
     bool ParseStringArray(const std::string& text, std::vector<std::string>& outStrings);
     // Helper to parse matrices (often 16 floats)
     bool ParseMatrix(const std::string& text, DirectX::XMFLOAT4X4& outMatrix);
-     // Helper to parse Dual Quaternions (8 floats)
+     // Helper to parse Dual Quaternions (8 floats: real x y z w, dual x y z w), normalized to a unit rigid transform
     bool ParseDualQuaternion(const std::string& text, DualQuaternion& outDQ);
 
     // --- Section Parsers (High-Level Placeholders) ---
@@ -98,8 +167,10 @@ private:
             void ApplySkinningData(const std::map<int, std::vector<std::pair<int, float>>>& vertexWeights, Mesh& targetMesh);
 
     bool ParseLibraryVisualScenes(); // <library_visual_scenes> -> <visual_scene> -> <node>
-        bool ParseNodeHierarchy(int parentJointIndex = -1); // Recursive node parsing
-            bool ParseNodeTransform(DirectX::XMFLOAT4X4& outTransform); // <matrix>, <translate>, <rotate>, <scale>
+        bool ParseNodeHierarchy(const XmlElement& node, DirectX::FXMMATRIX parentTransform); // Recursive node parsing
+            // <matrix>, <translate>, <rotate>, <scale>: applied to 'inOutLocal' in document order. False for other elements.
+            bool ParseNodeTransform(const XmlElement& element, DirectX::XMMATRIX& inOutLocal);
+        void ResolveInstances(); // m_pendingInstances -> Model::Instances
 
     bool ParseLibraryAnimations(); // <library_animations> -> <animation>
         bool ParseAnimation(AnimationClip& clip);
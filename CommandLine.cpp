@@ -0,0 +1,94 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "CommandLine.h"
+#include <cwchar>
+#include <cwctype>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// "-min 5": an option and its value. Negative numbers are values, not options.
+bool IsOption(const std::wstring& argument) {
+    return argument.size() > 1 && argument[0] == L'-' && !std::iswdigit(argument[1]) && argument[1] != L'.';
+}
+
+} // namespace
+
+CommandLineArguments SplitCommandLine(const std::wstring& commandLine) {
+    CommandLineArguments arguments;
+    std::wstring current;
+    bool quoted = false, pending = false;
+    for (wchar_t c : commandLine) {
+        if (c == L'"') {
+            quoted = !quoted;
+            pending = true; // "" is an empty argument
+        } else if (!quoted && std::iswspace(c)) {
+            if (pending) {
+                arguments.push_back(std::move(current));
+                current.clear();
+                pending = false;
+            }
+        } else {
+            current.push_back(c);
+            pending = true;
+        }
+    }
+    if (pending) {
+        arguments.push_back(std::move(current));
+    }
+    return arguments;
+}
+
+bool RunCommandLineTool(const CommandLineTool* tools, size_t toolCount, const CommandLineArguments& arguments, int& outExitCode) {
+    if (arguments.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < toolCount; ++i) {
+        if (arguments[0] == tools[i].Flag) {
+            outExitCode = tools[i].Run(CommandLineArguments(arguments.begin() + 1, arguments.end()));
+            return true;
+        }
+    }
+    return false;
+}
+
+void PrintCommandLineTools(const CommandLineTool* tools, size_t toolCount) {
+    std::ostringstream list;
+    for (size_t i = 0; i < toolCount; ++i) {
+        std::wstring line = std::wstring(tools[i].Flag) + L" " + tools[i].Usage;
+        list << "  " << std::string(line.begin(), line.end()) << "\n"; // Flags and usage are ASCII
+    }
+    std::cout << list.str();
+}
+
+std::wstring GetArgument(const CommandLineArguments& arguments, size_t index, const std::wstring& fallback) {
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        if (IsOption(arguments[i])) {
+            ++i; // And its value
+        } else if (index-- == 0) {
+            return arguments[i];
+        }
+    }
+    return fallback;
+}
+
+size_t GetCountArgument(const CommandLineArguments& arguments, size_t index, size_t fallback) {
+    std::wstring text = GetArgument(arguments, index, L"");
+    wchar_t* end = nullptr;
+    long long value = std::wcstoll(text.c_str(), &end, 10);
+    return (end != text.c_str() && value > 0) ? static_cast<size_t>(value) : fallback;
+}
+
+double GetNumberOption(const CommandLineArguments& arguments, const std::wstring& option, double fallback) {
+    for (size_t i = 0; i + 1 < arguments.size(); ++i) {
+        if (arguments[i] == option) {
+            wchar_t* end = nullptr;
+            double value = std::wcstod(arguments[i + 1].c_str(), &end);
+            return end != arguments[i + 1].c_str() ? value : fallback;
+        }
+    }
+    return fallback;
+}
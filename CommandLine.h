@@ -0,0 +1,36 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// The arguments after a tool's flag
+using CommandLineArguments = std::vector<std::wstring>;
+
+// A test or benchmark run from the command line instead of the game ("-mixbench 512").
+// 'Run' returns the process exit code (0 passed, 1 failed).
+struct CommandLineTool {
+    const wchar_t* Flag;
+    const wchar_t* Usage; // Arguments and what the tool does, for the tool list
+    int (*Run)(const CommandLineArguments& arguments);
+};
+
+// Splits on whitespace; double quotes keep a path with spaces in one argument
+CommandLineArguments SplitCommandLine(const std::wstring& commandLine);
+
+// Runs the tool whose flag is arguments[0] with the arguments after it. False when no tool has
+// the flag (no arguments, or the game's own options).
+bool RunCommandLineTool(const CommandLineTool* tools, size_t toolCount, const CommandLineArguments& arguments, int& outExitCode);
+// One line per tool to std::cout
+void PrintCommandLineTools(const CommandLineTool* tools, size_t toolCount);
+
+// Positional argument 'index' (options like "-min 5" are skipped), or 'fallback' when missing
+std::wstring GetArgument(const CommandLineArguments& arguments, size_t index, const std::wstring& fallback);
+// Positional argument 'index' as a count; 'fallback' when missing, not a number or not positive
+size_t GetCountArgument(const CommandLineArguments& arguments, size_t index, size_t fallback);
+// The number after 'option' ("-min 5"), or 'fallback'
+double GetNumberOption(const CommandLineArguments& arguments, const std::wstring& option, double fallback);
@@ -0,0 +1,161 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#ifdef _WIN32
+#include "pch.h"
+#endif
+#include "ContentHash.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t kC1 = 0x87c37b91114253d5ULL;
+constexpr uint64_t kC2 = 0x4cf5ad432745937fULL;
+
+inline uint64_t Rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t FinalMix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+inline uint64_t LoadLE64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v)); // x86/x64 are little endian
+    return v;
+}
+
+} // namespace
+
+
+std::string Hash128::ToString() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string result(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        result[15 - i] = digits[(High >> (i * 4)) & 0xf];
+        result[31 - i] = digits[(Low >> (i * 4)) & 0xf];
+    }
+    return result;
+}
+
+
+ContentHasher::ContentHasher(uint64_t seed) : m_h1(seed), m_h2(seed) {}
+
+void ContentHasher::ProcessBlock(const uint8_t* block) {
+    uint64_t k1 = LoadLE64(block);
+    uint64_t k2 = LoadLE64(block + 8);
+
+    k1 *= kC1; k1 = Rotl64(k1, 31); k1 *= kC2; m_h1 ^= k1;
+    m_h1 = Rotl64(m_h1, 27); m_h1 += m_h2; m_h1 = m_h1 * 5 + 0x52dce729;
+
+    k2 *= kC2; k2 = Rotl64(k2, 33); k2 *= kC1; m_h2 ^= k2;
+    m_h2 = Rotl64(m_h2, 31); m_h2 += m_h1; m_h2 = m_h2 * 5 + 0x38495ab5;
+}
+
+void ContentHasher::Update(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_totalLength += size;
+
+    // Complete a partially filled block from a previous Update
+    if (m_tailSize > 0) {
+        size_t take = std::min(size, sizeof(m_tail) - m_tailSize);
+        memcpy(m_tail + m_tailSize, bytes, take);
+        m_tailSize += take;
+        bytes += take;
+        size -= take;
+        if (m_tailSize < sizeof(m_tail)) {
+            return;
+        }
+        ProcessBlock(m_tail);
+        m_tailSize = 0;
+    }
+
+    while (size >= 16) {
+        ProcessBlock(bytes);
+        bytes += 16;
+        size -= 16;
+    }
+
+    memcpy(m_tail, bytes, size);
+    m_tailSize = size;
+}
+
+Hash128 ContentHasher::Finalize() const {
+    uint64_t h1 = m_h1;
+    uint64_t h2 = m_h2;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    const uint8_t* tail = m_tail;
+
+    switch (m_tailSize & 15) {
+    case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48; // fallthrough
+    case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40; // fallthrough
+    case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32; // fallthrough
+    case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24; // fallthrough
+    case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16; // fallthrough
+    case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8;   // fallthrough
+    case 9:  k2 ^= static_cast<uint64_t>(tail[8]);
+             k2 *= kC2; k2 = Rotl64(k2, 33); k2 *= kC1; h2 ^= k2; // fallthrough
+    case 8:  k1 ^= static_cast<uint64_t>(tail[7]) << 56; // fallthrough
+    case 7:  k1 ^= static_cast<uint64_t>(tail[6]) << 48; // fallthrough
+    case 6:  k1 ^= static_cast<uint64_t>(tail[5]) << 40; // fallthrough
+    case 5:  k1 ^= static_cast<uint64_t>(tail[4]) << 32; // fallthrough
+    case 4:  k1 ^= static_cast<uint64_t>(tail[3]) << 24; // fallthrough
+    case 3:  k1 ^= static_cast<uint64_t>(tail[2]) << 16; // fallthrough
+    case 2:  k1 ^= static_cast<uint64_t>(tail[1]) << 8;  // fallthrough
+    case 1:  k1 ^= static_cast<uint64_t>(tail[0]);
+             k1 *= kC1; k1 = Rotl64(k1, 31); k1 *= kC2; h1 ^= k1;
+    }
+
+    h1 ^= m_totalLength;
+    h2 ^= m_totalLength;
+    h1 += h2;
+    h2 += h1;
+    h1 = FinalMix64(h1);
+    h2 = FinalMix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    Hash128 result;
+    result.Low = h1;
+    result.High = h2;
+    return result;
+}
+
+Hash128 ContentHasher::Hash(const void* data, size_t size, uint64_t seed) {
+    ContentHasher hasher(seed);
+    hasher.Update(data, size);
+    return hasher.Finalize();
+}
+
+bool ContentHasher::HashFile(const std::wstring& filePath, Hash128& outHash) {
+    std::ifstream file(std::filesystem::path(filePath), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    ContentHasher hasher;
+    std::vector<char> buffer(1 << 20); // 1 MB chunks
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize got = file.gcount();
+        if (got <= 0) break;
+        hasher.Update(buffer.data(), static_cast<size_t>(got));
+    }
+    outHash = hasher.Finalize();
+    return true;
+}
+
+Hash128 ContentHasher::Combine(const Hash128& a, const Hash128& b) {
+    uint64_t words[4] = { a.Low, a.High, b.Low, b.High };
+    return Hash(words, sizeof(words));
+}
@@ -0,0 +1,44 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 128-bit content hash (MurmurHash3 x64 128)
+struct Hash128 {
+    uint64_t Low = 0;
+    uint64_t High = 0;
+
+    bool operator==(const Hash128& other) const { return Low == other.Low && High == other.High; }
+    bool operator!=(const Hash128& other) const { return !(*this == other); }
+    bool operator<(const Hash128& other) const { return High < other.High || (High == other.High && Low < other.Low); }
+
+    std::string ToString() const; // 32 hex digits
+};
+
+// Incremental hasher so large files can be hashed in chunks
+class ContentHasher {
+public:
+    explicit ContentHasher(uint64_t seed = 0);
+
+    void Update(const void* data, size_t size);
+    Hash128 Finalize() const;
+
+    // One-shot helpers
+    static Hash128 Hash(const void* data, size_t size, uint64_t seed = 0);
+    static bool HashFile(const std::wstring& filePath, Hash128& outHash);
+    static Hash128 Combine(const Hash128& a, const Hash128& b);
+
+private:
+    uint64_t m_h1;
+    uint64_t m_h2;
+    uint64_t m_totalLength = 0;
+    uint8_t m_tail[16];
+    size_t m_tailSize = 0;
+
+    void ProcessBlock(const uint8_t* block);
+};
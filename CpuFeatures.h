@@ -0,0 +1,8 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+// AVX2 and FMA3 are supported by the CPU and their YMM state is saved by the OS
+bool CpuSupportsAvx2();
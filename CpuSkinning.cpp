@@ -0,0 +1,448 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "CpuSkinning.h"
+#include "Timing.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include <immintrin.h>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace DirectX;
+
+namespace {
+
+constexpr size_t LANES = 8;
+
+inline size_t PaddedCount(size_t count) { return (count + LANES - 1) / LANES * LANES; }
+
+// Vertex ranges (multiples of 8) on the job system, or all on the caller
+template <typename Fn>
+void ForEachRange(size_t paddedCount, size_t batchSize, JobSystem* jobSystem, const Fn& fn) {
+    batchSize = PaddedCount(std::max<size_t>(batchSize, LANES));
+    if (jobSystem && jobSystem->GetWorkerCount() > 0 && paddedCount > batchSize) {
+        jobSystem->ParallelFor(paddedCount, batchSize, fn);
+    } else {
+        fn(0, paddedCount);
+    }
+}
+
+// Scalar reference, one vertex at a time
+
+void SkinLinearScalar(const SkinningInput& input, const XMFLOAT4X4A* palette, SkinnedVertexStreams& out, size_t begin, size_t end) {
+    const SkinnedVertexStreams& bind = input.Bind;
+    for (size_t i = begin; i < end; ++i) {
+        XMMATRIX m;
+        m.r[0] = m.r[1] = m.r[2] = m.r[3] = XMVectorZero();
+        for (size_t k = 0; k < 4; ++k) {
+            float w = input.Weights[k][i];
+            if (w == 0.0f) continue;
+            XMMATRIX joint = XMLoadFloat4x4A(&palette[input.Joints[k][i]]);
+            XMVECTOR weight = XMVectorReplicate(w);
+            for (int r = 0; r < 4; ++r) m.r[r] = XMVectorMultiplyAdd(joint.r[r], weight, m.r[r]);
+        }
+        XMVECTOR p = XMVector3Transform(XMVectorSet(bind.PositionX[i], bind.PositionY[i], bind.PositionZ[i], 1.0f), m);
+        XMVECTOR n = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(bind.NormalX[i], bind.NormalY[i], bind.NormalZ[i], 0.0f), m));
+        out.PositionX[i] = XMVectorGetX(p); out.PositionY[i] = XMVectorGetY(p); out.PositionZ[i] = XMVectorGetZ(p);
+        out.NormalX[i] = XMVectorGetX(n); out.NormalY[i] = XMVectorGetY(n); out.NormalZ[i] = XMVectorGetZ(n);
+    }
+}
+
+// v rotated by the unit quaternion q: v + 2 * cross(q.xyz, cross(q.xyz, v) + q.w * v)
+inline XMVECTOR RotateByQuaternion(FXMVECTOR v, FXMVECTOR q) {
+    XMVECTOR t = XMVectorMultiplyAdd(XMVectorSplatW(q), v, XMVector3Cross(q, v));
+    return XMVectorMultiplyAdd(XMVectorReplicate(2.0f), XMVector3Cross(q, t), v);
+}
+
+void SkinDualQuaternionScalar(const SkinningInput& input, const DualQuaternion* palette, SkinnedVertexStreams& out, size_t begin, size_t end) {
+    const SkinnedVertexStreams& bind = input.Bind;
+    for (size_t i = begin; i < end; ++i) {
+        XMVECTOR pivot = XMLoadFloat4(&palette[input.Joints[0][i]].Real);
+        XMVECTOR real = XMVectorZero();
+        XMVECTOR dual = XMVectorZero();
+        for (size_t k = 0; k < 4; ++k) {
+            float w = input.Weights[k][i];
+            if (w == 0.0f) continue;
+            const DualQuaternion& dq = palette[input.Joints[k][i]];
+            XMVECTOR r = XMLoadFloat4(&dq.Real);
+            // Blend in the hemisphere of the first influence (q and -q are the same rotation)
+            if (XMVectorGetX(XMVector4Dot(pivot, r)) < 0.0f) w = -w;
+            real = XMVectorMultiplyAdd(r, XMVectorReplicate(w), real);
+            dual = XMVectorMultiplyAdd(XMLoadFloat4(&dq.Dual), XMVectorReplicate(w), dual);
+        }
+        XMVECTOR inverseLength = XMVectorReciprocalSqrt(XMVector4Dot(real, real));
+        real = XMVectorMultiply(real, inverseLength);
+        dual = XMVectorMultiply(dual, inverseLength);
+        // Translation 2 * (r.w * d.xyz - d.w * r.xyz + cross(r.xyz, d.xyz))
+        XMVECTOR translation = XMVectorScale(XMVectorAdd(XMVectorSubtract(XMVectorMultiply(XMVectorSplatW(real), dual),
+                                                                          XMVectorMultiply(XMVectorSplatW(dual), real)),
+                                                         XMVector3Cross(real, dual)), 2.0f);
+        XMVECTOR p = XMVectorAdd(RotateByQuaternion(XMVectorSet(bind.PositionX[i], bind.PositionY[i], bind.PositionZ[i], 0.0f), real), translation);
+        XMVECTOR n = RotateByQuaternion(XMVectorSet(bind.NormalX[i], bind.NormalY[i], bind.NormalZ[i], 0.0f), real);
+        out.PositionX[i] = XMVectorGetX(p); out.PositionY[i] = XMVectorGetY(p); out.PositionZ[i] = XMVectorGetZ(p);
+        out.NormalX[i] = XMVectorGetX(n); out.NormalY[i] = XMVectorGetY(n); out.NormalZ[i] = XMVectorGetZ(n);
+    }
+}
+
+// AVX2 kernels, 8 vertices per iteration
+
+inline __m256 Cross(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz, __m256& outY, __m256& outZ) {
+    outY = _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz));
+    outZ = _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx));
+    return _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by));
+}
+
+inline void Normalize(__m256& x, __m256& y, __m256& z) {
+    __m256 lengthSq = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_mul_ps(z, z)));
+    __m256 inverse = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_max_ps(lengthSq, _mm256_set1_ps(1e-30f))));
+    x = _mm256_mul_ps(x, inverse);
+    y = _mm256_mul_ps(y, inverse);
+    z = _mm256_mul_ps(z, inverse);
+}
+
+inline bool AnyWeight(__m256 weights) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(weights, _mm256_setzero_ps(), _CMP_NEQ_OQ)) != 0;
+}
+
+void SkinLinearAvx2(const SkinningInput& input, const XMFLOAT4X4A* palette, SkinnedVertexStreams& out, size_t begin, size_t end) {
+    // The 12 affine entries of a row-vector matrix: rows 0-2 (rotation / scale) and row 3 (translation), xyz
+    static const int OFFSETS[12] = { 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14 };
+    const float* base = &palette[0]._11;
+    const SkinnedVertexStreams& bind = input.Bind;
+    for (size_t i = begin; i < end; i += LANES) {
+        __m256 m[12];
+        for (__m256& entry : m) entry = _mm256_setzero_ps();
+        for (size_t k = 0; k < 4; ++k) {
+            __m256 w = _mm256_loadu_ps(&input.Weights[k][i]);
+            if (k > 0 && !AnyWeight(w)) continue;
+            __m256i index = _mm256_slli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.Joints[k][i])), 4);
+            for (int c = 0; c < 12; ++c) {
+                m[c] = _mm256_fmadd_ps(w, _mm256_i32gather_ps(base + OFFSETS[c], index, 4), m[c]);
+            }
+        }
+        __m256 x = _mm256_loadu_ps(&bind.PositionX[i]);
+        __m256 y = _mm256_loadu_ps(&bind.PositionY[i]);
+        __m256 z = _mm256_loadu_ps(&bind.PositionZ[i]);
+        _mm256_storeu_ps(&out.PositionX[i], _mm256_fmadd_ps(x, m[0], _mm256_fmadd_ps(y, m[3], _mm256_fmadd_ps(z, m[6], m[9]))));
+        _mm256_storeu_ps(&out.PositionY[i], _mm256_fmadd_ps(x, m[1], _mm256_fmadd_ps(y, m[4], _mm256_fmadd_ps(z, m[7], m[10]))));
+        _mm256_storeu_ps(&out.PositionZ[i], _mm256_fmadd_ps(x, m[2], _mm256_fmadd_ps(y, m[5], _mm256_fmadd_ps(z, m[8], m[11]))));
+
+        x = _mm256_loadu_ps(&bind.NormalX[i]);
+        y = _mm256_loadu_ps(&bind.NormalY[i]);
+        z = _mm256_loadu_ps(&bind.NormalZ[i]);
+        __m256 nx = _mm256_fmadd_ps(x, m[0], _mm256_fmadd_ps(y, m[3], _mm256_mul_ps(z, m[6])));
+        __m256 ny = _mm256_fmadd_ps(x, m[1], _mm256_fmadd_ps(y, m[4], _mm256_mul_ps(z, m[7])));
+        __m256 nz = _mm256_fmadd_ps(x, m[2], _mm256_fmadd_ps(y, m[5], _mm256_mul_ps(z, m[8])));
+        Normalize(nx, ny, nz);
+        _mm256_storeu_ps(&out.NormalX[i], nx);
+        _mm256_storeu_ps(&out.NormalY[i], ny);
+        _mm256_storeu_ps(&out.NormalZ[i], nz);
+    }
+}
+
+void SkinDualQuaternionAvx2(const SkinningInput& input, const DualQuaternion* palette, SkinnedVertexStreams& out, size_t begin, size_t end) {
+    const float* base = &palette[0].Real.x;
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const SkinnedVertexStreams& bind = input.Bind;
+    for (size_t i = begin; i < end; i += LANES) {
+        __m256 r[4], d[4], pivot[4];
+        for (size_t k = 0; k < 4; ++k) {
+            __m256 w = _mm256_loadu_ps(&input.Weights[k][i]);
+            if (k > 0 && !AnyWeight(w)) continue;
+            __m256i index = _mm256_slli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.Joints[k][i])), 3);
+            __m256 real[4], dual[4];
+            for (int c = 0; c < 4; ++c) {
+                real[c] = _mm256_i32gather_ps(base + c, index, 4);
+                dual[c] = _mm256_i32gather_ps(base + 4 + c, index, 4);
+            }
+            if (k == 0) {
+                for (int c = 0; c < 4; ++c) {
+                    pivot[c] = real[c];
+                    r[c] = _mm256_mul_ps(w, real[c]);
+                    d[c] = _mm256_mul_ps(w, dual[c]);
+                }
+                continue;
+            }
+            // Weight negated where the rotation is in the other hemisphere than the first influence's
+            __m256 dot = _mm256_fmadd_ps(pivot[0], real[0], _mm256_fmadd_ps(pivot[1], real[1],
+                         _mm256_fmadd_ps(pivot[2], real[2], _mm256_mul_ps(pivot[3], real[3]))));
+            w = _mm256_xor_ps(w, _mm256_and_ps(dot, signMask));
+            for (int c = 0; c < 4; ++c) {
+                r[c] = _mm256_fmadd_ps(w, real[c], r[c]);
+                d[c] = _mm256_fmadd_ps(w, dual[c], d[c]);
+            }
+        }
+        __m256 lengthSq = _mm256_fmadd_ps(r[0], r[0], _mm256_fmadd_ps(r[1], r[1], _mm256_fmadd_ps(r[2], r[2], _mm256_mul_ps(r[3], r[3]))));
+        __m256 inverse = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_max_ps(lengthSq, _mm256_set1_ps(1e-30f))));
+        for (int c = 0; c < 4; ++c) {
+            r[c] = _mm256_mul_ps(r[c], inverse);
+            d[c] = _mm256_mul_ps(d[c], inverse);
+        }
+
+        // Translation 2 * (r.w * d.xyz - d.w * r.xyz + cross(r.xyz, d.xyz))
+        __m256 cy, cz;
+        __m256 cx = Cross(r[0], r[1], r[2], d[0], d[1], d[2], cy, cz);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        __m256 tx = _mm256_mul_ps(two, _mm256_add_ps(_mm256_fmsub_ps(r[3], d[0], _mm256_mul_ps(d[3], r[0])), cx));
+        __m256 ty = _mm256_mul_ps(two, _mm256_add_ps(_mm256_fmsub_ps(r[3], d[1], _mm256_mul_ps(d[3], r[1])), cy));
+        __m256 tz = _mm256_mul_ps(two, _mm256_add_ps(_mm256_fmsub_ps(r[3], d[2], _mm256_mul_ps(d[3], r[2])), cz));
+
+        // v + 2 * cross(r.xyz, cross(r.xyz, v) + r.w * v), for the position and the normal
+        auto rotate = [&](__m256& x, __m256& y, __m256& z) {
+            __m256 uy, uz;
+            __m256 ux = Cross(r[0], r[1], r[2], x, y, z, uy, uz);
+            ux = _mm256_fmadd_ps(r[3], x, ux);
+            uy = _mm256_fmadd_ps(r[3], y, uy);
+            uz = _mm256_fmadd_ps(r[3], z, uz);
+            __m256 vy, vz;
+            __m256 vx = Cross(r[0], r[1], r[2], ux, uy, uz, vy, vz);
+            x = _mm256_fmadd_ps(two, vx, x);
+            y = _mm256_fmadd_ps(two, vy, y);
+            z = _mm256_fmadd_ps(two, vz, z);
+        };
+        __m256 x = _mm256_loadu_ps(&bind.PositionX[i]);
+        __m256 y = _mm256_loadu_ps(&bind.PositionY[i]);
+        __m256 z = _mm256_loadu_ps(&bind.PositionZ[i]);
+        rotate(x, y, z);
+        _mm256_storeu_ps(&out.PositionX[i], _mm256_add_ps(x, tx));
+        _mm256_storeu_ps(&out.PositionY[i], _mm256_add_ps(y, ty));
+        _mm256_storeu_ps(&out.PositionZ[i], _mm256_add_ps(z, tz));
+
+        x = _mm256_loadu_ps(&bind.NormalX[i]);
+        y = _mm256_loadu_ps(&bind.NormalY[i]);
+        z = _mm256_loadu_ps(&bind.NormalZ[i]);
+        rotate(x, y, z);
+        _mm256_storeu_ps(&out.NormalX[i], x);
+        _mm256_storeu_ps(&out.NormalY[i], y);
+        _mm256_storeu_ps(&out.NormalZ[i], z);
+    }
+}
+
+} // namespace
+
+void SkinnedVertexStreams::Resize(size_t vertexCount) {
+    VertexCount = vertexCount;
+    size_t padded = PaddedCount(vertexCount);
+    for (std::vector<float>* stream : { &PositionX, &PositionY, &PositionZ, &NormalX, &NormalY, &NormalZ }) {
+        stream->resize(padded, 0.0f);
+    }
+}
+
+bool SkinningInput::Build(const Mesh& mesh, size_t jointCount) {
+    const size_t count = mesh.Vertices.size();
+    if (count == 0) {
+        return false;
+    }
+    Bind.Resize(count);
+    const size_t padded = Bind.PositionX.size();
+    for (size_t k = 0; k < 4; ++k) {
+        // Padding follows joint 0 with weight 1, so it skins like any vertex
+        Joints[k].assign(padded, 0);
+        Weights[k].assign(padded, k == 0 ? 1.0f : 0.0f);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const Vertex& v = mesh.Vertices[i];
+        Bind.PositionX[i] = v.Position.x;
+        Bind.PositionY[i] = v.Position.y;
+        Bind.PositionZ[i] = v.Position.z;
+        Bind.NormalX[i] = v.Normal.x;
+        Bind.NormalY[i] = v.Normal.y;
+        Bind.NormalZ[i] = v.Normal.z;
+
+        const uint32_t joints[4] = { v.BoneIndices.x, v.BoneIndices.y, v.BoneIndices.z, v.BoneIndices.w };
+        const float weights[4] = { v.BoneWeights.x, v.BoneWeights.y, v.BoneWeights.z, v.BoneWeights.w };
+        float sum = 0.0f;
+        size_t used = 0;
+        for (size_t k = 0; k < 4; ++k) {
+            if (weights[k] > 0.0f && joints[k] < jointCount) {
+                Joints[used][i] = static_cast<int32_t>(joints[k]);
+                Weights[used][i] = weights[k];
+                sum += weights[k];
+                ++used;
+            }
+        }
+        if (used == 0) {
+            continue; // Joint 0, weight 1
+        }
+        for (size_t k = 0; k < 4; ++k) {
+            Weights[k][i] = k < used ? Weights[k][i] / sum : 0.0f;
+        }
+    }
+    return true;
+}
+
+SkinningKernel CpuSkinning::GetBestKernel() {
+    static const SkinningKernel best = CpuSupportsAvx2() ? SkinningKernel::Avx2 : SkinningKernel::Scalar;
+    return best;
+}
+
+DualQuaternion CpuSkinning::MakeDualQuaternion(FXMVECTOR rotation, FXMVECTOR translation) {
+    // Dual = 0.5 * translation * rotation (Hamilton product, translation as a pure quaternion)
+    XMVECTOR real = XMQuaternionNormalize(rotation);
+    XMVECTOR t = XMVectorSetW(translation, 0.0f);
+    XMVECTOR dual = XMVectorScale(XMQuaternionMultiply(real, t), 0.5f); // XMQuaternionMultiply(a, b) = b * a
+    DualQuaternion result;
+    XMStoreFloat4(&result.Real, real);
+    XMStoreFloat4(&result.Dual, dual);
+    return result;
+}
+
+void CpuSkinning::BuildDualQuaternionPalette(const XMFLOAT4X4A* skinning, size_t jointCount, DualQuaternion* outPalette) {
+    for (size_t j = 0; j < jointCount; ++j) {
+        XMMATRIX m = XMLoadFloat4x4A(&skinning[j]);
+        // Strip scale so the rotation extraction sees an orthonormal basis
+        for (int r = 0; r < 3; ++r) m.r[r] = XMVector3Normalize(m.r[r]);
+        outPalette[j] = MakeDualQuaternion(XMQuaternionRotationMatrix(m), m.r[3]);
+    }
+}
+
+void CpuSkinning::SkinLinear(const SkinningInput& input, const XMFLOAT4X4A* palette, SkinnedVertexStreams& out,
+                             JobSystem* jobSystem, SkinningKernel kernel, size_t batchSize) {
+    out.Resize(input.Bind.VertexCount);
+    if (kernel == SkinningKernel::Avx2 && GetBestKernel() == SkinningKernel::Avx2) {
+        ForEachRange(out.PositionX.size(), batchSize, jobSystem, [&](size_t begin, size_t end) { SkinLinearAvx2(input, palette, out, begin, end); });
+    } else {
+        ForEachRange(out.VertexCount, batchSize, jobSystem, [&](size_t begin, size_t end) { SkinLinearScalar(input, palette, out, begin, end); });
+    }
+}
+
+void CpuSkinning::SkinDualQuaternion(const SkinningInput& input, const DualQuaternion* palette, SkinnedVertexStreams& out,
+                                     JobSystem* jobSystem, SkinningKernel kernel, size_t batchSize) {
+    out.Resize(input.Bind.VertexCount);
+    if (kernel == SkinningKernel::Avx2 && GetBestKernel() == SkinningKernel::Avx2) {
+        ForEachRange(out.PositionX.size(), batchSize, jobSystem, [&](size_t begin, size_t end) { SkinDualQuaternionAvx2(input, palette, out, begin, end); });
+    } else {
+        ForEachRange(out.VertexCount, batchSize, jobSystem, [&](size_t begin, size_t end) { SkinDualQuaternionScalar(input, palette, out, begin, end); });
+    }
+}
+
+bool CpuSkinning::RunBenchmark(size_t vertexCount, JobSystem* jobSystem) {
+    vertexCount = std::max<size_t>(vertexCount, 64);
+
+    // Tube of radius 0.1 along +y over a 4 joint chain (0.25 apart); each vertex blends the two
+    // nearest joints, ramping across each joint
+    const size_t jointCount = 4;
+    const float length = 1.0f, radius = 0.1f;
+    const size_t ringSize = 32;
+    const size_t ringCount = std::max<size_t>(vertexCount / ringSize, 2);
+    Mesh mesh;
+    for (size_t ring = 0; ring < ringCount; ++ring) {
+        float y = length * ring / (ringCount - 1);
+        float segment = y / (length / jointCount) - 0.5f;
+        int joint0 = std::max(0, std::min(static_cast<int>(std::floor(segment)), static_cast<int>(jointCount) - 1));
+        int joint1 = std::min(joint0 + 1, static_cast<int>(jointCount) - 1);
+        float blend = std::max(0.0f, std::min(segment - joint0, 1.0f));
+        for (size_t s = 0; s < ringSize; ++s) {
+            float angle = XM_2PI * s / ringSize;
+            Vertex v;
+            v.Position = { radius * std::cos(angle), y, radius * std::sin(angle) };
+            v.Normal = { std::cos(angle), 0.0f, std::sin(angle) };
+            v.BoneIndices = { static_cast<uint32_t>(joint0), static_cast<uint32_t>(joint1), 0, 0 };
+            v.BoneWeights = { 1.0f - blend, joint1 != joint0 ? blend : 0.0f, 0.0f, 0.0f };
+            mesh.Vertices.push_back(v);
+        }
+    }
+    SkinningInput input;
+    input.Build(mesh, jointCount);
+
+    // Each joint twists 90 degrees about the tube axis relative to its parent and bends a little
+    std::vector<XMFLOAT4X4A> palette(jointCount);
+    XMMATRIX parentModel = XMMatrixIdentity();
+    for (size_t j = 0; j < jointCount; ++j) {
+        XMMATRIX local = XMMatrixMultiply(XMMatrixMultiply(XMMatrixRotationY(j > 0 ? XM_PIDIV2 : 0.0f), XMMatrixRotationZ(j > 0 ? 0.2f : 0.0f)),
+                                          XMMatrixTranslation(0.0f, j > 0 ? length / jointCount : 0.0f, 0.0f));
+        XMMATRIX model = XMMatrixMultiply(local, parentModel);
+        XMMATRIX inverseBind = XMMatrixTranslation(0.0f, -(length / jointCount) * j, 0.0f);
+        XMStoreFloat4x4A(&palette[j], XMMatrixMultiply(inverseBind, model));
+        parentModel = model;
+    }
+    std::vector<DualQuaternion> dqPalette(jointCount);
+    BuildDualQuaternionPalette(palette.data(), jointCount, dqPalette.data());
+
+    SkinnedVertexStreams reference[2], result;
+    const bool avx2 = GetBestKernel() == SkinningKernel::Avx2;
+    struct Run { const char* Name; SkinningMode Mode; SkinningKernel Kernel; JobSystem* Jobs; double Seconds; float MaxError; };
+    Run runs[] = {
+        { "LBS scalar     ", SkinningMode::Linear, SkinningKernel::Scalar, nullptr, 0.0, 0.0f },
+        { "LBS AVX2       ", SkinningMode::Linear, SkinningKernel::Avx2, nullptr, 0.0, 0.0f },
+        { "LBS AVX2 jobs  ", SkinningMode::Linear, SkinningKernel::Avx2, jobSystem, 0.0, 0.0f },
+        { "DQS scalar     ", SkinningMode::DualQuaternion, SkinningKernel::Scalar, nullptr, 0.0, 0.0f },
+        { "DQS AVX2       ", SkinningMode::DualQuaternion, SkinningKernel::Avx2, nullptr, 0.0, 0.0f },
+        { "DQS AVX2 jobs  ", SkinningMode::DualQuaternion, SkinningKernel::Avx2, jobSystem, 0.0, 0.0f },
+    };
+    for (Run& run : runs) {
+        const int modeIndex = run.Mode == SkinningMode::Linear ? 0 : 1;
+        SkinnedVertexStreams& out = run.Kernel == SkinningKernel::Scalar ? reference[modeIndex] : result;
+        run.Seconds = 1e30;
+        for (int repeat = 0; repeat < 5; ++repeat) {
+            auto start = std::chrono::high_resolution_clock::now();
+            if (run.Mode == SkinningMode::Linear) {
+                SkinLinear(input, palette.data(), out, run.Jobs, run.Kernel);
+            } else {
+                SkinDualQuaternion(input, dqPalette.data(), out, run.Jobs, run.Kernel);
+            }
+            run.Seconds = std::min(run.Seconds, SecondsSince(start));
+        }
+        for (size_t i = 0; i < out.VertexCount && &out == &result; ++i) {
+            const SkinnedVertexStreams& expected = reference[modeIndex];
+            run.MaxError = std::max({ run.MaxError, std::abs(out.PositionX[i] - expected.PositionX[i]),
+                                      std::abs(out.PositionY[i] - expected.PositionY[i]), std::abs(out.PositionZ[i] - expected.PositionZ[i]),
+                                      std::abs(out.NormalX[i] - expected.NormalX[i]), std::abs(out.NormalY[i] - expected.NormalY[i]),
+                                      std::abs(out.NormalZ[i] - expected.NormalZ[i]) });
+        }
+    }
+
+    // LBS vs DQS: rigid vertices (one influence) must agree; where the twisted joints blend, LBS pulls
+    // the tube toward its axis. Radius kept = mean distance of a ring's vertices from its center / bind radius.
+    float rigidDifference = 0.0f, maxDifference = 0.0f;
+    float linearRadius = 1e30f, dualRadius = 1e30f;
+    for (size_t ring = 0; ring < ringCount; ++ring) {
+        const size_t first = ring * ringSize;
+        XMVECTOR linearCenter = XMVectorZero(), dualCenter = XMVectorZero();
+        for (size_t i = first; i < first + ringSize; ++i) {
+            XMFLOAT3 linear = reference[0].GetPosition(i), dual = reference[1].GetPosition(i);
+            linearCenter = XMVectorAdd(linearCenter, XMLoadFloat3(&linear));
+            dualCenter = XMVectorAdd(dualCenter, XMLoadFloat3(&dual));
+            float difference = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&linear), XMLoadFloat3(&dual))));
+            maxDifference = std::max(maxDifference, difference);
+            if (input.Weights[1][i] == 0.0f) rigidDifference = std::max(rigidDifference, difference);
+        }
+        linearCenter = XMVectorScale(linearCenter, 1.0f / ringSize);
+        dualCenter = XMVectorScale(dualCenter, 1.0f / ringSize);
+        float linearSum = 0.0f, dualSum = 0.0f;
+        for (size_t i = first; i < first + ringSize; ++i) {
+            XMFLOAT3 linear = reference[0].GetPosition(i), dual = reference[1].GetPosition(i);
+            linearSum += XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&linear), linearCenter)));
+            dualSum += XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&dual), dualCenter)));
+        }
+        linearRadius = std::min(linearRadius, linearSum / ringSize / radius);
+        dualRadius = std::min(dualRadius, dualSum / ringSize / radius);
+    }
+
+    bool ok = rigidDifference <= 1e-4f;
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(0);
+    report << "Skinning benchmark: " << input.Bind.VertexCount << " vertices, " << jointCount << " joints, "
+           << (jobSystem ? jobSystem->GetWorkerCount() : 0) << " workers" << (avx2 ? "" : " (no AVX2, scalar only)") << "\n";
+    for (const Run& run : runs) {
+        if (run.Kernel == SkinningKernel::Avx2 && !avx2) continue;
+        report << "  " << run.Name << std::setprecision(0) << input.Bind.VertexCount / std::max(run.Seconds * 1000.0, 1e-9) << " vertices/ms";
+        if (run.Kernel != SkinningKernel::Scalar) {
+            report << std::setprecision(7) << ", max difference to scalar " << run.MaxError;
+            ok = ok && run.MaxError <= 1e-4f;
+        }
+        report << "\n";
+    }
+    report << std::setprecision(5) << "  LBS vs DQS: rigid vertices differ by " << rigidDifference << ", blended by up to " << maxDifference
+           << "; smallest ring radius kept: LBS " << std::setprecision(1) << linearRadius * 100.0f << "%, DQS " << dualRadius * 100.0f << "%\n";
+    if (!ok) {
+        report << "  FAILED: kernels disagree\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
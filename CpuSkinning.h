@@ -0,0 +1,71 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <array>
+#include <vector>
+
+class JobSystem;
+
+enum class SkinningMode : uint8_t {
+    Linear,         // Linear blend of the skinning matrices (supports scale; twists collapse volume)
+    DualQuaternion, // Blended rigid transforms (keeps volume; ignores scale in the palette)
+};
+
+enum class SkinningKernel : uint8_t {
+    Scalar, // One vertex at a time with DirectXMath
+    Avx2,   // 8 vertices per iteration (AVX2 + FMA3, checked at runtime)
+};
+
+// Vertex positions and normals as structure of arrays. Streams are padded to a multiple of 8;
+// entries past VertexCount are scratch.
+struct SkinnedVertexStreams {
+    size_t VertexCount = 0;
+    std::vector<float> PositionX, PositionY, PositionZ;
+    std::vector<float> NormalX, NormalY, NormalZ;
+
+    void Resize(size_t vertexCount);
+    DirectX::XMFLOAT3 GetPosition(size_t index) const { return { PositionX[index], PositionY[index], PositionZ[index] }; }
+    DirectX::XMFLOAT3 GetNormal(size_t index) const { return { NormalX[index], NormalY[index], NormalZ[index] }; }
+};
+
+// Bind pose streams plus 4 joint index / weight streams of a skinned mesh
+struct SkinningInput {
+    SkinnedVertexStreams Bind;
+    std::array<std::vector<int32_t>, 4> Joints;
+    std::array<std::vector<float>, 4> Weights; // Normalized to sum to 1
+
+    // From mesh.Vertices. Influences on joints >= jointCount are dropped; vertices without any weight
+    // follow joint 0. Returns false for a mesh without vertices.
+    bool Build(const Mesh& mesh, size_t jointCount);
+};
+
+// CPU skinning for physics / hit meshes and headless hit-box evaluation (the GPU skins for drawing).
+// Palettes are indexed by Vertex::BoneIndices: skinning matrices (PoseEvaluator) or the dual
+// quaternions made from them. The AVX2 kernels gather the palette entries of 8 vertices per
+// influence, skip influences no vertex of the 8 uses, and run in parallel over vertex ranges.
+class CpuSkinning {
+public:
+    // The fastest kernel this CPU runs
+    static SkinningKernel GetBestKernel();
+
+    // Rigid part of each skinning matrix as a unit dual quaternion (scale is dropped)
+    static void BuildDualQuaternionPalette(const DirectX::XMFLOAT4X4A* skinning, size_t jointCount, DualQuaternion* outPalette);
+    static DualQuaternion MakeDualQuaternion(DirectX::FXMVECTOR rotation, DirectX::FXMVECTOR translation);
+
+    // Skins every vertex of 'input' into 'out' (resized). Vertex ranges of 'batchSize' go to
+    // 'jobSystem' when there is one.
+    static void SkinLinear(const SkinningInput& input, const DirectX::XMFLOAT4X4A* palette, SkinnedVertexStreams& out,
+                           JobSystem* jobSystem = nullptr, SkinningKernel kernel = GetBestKernel(), size_t batchSize = 4096);
+    static void SkinDualQuaternion(const SkinningInput& input, const DualQuaternion* palette, SkinnedVertexStreams& out,
+                                   JobSystem* jobSystem = nullptr, SkinningKernel kernel = GetBestKernel(), size_t batchSize = 4096);
+
+    // Skins a synthetic 'vertexCount' vertex tube on a twisting and bending joint chain with every
+    // kernel in both modes (WinMain "-skinbench"). Reports vertices per millisecond, the kernels'
+    // agreement with the scalar path, and how LBS and DQS differ (volume kept at the twisted joint).
+    static bool RunBenchmark(size_t vertexCount = 200000, JobSystem* jobSystem = nullptr);
+};
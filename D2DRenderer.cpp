@@ -4,6 +4,9 @@
 
 #include "pch.h"
 #include "D2DRenderer.h"
+#include "TextureCooker.h"
+#include "TextureSerializer.h"
+#include "VirtualFileSystem.h"
 
 D2DRenderer::D2DRenderer() {}
 
@@ -174,11 +177,11 @@ void D2DRenderer::DrawText(const std::wstring& text, IDWriteTextFormat* format,
     );
 }
 
-void D2DRenderer::DrawImage(const std::string& imageName, const D2D1_RECT_F& destRect, float opacity, D2D1_INTERPOLATION_MODE interpolation) {
+void D2DRenderer::DrawImage(StringId imageId, const D2D1_RECT_F& destRect, float opacity, D2D1_INTERPOLATION_MODE interpolation) {
     if (!m_pD2DDeviceContext) return;
-    auto it = m_loadedImages.find(imageName);
+    auto it = m_loadedImages.find(imageId);
     if (it == m_loadedImages.end()) {
-        OutputDebugStringA(("Image not found for drawing: " + imageName + "\n").c_str());
+        OutputDebugStringA(("Image not found for drawing: " + imageId.ToString() + "\n").c_str());
         return;
     }
 
@@ -206,68 +209,134 @@ void D2DRenderer::FillRectangle(const D2D1_RECT_F& rect, ID2D1Brush* brush) {
 
 bool D2DRenderer::LoadImageFromFile(const std::wstring& filename, const std::string& imageName) {
     if (!m_pWICFactory || !m_pD2DDeviceContext) return false;
-    if (m_loadedImages.count(imageName)) return true; // Already loaded
+    StringId imageId = StringId::Intern(imageName);
+    if (m_loadedImages.count(imageId)) return true; // Already loaded
+
+    // Read through the VFS so packed images decode from the pack mapping without a copy
+    FileView file;
+    if (!VirtualFileSystem::Get().ReadFile(filename, file)) {
+        OutputDebugString((L"Failed to open image file: " + filename + L"\n").c_str());
+        return false;
+    }
+
+    DecodedImage image;
+    bool isDds = file.Size() >= 4 && std::memcmp(file.Data(), "DDS ", 4) == 0;
+    bool decoded = isDds ? DecodeDds(file.Data(), file.Size(), image)
+                         : DecodeImage(m_pWICFactory.Get(), file.Data(), file.Size(), image);
+    if (!decoded) {
+        OutputDebugString((L"Failed to decode image: " + filename + L"\n").c_str());
+        return false;
+    }
+    return CreateImageFromPixels(image, imageId);
+}
+
+bool D2DRenderer::DecodeImage(IWICImagingFactory* wicFactory, const BYTE* fileData, size_t fileSize, DecodedImage& outImage, bool premultiplied) {
+    if (!wicFactory || !fileData || fileSize == 0 || fileSize > UINT32_MAX) return false;
 
     HRESULT hr;
+    Microsoft::WRL::ComPtr<IWICStream> pStream;
     Microsoft::WRL::ComPtr<IWICBitmapDecoder> pDecoder;
     Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> pSourceFrame;
     Microsoft::WRL::ComPtr<IWICFormatConverter> pConverter;
-    Microsoft::WRL::ComPtr<ID2D1Bitmap> pD2DBitmap;
 
-    // Create decoder for the file
-    hr = m_pWICFactory->CreateDecoderFromFilename(
-        filename.c_str(),
-        NULL, // No preferred vendor
-        GENERIC_READ,
-        WICDecodeMetadataCacheOnLoad, // Cache metadata
-        &pDecoder
-    );
+    // Decode straight from memory, the file was already read by the caller
+    hr = wicFactory->CreateStream(&pStream);
+    if (SUCCEEDED(hr)) {
+        hr = pStream->InitializeFromMemory(const_cast<BYTE*>(fileData), static_cast<DWORD>(fileSize));
+    }
+    if (SUCCEEDED(hr)) {
+        hr = wicFactory->CreateDecoderFromStream(pStream.Get(), NULL, WICDecodeMetadataCacheOnDemand, &pDecoder);
+    }
     if (FAILED(hr)) {
-        OutputDebugString((L"Failed to create WIC decoder for: " + filename + L"\n").c_str());
+        OutputDebugString(L"Failed to create WIC decoder from memory.\n");
         return false;
     }
 
-    // Get the first frame (WIC supports multi-frame images like GIF/TIFF)
     hr = pDecoder->GetFrame(0, &pSourceFrame);
-    if (FAILED(hr)) {
-        OutputDebugString((L"Failed to get WIC frame from: " + filename + L"\n").c_str());
+    if (SUCCEEDED(hr)) {
+        hr = wicFactory->CreateFormatConverter(&pConverter);
+    }
+    if (SUCCEEDED(hr)) {
+        hr = pConverter->Initialize(pSourceFrame.Get(), premultiplied ? GUID_WICPixelFormat32bppPBGRA : GUID_WICPixelFormat32bppBGRA,
+                                    WICBitmapDitherTypeNone, NULL, 0.f, WICBitmapPaletteTypeMedianCut);
+    }
+    UINT width = 0, height = 0;
+    if (SUCCEEDED(hr)) {
+        hr = pConverter->GetSize(&width, &height);
+    }
+    if (FAILED(hr) || width == 0 || height == 0) {
+        OutputDebugString(L"Failed to convert WIC frame.\n");
         return false;
     }
 
-    // Create a format converter to ensure the image is in a D2D-compatible format
-    hr = m_pWICFactory->CreateFormatConverter(&pConverter);
+    outImage.Width = width;
+    outImage.Height = height;
+    outImage.Stride = width * 4;
+    outImage.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    outImage.Pixels.resize(static_cast<size_t>(outImage.Stride) * height);
+    hr = pConverter->CopyPixels(NULL, outImage.Stride, static_cast<UINT>(outImage.Pixels.size()), outImage.Pixels.data());
     if (FAILED(hr)) {
-        OutputDebugString(L"Failed to create WIC format converter.\n");
+        OutputDebugString(L"Failed to copy WIC pixels.\n");
+        outImage.Pixels.clear();
         return false;
     }
+    return true;
+}
 
-    // Initialize the converter
-    hr = pConverter->Initialize(
-        pSourceFrame.Get(),                 // Input bitmap to convert
-        GUID_WICPixelFormat32bppPBGRA,      // Destination pixel format (premultiplied BGRA)
-        WICBitmapDitherTypeNone,            // No dithering
-        NULL,                               // No custom palette
-        0.f,                                // Alpha threshold
-        WICBitmapPaletteTypeMedianCut       // Palette translation type
-    );
-    if (FAILED(hr)) {
-        OutputDebugString(L"Failed to initialize WIC format converter.\n");
+bool D2DRenderer::DecodeDds(const BYTE* fileData, size_t fileSize, DecodedImage& outImage) {
+    CookedTexture texture;
+    if (!TextureSerializer::Deserialize(fileData, fileSize, texture)) {
+        OutputDebugString(L"Failed to read DDS image.\n");
         return false;
     }
+    const TextureMip& top = texture.Mips.front();
+    outImage.Width = top.Width;
+    outImage.Height = top.Height;
+
+    // D2D draws BC1-BC3 as premultiplied; its blending ignores sRGB, like the WIC path
+    DXGI_FORMAT format = TextureSerializer::ToLinearFormat(texture.Format);
+    bool drawable = format == DXGI_FORMAT_BC1_UNORM || format == DXGI_FORMAT_BC2_UNORM || format == DXGI_FORMAT_BC3_UNORM;
+    if (drawable && (texture.Premultiplied || format == DXGI_FORMAT_BC1_UNORM)) {
+        outImage.Format = format;
+        outImage.Stride = top.RowPitch;
+        outImage.Pixels.assign(texture.Data.begin() + top.Offset, texture.Data.begin() + top.Offset + top.Size);
+        return true;
+    }
 
-    // Create a D2D bitmap from the WIC bitmap source
-    hr = m_pD2DDeviceContext->CreateBitmapFromWicBitmap(
-        pConverter.Get(),
-        NULL, // Default bitmap properties
-        &pD2DBitmap
-    );
+    std::vector<uint8_t> rgba;
+    if (!TextureCooker::DecodeMip(texture, 0, rgba)) {
+        OutputDebugString(L"Unsupported DDS format for D2D.\n");
+        return false;
+    }
+    outImage.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    outImage.Stride = top.Width * 4;
+    outImage.Pixels.resize(rgba.size());
+    for (size_t i = 0; i < rgba.size(); i += 4) {
+        uint32_t alpha = rgba[i + 3];
+        for (int c = 0; c < 3; ++c) {
+            uint32_t value = rgba[i + c];
+            outImage.Pixels[i + 2 - c] = static_cast<BYTE>(texture.Premultiplied ? value : (value * alpha + 127) / 255);
+        }
+        outImage.Pixels[i + 3] = static_cast<BYTE>(alpha);
+    }
+    return true;
+}
+
+bool D2DRenderer::CreateImageFromPixels(const DecodedImage& image, StringId imageId) {
+    if (!m_pD2DDeviceContext || image.Pixels.empty()) return false;
+
+    // BGRA or BC1-BC3 blocks (ID2D1DeviceContext bitmaps take block-compressed formats directly)
+    D2D1_BITMAP_PROPERTIES properties = D2D1::BitmapProperties(
+        D2D1::PixelFormat(image.Format, D2D1_ALPHA_MODE_PREMULTIPLIED));
+    Microsoft::WRL::ComPtr<ID2D1Bitmap> pD2DBitmap;
+    HRESULT hr = m_pD2DDeviceContext->CreateBitmap(
+        D2D1::SizeU(image.Width, image.Height), image.Pixels.data(), image.Stride, &properties, &pD2DBitmap);
     if (FAILED(hr)) {
-        OutputDebugString(L"Failed to create D2D bitmap from WIC bitmap.\n");
+        OutputDebugString(L"Failed to create D2D bitmap from decoded pixels.\n");
         return false;
     }
 
-    // Store the loaded bitmap
-    m_loadedImages[imageName] = pD2DBitmap;
+    m_loadedImages[imageId] = pD2DBitmap; // Replaces an older version of the same image
     return true;
 }
 
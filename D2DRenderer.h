@@ -5,8 +5,19 @@
 #pragma once
 
 #include "pch.h"
-#include <map>
+#include "StringId.h"
 #include <string>
+#include <vector>
+
+// CPU-side decoded image (32bpp premultiplied BGRA, or BC1-BC3 blocks from a cooked .dds),
+// e.g. produced on a worker thread
+struct DecodedImage {
+    UINT Width = 0;
+    UINT Height = 0;
+    UINT Stride = 0; // Bytes per row (per row of 4x4 blocks for BC formats)
+    DXGI_FORMAT Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    std::vector<BYTE> Pixels;
+};
 
 class D2DRenderer {
 public:
@@ -28,12 +39,20 @@ public:
     // Drawing operations (must be between BeginDraw/EndDraw)
     void DrawTextLayout(IDWriteTextLayout* layout, float x, float y, ID2D1Brush* brush);
     void DrawText(const std::wstring& text, IDWriteTextFormat* format, const D2D1_RECT_F& layoutRect, ID2D1Brush* brush);
-    void DrawImage(const std::string& imageName, const D2D1_RECT_F& destRect, float opacity = 1.0f, D2D1_INTERPOLATION_MODE interpolation = D2D1_INTERPOLATION_MODE_LINEAR);
+    void DrawImage(StringId imageId, const D2D1_RECT_F& destRect, float opacity = 1.0f, D2D1_INTERPOLATION_MODE interpolation = D2D1_INTERPOLATION_MODE_LINEAR);
     void DrawRectangle(const D2D1_RECT_F& rect, ID2D1Brush* brush, float strokeWidth = 1.0f);
     void FillRectangle(const D2D1_RECT_F& rect, ID2D1Brush* brush);
 
     // Resource Loading/Creation
-    bool LoadImageFromFile(const std::wstring& filename, const std::string& imageName);
+    bool LoadImageFromFile(const std::wstring& filename, const std::string& imageName); // Name is interned, draw by StringId
+    // Decodes an in-memory image file with WIC. Safe on worker threads (the WIC factory is free threaded,
+    // the calling thread must have COM initialized). Straight alpha (premultiplied = false) is for TextureCooker.
+    static bool DecodeImage(IWICImagingFactory* wicFactory, const BYTE* fileData, size_t fileSize, DecodedImage& outImage, bool premultiplied = true);
+    // Top mip of a cooked .dds (TextureCooker). Premultiplied BC1-BC3 stay compressed; anything else
+    // D2D can't draw directly (BC7, straight alpha, RGBA) is decoded to BGRA. No WIC needed.
+    static bool DecodeDds(const BYTE* fileData, size_t fileSize, DecodedImage& outImage);
+    // Creates the D2D bitmap for an image decoded with DecodeImage (render thread only)
+    bool CreateImageFromPixels(const DecodedImage& image, StringId imageId);
     Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> CreateSolidColorBrush(const D2D1_COLOR_F& color);
     Microsoft::WRL::ComPtr<IDWriteTextFormat> CreateTextFormat(const std::wstring& fontFamily = L"Arial", float fontSize = 20.0f, DWRITE_FONT_WEIGHT weight = DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE style = DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH stretch = DWRITE_FONT_STRETCH_NORMAL);
     Microsoft::WRL::ComPtr<IDWriteTextLayout> CreateTextLayout(const std::wstring& text, IDWriteTextFormat* format, float maxWidth, float maxHeight);
@@ -59,5 +78,5 @@ private:
     Microsoft::WRL::ComPtr<ID2D1Bitmap1>         m_pD2DTargetBitmap;
 
     // Loaded Image Resources
-    std::map<std::string, Microsoft::WRL::ComPtr<ID2D1Bitmap>> m_loadedImages;
+    StringIdMap<Microsoft::WRL::ComPtr<ID2D1Bitmap>> m_loadedImages;
 };
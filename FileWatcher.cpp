@@ -0,0 +1,211 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "FileWatcher.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher() {}
+
+FileWatcher::~FileWatcher() {
+    Stop();
+}
+
+void FileWatcher::AddPending(const std::wstring& path) {
+    std::error_code ec;
+    if (std::filesystem::is_directory(path, ec)) {
+        return; // Only files are reported
+    }
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    m_pending[path] = std::chrono::steady_clock::now();
+}
+
+void FileWatcher::PollChanges(std::vector<std::wstring>& outPaths) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (now - it->second >= m_settleTime) {
+            outPaths.push_back(it->first);
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+#ifdef _WIN32
+
+bool FileWatcher::Start(const std::wstring& directory, std::chrono::milliseconds settleTime) {
+    if (m_running.load()) {
+        return true;
+    }
+    m_directory = std::filesystem::absolute(directory).wstring();
+    m_settleTime = settleTime;
+
+    m_directoryHandle = CreateFileW(m_directory.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (m_directoryHandle == INVALID_HANDLE_VALUE) {
+        OutputDebugString((L"FileWatcher: Failed to open " + m_directory + L"\n").c_str());
+        return false;
+    }
+    m_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+    m_running = true;
+    m_thread = std::thread(&FileWatcher::WatchThread, this);
+    return true;
+}
+
+void FileWatcher::Stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    SetEvent(m_stopEvent);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    CloseHandle(m_directoryHandle);
+    CloseHandle(m_stopEvent);
+    m_directoryHandle = INVALID_HANDLE_VALUE;
+    m_stopEvent = nullptr;
+}
+
+void FileWatcher::WatchThread() {
+    // DWORD aligned as ReadDirectoryChangesW requires
+    std::vector<DWORD> buffer(16 * 1024);
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+    while (m_running.load()) {
+        ResetEvent(overlapped.hEvent);
+        if (!ReadDirectoryChangesW(m_directoryHandle, buffer.data(), static_cast<DWORD>(buffer.size() * sizeof(DWORD)),
+            TRUE, filter, nullptr, &overlapped, nullptr)) {
+            OutputDebugString(L"FileWatcher: ReadDirectoryChangesW failed.\n");
+            break;
+        }
+
+        HANDLE waitHandles[2] = { overlapped.hEvent, m_stopEvent };
+        DWORD waitResult = WaitForMultipleObjects(2, waitHandles, FALSE, INFINITE);
+        if (waitResult != WAIT_OBJECT_0) {
+            CancelIo(m_directoryHandle);
+            WaitForSingleObject(overlapped.hEvent, INFINITE); // Buffer must stay valid until the cancel lands
+            break;
+        }
+
+        DWORD bytesReturned = 0;
+        if (!GetOverlappedResult(m_directoryHandle, &overlapped, &bytesReturned, FALSE) || bytesReturned == 0) {
+            continue; // Buffer overflow: changes were lost, keep watching
+        }
+
+        const BYTE* record = reinterpret_cast<const BYTE*>(buffer.data());
+        for (;;) {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(record);
+            if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+                std::wstring relative(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                AddPending((std::filesystem::path(m_directory) / relative).wstring());
+            }
+            if (info->NextEntryOffset == 0) break;
+            record += info->NextEntryOffset;
+        }
+    }
+
+    CloseHandle(overlapped.hEvent);
+}
+
+#else // inotify
+
+bool FileWatcher::Start(const std::wstring& directory, std::chrono::milliseconds settleTime) {
+    if (m_running.load()) {
+        return true;
+    }
+    m_directory = std::filesystem::absolute(directory).wstring();
+    m_settleTime = settleTime;
+
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        std::cerr << "FileWatcher: inotify_init1 failed" << std::endl;
+        return false;
+    }
+    AddWatchRecursive(m_directory);
+    if (m_watchDirectories.empty()) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+        return false;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&FileWatcher::WatchThread, this);
+    return true;
+}
+
+void FileWatcher::Stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join(); // Wakes within one poll timeout
+    }
+    close(m_inotifyFd);
+    m_inotifyFd = -1;
+    m_watchDirectories.clear();
+}
+
+void FileWatcher::AddWatchRecursive(const std::wstring& directory) {
+    // IN_CLOSE_WRITE rather than IN_MODIFY: one event per save, after the data is complete
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+    std::string narrow = std::filesystem::path(directory).string();
+    int wd = inotify_add_watch(m_inotifyFd, narrow.c_str(), mask | IN_ONLYDIR);
+    if (wd < 0) {
+        std::cerr << "FileWatcher: Failed to watch " << narrow << std::endl;
+        return;
+    }
+    m_watchDirectories[wd] = directory;
+
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory, ec), endIt; !ec && it != endIt; it.increment(ec)) {
+        if (it->is_directory(ec)) {
+            AddWatchRecursive(it->path().wstring());
+        }
+    }
+}
+
+void FileWatcher::WatchThread() {
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while (m_running.load()) {
+        pollfd descriptor = { m_inotifyFd, POLLIN, 0 };
+        int ready = poll(&descriptor, 1, 100); // Timeout so Stop() is noticed
+        if (ready <= 0) {
+            continue;
+        }
+
+        ssize_t length = read(m_inotifyFd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; length > 0 && offset < length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            auto dir = m_watchDirectories.find(event->wd);
+            if (dir == m_watchDirectories.end() || event->len == 0) {
+                continue;
+            }
+            std::wstring path = (std::filesystem::path(dir->second) / event->name).wstring();
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    AddWatchRecursive(path); // New sub directory
+                }
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                AddPending(path);
+            }
+        }
+    }
+}
+
+#endif
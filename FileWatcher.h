@@ -0,0 +1,52 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches a directory tree on a background thread and reports files that were written, created
+// or renamed into it. Uses ReadDirectoryChangesW on Windows and inotify on Linux.
+// Changes are debounced: a file is reported once it has been quiet for the settle time, so
+// editors that save in several writes produce a single change.
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    bool Start(const std::wstring& directory, std::chrono::milliseconds settleTime = std::chrono::milliseconds(200));
+    void Stop();
+    bool IsRunning() const { return m_running.load(); }
+
+    // Non-blocking: appends the settled changed files (absolute paths) since the last call
+    void PollChanges(std::vector<std::wstring>& outPaths);
+
+private:
+    std::wstring m_directory;
+    std::chrono::milliseconds m_settleTime{ 200 };
+    std::atomic<bool> m_running{ false };
+    std::thread m_thread;
+
+    std::mutex m_pendingMutex;
+    std::map<std::wstring, std::chrono::steady_clock::time_point> m_pending; // Path -> last event time
+
+    void AddPending(const std::wstring& path);
+    void WatchThread();
+
+#ifdef _WIN32
+    HANDLE m_directoryHandle = INVALID_HANDLE_VALUE;
+    HANDLE m_stopEvent = nullptr;
+#else
+    int m_inotifyFd = -1;
+    std::map<int, std::wstring> m_watchDirectories; // inotify watch descriptor -> directory (watch thread only)
+    void AddWatchRecursive(const std::wstring& directory);
+#endif
+};
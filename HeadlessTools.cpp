@@ -0,0 +1,22 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "HeadlessTools.h"
+#include "ColladaBenchmark.h"
+#include "SoftwareMixer.h"
+
+const CommandLineTool HEADLESS_TOOLS[] = {
+    { L"-colladabench", L"[directory] [-min <MB/s>]: parses every .dae in the directory (a synthetic corpus is generated when there is none) and fails if any file parses below the threshold",
+      [](const CommandLineArguments& arguments) {
+          ColladaBenchmarkSettings settings;
+          settings.MinMegabytesPerSecond = GetNumberOption(arguments, L"-min", settings.MinMegabytesPerSecond);
+          return ColladaBenchmark::Run(GetArgument(arguments, 0, L"ColladaCorpus"), settings) ? 0 : 1;
+      } },
+    { L"-mixbench", L"[voices]: mixes looping voices into 48 kHz stereo with each software mixer kernel and reports voices mixed per millisecond of audio",
+      [](const CommandLineArguments& arguments) {
+          return SoftwareMixer::RunBenchmark(GetCountArgument(arguments, 0, 256)) ? 0 : 1;
+      } },
+};
+
+const size_t HEADLESS_TOOL_COUNT = sizeof(HEADLESS_TOOLS) / sizeof(HEADLESS_TOOLS[0]);
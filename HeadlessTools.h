@@ -0,0 +1,12 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "CommandLine.h"
+
+// Tools without platform dependencies (no window, device or Windows headers). The game runs them
+// from wWinMain, and ToolsMain.cpp is a console entry point for them on any platform.
+extern const CommandLineTool HEADLESS_TOOLS[];
+extern const size_t HEADLESS_TOOL_COUNT;
@@ -0,0 +1,147 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "JobSystem.h"
+
+JobSystem::JobSystem() {}
+
+JobSystem::~JobSystem() {
+    Shutdown();
+}
+
+bool JobSystem::Initialize(unsigned int threadCount) {
+    if (!m_workers.empty()) {
+        return true; // Already running
+    }
+
+    if (threadCount == 0) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    m_shutdown = false;
+    try {
+        for (unsigned int i = 0; i < threadCount; ++i) {
+            m_workers.emplace_back(&JobSystem::WorkerLoop, this);
+        }
+    } catch (const std::system_error&) {
+        OutputDebugStringA("JobSystem: Failed to create worker thread.\n");
+        Shutdown();
+        return false;
+    }
+    return true;
+}
+
+void JobSystem::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_shutdown = true;
+    }
+    m_queueCondition.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+
+    // Drain anything submitted after the workers stopped so counters never hang
+    while (TryRunOne()) {}
+}
+
+void JobSystem::Submit(std::function<void()> job, JobCounter* counter) {
+    if (counter) {
+        counter->Pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Job entry;
+    entry.Function = std::move(job);
+    entry.Counter = counter;
+
+    if (m_workers.empty()) {
+        Execute(entry);
+        return;
+    }
+
+    bool wakeWaiters = false;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back(std::move(entry));
+        wakeWaiters = m_waitingThreads > 0;
+    }
+    m_queueCondition.notify_one();
+    if (wakeWaiters) {
+        m_doneCondition.notify_all(); // Threads blocked in Wait() can help run it
+    }
+}
+
+void JobSystem::Execute(Job& job) {
+    if (job.Function) {
+        job.Function();
+    }
+    if (job.Counter && job.Counter->Pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Take the lock so a waiter can't miss the notification between its check and its wait
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_doneCondition.notify_all();
+    }
+}
+
+bool JobSystem::TryRunOne() {
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (m_queue.empty()) {
+            return false;
+        }
+        job = std::move(m_queue.front());
+        m_queue.pop_front();
+    }
+    Execute(job);
+    return true;
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    while (!counter.IsDone()) {
+        if (TryRunOne()) {
+            continue;
+        }
+        // Nothing to help with: the remaining jobs are running on workers
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        ++m_waitingThreads;
+        m_doneCondition.wait(lock, [&]() { return counter.IsDone() || !m_queue.empty(); });
+        --m_waitingThreads;
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t begin, size_t end)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    batchSize = std::max<size_t>(batchSize, 1);
+
+    JobCounter counter;
+    for (size_t begin = 0; begin < count; begin += batchSize) {
+        size_t end = std::min(begin + batchSize, count);
+        Submit([&fn, begin, end]() { fn(begin, end); }, &counter);
+    }
+    Wait(counter);
+}
+
+void JobSystem::WorkerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCondition.wait(lock, [this]() { return m_shutdown || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return; // Shutdown requested and nothing left to do
+            }
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        Execute(job);
+    }
+}
@@ -0,0 +1,62 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tracks completion of a group of jobs. Wait() on it with JobSystem::Wait.
+struct JobCounter {
+    std::atomic<int> Pending{ 0 };
+
+    bool IsDone() const { return Pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Simple fixed-size worker thread pool with a shared FIFO queue.
+// Waiting threads help run queued jobs, so nested Submit/Wait from inside a job cannot deadlock.
+class JobSystem {
+public:
+    JobSystem();
+    ~JobSystem();
+
+    // threadCount 0 = hardware threads - 1 (the calling thread also runs jobs while waiting)
+    bool Initialize(unsigned int threadCount = 0);
+    void Shutdown();
+
+    // Queues a job. Without workers (not initialized) the job runs immediately on the caller.
+    void Submit(std::function<void()> job, JobCounter* counter = nullptr);
+
+    // Blocks until 'counter' reaches zero, running queued jobs meanwhile
+    void Wait(JobCounter& counter);
+
+    // Splits [0, count) into batches of 'batchSize' and runs fn(begin, end) for each batch in parallel.
+    // Returns when all batches have completed.
+    void ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t begin, size_t end)>& fn);
+
+    unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+private:
+    struct Job {
+        std::function<void()> Function;
+        JobCounter* Counter = nullptr;
+    };
+
+    std::vector<std::thread> m_workers;
+    std::deque<Job> m_queue;
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueCondition; // Signalled on new jobs and on shutdown
+    std::condition_variable m_doneCondition;  // Signalled whenever a counter reaches zero
+    bool m_shutdown = false;
+    int m_waitingThreads = 0; // Threads blocked in Wait(), guarded by m_queueMutex
+
+    void WorkerLoop();
+    bool TryRunOne(); // Pops and runs one job if the queue is not empty
+    void Execute(Job& job);
+};
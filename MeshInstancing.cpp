@@ -0,0 +1,66 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "MeshInstancing.h"
+
+using namespace DirectX;
+
+void InstanceBatcher::Clear() {
+    m_batchByGeometry.clear();
+    m_batchByMesh.clear();
+    m_batches.clear();
+    m_queued.clear();
+    m_transforms.clear();
+}
+
+void InstanceBatcher::AddModel(const Model& model, FXMMATRIX world) {
+    if (model.Instances.empty()) {
+        for (const Mesh& mesh : model.Meshes) {
+            AddInstance(mesh, world);
+        }
+        return;
+    }
+    for (const MeshInstance& instance : model.Instances) {
+        if (instance.MeshIndex < model.Meshes.size()) {
+            AddInstance(model.Meshes[instance.MeshIndex], XMMatrixMultiply(XMLoadFloat4x4(&instance.Transform), world));
+        }
+    }
+}
+
+void InstanceBatcher::AddInstance(const Mesh& mesh, FXMMATRIX world) {
+    uint32_t nextBatch = static_cast<uint32_t>(m_batches.size());
+    uint32_t batch = mesh.ContentHash != Hash128()
+        ? m_batchByGeometry.emplace(std::make_pair(mesh.ContentHash, mesh.MaterialNameId.GetValue()), nextBatch).first->second
+        : m_batchByMesh.emplace(&mesh, nextBatch).first->second;
+    if (batch == nextBatch) {
+        InstanceBatch newBatch;
+        newBatch.pMesh = &mesh;
+        m_batches.push_back(newBatch);
+    }
+    m_batches[batch].InstanceCount++;
+
+    QueuedInstance queued;
+    queued.Batch = batch;
+    XMStoreFloat4x4(&queued.Transform, world);
+    m_queued.push_back(queued);
+}
+
+void InstanceBatcher::Build() {
+    // Counting sort: batch ranges from the counts, then one scatter pass
+    uint32_t offset = 0;
+    for (InstanceBatch& batch : m_batches) {
+        batch.FirstInstance = offset;
+        offset += batch.InstanceCount;
+    }
+    m_transforms.resize(offset);
+    std::vector<uint32_t> cursor(m_batches.size());
+    for (size_t i = 0; i < m_batches.size(); ++i) {
+        cursor[i] = m_batches[i].FirstInstance;
+    }
+    for (const QueuedInstance& queued : m_queued) {
+        m_transforms[cursor[queued.Batch]++] = queued.Transform;
+    }
+    m_queued.clear();
+}
@@ -0,0 +1,48 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <map>
+#include <utility>
+#include <vector>
+
+// One DrawIndexedInstanced: a shared mesh and the world transforms of all its instances
+struct InstanceBatch {
+    const Mesh* pMesh = nullptr; // First mesh added with this geometry; its GPU buffers draw the whole batch
+    uint32_t FirstInstance = 0;  // Into InstanceBatcher::GetTransforms()
+    uint32_t InstanceCount = 0;
+};
+
+// Groups mesh instances of any number of models into batches each frame (runtime).
+// Meshes are keyed by Mesh::ContentHash and material, so the same geometry cooked into
+// different models lands in one batch. Meshes without a hash (not cooked) batch by address.
+class InstanceBatcher {
+public:
+    void Clear();
+
+    // Every instance of 'model' (every mesh once when it has none) placed by 'world'
+    void AddModel(const Model& model, DirectX::FXMMATRIX world);
+    void AddInstance(const Mesh& mesh, DirectX::FXMMATRIX world);
+
+    // Orders the transforms by batch, so each batch is one contiguous range of the instance buffer
+    void Build();
+
+    const std::vector<InstanceBatch>& GetBatches() const { return m_batches; }
+    const std::vector<DirectX::XMFLOAT4X4>& GetTransforms() const { return m_transforms; } // Row vectors, valid after Build()
+
+private:
+    struct QueuedInstance {
+        uint32_t Batch;
+        DirectX::XMFLOAT4X4 Transform;
+    };
+
+    std::map<std::pair<Hash128, uint64_t>, uint32_t> m_batchByGeometry; // (ContentHash, material) -> batch
+    std::map<const Mesh*, uint32_t> m_batchByMesh;                      // Meshes without a ContentHash
+    std::vector<InstanceBatch> m_batches;
+    std::vector<QueuedInstance> m_queued;
+    std::vector<DirectX::XMFLOAT4X4> m_transforms;
+};
@@ -0,0 +1,364 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <numeric>
+
+using namespace DirectX;
+
+namespace {
+
+// --- Forsyth vertex cache optimization tuning (values from the original paper) ---
+constexpr int   kForsythCacheSize = 32;
+constexpr int   kForsythMaxValence = 32; // Valence scores are clamped beyond this
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriangleScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+// Score table indexed by [cachePosition + 1][liveTriangles] (cachePosition -1 = not in cache)
+struct ForsythScoreTable {
+    float Scores[kForsythCacheSize + 1][kForsythMaxValence + 1];
+
+    ForsythScoreTable() {
+        for (int cachePos = -1; cachePos < kForsythCacheSize; ++cachePos) {
+            for (int valence = 0; valence <= kForsythMaxValence; ++valence) {
+                Scores[cachePos + 1][valence] = Compute(cachePos, valence);
+            }
+        }
+    }
+
+    static float Compute(int cachePosition, int liveTriangles) {
+        if (liveTriangles == 0) {
+            return -1.0f; // No triangles left, vertex is irrelevant
+        }
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                // Used by the last triangle; fixed score so we don't favour any one of its edges
+                score = kLastTriangleScore;
+            } else {
+                const float scaler = 1.0f / static_cast<float>(kForsythCacheSize - 3);
+                score = powf(1.0f - static_cast<float>(cachePosition - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        // Boost vertices with few remaining triangles so lone triangles don't get left behind
+        score += kValenceBoostScale * powf(static_cast<float>(liveTriangles), -kValenceBoostPower);
+        return score;
+    }
+
+    float Get(int cachePosition, unsigned int liveTriangles) const {
+        return Scores[cachePosition + 1][std::min<unsigned int>(liveTriangles, kForsythMaxValence)];
+    }
+};
+
+const ForsythScoreTable& GetForsythScores() {
+    static const ForsythScoreTable table;
+    return table;
+}
+
+// FIFO cache simulation using timestamps. A vertex is resident while fewer than 'cacheSize'
+// misses have happened since it was loaded. Advancing 'timestamp' by cacheSize + 1 flushes the cache.
+unsigned int SimulateTriangle(const uint32_t* tri, std::vector<unsigned int>& cacheTimestamps, unsigned int& timestamp, unsigned int cacheSize) {
+    unsigned int misses = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (timestamp - cacheTimestamps[tri[k]] > cacheSize) {
+            cacheTimestamps[tri[k]] = timestamp++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+bool IndicesInRange(const AssetVector<uint32_t>& indices, size_t vertexCount) {
+    for (uint32_t index : indices) {
+        if (index >= vertexCount) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+
+void MeshOptimizer::OptimizeVertexCache(AssetVector<uint32_t>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0 || !IndicesInRange(indices, vertexCount)) {
+        return;
+    }
+    const ForsythScoreTable& scores = GetForsythScores();
+
+    // Build vertex -> triangle adjacency (CSR layout)
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices) {
+        liveTriangles[index]++;
+    }
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+            }
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        vertexScore[v] = scores.Get(-1, liveTriangles[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+
+    AssetVector<uint32_t> output(indices.get_allocator());
+    output.reserve(indices.size());
+
+    // Cache holds up to kForsythCacheSize entries plus the 3 vertices pushed by the current triangle
+    uint32_t cache[kForsythCacheSize + 3];
+    size_t cacheCount = 0;
+    size_t scanPosition = 0; // Fallback linear scan when the cache has no live triangles
+
+    int bestTriangle = static_cast<int>(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+        if (bestTriangle < 0) {
+            while (scanPosition < triangleCount && emitted[scanPosition]) {
+                scanPosition++;
+            }
+            bestTriangle = static_cast<int>(scanPosition);
+        }
+
+        const uint32_t* tri = &indices[bestTriangle * 3];
+        output.insert(output.end(), tri, tri + 3);
+        emitted[bestTriangle] = true;
+
+        // Remove the triangle from its vertices' live adjacency lists
+        for (int k = 0; k < 3; ++k) {
+            uint32_t v = tri[k];
+            unsigned int* begin = &adjacency[adjacencyOffsets[v]];
+            unsigned int* end = begin + liveTriangles[v];
+            unsigned int* found = std::find(begin, end, static_cast<unsigned int>(bestTriangle));
+            if (found != end) {
+                *found = *(end - 1);
+                liveTriangles[v]--;
+            }
+        }
+
+        // Push the triangle's vertices to the front of the LRU cache
+        uint32_t newCache[kForsythCacheSize + 3];
+        size_t newCount = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (std::find(newCache, newCache + newCount, tri[k]) == newCache + newCount) {
+                newCache[newCount++] = tri[k];
+            }
+        }
+        for (size_t i = 0; i < cacheCount; ++i) {
+            uint32_t v = cache[i];
+            if (std::find(newCache, newCache + newCount, v) == newCache + newCount) {
+                newCache[newCount++] = v;
+            }
+        }
+
+        // Update scores of everything that was or is in the cache, track the best candidate
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < newCount; ++i) {
+            uint32_t v = newCache[i];
+            int position = (i < kForsythCacheSize) ? static_cast<int>(i) : -1;
+            cachePosition[v] = position;
+            float newScore = scores.Get(position, liveTriangles[v]);
+            float delta = newScore - vertexScore[v];
+            vertexScore[v] = newScore;
+
+            const unsigned int* adj = &adjacency[adjacencyOffsets[v]];
+            for (unsigned int a = 0; a < liveTriangles[v]; ++a) {
+                unsigned int t = adj[a];
+                triangleScore[t] += delta;
+                if (position >= 0 && triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    bestTriangle = static_cast<int>(t);
+                }
+            }
+        }
+
+        cacheCount = std::min<size_t>(newCount, kForsythCacheSize);
+        std::copy(newCache, newCache + cacheCount, cache);
+    }
+
+    indices.swap(output);
+}
+
+
+void MeshOptimizer::OptimizeOverdraw(AssetVector<uint32_t>& indices, const AssetVector<Vertex>& vertices, float threshold) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || !IndicesInRange(indices, vertices.size())) {
+        return;
+    }
+    const unsigned int cacheSize = 16;
+    std::vector<unsigned int> cacheTimestamps(vertices.size(), 0);
+    unsigned int timestamp = cacheSize + 1;
+
+    // 1. Hard boundaries: triangles that miss on all 3 vertices start a new cluster
+    std::vector<size_t> hardBoundaries;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        unsigned int misses = SimulateTriangle(&indices[t * 3], cacheTimestamps, timestamp, cacheSize);
+        if (t == 0 || misses == 3) {
+            hardBoundaries.push_back(t);
+        }
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    // 2. Soft boundaries: split hard clusters wherever the running ACMR (from a cold cache)
+    //    is within 'threshold' of the whole cluster's ACMR, so reordering costs little cache efficiency
+    std::vector<size_t> clusters;
+    for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h) {
+        const size_t start = hardBoundaries[h];
+        const size_t end = hardBoundaries[h + 1];
+
+        timestamp += cacheSize + 1;
+        unsigned int clusterMisses = 0;
+        for (size_t t = start; t < end; ++t) {
+            clusterMisses += SimulateTriangle(&indices[t * 3], cacheTimestamps, timestamp, cacheSize);
+        }
+        const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+        clusters.push_back(start);
+        timestamp += cacheSize + 1;
+        unsigned int runningMisses = 0;
+        size_t runningTriangles = 0;
+        for (size_t t = start; t < end; ++t) {
+            runningMisses += SimulateTriangle(&indices[t * 3], cacheTimestamps, timestamp, cacheSize);
+            runningTriangles++;
+            if (t + 1 < end && static_cast<float>(runningMisses) / static_cast<float>(runningTriangles) <= clusterThreshold) {
+                clusters.push_back(t + 1);
+                timestamp += cacheSize + 1;
+                runningMisses = 0;
+                runningTriangles = 0;
+            }
+        }
+    }
+    const size_t clusterCount = clusters.size();
+    clusters.push_back(triangleCount);
+
+    // 3. Sort key per cluster: how much the cluster faces away from the mesh centroid
+    XMVECTOR meshCentroid = XMVectorZero();
+    float meshArea = 0.0f;
+    std::vector<XMFLOAT3> clusterCentroids(clusterCount);
+    std::vector<XMFLOAT3> clusterNormals(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        XMVECTOR centroid = XMVectorZero();
+        XMVECTOR normal = XMVectorZero();
+        float area = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            XMVECTOR p0 = XMLoadFloat3(&vertices[indices[t * 3]].Position);
+            XMVECTOR p1 = XMLoadFloat3(&vertices[indices[t * 3 + 1]].Position);
+            XMVECTOR p2 = XMLoadFloat3(&vertices[indices[t * 3 + 2]].Position);
+            XMVECTOR n = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+            float triArea = XMVectorGetX(XMVector3Length(n));
+            XMVECTOR triCentroid = XMVectorScale(XMVectorAdd(XMVectorAdd(p0, p1), p2), 1.0f / 3.0f);
+            centroid = XMVectorMultiplyAdd(triCentroid, XMVectorReplicate(triArea), centroid);
+            normal = XMVectorAdd(normal, n);
+            area += triArea;
+        }
+        meshCentroid = XMVectorAdd(meshCentroid, centroid);
+        meshArea += area;
+        XMStoreFloat3(&clusterCentroids[c], area > 0.0f ? XMVectorScale(centroid, 1.0f / area) : centroid);
+        XMStoreFloat3(&clusterNormals[c], XMVector3Normalize(normal));
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid = XMVectorScale(meshCentroid, 1.0f / meshArea);
+    }
+
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&clusterCentroids[c]), meshCentroid);
+        sortKeys[c] = XMVectorGetX(XMVector3Dot(offset, XMLoadFloat3(&clusterNormals[c])));
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    // 4. Emit clusters in sorted order
+    AssetVector<uint32_t> output(indices.get_allocator());
+    output.reserve(indices.size());
+    for (size_t c : order) {
+        output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    }
+    indices.swap(output);
+}
+
+
+void MeshOptimizer::OptimizeVertexFetch(AssetVector<Vertex>& vertices, AssetVector<uint32_t>& indices) {
+    if (!IndicesInRange(indices, vertices.size())) {
+        return;
+    }
+    const uint32_t unused = UINT32_MAX;
+    std::vector<uint32_t> remap(vertices.size(), unused);
+    AssetVector<Vertex> reordered(vertices.get_allocator()); // Same resource, so swap() just exchanges buffers
+    reordered.reserve(vertices.size());
+
+    for (uint32_t& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const AssetVector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize) {
+    VertexCacheStats stats;
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || !IndicesInRange(indices, vertexCount)) {
+        return stats;
+    }
+
+    std::vector<unsigned int> cacheTimestamps(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    unsigned int timestamp = cacheSize + 1;
+    unsigned int misses = 0;
+    size_t uniqueVertices = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        misses += SimulateTriangle(&indices[t * 3], cacheTimestamps, timestamp, cacheSize);
+        for (int k = 0; k < 3; ++k) {
+            if (!referenced[indices[t * 3 + k]]) {
+                referenced[indices[t * 3 + k]] = true;
+                uniqueVertices++;
+            }
+        }
+    }
+
+    stats.ACMR = static_cast<float>(misses) / static_cast<float>(triangleCount);
+    stats.ATVR = uniqueVertices ? static_cast<float>(misses) / static_cast<float>(uniqueVertices) : 0.0f;
+    return stats;
+}
+
+
+void MeshOptimizer::Optimize(Mesh& mesh, float overdrawThreshold, VertexCacheStats* pStatsBefore, VertexCacheStats* pStatsAfter) {
+    if (pStatsBefore) {
+        *pStatsBefore = AnalyzeVertexCache(mesh.Indices, mesh.Vertices.size());
+    }
+
+    OptimizeVertexCache(mesh.Indices, mesh.Vertices.size());
+    OptimizeOverdraw(mesh.Indices, mesh.Vertices, overdrawThreshold);
+    OptimizeVertexFetch(mesh.Vertices, mesh.Indices);
+    mesh.IndexCount = static_cast<UINT>(mesh.Indices.size());
+
+    if (pStatsAfter) {
+        *pStatsAfter = AnalyzeVertexCache(mesh.Indices, mesh.Vertices.size());
+    }
+}
@@ -0,0 +1,36 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <vector>
+
+// Post-transform vertex cache statistics for an index buffer
+struct VertexCacheStats {
+    float ACMR = 0.0f; // Average cache miss ratio: transformed vertices per triangle (0.5 - 3.0, lower is better)
+    float ATVR = 0.0f; // Average transformed vertex ratio: transformed vertices per unique vertex (1.0 is ideal)
+};
+
+// Offline mesh optimization passes, run by the ModelCooker.
+// Recommended order: OptimizeVertexCache -> OptimizeOverdraw -> OptimizeVertexFetch.
+class MeshOptimizer {
+public:
+    // Reorders triangles for the post-transform vertex cache (Tom Forsyth's linear-speed algorithm)
+    static void OptimizeVertexCache(AssetVector<uint32_t>& indices, size_t vertexCount);
+
+    // Reorders clusters of cache-optimized triangles so outward facing clusters draw first.
+    // 'threshold' is the maximum allowed ACMR degradation (1.05 = 5% worse).
+    static void OptimizeOverdraw(AssetVector<uint32_t>& indices, const AssetVector<Vertex>& vertices, float threshold = 1.05f);
+
+    // Reorders vertices into first-use order and remaps the indices. Unreferenced vertices are dropped.
+    static void OptimizeVertexFetch(AssetVector<Vertex>& vertices, AssetVector<uint32_t>& indices);
+
+    // Simulates a FIFO post-transform cache of 'cacheSize' entries
+    static VertexCacheStats AnalyzeVertexCache(const AssetVector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+    // Runs all passes on a mesh. Optional stats are filled before/after optimization.
+    static void Optimize(Mesh& mesh, float overdrawThreshold = 1.05f, VertexCacheStats* pStatsBefore = nullptr, VertexCacheStats* pStatsAfter = nullptr);
+};
@@ -0,0 +1,494 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "ModelBounds.h"
+#include "Camera.h"
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+
+using namespace DirectX;
+
+namespace {
+
+// Symmetric 4x4 quadric (A, b, c) plus accumulated weight, evaluated as Q(p) / weight
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    static Quadric FromPlane(double nx, double ny, double nz, double d, double w) {
+        Quadric q;
+        q.a00 = w * nx * nx; q.a01 = w * nx * ny; q.a02 = w * nx * nz;
+        q.a11 = w * ny * ny; q.a12 = w * ny * nz; q.a22 = w * nz * nz;
+        q.b0 = w * nx * d; q.b1 = w * ny * d; q.b2 = w * nz * d;
+        q.c = w * d * d;
+        q.weight = w;
+        return q;
+    }
+
+    void Add(const Quadric& o) {
+        a00 += o.a00; a01 += o.a01; a02 += o.a02; a11 += o.a11; a12 += o.a12; a22 += o.a22;
+        b0 += o.b0; b1 += o.b1; b2 += o.b2;
+        c += o.c;
+        weight += o.weight;
+    }
+
+    // Mean squared distance to the accumulated planes
+    double Evaluate(const XMFLOAT3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double r = a00 * x * x + a11 * y * y + a22 * z * z
+                 + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                 + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return (weight > 0.0) ? std::fabs(r) / weight : 0.0;
+    }
+};
+
+struct Collapse {
+    uint32_t From;
+    uint32_t To;
+    double Cost;
+};
+
+struct PositionKey {
+    float x, y, z;
+    bool operator==(const PositionKey& o) const { return x == o.x && y == o.y && z == o.z; }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& k) const {
+        uint32_t bits[3];
+        memcpy(bits, &k, sizeof(bits));
+        return (static_cast<size_t>(bits[0]) * 73856093u) ^ (static_cast<size_t>(bits[1]) * 19349663u) ^ (static_cast<size_t>(bits[2]) * 83492791u);
+    }
+};
+
+// Vertices equal in every attribute (exporters often emit one vertex per face corner)
+struct VertexKeyHash {
+    size_t operator()(const Vertex& v) const {
+        uint32_t words[sizeof(Vertex) / 4];
+        memcpy(words, &v, sizeof(words));
+        size_t hash = 0;
+        for (uint32_t word : words) hash = hash * 31 + word;
+        return hash;
+    }
+};
+
+struct VertexKeyEqual {
+    bool operator()(const Vertex& a, const Vertex& b) const { return memcmp(&a, &b, sizeof(Vertex)) == 0; }
+};
+
+inline uint64_t EdgeKey(uint32_t a, uint32_t b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+int DominantBone(const Vertex& v) {
+    const float w[4] = { v.BoneWeights.x, v.BoneWeights.y, v.BoneWeights.z, v.BoneWeights.w };
+    const uint32_t idx[4] = { v.BoneIndices.x, v.BoneIndices.y, v.BoneIndices.z, v.BoneIndices.w };
+    int best = -1;
+    float bestWeight = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        if (w[i] > bestWeight) {
+            bestWeight = w[i];
+            best = static_cast<int>(idx[i]);
+        }
+    }
+    return best;
+}
+
+XMVECTOR TriangleNormal(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c) {
+    XMVECTOR p0 = XMLoadFloat3(&a);
+    return XMVector3Cross(XMVectorSubtract(XMLoadFloat3(&b), p0), XMVectorSubtract(XMLoadFloat3(&c), p0));
+}
+
+// Squared distance from p to the triangle abc (closest point by Voronoi region)
+float PointTriangleDistanceSquared(FXMVECTOR p, FXMVECTOR a, FXMVECTOR b, GXMVECTOR c) {
+    XMVECTOR ab = XMVectorSubtract(b, a), ac = XMVectorSubtract(c, a), ap = XMVectorSubtract(p, a);
+    float d1 = XMVectorGetX(XMVector3Dot(ab, ap)), d2 = XMVectorGetX(XMVector3Dot(ac, ap));
+    XMVECTOR closest;
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        closest = a;
+    } else {
+        XMVECTOR bp = XMVectorSubtract(p, b);
+        float d3 = XMVectorGetX(XMVector3Dot(ab, bp)), d4 = XMVectorGetX(XMVector3Dot(ac, bp));
+        XMVECTOR cp = XMVectorSubtract(p, c);
+        float d5 = XMVectorGetX(XMVector3Dot(ab, cp)), d6 = XMVectorGetX(XMVector3Dot(ac, cp));
+        float vc = d1 * d4 - d3 * d2, vb = d5 * d2 - d1 * d6, va = d3 * d6 - d5 * d4;
+        if (d3 >= 0.0f && d4 <= d3) {
+            closest = b;
+        } else if (d6 >= 0.0f && d5 <= d6) {
+            closest = c;
+        } else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+            closest = XMVectorMultiplyAdd(ab, XMVectorReplicate(d1 / (d1 - d3)), a);
+        } else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+            closest = XMVectorMultiplyAdd(ac, XMVectorReplicate(d2 / (d2 - d6)), a);
+        } else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+            closest = XMVectorLerp(b, c, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        } else {
+            float denominator = va + vb + vc;
+            if (denominator <= 0.0f) { // Degenerate: nearest corner
+                return std::min({ XMVectorGetX(XMVector3LengthSq(ap)), XMVectorGetX(XMVector3LengthSq(bp)), XMVectorGetX(XMVector3LengthSq(cp)) });
+            }
+            closest = XMVectorAdd(a, XMVectorAdd(XMVectorScale(ab, vb / denominator), XMVectorScale(ac, vc / denominator)));
+        }
+    }
+    return XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(p, closest)));
+}
+
+} // namespace
+
+
+float MeshSimplifier::Simplify(const AssetVector<Vertex>& vertices, const AssetVector<uint32_t>& indices,
+                               size_t targetIndexCount, float targetError, AssetVector<uint32_t>& outIndices) {
+    outIndices = indices;
+    const size_t vertexCount = vertices.size();
+    if (indices.size() <= targetIndexCount || vertexCount == 0) {
+        return 0.0f;
+    }
+    for (uint32_t index : indices) {
+        if (index >= vertexCount) return 0.0f;
+    }
+
+    // 1. Vertices equal in every attribute are one vertex; the output references the first of them
+    {
+        std::unordered_map<Vertex, uint32_t, VertexKeyHash, VertexKeyEqual> firstEqual;
+        firstEqual.reserve(vertexCount);
+        std::vector<uint32_t> canonical(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            canonical[v] = firstEqual.emplace(vertices[v], v).first->second;
+        }
+        for (uint32_t& index : outIndices) index = canonical[index];
+    }
+
+    // 2. Group the remaining vertices by position; a group of several is an attribute seam (the
+    // vertices differ in normal, UV or weights) and only collapses as a whole, along the seam
+    std::vector<uint32_t> positionGroup(vertexCount, UINT32_MAX);
+    std::vector<std::vector<uint32_t>> groupMembers(vertexCount);
+    {
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> firstWithPosition;
+        firstWithPosition.reserve(vertexCount);
+        for (uint32_t index : outIndices) {
+            if (positionGroup[index] != UINT32_MAX) continue;
+            const XMFLOAT3& p = vertices[index].Position;
+            positionGroup[index] = firstWithPosition.emplace(PositionKey{ p.x, p.y, p.z }, index).first->second;
+            groupMembers[positionGroup[index]].push_back(index);
+        }
+    }
+
+    // 3. Open border edges (no opposite half-edge in position space) lock their vertices
+    std::vector<bool> lockedGroup(vertexCount, false);
+    {
+        std::unordered_map<uint64_t, uint32_t> halfEdges;
+        halfEdges.reserve(outIndices.size());
+        for (size_t i = 0; i < outIndices.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                uint32_t a = positionGroup[outIndices[i + k]];
+                uint32_t b = positionGroup[outIndices[i + (k + 1) % 3]];
+                halfEdges[EdgeKey(a, b)]++;
+            }
+        }
+        for (const auto& edge : halfEdges) {
+            uint32_t a = static_cast<uint32_t>(edge.first >> 32);
+            uint32_t b = static_cast<uint32_t>(edge.first & 0xffffffffu);
+            if (halfEdges.find(EdgeKey(b, a)) == halfEdges.end()) {
+                lockedGroup[a] = true;
+                lockedGroup[b] = true;
+            }
+        }
+    }
+
+    // 4. Area weighted plane quadrics per position group
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < outIndices.size(); i += 3) {
+        const XMFLOAT3& p0 = vertices[outIndices[i]].Position;
+        XMVECTOR n = TriangleNormal(p0, vertices[outIndices[i + 1]].Position, vertices[outIndices[i + 2]].Position);
+        float doubleArea = XMVectorGetX(XMVector3Length(n));
+        if (doubleArea <= 0.0f) continue;
+        XMFLOAT3 unitNormal;
+        XMStoreFloat3(&unitNormal, XMVectorScale(n, 1.0f / doubleArea));
+        double d = -(static_cast<double>(unitNormal.x) * p0.x + static_cast<double>(unitNormal.y) * p0.y + static_cast<double>(unitNormal.z) * p0.z);
+        Quadric q = Quadric::FromPlane(unitNormal.x, unitNormal.y, unitNormal.z, d, 0.5 * doubleArea);
+        for (int k = 0; k < 3; ++k) {
+            quadrics[positionGroup[outIndices[i + k]]].Add(q);
+        }
+    }
+
+    std::vector<int> dominantBone(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        dominantBone[v] = DominantBone(vertices[v]);
+    }
+
+    // Input positions each group stands for; the error of a collapse is the largest distance from
+    // them to the surface left around their group (an upper bound of the distance to the result)
+    std::vector<std::vector<XMFLOAT3>> absorbed(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        if (positionGroup[v] == v) absorbed[v].push_back(vertices[v].Position);
+    }
+
+    const double errorLimit = static_cast<double>(targetError) * targetError;
+    const float distanceLimitSq = targetError * targetError;
+    float resultErrorSq = 0.0f;
+
+    std::vector<uint32_t> collapseTarget(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> candidates;
+    std::vector<std::pair<uint32_t, uint32_t>> pairs; // Seam vertex -> vertex it moves to
+    std::vector<uint32_t> ringGroups;
+
+    // 5. Collapse passes: each pass performs independent collapses in order of increasing cost
+    while (outIndices.size() > targetIndexCount) {
+        const size_t triangleCount = outIndices.size() / 3;
+
+        // Vertex -> triangle adjacency for flip and error checks
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t index : outIndices) adjacencyOffsets[index + 1]++;
+        for (size_t v = 0; v < vertexCount; ++v) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        adjacency.resize(outIndices.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t t = 0; t < triangleCount; ++t) {
+                for (int k = 0; k < 3; ++k) adjacency[fill[outIndices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        candidates.clear();
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                uint32_t a = outIndices[t * 3 + k];
+                uint32_t b = outIndices[t * 3 + (k + 1) % 3];
+                for (int dir = 0; dir < 2; ++dir) {
+                    uint32_t from = dir ? b : a;
+                    uint32_t to = dir ? a : b;
+                    if (lockedGroup[positionGroup[from]] || positionGroup[from] == positionGroup[to]) continue;
+                    if (dominantBone[from] != dominantBone[to]) continue; // Don't smear skinning across bones
+                    double cost = quadrics[positionGroup[from]].Evaluate(vertices[to].Position);
+                    if (cost <= errorLimit) {
+                        candidates.push_back({ from, to, cost });
+                    }
+                }
+            }
+        }
+        if (candidates.empty()) break;
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& x, const Collapse& y) { return x.Cost < y.Cost; });
+
+        for (uint32_t v = 0; v < vertexCount; ++v) collapseTarget[v] = v;
+        std::fill(touched.begin(), touched.end(), false);
+
+        // Triangle 't' after this pass's collapses and the pending pairs
+        auto mapped = [&](uint32_t t, uint32_t* out) {
+            for (int k = 0; k < 3; ++k) {
+                uint32_t v = collapseTarget[outIndices[t * 3 + k]];
+                for (const auto& pair : pairs) {
+                    if (v == pair.first) v = pair.second;
+                }
+                out[k] = v;
+            }
+            return out[0] != out[1] && out[1] != out[2] && out[0] != out[2];
+        };
+
+        size_t trianglesLeft = triangleCount;
+        const size_t targetTriangles = targetIndexCount / 3;
+        size_t collapses = 0;
+        for (const Collapse& collapse : candidates) {
+            if (trianglesLeft <= targetTriangles) break;
+            const uint32_t fromGroup = positionGroup[collapse.From];
+            const uint32_t toGroup = positionGroup[collapse.To];
+
+            // Every vertex of the from-group moves to a to-group vertex it shares an edge with
+            pairs.clear();
+            bool valid = true;
+            for (uint32_t member : groupMembers[fromGroup]) {
+                if (adjacencyOffsets[member] == adjacencyOffsets[member + 1]) continue; // No triangles left
+                uint32_t target = member == collapse.From ? collapse.To : UINT32_MAX;
+                for (uint32_t a = adjacencyOffsets[member]; a < adjacencyOffsets[member + 1] && target == UINT32_MAX; ++a) {
+                    const uint32_t* tri = &outIndices[adjacency[a] * 3];
+                    for (int k = 0; k < 3; ++k) {
+                        if (positionGroup[tri[k]] == toGroup) target = tri[k];
+                    }
+                }
+                if (target == UINT32_MAX || touched[member] || touched[target] || dominantBone[member] != dominantBone[target]) {
+                    valid = false;
+                    break;
+                }
+                pairs.emplace_back(member, target);
+            }
+            if (!valid || pairs.empty()) continue;
+
+            // Reject collapses that flip any surviving triangle around the moved vertices
+            bool flips = false;
+            size_t removed = 0;
+            for (size_t i = 0; i < pairs.size() && !flips; ++i) {
+                const uint32_t from = pairs[i].first, to = pairs[i].second;
+                for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1] && !flips; ++a) {
+                    const uint32_t* tri = &outIndices[adjacency[a] * 3];
+                    if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                        removed++;
+                        continue;
+                    }
+                    XMFLOAT3 p[3], q[3];
+                    for (int k = 0; k < 3; ++k) {
+                        p[k] = vertices[tri[k]].Position;
+                        q[k] = (tri[k] == from) ? vertices[to].Position : p[k];
+                    }
+                    XMVECTOR before = TriangleNormal(p[0], p[1], p[2]);
+                    XMVECTOR after = TriangleNormal(q[0], q[1], q[2]);
+                    flips = XMVectorGetX(XMVector3Dot(before, after)) <= 0.0f;
+                }
+            }
+            if (flips) continue;
+
+            // Maximum error: the input positions of every group whose surroundings change, against
+            // its triangles after the collapse
+            ringGroups.clear();
+            for (const auto& pair : pairs) {
+                for (uint32_t a = adjacencyOffsets[pair.first]; a < adjacencyOffsets[pair.first + 1]; ++a) {
+                    const uint32_t* tri = &outIndices[adjacency[a] * 3];
+                    for (int k = 0; k < 3; ++k) {
+                        uint32_t group = positionGroup[collapseTarget[tri[k]]];
+                        if (group != fromGroup && std::find(ringGroups.begin(), ringGroups.end(), group) == ringGroups.end()) {
+                            ringGroups.push_back(group);
+                        }
+                    }
+                }
+            }
+            float collapseErrorSq = 0.0f;
+            for (size_t g = 0; g < ringGroups.size() && collapseErrorSq <= distanceLimitSq; ++g) {
+                const uint32_t group = ringGroups[g];
+                auto measure = [&](const std::vector<XMFLOAT3>& points) {
+                    for (const XMFLOAT3& point : points) {
+                        XMVECTOR p = XMLoadFloat3(&point);
+                        float nearest = FLT_MAX;
+                        for (uint32_t member : groupMembers[group]) {
+                            for (uint32_t a = adjacencyOffsets[member]; a < adjacencyOffsets[member + 1]; ++a) {
+                                uint32_t tri[3];
+                                if (!mapped(adjacency[a], tri)) continue;
+                                nearest = std::min(nearest, PointTriangleDistanceSquared(p, XMLoadFloat3(&vertices[tri[0]].Position),
+                                    XMLoadFloat3(&vertices[tri[1]].Position), XMLoadFloat3(&vertices[tri[2]].Position)));
+                            }
+                        }
+                        if (group == toGroup) { // Triangles that moved onto the to-group
+                            for (const auto& pair : pairs) {
+                                for (uint32_t a = adjacencyOffsets[pair.first]; a < adjacencyOffsets[pair.first + 1]; ++a) {
+                                    uint32_t tri[3];
+                                    if (!mapped(adjacency[a], tri)) continue;
+                                    nearest = std::min(nearest, PointTriangleDistanceSquared(p, XMLoadFloat3(&vertices[tri[0]].Position),
+                                        XMLoadFloat3(&vertices[tri[1]].Position), XMLoadFloat3(&vertices[tri[2]].Position)));
+                                }
+                            }
+                        }
+                        if (nearest != FLT_MAX) collapseErrorSq = std::max(collapseErrorSq, nearest);
+                    }
+                };
+                measure(absorbed[group]);
+                if (group == toGroup) measure(absorbed[fromGroup]);
+            }
+            if (collapseErrorSq > distanceLimitSq) continue;
+
+            for (const auto& pair : pairs) {
+                collapseTarget[pair.first] = pair.second;
+            }
+            quadrics[toGroup].Add(quadrics[fromGroup]);
+            absorbed[toGroup].insert(absorbed[toGroup].end(), absorbed[fromGroup].begin(), absorbed[fromGroup].end());
+            absorbed[fromGroup].clear();
+            resultErrorSq = std::max(resultErrorSq, collapseErrorSq);
+            trianglesLeft -= std::min(removed, trianglesLeft);
+            collapses++;
+
+            // Freeze the one-rings so flip and error checks of later collapses in this pass stay valid
+            for (const auto& pair : pairs) {
+                for (uint32_t a = adjacencyOffsets[pair.first]; a < adjacencyOffsets[pair.first + 1]; ++a) {
+                    const uint32_t* tri = &outIndices[adjacency[a] * 3];
+                    touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+                }
+            }
+            pairs.clear();
+        }
+        pairs.clear();
+        if (collapses == 0) break;
+
+        // Apply collapses and drop degenerate triangles
+        size_t write = 0;
+        for (size_t t = 0; t < triangleCount; ++t) {
+            uint32_t a = collapseTarget[outIndices[t * 3]];
+            uint32_t b = collapseTarget[outIndices[t * 3 + 1]];
+            uint32_t c = collapseTarget[outIndices[t * 3 + 2]];
+            if (a == b || b == c || a == c) continue;
+            outIndices[write++] = a;
+            outIndices[write++] = b;
+            outIndices[write++] = c;
+        }
+        outIndices.resize(write);
+    }
+
+    return std::sqrt(resultErrorSq);
+}
+
+
+void MeshSimplifier::GenerateLods(Mesh& mesh, const LodSettings& settings) {
+    mesh.Lods.clear();
+    mesh.LodIndices.clear();
+    if (mesh.Vertices.empty() || mesh.Indices.size() < settings.MinTriangles * 3) {
+        return;
+    }
+
+    XMFLOAT3 boundsMin, boundsMax;
+    ModelBounds::ComputeAABB(mesh.Vertices, boundsMin, boundsMax);
+    XMVECTOR diagonal = XMVectorSubtract(XMLoadFloat3(&boundsMax), XMLoadFloat3(&boundsMin));
+    const float maxError = settings.MaxRelativeError * XMVectorGetX(XMVector3Length(diagonal));
+
+    AssetVector<uint32_t> previous(mesh.Indices, AssetAllocator()); // Scratch on the default resource
+    AssetVector<uint32_t> simplified;
+    float accumulatedError = 0.0f;
+
+    for (int level = 0; level < settings.MaxLodCount; ++level) {
+        size_t targetTriangles = static_cast<size_t>(static_cast<float>(previous.size() / 3) * settings.TriangleRatio);
+        if (targetTriangles < settings.MinTriangles) break;
+
+        float levelError = MeshSimplifier::Simplify(mesh.Vertices, previous, targetTriangles * 3, maxError - accumulatedError, simplified);
+        // Give up once a level no longer removes a meaningful amount of geometry
+        if (simplified.size() * 10 > previous.size() * 9) break;
+
+        MeshOptimizer::OptimizeVertexCache(simplified, mesh.Vertices.size());
+        // Errors are measured against the previous level, so accumulate them against LOD 0
+        accumulatedError += levelError;
+
+        MeshLod lod;
+        lod.IndexOffset = static_cast<uint32_t>(mesh.LodIndices.size());
+        lod.IndexCount = static_cast<uint32_t>(simplified.size());
+        lod.Error = accumulatedError;
+        mesh.Lods.push_back(lod);
+        mesh.LodIndices.insert(mesh.LodIndices.end(), simplified.begin(), simplified.end());
+        previous.swap(simplified);
+    }
+}
+
+
+size_t MeshSimplifier::SelectLod(const Mesh& mesh, const Camera& camera, const XMFLOAT3& worldPosition,
+                                 float worldScale, float viewportHeight, float maxPixelError) {
+    size_t lod = 0;
+    for (size_t i = 0; i < mesh.Lods.size(); ++i) {
+        float pixels = camera.GetProjectedSize(mesh.Lods[i].Error * worldScale, worldPosition, viewportHeight);
+        if (pixels > maxPixelError) break;
+        lod = i + 1;
+    }
+    return lod;
+}
+
+
+void MeshSimplifier::GetLodDrawRange(const Mesh& mesh, size_t lod, UINT& outStartIndex, UINT& outIndexCount) {
+    if (lod == 0 || lod > mesh.Lods.size()) {
+        outStartIndex = 0;
+        outIndexCount = static_cast<UINT>(mesh.Indices.size());
+        return;
+    }
+    const MeshLod& level = mesh.Lods[lod - 1];
+    outStartIndex = static_cast<UINT>(mesh.Indices.size()) + level.IndexOffset;
+    outIndexCount = level.IndexCount;
+}
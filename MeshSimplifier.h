@@ -0,0 +1,44 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <vector>
+
+class Camera;
+
+// Settings for LOD chain generation
+struct LodSettings {
+    int MaxLodCount = 4;          // Number of simplified levels to generate (excluding LOD 0)
+    float TriangleRatio = 0.5f;   // Each level targets this fraction of the previous level's triangles
+    float MaxRelativeError = 0.05f; // Max error as a fraction of the mesh bounding box diagonal
+    size_t MinTriangles = 32;     // Stop when a level would drop below this
+};
+
+// Quadric error metric simplification (Garland-Heckbert, half-edge collapses so no new
+// vertices are created and all LODs share the LOD 0 vertex buffer).
+// Duplicate vertices are merged; the split vertices of a UV/normal seam collapse together along
+// the seam, open borders are locked, and collapses never cross a change of dominant bone, so
+// skinning weights stay intact.
+class MeshSimplifier {
+public:
+    // Simplifies 'indices' towards 'targetIndexCount' without exceeding 'targetError' (model units).
+    // Returns the maximum geometric error: the largest distance from an input vertex to the
+    // simplified triangles around it, in model units.
+    static float Simplify(const AssetVector<Vertex>& vertices, const AssetVector<uint32_t>& indices,
+                          size_t targetIndexCount, float targetError, AssetVector<uint32_t>& outIndices);
+
+    // Builds mesh.Lods / mesh.LodIndices from mesh.Indices
+    static void GenerateLods(Mesh& mesh, const LodSettings& settings);
+
+    // Picks the coarsest LOD whose projected error stays below 'maxPixelError' for this camera.
+    // 'worldScale' is the largest scale factor of the instance's world transform.
+    static size_t SelectLod(const Mesh& mesh, const Camera& camera, const DirectX::XMFLOAT3& worldPosition,
+                            float worldScale, float viewportHeight, float maxPixelError = 1.0f);
+
+    // DrawIndexed range for a LOD when the index buffer holds Indices followed by LodIndices
+    static void GetLodDrawRange(const Mesh& mesh, size_t lod, UINT& outStartIndex, UINT& outIndexCount);
+};
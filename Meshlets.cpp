@@ -0,0 +1,298 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "Meshlets.h"
+#include "Camera.h"
+#include "MeshOptimizer.h"
+#include "ModelSerializer.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+using namespace DirectX;
+
+void MeshletBuilder::Build(Mesh& mesh, size_t maxVertices, size_t maxTriangles) {
+    mesh.Meshlets.clear();
+    mesh.MeshletVertices.clear();
+    mesh.MeshletTriangles.clear();
+
+    maxVertices = std::min<size_t>(std::max<size_t>(maxVertices, 3), 255); // Local indices are 8 bit
+    maxTriangles = std::max<size_t>(maxTriangles, 1);
+    const size_t vertexCount = mesh.Vertices.size();
+    if (mesh.Indices.empty() || vertexCount == 0) {
+        return;
+    }
+
+    const uint8_t notUsed = 0xff;
+    std::vector<uint8_t> localIndex(vertexCount, notUsed);
+    Meshlet current;
+
+    auto finishMeshlet = [&mesh, &localIndex, &current]() {
+        if (current.TriangleCount == 0) return;
+        for (uint32_t i = 0; i < current.VertexCount; ++i) {
+            localIndex[mesh.MeshletVertices[current.VertexOffset + i]] = 0xff;
+        }
+        mesh.Meshlets.push_back(current);
+        current = Meshlet();
+        current.VertexOffset = static_cast<uint32_t>(mesh.MeshletVertices.size());
+        current.TriangleOffset = static_cast<uint32_t>(mesh.MeshletTriangles.size() / 3);
+    };
+
+    for (size_t i = 0; i + 2 < mesh.Indices.size(); i += 3) {
+        const uint32_t a = mesh.Indices[i], b = mesh.Indices[i + 1], c = mesh.Indices[i + 2];
+        if (a >= vertexCount || b >= vertexCount || c >= vertexCount) continue;
+
+        size_t newVertices = (localIndex[a] == notUsed) + (localIndex[b] == notUsed) + (localIndex[c] == notUsed);
+        // Duplicate corners (degenerate triangles) would be counted twice; that's harmless
+        if (current.VertexCount + newVertices > maxVertices || current.TriangleCount + 1 > maxTriangles) {
+            finishMeshlet();
+        }
+
+        for (uint32_t v : { a, b, c }) {
+            if (localIndex[v] == notUsed) {
+                localIndex[v] = static_cast<uint8_t>(current.VertexCount++);
+                mesh.MeshletVertices.push_back(v);
+            }
+            mesh.MeshletTriangles.push_back(localIndex[v]);
+        }
+        current.TriangleCount++;
+    }
+    finishMeshlet();
+
+    for (Meshlet& meshlet : mesh.Meshlets) {
+        ComputeBounds(mesh, meshlet);
+    }
+}
+
+
+void MeshletBuilder::ComputeBounds(const Mesh& mesh, Meshlet& meshlet) {
+    const uint32_t* vertexIndices = &mesh.MeshletVertices[meshlet.VertexOffset];
+    auto position = [&mesh, vertexIndices](uint32_t local) {
+        return XMLoadFloat3(&mesh.Vertices[vertexIndices[local]].Position);
+    };
+
+    // Ritter bounding sphere: start from an approximately farthest pair, then grow
+    XMVECTOR p0 = position(0);
+    uint32_t far1 = 0, far2 = 0;
+    float best = -1.0f;
+    for (uint32_t i = 0; i < meshlet.VertexCount; ++i) {
+        float d = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(position(i), p0)));
+        if (d > best) { best = d; far1 = i; }
+    }
+    best = -1.0f;
+    for (uint32_t i = 0; i < meshlet.VertexCount; ++i) {
+        float d = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(position(i), position(far1))));
+        if (d > best) { best = d; far2 = i; }
+    }
+    XMVECTOR center = XMVectorScale(XMVectorAdd(position(far1), position(far2)), 0.5f);
+    float radius = sqrtf(best) * 0.5f;
+    for (uint32_t i = 0; i < meshlet.VertexCount; ++i) {
+        XMVECTOR offset = XMVectorSubtract(position(i), center);
+        float distance = XMVectorGetX(XMVector3Length(offset));
+        if (distance > radius) {
+            float newRadius = (radius + distance) * 0.5f;
+            center = XMVectorAdd(center, XMVectorScale(offset, (newRadius - radius) / distance));
+            radius = newRadius;
+        }
+    }
+    XMStoreFloat3(&meshlet.Center, center);
+    meshlet.Radius = radius;
+
+    // Normal cone from triangle normals
+    const uint8_t* triangles = &mesh.MeshletTriangles[meshlet.TriangleOffset * 3];
+    std::vector<XMFLOAT3> normals;
+    std::vector<XMFLOAT3> corners;
+    normals.reserve(meshlet.TriangleCount);
+    corners.reserve(meshlet.TriangleCount);
+    XMVECTOR axis = XMVectorZero();
+    for (uint32_t t = 0; t < meshlet.TriangleCount; ++t) {
+        XMVECTOR a = position(triangles[t * 3]);
+        XMVECTOR n = XMVector3Cross(XMVectorSubtract(position(triangles[t * 3 + 1]), a), XMVectorSubtract(position(triangles[t * 3 + 2]), a));
+        float length = XMVectorGetX(XMVector3Length(n));
+        if (length <= 0.0f) continue; // Degenerate triangles don't constrain the cone
+        n = XMVectorScale(n, 1.0f / length);
+        axis = XMVectorAdd(axis, n);
+        XMFLOAT3 normal, corner;
+        XMStoreFloat3(&normal, n);
+        XMStoreFloat3(&corner, a);
+        normals.push_back(normal);
+        corners.push_back(corner);
+    }
+
+    meshlet.ConeCutoff = 2.0f;
+    meshlet.ConeApex = meshlet.Center;
+    float axisLength = XMVectorGetX(XMVector3Length(axis));
+    if (normals.empty() || axisLength <= 0.0f) {
+        return;
+    }
+    axis = XMVectorScale(axis, 1.0f / axisLength);
+    XMStoreFloat3(&meshlet.ConeAxis, axis);
+
+    float minDot = 1.0f;
+    for (const XMFLOAT3& n : normals) {
+        minDot = std::min(minDot, XMVectorGetX(XMVector3Dot(XMLoadFloat3(&n), axis)));
+    }
+    // Cone wider than ~84 degrees half-angle is nearly never culled; skip it
+    if (minDot <= 0.1f) {
+        return;
+    }
+
+    // Move the apex back along the axis until it's behind every triangle plane
+    float maxT = 0.0f;
+    for (size_t t = 0; t < normals.size(); ++t) {
+        XMVECTOR n = XMLoadFloat3(&normals[t]);
+        float dc = XMVectorGetX(XMVector3Dot(XMVectorSubtract(center, XMLoadFloat3(&corners[t])), n));
+        float dn = XMVectorGetX(XMVector3Dot(axis, n));
+        maxT = std::max(maxT, dc / dn);
+    }
+    XMStoreFloat3(&meshlet.ConeApex, XMVectorSubtract(center, XMVectorScale(axis, maxT)));
+    meshlet.ConeCutoff = sqrtf(1.0f - minDot * minDot);
+}
+
+
+void MeshletCuller::Cull(const Mesh& mesh, FXMMATRIX world, CXMMATRIX viewProjection,
+                         const XMFLOAT3& eyePosition, std::vector<uint32_t>& outVisible) {
+    outVisible.clear();
+
+    // Frustum planes in model space (Gribb/Hartmann) from the columns of world * viewProjection
+    XMMATRIX columns = XMMatrixTranspose(XMMatrixMultiply(world, viewProjection));
+    XMVECTOR planes[6] = {
+        XMVectorAdd(columns.r[3], columns.r[0]),      // Left
+        XMVectorSubtract(columns.r[3], columns.r[0]), // Right
+        XMVectorAdd(columns.r[3], columns.r[1]),      // Bottom
+        XMVectorSubtract(columns.r[3], columns.r[1]), // Top
+        columns.r[2],                                 // Near (D3D clip z >= 0)
+        XMVectorSubtract(columns.r[3], columns.r[2]), // Far
+    };
+    for (XMVECTOR& plane : planes) {
+        plane = XMVectorScale(plane, 1.0f / XMVectorGetX(XMVector3Length(plane)));
+    }
+
+    // Eye in model space for the cone test
+    XMVECTOR eye = XMVector3Transform(XMLoadFloat3(&eyePosition), XMMatrixInverse(nullptr, world));
+
+    for (uint32_t i = 0; i < mesh.Meshlets.size(); ++i) {
+        const Meshlet& meshlet = mesh.Meshlets[i];
+        XMVECTOR center = XMVectorSetW(XMLoadFloat3(&meshlet.Center), 1.0f);
+        XMVECTOR negRadius = XMVectorReplicate(-meshlet.Radius);
+
+        bool outside = false;
+        for (const XMVECTOR& plane : planes) {
+            if (XMVector4Less(XMVector4Dot(plane, center), negRadius)) {
+                outside = true;
+                break;
+            }
+        }
+        if (outside) continue;
+
+        if (meshlet.ConeCutoff <= 1.0f) {
+            XMVECTOR toApex = XMVector3Normalize(XMVectorSubtract(XMLoadFloat3(&meshlet.ConeApex), eye));
+            if (XMVectorGetX(XMVector3Dot(toApex, XMLoadFloat3(&meshlet.ConeAxis))) >= meshlet.ConeCutoff) {
+                continue; // Every triangle faces away from the eye
+            }
+        }
+        outVisible.push_back(i);
+    }
+}
+
+void MeshletCuller::Cull(const Mesh& mesh, FXMMATRIX world, const Camera& camera, std::vector<uint32_t>& outVisible) {
+    XMMATRIX viewProjection = XMMatrixMultiply(camera.GetViewMatrix(), camera.GetProjectionMatrix());
+    Cull(mesh, world, viewProjection, camera.GetPosition(), outVisible);
+}
+
+double MeshletCuller::BenchmarkCulling(const Mesh& mesh, int iterations, int viewCount) {
+    if (mesh.Meshlets.empty() || mesh.Vertices.empty() || iterations <= 0 || viewCount <= 0) {
+        return 0.0;
+    }
+
+    // Orbit the mesh bounds so both frustum and cone tests get exercised
+    XMVECTOR vMin = XMLoadFloat3(&mesh.Vertices[0].Position);
+    XMVECTOR vMax = vMin;
+    for (const Vertex& v : mesh.Vertices) {
+        vMin = XMVectorMin(vMin, XMLoadFloat3(&v.Position));
+        vMax = XMVectorMax(vMax, XMLoadFloat3(&v.Position));
+    }
+    XMVECTOR center = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+    float radius = std::max(XMVectorGetX(XMVector3Length(XMVectorSubtract(vMax, vMin))), 0.001f);
+    XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, radius * 10.0f);
+
+    std::vector<XMFLOAT4X4> viewProjections(viewCount);
+    std::vector<XMFLOAT3> eyes(viewCount);
+    for (int v = 0; v < viewCount; ++v) {
+        float angle = XM_2PI * static_cast<float>(v) / static_cast<float>(viewCount);
+        XMVECTOR eye = XMVectorAdd(center, XMVectorSet(cosf(angle) * radius, radius * 0.25f, sinf(angle) * radius, 0.0f));
+        XMStoreFloat4x4(&viewProjections[v], XMMatrixMultiply(XMMatrixLookAtLH(eye, center, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)), projection));
+        XMStoreFloat3(&eyes[v], eye);
+    }
+
+    std::vector<uint32_t> visible;
+    visible.reserve(mesh.Meshlets.size());
+    size_t visibleTotal = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (int v = 0; v < viewCount; ++v) {
+            Cull(mesh, XMMatrixIdentity(), XMLoadFloat4x4(&viewProjections[v]), eyes[v], visible);
+            visibleTotal += visible.size();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double microseconds = std::chrono::duration<double, std::micro>(end - start).count();
+    double tested = static_cast<double>(mesh.Meshlets.size()) * iterations * viewCount;
+
+    std::ostringstream ss;
+    ss << "Meshlet culling: " << mesh.Meshlets.size() << " meshlets, " << iterations * viewCount << " views, "
+       << (100.0 * static_cast<double>(visibleTotal) / tested) << "% visible, "
+       << tested / std::max(microseconds, 0.001) << " clusters/us\n";
+    std::cout << ss.str();
+    OutputDebugStringA(ss.str().c_str());
+
+    return tested / std::max(microseconds, 0.001);
+}
+
+bool MeshletCuller::RunBenchmark(const std::wstring& cookedModelFile) {
+    Model model;
+    if (!cookedModelFile.empty()) {
+        if (!ModelSerializer::LoadFromFile(cookedModelFile, model)) {
+            std::cerr << "Meshlet benchmark: failed to load the cooked model." << std::endl;
+            return false;
+        }
+    } else {
+        // Bumpy sphere, so the normal cones of neighbouring meshlets differ
+        const uint32_t slices = 256, stacks = 256;
+        model.Meshes.emplace_back();
+        Mesh& mesh = model.Meshes.back();
+        for (uint32_t y = 0; y <= stacks; ++y) {
+            for (uint32_t x = 0; x <= slices; ++x) {
+                float theta = XM_2PI * x / slices, phi = XM_PI * y / stacks;
+                float radius = 1.0f + 0.05f * sinf(theta * 12.0f) * sinf(phi * 9.0f);
+                Vertex vertex = {};
+                vertex.Normal = { sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta) };
+                vertex.Position = { vertex.Normal.x * radius, vertex.Normal.y * radius, vertex.Normal.z * radius };
+                vertex.TexCoord = { static_cast<float>(x) / slices, static_cast<float>(y) / stacks };
+                mesh.Vertices.push_back(vertex);
+            }
+        }
+        for (uint32_t y = 0; y < stacks; ++y) {
+            for (uint32_t x = 0; x < slices; ++x) {
+                uint32_t a = y * (slices + 1) + x, b = a + 1, c = a + slices + 1, d = c + 1;
+                mesh.Indices.insert(mesh.Indices.end(), { a, b, c, b, d, c });
+            }
+        }
+        MeshOptimizer::Optimize(mesh);
+    }
+
+    bool ran = false;
+    for (Mesh& mesh : model.Meshes) {
+        if (mesh.Meshlets.empty() && !mesh.Indices.empty()) {
+            MeshletBuilder::Build(mesh);
+        }
+        ran = BenchmarkCulling(mesh) > 0.0 || ran;
+    }
+    if (!ran) {
+        std::cerr << "Meshlet benchmark: no meshlets to cull." << std::endl;
+    }
+    return ran;
+}
@@ -0,0 +1,47 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <vector>
+
+class Camera;
+
+constexpr size_t MESHLET_MAX_VERTICES = 64;
+constexpr size_t MESHLET_MAX_TRIANGLES = 124;
+
+// Splits LOD 0 of a mesh into meshlets (cook time)
+class MeshletBuilder {
+public:
+    // Greedy scan over the index buffer; run after MeshOptimizer so triangles are spatially coherent.
+    // Fills mesh.Meshlets, mesh.MeshletVertices and mesh.MeshletTriangles.
+    static void Build(Mesh& mesh, size_t maxVertices = MESHLET_MAX_VERTICES, size_t maxTriangles = MESHLET_MAX_TRIANGLES);
+
+    // Computes bounding sphere and normal cone for one meshlet
+    static void ComputeBounds(const Mesh& mesh, Meshlet& meshlet);
+};
+
+// CPU frustum + backface cone culling of meshlets (runtime)
+class MeshletCuller {
+public:
+    // Returns indices of meshlets that are potentially visible.
+    // 'world' is the instance transform, 'viewProjection' the camera's view * projection,
+    // 'eyePosition' the camera position in world space.
+    static void Cull(const Mesh& mesh, DirectX::FXMMATRIX world, DirectX::CXMMATRIX viewProjection,
+                     const DirectX::XMFLOAT3& eyePosition, std::vector<uint32_t>& outVisible);
+
+    // Convenience overload using the camera's current view and projection
+    static void Cull(const Mesh& mesh, DirectX::FXMMATRIX world, const Camera& camera, std::vector<uint32_t>& outVisible);
+
+    // Headless benchmark: culls the mesh from 'viewCount' viewpoints around it, 'iterations' times.
+    // Returns meshlets culled (tested) per microsecond.
+    static double BenchmarkCulling(const Mesh& mesh, int iterations = 100, int viewCount = 16);
+
+    // Runs BenchmarkCulling on every mesh of a cooked model, or on a synthetic 128k triangle sphere
+    // when 'cookedModelFile' is empty (WinMain "-meshletbench"). Meshes cooked without meshlets are
+    // split first. Returns false when the model can't be loaded or has no meshlets.
+    static bool RunBenchmark(const std::wstring& cookedModelFile = L"");
+};
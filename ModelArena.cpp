@@ -0,0 +1,55 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#ifdef _WIN32
+#include "pch.h"
+#endif
+#include "ModelArena.h"
+#include <new>
+
+namespace {
+
+constexpr size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+ModelArenaPtr ModelArena::Create(size_t capacity) {
+    // Arena object first, the block right behind it
+    size_t headerBytes = AlignUp(sizeof(ModelArena), BLOCK_ALIGNMENT);
+    capacity = AlignUp(capacity, BLOCK_ALIGNMENT);
+    void* memory = ::operator new(headerBytes + capacity, std::align_val_t(BLOCK_ALIGNMENT));
+    uint8_t* block = static_cast<uint8_t*>(memory) + headerBytes;
+    return ModelArenaPtr(new (memory) ModelArena(block, capacity, std::pmr::get_default_resource()));
+}
+
+void ModelArenaDeleter::operator()(ModelArena* arena) const {
+    if (arena) {
+        arena->~ModelArena();
+        ::operator delete(static_cast<void*>(arena), std::align_val_t(ModelArena::BLOCK_ALIGNMENT));
+    }
+}
+
+ModelArena::ModelArena(uint8_t* block, size_t capacity, std::pmr::memory_resource* upstream)
+    : m_block(block), m_capacity(capacity), m_upstream(upstream) {}
+
+void* ModelArena::do_allocate(size_t bytes, size_t alignment) {
+    size_t offset = AlignUp(m_used, alignment);
+    if (offset <= m_capacity && bytes <= m_capacity - offset) {
+        m_used = offset + bytes;
+        ++m_allocationCount;
+        return m_block + offset;
+    }
+    ++m_overflowCount;
+    m_overflowBytes += bytes;
+    return m_upstream->allocate(bytes, alignment);
+}
+
+void ModelArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    uint8_t* pointer = static_cast<uint8_t*>(p);
+    if (pointer < m_block || pointer >= m_block + m_capacity) {
+        m_upstream->deallocate(p, bytes, alignment); // Overflow allocation
+    }
+}
@@ -0,0 +1,53 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+class ModelArena;
+
+struct ModelArenaDeleter {
+    void operator()(ModelArena* arena) const;
+};
+using ModelArenaPtr = std::unique_ptr<ModelArena, ModelArenaDeleter>;
+
+// Bump allocator backing the containers of one loaded Model. The arena object and its block are a
+// single heap allocation sized from the cooked model header, so loading a model allocates once and
+// unloading frees once. Deallocation is a no-op; the block goes away with the model.
+// Requests that don't fit (size estimate too small) go to the resource that was the default when
+// the arena was created and are counted as overflows.
+// Not thread safe: a model is filled by one decode job and read-only afterwards.
+class ModelArena final : public std::pmr::memory_resource {
+public:
+    static ModelArenaPtr Create(size_t capacity);
+
+    size_t GetCapacity() const { return m_capacity; }
+    size_t GetUsed() const { return m_used; }
+    size_t GetAllocationCount() const { return m_allocationCount; } // Served from the block
+    size_t GetOverflowCount() const { return m_overflowCount; }
+    size_t GetOverflowBytes() const { return m_overflowBytes; }
+
+private:
+    friend struct ModelArenaDeleter;
+    static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+    ModelArena(uint8_t* block, size_t capacity, std::pmr::memory_resource* upstream);
+    ~ModelArena() override = default;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    uint8_t* m_block;
+    size_t m_capacity;
+    size_t m_used = 0;
+    std::pmr::memory_resource* m_upstream;
+    size_t m_allocationCount = 0;
+    size_t m_overflowCount = 0;
+    size_t m_overflowBytes = 0;
+};
@@ -0,0 +1,480 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "ModelBounds.h"
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace {
+
+BoundingVolume MakeVolume(FXMVECTOR vMin, FXMVECTOR vMax, float radius) {
+    BoundingVolume volume;
+    XMStoreFloat3(&volume.Min, vMin);
+    XMStoreFloat3(&volume.Max, vMax);
+    XMStoreFloat3(&volume.Center, XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f));
+    volume.Radius = radius;
+    volume.IsValid = true;
+    return volume;
+}
+
+// Index of the first key with time > 't', clamped so [i - 1, i] is a valid pair
+size_t FindKey(const AssetVector<float>& timestamps, float t) {
+    size_t key = std::upper_bound(timestamps.begin(), timestamps.end(), t) - timestamps.begin();
+    return std::min(std::max<size_t>(key, 1), timestamps.size() - 1);
+}
+
+XMVECTOR SampleVector3(const AssetVector<float>& timestamps, const AssetVector<XMFLOAT3>& values, float t, FXMVECTOR fallback) {
+    if (values.empty() || timestamps.size() != values.size()) return fallback;
+    if (values.size() == 1) return XMLoadFloat3(&values[0]);
+    size_t key = FindKey(timestamps, t);
+    float span = timestamps[key] - timestamps[key - 1];
+    float alpha = (span > 0.0f) ? std::min(std::max((t - timestamps[key - 1]) / span, 0.0f), 1.0f) : 0.0f;
+    return XMVectorLerp(XMLoadFloat3(&values[key - 1]), XMLoadFloat3(&values[key]), alpha);
+}
+
+XMVECTOR SampleRotation(const AssetVector<float>& timestamps, const AssetVector<XMFLOAT4>& values, float t, FXMVECTOR fallback) {
+    if (values.empty() || timestamps.size() != values.size()) return fallback;
+    if (values.size() == 1) return XMLoadFloat4(&values[0]);
+    size_t key = FindKey(timestamps, t);
+    float span = timestamps[key] - timestamps[key - 1];
+    float alpha = (span > 0.0f) ? std::min(std::max((t - timestamps[key - 1]) / span, 0.0f), 1.0f) : 0.0f;
+    return XMQuaternionSlerp(XMLoadFloat4(&values[key - 1]), XMLoadFloat4(&values[key]), alpha);
+}
+
+// Dual quaternion keys: blended, renormalized, and split into rotation and translation
+bool SampleDualQuaternion(const AssetVector<float>& timestamps, const AssetVector<DualQuaternion>& values, float t,
+                          XMVECTOR& outRotation, XMVECTOR& outTranslation) {
+    if (values.empty() || timestamps.size() != values.size()) return false;
+    size_t key = values.size() == 1 ? 0 : FindKey(timestamps, t);
+    XMVECTOR real = XMLoadFloat4(&values[key].Real);
+    XMVECTOR dual = XMLoadFloat4(&values[key].Dual);
+    if (values.size() > 1) {
+        float span = timestamps[key] - timestamps[key - 1];
+        float alpha = (span > 0.0f) ? std::min(std::max((t - timestamps[key - 1]) / span, 0.0f), 1.0f) : 0.0f;
+        XMVECTOR real0 = XMLoadFloat4(&values[key - 1].Real);
+        float sign = XMVectorGetX(XMVector4Dot(real0, real)) < 0.0f ? -1.0f : 1.0f;
+        real = XMVectorLerp(real0, XMVectorScale(real, sign), alpha);
+        dual = XMVectorLerp(XMLoadFloat4(&values[key - 1].Dual), XMVectorScale(dual, sign), alpha);
+    }
+    float inverseLength = 1.0f / XMVectorGetX(XMVector4Length(real));
+    outRotation = XMVectorScale(real, inverseLength);
+    // Translation = 2 * dual * conjugate(real)
+    outTranslation = XMVectorScale(XMQuaternionMultiply(XMQuaternionConjugate(outRotation), XMVectorScale(dual, inverseLength)), 2.0f);
+    return true;
+}
+
+// Local scale, rotation and translation of a joint at 't'
+struct JointPose {
+    XMFLOAT3 Scale;
+    XMFLOAT4 Rotation;
+    XMFLOAT3 Translation;
+};
+
+JointPose SampleJointPose(const Joint& joint, const AnimationChannel* channel, float t) {
+    XMVECTOR bindScale, bindRotation, bindTranslation;
+    if (!XMMatrixDecompose(&bindScale, &bindRotation, &bindTranslation, XMLoadFloat4x4(&joint.LocalBindTransform))) {
+        bindScale = XMLoadFloat3(&joint.Scale);
+        bindRotation = XMLoadFloat4(&joint.RotationQuat);
+        bindTranslation = XMLoadFloat3(&joint.Translation);
+    }
+    XMVECTOR s = bindScale, r = bindRotation, p = bindTranslation;
+    if (channel) {
+        s = SampleVector3(channel->ScaleTimestamps, channel->Scales, t, bindScale);
+        r = XMQuaternionNormalize(SampleRotation(channel->RotationTimestamps, channel->Rotations, t, bindRotation));
+        p = SampleVector3(channel->PositionTimestamps, channel->Positions, t, bindTranslation);
+        SampleDualQuaternion(channel->DQTimestamps, channel->DQs, t, r, p);
+    }
+    JointPose pose;
+    XMStoreFloat3(&pose.Scale, s);
+    XMStoreFloat4(&pose.Rotation, r);
+    XMStoreFloat3(&pose.Translation, p);
+    return pose;
+}
+
+XMMATRIX JointLocalMatrix(const Joint& joint, const AnimationChannel* channel, const JointPose& pose) {
+    if (!channel) {
+        return XMLoadFloat4x4(&joint.LocalBindTransform);
+    }
+    return XMMatrixAffineTransformation(XMLoadFloat3(&pose.Scale), XMVectorZero(), XMLoadFloat4(&pose.Rotation), XMLoadFloat3(&pose.Translation));
+}
+
+// How far a joint's local transform can move within one interval between keys
+struct JointMotion {
+    float StartScale = 1.0f;       // Largest scale component at the interval start
+    float MaxScale = 1.0f;         // Largest scale component over the interval
+    float ScaleDelta = 0.0f;       // Largest change of a scale component
+    float Angle = 0.0f;            // Rotation angle between the interval ends (radians)
+    float TranslationDelta = 0.0f; // Largest distance of the translation from its start value
+};
+
+float MaxAbsComponent(FXMVECTOR v) {
+    XMVECTOR a = XMVectorAbs(v);
+    return std::max({ XMVectorGetX(a), XMVectorGetY(a), XMVectorGetZ(a) });
+}
+
+// [ta, tb] must not contain a key of 'channel' other than at its ends, so every component moves
+// along a single segment: scales and positions lerp (the extremes are at the ends) and rotations
+// slerp or nlerp along one arc (no point is farther from the start than the end is).
+JointMotion BoundJointMotion(const AnimationChannel* channel, float ta, float tb, const JointPose& a, const JointPose& b) {
+    JointMotion motion;
+    XMVECTOR scaleA = XMLoadFloat3(&a.Scale);
+    XMVECTOR scaleB = XMLoadFloat3(&b.Scale);
+    motion.StartScale = MaxAbsComponent(scaleA);
+    motion.MaxScale = std::max(motion.StartScale, MaxAbsComponent(scaleB));
+    motion.ScaleDelta = MaxAbsComponent(XMVectorSubtract(scaleB, scaleA));
+    float cosHalf = std::min(fabsf(XMVectorGetX(XMVector4Dot(XMLoadFloat4(&a.Rotation), XMLoadFloat4(&b.Rotation)))), 1.0f);
+    motion.Angle = 2.0f * acosf(cosHalf);
+    motion.TranslationDelta = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&b.Translation), XMLoadFloat3(&a.Translation))));
+
+    if (!channel || channel->DQs.size() < 2 || channel->DQTimestamps.size() != channel->DQs.size()) {
+        return motion;
+    }
+    // Blended dual quaternion translations don't move on a line. With R and D the (unnormalized)
+    // blends at ta plus a * (dR, dD), T(a) = 2 D conj(R) / |R|^2 and
+    // |T(a) - T(0)| <= 2 (|c1| + |c2|) / (|R(0)|^2 min|R(a)|^2) on [0, 1], where c1 and c2 are the
+    // linear and quadratic coefficients of the numerator of the difference.
+    const AssetVector<float>& times = channel->DQTimestamps;
+    size_t key = FindKey(times, 0.5f * (ta + tb));
+    float span = times[key] - times[key - 1];
+    auto alphaAt = [&](float t) { return (span > 0.0f) ? std::min(std::max((t - times[key - 1]) / span, 0.0f), 1.0f) : 0.0f; };
+    XMVECTOR real0 = XMLoadFloat4(&channel->DQs[key - 1].Real);
+    XMVECTOR real1 = XMLoadFloat4(&channel->DQs[key].Real);
+    float sign = XMVectorGetX(XMVector4Dot(real0, real1)) < 0.0f ? -1.0f : 1.0f;
+    real1 = XMVectorScale(real1, sign);
+    XMVECTOR dual0 = XMLoadFloat4(&channel->DQs[key - 1].Dual);
+    XMVECTOR dual1 = XMVectorScale(XMLoadFloat4(&channel->DQs[key].Dual), sign);
+    float alphaA = alphaAt(ta), alphaB = alphaAt(tb);
+    XMVECTOR realA = XMVectorLerp(real0, real1, alphaA);
+    XMVECTOR dualA = XMVectorLerp(dual0, dual1, alphaA);
+    XMVECTOR dReal = XMVectorSubtract(XMVectorLerp(real0, real1, alphaB), realA);
+    XMVECTOR dDual = XMVectorSubtract(XMVectorLerp(dual0, dual1, alphaB), dualA);
+
+    float lengthSqA = XMVectorGetX(XMVector4LengthSq(realA));
+    float realDot = XMVectorGetX(XMVector4Dot(realA, dReal));
+    float dRealSq = XMVectorGetX(XMVector4LengthSq(dReal));
+    float minAlpha = dRealSq > 0.0f ? std::min(std::max(-realDot / dRealSq, 0.0f), 1.0f) : 0.0f;
+    float minLengthSq = lengthSqA + 2.0f * minAlpha * realDot + minAlpha * minAlpha * dRealSq;
+    if (lengthSqA <= 1e-12f || minLengthSq <= 1e-12f) {
+        motion.TranslationDelta = FLT_MAX; // Degenerate blend
+        return motion;
+    }
+    // D conj(R) blended: q0 + a q1 + a^2 q2
+    XMVECTOR q0 = XMQuaternionMultiply(XMQuaternionConjugate(realA), dualA);
+    XMVECTOR q1 = XMVectorAdd(XMQuaternionMultiply(XMQuaternionConjugate(dReal), dualA), XMQuaternionMultiply(XMQuaternionConjugate(realA), dDual));
+    XMVECTOR q2 = XMQuaternionMultiply(XMQuaternionConjugate(dReal), dDual);
+    XMVECTOR c1 = XMVectorSubtract(XMVectorScale(q1, lengthSqA), XMVectorScale(q0, 2.0f * realDot));
+    XMVECTOR c2 = XMVectorSubtract(XMVectorScale(q2, lengthSqA), XMVectorScale(q0, dRealSq));
+    float bound = 2.0f * (XMVectorGetX(XMVector4Length(c1)) + XMVectorGetX(XMVector4Length(c2))) / (lengthSqA * minLengthSq);
+    motion.TranslationDelta = std::max(motion.TranslationDelta, bound);
+    return motion;
+}
+
+// Local -> model transforms; parents may appear after their children
+void ResolveModelTransforms(const Skeleton& skeleton, const std::vector<XMFLOAT4X4>& local, std::vector<XMFLOAT4X4>& outModel) {
+    const size_t count = skeleton.Joints.size();
+    outModel.resize(count);
+    std::vector<uint8_t> resolved(count, 0);
+    std::vector<size_t> chain;
+    for (size_t j = 0; j < count; ++j) {
+        // Walk up to the first resolved ancestor, then resolve back down
+        chain.clear();
+        size_t current = j;
+        while (!resolved[current]) {
+            chain.push_back(current);
+            int parent = skeleton.Joints[current].ParentIndex;
+            if (parent < 0 || static_cast<size_t>(parent) >= count || chain.size() > count) break;
+            current = static_cast<size_t>(parent);
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            size_t joint = *it;
+            if (resolved[joint]) continue;
+            XMMATRIX transform = XMLoadFloat4x4(&local[joint]);
+            int parent = skeleton.Joints[joint].ParentIndex;
+            if (parent >= 0 && static_cast<size_t>(parent) < count && resolved[parent]) {
+                transform = XMMatrixMultiply(transform, XMLoadFloat4x4(&outModel[parent]));
+            }
+            XMStoreFloat4x4(&outModel[joint], transform);
+            resolved[joint] = 1;
+        }
+    }
+}
+
+} // namespace
+
+
+bool ModelBounds::ComputeAABB(const AssetVector<Vertex>& vertices, XMFLOAT3& outMin, XMFLOAT3& outMax) {
+    const size_t count = vertices.size();
+    if (count == 0) {
+        return false;
+    }
+
+    // Four independent accumulators hide the min/max latency chain
+    XMVECTOR min0 = XMLoadFloat3(&vertices[0].Position);
+    XMVECTOR max0 = min0, min1 = min0, max1 = min0, min2 = min0, max2 = min0, min3 = min0, max3 = min0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        XMVECTOR p0 = XMLoadFloat3(&vertices[i].Position);
+        XMVECTOR p1 = XMLoadFloat3(&vertices[i + 1].Position);
+        XMVECTOR p2 = XMLoadFloat3(&vertices[i + 2].Position);
+        XMVECTOR p3 = XMLoadFloat3(&vertices[i + 3].Position);
+        min0 = XMVectorMin(min0, p0); max0 = XMVectorMax(max0, p0);
+        min1 = XMVectorMin(min1, p1); max1 = XMVectorMax(max1, p1);
+        min2 = XMVectorMin(min2, p2); max2 = XMVectorMax(max2, p2);
+        min3 = XMVectorMin(min3, p3); max3 = XMVectorMax(max3, p3);
+    }
+    for (; i < count; ++i) {
+        XMVECTOR p = XMLoadFloat3(&vertices[i].Position);
+        min0 = XMVectorMin(min0, p);
+        max0 = XMVectorMax(max0, p);
+    }
+    XMStoreFloat3(&outMin, XMVectorMin(XMVectorMin(min0, min1), XMVectorMin(min2, min3)));
+    XMStoreFloat3(&outMax, XMVectorMax(XMVectorMax(max0, max1), XMVectorMax(max2, max3)));
+    return true;
+}
+
+BoundingVolume ModelBounds::ComputeMeshBounds(const AssetVector<Vertex>& vertices) {
+    XMFLOAT3 boundsMin, boundsMax;
+    if (!ComputeAABB(vertices, boundsMin, boundsMax)) {
+        return BoundingVolume();
+    }
+    XMVECTOR vMin = XMLoadFloat3(&boundsMin);
+    XMVECTOR vMax = XMLoadFloat3(&boundsMax);
+    XMVECTOR center = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+
+    // Sphere around the box center, radius = farthest vertex (tighter than the half diagonal)
+    XMVECTOR maxDistSq = XMVectorZero();
+    for (const Vertex& v : vertices) {
+        maxDistSq = XMVectorMax(maxDistSq, XMVector3LengthSq(XMVectorSubtract(XMLoadFloat3(&v.Position), center)));
+    }
+    return MakeVolume(vMin, vMax, sqrtf(XMVectorGetX(maxDistSq)));
+}
+
+void ModelBounds::Merge(BoundingVolume& inOut, const BoundingVolume& other) {
+    if (!other.IsValid) return;
+    if (!inOut.IsValid) {
+        inOut = other;
+        return;
+    }
+    XMVECTOR vMin = XMVectorMin(XMLoadFloat3(&inOut.Min), XMLoadFloat3(&other.Min));
+    XMVECTOR vMax = XMVectorMax(XMLoadFloat3(&inOut.Max), XMLoadFloat3(&other.Max));
+
+    // Smallest sphere enclosing both spheres
+    XMVECTOR c0 = XMLoadFloat3(&inOut.Center);
+    XMVECTOR c1 = XMLoadFloat3(&other.Center);
+    float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(c1, c0)));
+    XMVECTOR center = c0;
+    float radius = inOut.Radius;
+    if (distance + other.Radius <= inOut.Radius) {
+        // 'other' already inside
+    } else if (distance + inOut.Radius <= other.Radius) {
+        center = c1;
+        radius = other.Radius;
+    } else {
+        radius = (distance + inOut.Radius + other.Radius) * 0.5f;
+        center = XMVectorAdd(c0, XMVectorScale(XMVectorSubtract(c1, c0), (radius - inOut.Radius) / distance));
+    }
+
+    inOut = MakeVolume(vMin, vMax, radius);
+    XMStoreFloat3(&inOut.Center, center);
+}
+
+BoundingVolume ModelBounds::Transform(const BoundingVolume& volume, const XMFLOAT4X4& transform) {
+    if (!volume.IsValid) {
+        return volume;
+    }
+    XMMATRIX m = XMLoadFloat4x4(&transform);
+    XMVECTOR vMin = XMVectorReplicate(FLT_MAX);
+    XMVECTOR vMax = XMVectorReplicate(-FLT_MAX);
+    for (int corner = 0; corner < 8; ++corner) {
+        XMVECTOR p = XMVectorSet((corner & 1) ? volume.Max.x : volume.Min.x,
+                                 (corner & 2) ? volume.Max.y : volume.Min.y,
+                                 (corner & 4) ? volume.Max.z : volume.Min.z, 1.0f);
+        p = XMVector3Transform(p, m);
+        vMin = XMVectorMin(vMin, p);
+        vMax = XMVectorMax(vMax, p);
+    }
+    float scale = std::max({ XMVectorGetX(XMVector3Length(m.r[0])), XMVectorGetX(XMVector3Length(m.r[1])),
+                             XMVectorGetX(XMVector3Length(m.r[2])) });
+    BoundingVolume result = MakeVolume(vMin, vMax, volume.Radius * scale);
+    XMStoreFloat3(&result.Center, XMVector3Transform(XMLoadFloat3(&volume.Center), m));
+    return result;
+}
+
+BoundingVolume ModelBounds::ComputeClipBounds(const Model& model, const AnimationClip& clip) {
+    BoundingVolume result;
+    if (!model.pSkeleton || model.pSkeleton->Joints.empty()) {
+        return result;
+    }
+    const Skeleton& skeleton = *model.pSkeleton;
+    const size_t jointCount = skeleton.Joints.size();
+
+    // Bind-space box of the vertices each joint influences
+    std::vector<XMFLOAT3> jointMin(jointCount), jointMax(jointCount);
+    std::vector<bool> jointUsed(jointCount, false);
+    for (const Mesh& mesh : model.Meshes) {
+        for (const Vertex& v : mesh.Vertices) {
+            const float weights[4] = { v.BoneWeights.x, v.BoneWeights.y, v.BoneWeights.z, v.BoneWeights.w };
+            const uint32_t joints[4] = { v.BoneIndices.x, v.BoneIndices.y, v.BoneIndices.z, v.BoneIndices.w };
+            for (int k = 0; k < 4; ++k) {
+                if (weights[k] <= 0.0f || joints[k] >= jointCount) continue;
+                uint32_t j = joints[k];
+                if (!jointUsed[j]) {
+                    jointMin[j] = jointMax[j] = v.Position;
+                    jointUsed[j] = true;
+                } else {
+                    XMStoreFloat3(&jointMin[j], XMVectorMin(XMLoadFloat3(&jointMin[j]), XMLoadFloat3(&v.Position)));
+                    XMStoreFloat3(&jointMax[j], XMVectorMax(XMLoadFloat3(&jointMax[j]), XMLoadFloat3(&v.Position)));
+                }
+            }
+        }
+    }
+
+    std::vector<const AnimationChannel*> jointChannels(jointCount, nullptr);
+    std::vector<float> sampleTimes = { 0.0f, clip.Duration };
+    for (const AnimationChannel& channel : clip.Channels) {
+        auto it = skeleton.JointNameToIndex.find(channel.TargetNodeId);
+        if (it != skeleton.JointNameToIndex.end() && it->second >= 0 && static_cast<size_t>(it->second) < jointCount) {
+            jointChannels[it->second] = &channel;
+        }
+        sampleTimes.insert(sampleTimes.end(), channel.PositionTimestamps.begin(), channel.PositionTimestamps.end());
+        sampleTimes.insert(sampleTimes.end(), channel.RotationTimestamps.begin(), channel.RotationTimestamps.end());
+        sampleTimes.insert(sampleTimes.end(), channel.ScaleTimestamps.begin(), channel.ScaleTimestamps.end());
+        sampleTimes.insert(sampleTimes.end(), channel.DQTimestamps.begin(), channel.DQTimestamps.end());
+    }
+    std::sort(sampleTimes.begin(), sampleTimes.end());
+    sampleTimes.erase(std::unique(sampleTimes.begin(), sampleTimes.end()), sampleTimes.end());
+
+    // The padding below grows with the motion between samples, so split intervals with large
+    // rotations or translations (relative to the bind-pose extent) to keep the box tight
+    float extent = 0.0f;
+    for (size_t j = 0; j < jointCount; ++j) {
+        if (jointUsed[j]) {
+            extent = std::max(extent, XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&jointMax[j]), XMLoadFloat3(&jointMin[j])))));
+        }
+    }
+    const float maxStepAngle = 0.05f;
+    const float maxStepTranslation = std::max(extent * 0.025f, 1e-4f);
+    const size_t maxSubdivisions = 64;
+    std::vector<float> keyTimes;
+    keyTimes.swap(sampleTimes);
+    for (size_t i = 0; i < keyTimes.size(); ++i) {
+        sampleTimes.push_back(keyTimes[i]);
+        if (i + 1 == keyTimes.size()) break;
+        float ta = keyTimes[i], tb = keyTimes[i + 1];
+        float steps = 1.0f;
+        for (size_t j = 0; j < jointCount; ++j) {
+            if (!jointChannels[j]) continue;
+            JointMotion motion = BoundJointMotion(jointChannels[j], ta, tb, SampleJointPose(skeleton.Joints[j], jointChannels[j], ta),
+                                                  SampleJointPose(skeleton.Joints[j], jointChannels[j], tb));
+            steps = std::max({ steps, motion.Angle / maxStepAngle, motion.TranslationDelta / maxStepTranslation });
+        }
+        size_t subdivisions = std::min(static_cast<size_t>(ceilf(std::min(steps, static_cast<float>(maxSubdivisions)))), maxSubdivisions);
+        for (size_t k = 1; k < subdivisions; ++k) {
+            sampleTimes.push_back(ta + (tb - ta) * static_cast<float>(k) / static_cast<float>(subdivisions));
+        }
+    }
+    const size_t sampleCount = sampleTimes.size();
+
+    std::vector<JointPose> poses(sampleCount * jointCount);
+    for (size_t i = 0; i < sampleCount; ++i) {
+        for (size_t j = 0; j < jointCount; ++j) {
+            poses[i * jointCount + j] = SampleJointPose(skeleton.Joints[j], jointChannels[j], sampleTimes[i]);
+        }
+    }
+
+    std::vector<XMFLOAT4X4> local(jointCount), modelSpace;
+    std::vector<JointMotion> motions(jointCount);
+    XMVECTOR vMin = XMVectorReplicate(FLT_MAX);
+    XMVECTOR vMax = XMVectorReplicate(-FLT_MAX);
+    XMVECTOR corners[8];
+    for (size_t i = 0; i < sampleCount; ++i) {
+        const JointPose* pose = &poses[i * jointCount];
+        for (size_t j = 0; j < jointCount; ++j) {
+            XMStoreFloat4x4(&local[j], JointLocalMatrix(skeleton.Joints[j], jointChannels[j], pose[j]));
+        }
+        ResolveModelTransforms(skeleton, local, modelSpace);
+        const bool hasInterval = i + 1 < sampleCount;
+        if (hasInterval) {
+            for (size_t j = 0; j < jointCount; ++j) {
+                motions[j] = BoundJointMotion(jointChannels[j], sampleTimes[i], sampleTimes[i + 1], pose[j], pose[jointCount + j]);
+            }
+        }
+
+        for (size_t j = 0; j < jointCount; ++j) {
+            if (!jointUsed[j]) continue;
+            XMMATRIX inverseBind = XMLoadFloat4x4(&skeleton.Joints[j].InverseBindPoseMatrix);
+            XMMATRIX jointToModel = XMLoadFloat4x4(&modelSpace[j]);
+            XMVECTOR boxMin = XMVectorReplicate(FLT_MAX);
+            XMVECTOR boxMax = XMVectorReplicate(-FLT_MAX);
+            for (int corner = 0; corner < 8; ++corner) {
+                // Joint space corner (the skinning matrix is inverse bind x joint to model)
+                corners[corner] = XMVector3Transform(XMVectorSet((corner & 1) ? jointMax[j].x : jointMin[j].x,
+                                                                 (corner & 2) ? jointMax[j].y : jointMin[j].y,
+                                                                 (corner & 4) ? jointMax[j].z : jointMin[j].z, 1.0f), inverseBind);
+                XMVECTOR p = XMVector3Transform(corners[corner], jointToModel);
+                boxMin = XMVectorMin(boxMin, p);
+                boxMax = XMVectorMax(boxMax, p);
+            }
+            vMin = XMVectorMin(vMin, boxMin);
+            vMax = XMVectorMax(vMax, boxMax);
+            if (!hasInterval) continue;
+
+            // Until the next key each skinned point stays within 'reach' of where it is now. Walking
+            // from the joint to the root, with y the point in the space a joint's local transform
+            // S R + T applies to, the transform moves it by at most |y| (dS + S0 * angle) + dT, and
+            // the error carried up from the children grows by at most the joint's largest scale.
+            // Chord <= arc <= radius * angle, so the padding holds for any rotation between the keys.
+            float reach = 0.0f;
+            size_t current = j;
+            for (size_t depth = 0; depth < jointCount; ++depth) {
+                const JointMotion& motion = motions[current];
+                float radius = 0.0f;
+                XMMATRIX transform = XMLoadFloat4x4(&local[current]);
+                for (XMVECTOR& y : corners) {
+                    radius = std::max(radius, XMVectorGetX(XMVector3Length(y)));
+                    y = XMVector3Transform(y, transform);
+                }
+                reach = reach * motion.MaxScale + radius * (motion.ScaleDelta + motion.StartScale * motion.Angle) + motion.TranslationDelta;
+                int parent = skeleton.Joints[current].ParentIndex;
+                if (parent < 0 || static_cast<size_t>(parent) >= jointCount) break;
+                current = static_cast<size_t>(parent);
+            }
+            if (!(reach < FLT_MAX)) {
+                continue; // Degenerate dual quaternion blend; nothing sensible to pad by
+            }
+            XMVECTOR padding = XMVectorReplicate(reach);
+            vMin = XMVectorMin(vMin, XMVectorSubtract(boxMin, padding));
+            vMax = XMVectorMax(vMax, XMVectorAdd(boxMax, padding));
+        }
+    }
+    if (XMVectorGetX(vMin) > XMVectorGetX(vMax)) {
+        return result; // No skinned vertices
+    }
+    // Skinned positions are convex combinations of the per-joint positions, so the union box holds them all
+    return MakeVolume(vMin, vMax, 0.5f * XMVectorGetX(XMVector3Length(XMVectorSubtract(vMax, vMin))));
+}
+
+void ModelBounds::ComputeModelBounds(Model& model) {
+    model.Bounds = BoundingVolume();
+    for (Mesh& mesh : model.Meshes) {
+        mesh.Bounds = ComputeMeshBounds(mesh.Vertices);
+        if (model.Instances.empty()) {
+            Merge(model.Bounds, mesh.Bounds);
+        }
+    }
+    for (const MeshInstance& instance : model.Instances) {
+        if (instance.MeshIndex < model.Meshes.size()) {
+            Merge(model.Bounds, Transform(model.Meshes[instance.MeshIndex].Bounds, instance.Transform));
+        }
+    }
+
+    model.AnimatedBounds = model.Bounds;
+    for (AnimationClip& clip : model.Animations) {
+        clip.Bounds = ComputeClipBounds(model, clip);
+        Merge(model.AnimatedBounds, clip.Bounds);
+    }
+}
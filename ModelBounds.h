@@ -0,0 +1,36 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <vector>
+
+// Bounding volume computation for meshes, models and animation clips (cook / load time)
+class ModelBounds {
+public:
+    // SIMD min/max reduction over vertex positions. Returns false for an empty vertex list.
+    static bool ComputeAABB(const AssetVector<Vertex>& vertices, DirectX::XMFLOAT3& outMin, DirectX::XMFLOAT3& outMax);
+
+    // Tight AABB plus a sphere centered on the box
+    static BoundingVolume ComputeMeshBounds(const AssetVector<Vertex>& vertices);
+
+    // Grows 'inOut' to enclose 'other' (box union and enclosing sphere of both spheres)
+    static void Merge(BoundingVolume& inOut, const BoundingVolume& other);
+
+    // 'volume' moved by an affine transform: box of the transformed corners, sphere scaled by the largest axis scale
+    static BoundingVolume Transform(const BoundingVolume& volume, const DirectX::XMFLOAT4X4& transform);
+
+    // Conservative bounds of the skinned meshes over the whole of 'clip'.
+    // Each joint's bind-space box of influenced vertices is moved by the joint's skinning
+    // matrix at every key (intervals with large motion are subdivided) and the results are unioned.
+    // The box at each sample is padded by how far the joint chain can carry a point before the next
+    // one: per ancestor, rotation angle x reach plus scale and translation change, so poses between
+    // samples stay inside.
+    static BoundingVolume ComputeClipBounds(const Model& model, const AnimationClip& clip);
+
+    // Fills Mesh::Bounds, Model::Bounds (over Model::Instances when present), AnimationClip::Bounds and Model::AnimatedBounds
+    static void ComputeModelBounds(Model& model);
+};
@@ -0,0 +1,254 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "ModelCooker.h"
+#include "MeshOptimizer.h"
+#include "Meshlets.h"
+#include "ModelBounds.h"
+#include "PoseEvaluator.h"
+#include <iostream>
+#include <iomanip>
+
+ModelCooker::ModelCooker() {}
+
+ModelCooker::ModelCooker(const CookSettings& settings) : m_settings(settings) {}
+
+bool ModelCooker::Cook(Model& model, const std::string& modelName) {
+    AssignNameIds(model);
+
+    // Parents-first joints, before anything stores joint indices (packed vertices, bounds)
+    if (!PoseEvaluator::SortJoints(model)) {
+        LogMessage(modelName + " skeleton has a cyclic joint hierarchy");
+        return false;
+    }
+
+    // Before the expensive stages, so each distinct geometry is processed once
+    size_t sourceMeshes = model.Meshes.size();
+    size_t duplicates = DeduplicateMeshes(model);
+    if (m_settings.PrintStats && duplicates > 0) {
+        LogMessage(modelName + " merged " + std::to_string(duplicates) + " of " + std::to_string(sourceMeshes) +
+                   " meshes into shared geometry (" + std::to_string(model.Instances.size()) + " instances)");
+    }
+
+    for (size_t i = 0; i < model.Meshes.size(); ++i) {
+        Mesh& mesh = model.Meshes[i];
+        if (mesh.Indices.empty() || mesh.Vertices.empty()) {
+            continue;
+        }
+
+        if (m_settings.OptimizeMeshes) {
+            VertexCacheStats before, after;
+            MeshOptimizer::Optimize(mesh, m_settings.OverdrawThreshold, &before, &after);
+
+            if (m_settings.PrintStats) {
+                std::ostringstream ss;
+                ss << std::fixed << std::setprecision(3);
+                ss << modelName << " mesh " << i << " (" << mesh.Indices.size() / 3 << " tris, " << mesh.Vertices.size() << " verts): "
+                   << "ACMR " << before.ACMR << " -> " << after.ACMR << ", "
+                   << "ATVR " << before.ATVR << " -> " << after.ATVR;
+                LogMessage(ss.str());
+            }
+        }
+
+        // LODs index the final (fetch optimized) vertex order, so they're built after optimization
+        if (m_settings.GenerateLods) {
+            MeshSimplifier::GenerateLods(mesh, m_settings.Lods);
+
+            if (m_settings.PrintStats && !mesh.Lods.empty()) {
+                std::ostringstream ss;
+                ss << std::setprecision(4);
+                ss << modelName << " mesh " << i << " LODs (tris/error):";
+                for (const MeshLod& lod : mesh.Lods) {
+                    ss << " " << lod.IndexCount / 3 << "/" << lod.Error;
+                }
+                LogMessage(ss.str());
+            }
+        }
+
+        if (m_settings.BuildMeshlets) {
+            MeshletBuilder::Build(mesh);
+            if (m_settings.PrintStats) {
+                LogMessage(modelName + " mesh " + std::to_string(i) + " meshlets: " + std::to_string(mesh.Meshlets.size()));
+            }
+        }
+
+        VertexQuantizationReport packReport = VertexQuantization::PackMesh(mesh, m_settings.VertexPacking);
+        if (!packReport.Error.empty()) {
+            LogMessage(modelName + " mesh " + std::to_string(i) + " kept full vertex format: " + packReport.Error);
+        } else if (m_settings.PrintStats && packReport.Format != VertexFormat::Full) {
+            std::ostringstream ss;
+            ss << std::setprecision(4);
+            ss << modelName << " mesh " << i << " packed " << packReport.SourceBytes << " -> " << packReport.PackedBytes << " bytes"
+               << " (stride " << mesh.VertexStride << "), max error: position " << packReport.MaxPositionError
+               << ", normal " << packReport.MaxNormalErrorDegrees << " deg"
+               << ", uv " << packReport.MaxTexCoordError
+               << ", weight " << packReport.MaxBoneWeightError;
+            LogMessage(ss.str());
+        }
+
+        mesh.IndexCount = static_cast<UINT>(mesh.Indices.size());
+    }
+    for (Mesh& mesh : model.Meshes) {
+        mesh.ContentHash = ComputeMeshHash(mesh);
+    }
+
+    // Mesh, model and per-clip animated bounds so culling never has to walk or skin vertices
+    ModelBounds::ComputeModelBounds(model);
+    if (m_settings.PrintStats && model.AnimatedBounds.IsValid) {
+        std::ostringstream ss;
+        ss << std::setprecision(4);
+        ss << modelName << " bounds radius " << model.Bounds.Radius << ", animated radius " << model.AnimatedBounds.Radius;
+        LogMessage(ss.str());
+    }
+
+    // Last: clip bounds above are computed from the float keys
+    Skeleton noSkeleton;
+    const Skeleton& skeleton = model.pSkeleton ? *model.pSkeleton : noSkeleton;
+    if (m_settings.DualQuaternionKeys) {
+        for (size_t i = 0; i < model.Animations.size(); ++i) {
+            size_t converted = AnimationCompressor::ConvertToDualQuaternionKeys(model.Animations[i], skeleton);
+            if (m_settings.PrintStats && converted > 0) {
+                LogMessage(modelName + " clip " + std::to_string(i) + ": " + std::to_string(converted) + " of " +
+                           std::to_string(model.Animations[i].Channels.size()) + " channels as dual quaternion keys");
+            }
+        }
+    }
+    if (m_settings.CompressAnimations) {
+        for (size_t i = 0; i < model.Animations.size(); ++i) {
+            AnimationClip& clip = model.Animations[i];
+            AnimationCompressionStats stats;
+            if (!AnimationCompressor::Compress(clip, skeleton, m_settings.Animation, &stats)) {
+                if (stats.MaxError > m_settings.Animation.Tolerance) {
+                    std::ostringstream ss;
+                    ss << std::setprecision(5) << modelName << " clip " << i << ": compression error " << stats.MaxError
+                       << " over the tolerance " << m_settings.Animation.Tolerance << ", kept uncompressed";
+                    LogMessage(ss.str());
+                }
+                continue;
+            }
+            if (!m_settings.PrintStats) {
+                continue;
+            }
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(1);
+            ss << modelName << " clip " << i << ": keys " << stats.SourceKeys << " -> "
+               << stats.StoredKeys << " (" << stats.FloatTracks << " float tracks), " << stats.SourceBytes / 1024.0 << " KB -> " << stats.CompressedBytes / 1024.0
+               << " KB, max error " << std::setprecision(5) << stats.MaxError;
+            LogMessage(ss.str());
+        }
+    }
+    return true;
+}
+
+void ModelCooker::AssignNameIds(Model& model) {
+    auto intern = [](const AssetString& name) { return name.empty() ? StringId() : StringId::Intern(name); };
+
+    model.MaterialNameToIndex.clear();
+    for (size_t i = 0; i < model.Materials.size(); ++i) {
+        Material& material = model.Materials[i];
+        material.NameId = intern(material.Name);
+        model.MaterialNameToIndex[material.NameId] = static_cast<int>(i);
+    }
+    for (Mesh& mesh : model.Meshes) {
+        mesh.MaterialNameId = intern(mesh.MaterialName);
+    }
+    if (model.pSkeleton) {
+        model.pSkeleton->JointNameToIndex.clear();
+        for (size_t i = 0; i < model.pSkeleton->Joints.size(); ++i) {
+            Joint& joint = model.pSkeleton->Joints[i];
+            joint.NameId = intern(joint.Name);
+            model.pSkeleton->JointNameToIndex[joint.NameId] = static_cast<int>(i);
+        }
+    }
+    for (AnimationClip& clip : model.Animations) {
+        clip.NameId = intern(clip.Name);
+        for (AnimationChannel& channel : clip.Channels) {
+            channel.TargetNodeId = intern(channel.TargetNodeName);
+        }
+    }
+}
+
+size_t ModelCooker::DeduplicateMeshes(Model& model) {
+    // Cooking is deterministic, so meshes with the same source geometry cook to the same output
+    std::map<Hash128, uint32_t> uniqueIndex;
+    std::vector<uint32_t> remap(model.Meshes.size());
+    std::vector<uint32_t> keep;
+    for (size_t i = 0; i < model.Meshes.size(); ++i) {
+        const Mesh& mesh = model.Meshes[i];
+        ContentHasher hasher;
+        uint64_t materialId = mesh.MaterialNameId.GetValue();
+        uint64_t counts[2] = { mesh.Vertices.size(), mesh.Indices.size() };
+        hasher.Update(&materialId, sizeof(materialId));
+        hasher.Update(counts, sizeof(counts));
+        if (!mesh.Vertices.empty()) hasher.Update(mesh.Vertices.data(), mesh.Vertices.size() * sizeof(Vertex));
+        if (!mesh.Indices.empty()) hasher.Update(mesh.Indices.data(), mesh.Indices.size() * sizeof(uint32_t));
+
+        auto inserted = uniqueIndex.emplace(hasher.Finalize(), static_cast<uint32_t>(keep.size()));
+        if (inserted.second) {
+            keep.push_back(static_cast<uint32_t>(i));
+        }
+        remap[i] = inserted.first->second;
+    }
+    size_t removed = model.Meshes.size() - keep.size();
+    if (removed == 0) {
+        return 0;
+    }
+
+    if (model.Instances.empty()) {
+        // The model drew every mesh once; keep that as explicit instances
+        for (size_t i = 0; i < model.Meshes.size(); ++i) {
+            MeshInstance instance;
+            DirectX::XMStoreFloat4x4(&instance.Transform, DirectX::XMMatrixIdentity());
+            instance.MeshIndex = static_cast<uint32_t>(i);
+            model.Instances.push_back(instance);
+        }
+    }
+    for (MeshInstance& instance : model.Instances) {
+        if (instance.MeshIndex < remap.size()) {
+            instance.MeshIndex = remap[instance.MeshIndex];
+        }
+    }
+
+    AssetVector<Mesh> meshes(model.GetAllocator());
+    meshes.reserve(keep.size());
+    for (uint32_t i : keep) {
+        meshes.push_back(std::move(model.Meshes[i]));
+    }
+    model.Meshes = std::move(meshes);
+    return removed;
+}
+
+Hash128 ModelCooker::ComputeMeshHash(const Mesh& mesh) {
+    ContentHasher hasher;
+    auto add = [&hasher](const auto& values) {
+        uint64_t count = values.size();
+        hasher.Update(&count, sizeof(count));
+        if (count > 0) hasher.Update(values.data(), values.size() * sizeof(values[0]));
+    };
+    add(mesh.Vertices);
+    add(mesh.Indices);
+    add(mesh.Lods);
+    add(mesh.LodIndices);
+    add(mesh.Meshlets);
+    add(mesh.MeshletVertices);
+    add(mesh.MeshletTriangles);
+    add(mesh.PackedVertices);
+    // Field by field, BoundingVolume has padding
+    const BoundingVolume& b = mesh.Bounds;
+    float bounds[10] = { b.Min.x, b.Min.y, b.Min.z, b.Max.x, b.Max.y, b.Max.z, b.Center.x, b.Center.y, b.Center.z, b.Radius };
+    float packing[6] = { mesh.PositionScale.x, mesh.PositionScale.y, mesh.PositionScale.z,
+                         mesh.PositionOffset.x, mesh.PositionOffset.y, mesh.PositionOffset.z };
+    uint32_t layout[5] = { static_cast<uint32_t>(b.IsValid), static_cast<uint32_t>(mesh.PackedFormat),
+                           mesh.IndexCount, mesh.VertexStride, mesh.VertexOffset };
+    hasher.Update(bounds, sizeof(bounds));
+    hasher.Update(packing, sizeof(packing));
+    hasher.Update(layout, sizeof(layout));
+    return hasher.Finalize();
+}
+
+void ModelCooker::LogMessage(const std::string& message) {
+    std::cout << "Model Cooker: " << message << std::endl;
+    OutputDebugStringA(("Model Cooker: " + message + "\n").c_str());
+}
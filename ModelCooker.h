@@ -0,0 +1,57 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include "VertexQuantization.h"
+#include "AnimationCompression.h"
+#include "MeshSimplifier.h"
+#include <string>
+
+// Options controlling which offline processing stages run on a model
+struct CookSettings {
+    bool OptimizeMeshes = true;      // Vertex cache, overdraw and vertex fetch optimization
+    float OverdrawThreshold = 1.05f; // Max ACMR degradation allowed by overdraw cluster sorting
+    bool GenerateLods = true;        // Quadric simplified LOD chain per mesh
+    LodSettings Lods;
+    bool BuildMeshlets = true;       // 64 vertex / 124 triangle clusters with culling bounds
+    PositionQuantization VertexPacking = PositionQuantization::UNorm16; // None keeps the full Vertex
+    bool PrintStats = true;          // Print per-mesh statistics to stdout / debug output
+    bool CompressPayloads = true;    // AssetCooker: LZ block compress cooked models and waves (BlockCompression.h)
+    bool ShareGeometry = true;       // AssetCooker: meshes go to content-addressed .agg files shared by all models
+    bool CompressAnimations = true;  // Reduced, quantized clip keys (AnimationCompression.h)
+    bool DualQuaternionKeys = false; // Rigid channels as dual quaternion keys, for dual quaternion skinning runtimes
+    AnimationCompressionSettings Animation;
+};
+
+// Runs offline processing on parsed models (ColladaParser output) before they are
+// written to the cooked format or uploaded to the GPU.
+class ModelCooker {
+public:
+    ModelCooker();
+    explicit ModelCooker(const CookSettings& settings);
+
+    // Processes all meshes of the model in place. 'modelName' is only used for logging.
+    bool Cook(Model& model, const std::string& modelName);
+
+    // Interns every name (materials, joints, clips, channel targets) into its StringId field and
+    // rebuilds the id lookup maps. First cook stage; also for parsed models that skip cooking.
+    static void AssignNameIds(Model& model);
+
+    // Merges meshes with identical source geometry and material into one, remapping Model::Instances
+    // (created first, one per mesh, when the model had none). Returns the number of meshes removed.
+    static size_t DeduplicateMeshes(Model& model);
+    // Hash of everything a cooked mesh stores except its material: equal for content-identical
+    // meshes in any model, so it names the shared geometry file (AssetCooker) and batches instances
+    static Hash128 ComputeMeshHash(const Mesh& mesh);
+
+    const CookSettings& GetSettings() const { return m_settings; }
+
+private:
+    CookSettings m_settings;
+
+    void LogMessage(const std::string& message);
+};
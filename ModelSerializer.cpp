@@ -0,0 +1,913 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "ModelSerializer.h"
+#include "AssetCache.h"
+#include "BlockCompression.h"
+#include "VirtualFileSystem.h"
+#include "PoseEvaluator.h"
+#include <cstring>
+#include <map>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <type_traits>
+
+namespace {
+
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+    void WriteBytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_out.insert(m_out.end(), bytes, bytes + size);
+    }
+
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Write requires a POD type");
+        WriteBytes(&value, sizeof(T));
+    }
+
+    template <typename Vector>
+    void WriteVector(const Vector& values) {
+        using T = typename Vector::value_type;
+        static_assert(std::is_trivially_copyable<T>::value, "WriteVector requires a POD element type");
+        Write(static_cast<uint32_t>(values.size()));
+        if (!values.empty()) {
+            WriteBytes(values.data(), values.size() * sizeof(T));
+        }
+    }
+
+    void WriteString(std::wstring_view text) {
+        // Stored as UTF-16 code units regardless of wchar_t size
+        Write(static_cast<uint32_t>(text.size()));
+        for (wchar_t c : text) {
+            Write(static_cast<uint16_t>(c));
+        }
+    }
+
+private:
+    std::vector<uint8_t>& m_out;
+};
+
+class BinaryReader {
+public:
+    BinaryReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    bool ReadBytes(void* out, size_t size) {
+        if (m_failed || size > m_size - m_offset) {
+            m_failed = true;
+            return false;
+        }
+        memcpy(out, m_data + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Read requires a POD type");
+        return ReadBytes(&value, sizeof(T));
+    }
+
+    template <typename Vector>
+    bool ReadVector(Vector& values) {
+        using T = typename Vector::value_type;
+        uint32_t count = 0;
+        if (!Read(count)) return false;
+        // Reject counts that can't fit in the remaining data before allocating
+        if (static_cast<uint64_t>(count) * sizeof(T) > m_size - m_offset) {
+            m_failed = true;
+            return false;
+        }
+        values.resize(count);
+        return count == 0 || ReadBytes(values.data(), count * sizeof(T));
+    }
+
+    template <typename String>
+    bool ReadString(String& text) {
+        uint32_t length = 0;
+        if (!Read(length)) return false;
+        if (static_cast<uint64_t>(length) * sizeof(uint16_t) > m_size - m_offset) {
+            m_failed = true;
+            return false;
+        }
+        text.resize(length);
+        for (uint32_t i = 0; i < length; ++i) {
+            uint16_t c = 0;
+            Read(c);
+            text[i] = static_cast<wchar_t>(c);
+        }
+        return !m_failed;
+    }
+
+    bool Failed() const { return m_failed; }
+    size_t Remaining() const { return m_size - m_offset; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset = 0;
+    bool m_failed = false;
+};
+
+// Cooked files store name ids. Models that skipped ModelCooker may only have the names.
+StringId ResolveId(StringId id, std::wstring_view name) {
+    return id.IsValid() || name.empty() ? id : StringId::Intern(name);
+}
+
+// Optional id -> name table at the end of the payload (debug cooks), for names in tools and logs
+class NameTable {
+public:
+    explicit NameTable(bool enabled) : m_enabled(enabled) {}
+    void Add(StringId id, std::wstring_view name) {
+        if (m_enabled && id.IsValid() && !name.empty()) {
+            m_names.emplace(id, std::wstring(name));
+        }
+    }
+    const std::map<StringId, std::wstring>& GetNames() const { return m_names; }
+
+private:
+    bool m_enabled;
+    std::map<StringId, std::wstring> m_names; // Sorted so the output is deterministic
+};
+
+enum class MeshStorage : uint8_t {
+    Inline = 0, // Geometry follows the record
+    Shared,     // Path of a shared geometry file (relative to the model file) follows the record
+};
+
+void WriteMeshGeometry(BinaryWriter& writer, const Mesh& mesh) {
+    writer.WriteVector(mesh.Vertices);
+    writer.WriteVector(mesh.Indices);
+    writer.WriteVector(mesh.Lods);
+    writer.WriteVector(mesh.LodIndices);
+    writer.WriteVector(mesh.Meshlets);
+    writer.WriteVector(mesh.MeshletVertices);
+    writer.WriteVector(mesh.MeshletTriangles);
+    writer.Write(mesh.Bounds);
+    writer.Write(static_cast<uint8_t>(mesh.PackedFormat));
+    writer.WriteVector(mesh.PackedVertices);
+    writer.Write(mesh.PositionScale);
+    writer.Write(mesh.PositionOffset);
+    writer.Write(static_cast<uint32_t>(mesh.IndexCount));
+    writer.Write(static_cast<uint32_t>(mesh.VertexStride));
+    writer.Write(static_cast<uint32_t>(mesh.VertexOffset));
+}
+
+bool ReadMeshGeometry(BinaryReader& reader, Mesh& mesh) {
+    uint8_t packedFormat = 0;
+    uint32_t indexCount = 0, vertexStride = 0, vertexOffset = 0;
+
+    reader.ReadVector(mesh.Vertices);
+    reader.ReadVector(mesh.Indices);
+    reader.ReadVector(mesh.Lods);
+    reader.ReadVector(mesh.LodIndices);
+    reader.ReadVector(mesh.Meshlets);
+    reader.ReadVector(mesh.MeshletVertices);
+    reader.ReadVector(mesh.MeshletTriangles);
+    reader.Read(mesh.Bounds);
+    reader.Read(packedFormat);
+    reader.ReadVector(mesh.PackedVertices);
+    reader.Read(mesh.PositionScale);
+    reader.Read(mesh.PositionOffset);
+    reader.Read(indexCount);
+    reader.Read(vertexStride);
+    reader.Read(vertexOffset);
+    if (reader.Failed() || packedFormat > static_cast<uint8_t>(VertexFormat::SkinnedUNorm16)) {
+        return false;
+    }
+
+    mesh.PackedFormat = static_cast<VertexFormat>(packedFormat);
+    mesh.IndexCount = indexCount;
+    mesh.VertexStride = vertexStride;
+    mesh.VertexOffset = vertexOffset;
+    return true;
+}
+
+// Meshes without a content hash (not cooked by ModelCooker) are always written inline
+void WriteMesh(BinaryWriter& writer, const Mesh& mesh, NameTable& names, const std::wstring& sharedGeometryDirectory) {
+    StringId materialId = ResolveId(mesh.MaterialNameId, mesh.MaterialName);
+    names.Add(materialId, mesh.MaterialName);
+    bool shared = !sharedGeometryDirectory.empty() && mesh.ContentHash != Hash128();
+    writer.Write(static_cast<uint8_t>(shared ? MeshStorage::Shared : MeshStorage::Inline));
+    writer.Write(mesh.ContentHash);
+    writer.Write(materialId.GetValue());
+    if (shared) {
+        std::filesystem::path path = std::filesystem::path(sharedGeometryDirectory) / ModelSerializer::GetGeometryFileName(mesh.ContentHash);
+        writer.WriteString(path.generic_wstring());
+    } else {
+        WriteMeshGeometry(writer, mesh);
+    }
+}
+
+// A shared mesh only gets its hash and material here; 'outSharedPath' receives the reference
+bool ReadMesh(BinaryReader& reader, Mesh& mesh, std::wstring& outSharedPath) {
+    uint8_t storage = 0;
+    uint64_t materialId = 0;
+    reader.Read(storage);
+    reader.Read(mesh.ContentHash);
+    reader.Read(materialId);
+    mesh.MaterialNameId = StringId(materialId);
+    outSharedPath.clear();
+    if (storage == static_cast<uint8_t>(MeshStorage::Shared)) {
+        return reader.ReadString(outSharedPath) && !outSharedPath.empty();
+    }
+    return storage == static_cast<uint8_t>(MeshStorage::Inline) && ReadMeshGeometry(reader, mesh);
+}
+
+// Fills a shared mesh from its geometry file, keeping the material of the referencing model
+bool ReadSharedGeometry(const std::wstring& path, Mesh& mesh) {
+    FileView file;
+    if (!VirtualFileSystem::Get().ReadFile(path, file)) {
+        OutputDebugString((L"ModelSerializer: Missing shared geometry " + path + L"\n").c_str());
+        return false;
+    }
+    CookedModelHeader header;
+    if (!ModelSerializer::IsCookedModel(file.Data(), file.Size())) {
+        return false;
+    }
+    memcpy(&header, file.Data(), sizeof(header));
+    if (header.MeshCount != 1 || header.PayloadBytes > file.Size() - sizeof(CookedModelHeader)) {
+        return false;
+    }
+
+    BinaryReader reader(file.Data() + sizeof(CookedModelHeader), static_cast<size_t>(header.PayloadBytes));
+    BoundingVolume bounds;
+    reader.Read(bounds);
+    reader.Read(bounds);
+    Hash128 expectedHash = mesh.ContentHash;
+    StringId materialId = mesh.MaterialNameId;
+    std::wstring nestedPath;
+    if (!ReadMesh(reader, mesh, nestedPath) || !nestedPath.empty() || mesh.ContentHash != expectedHash) {
+        OutputDebugString((L"ModelSerializer: Stale or corrupt shared geometry " + path + L"\n").c_str());
+        return false;
+    }
+    mesh.MaterialNameId = materialId;
+    return true;
+}
+
+void WriteInstance(BinaryWriter& writer, const MeshInstance& instance, NameTable& names) {
+    std::string nodeName;
+    if (StringInterner::TryGetName(instance.NodeNameId, nodeName)) {
+        names.Add(instance.NodeNameId, instance.NodeNameId.ToWideString());
+    }
+    writer.Write(instance.Transform);
+    writer.Write(instance.MeshIndex);
+    writer.Write(instance.NodeNameId.GetValue());
+}
+
+bool ReadInstance(BinaryReader& reader, MeshInstance& instance) {
+    uint64_t nodeId = 0;
+    reader.Read(instance.Transform);
+    reader.Read(instance.MeshIndex);
+    reader.Read(nodeId);
+    instance.NodeNameId = StringId(nodeId);
+    return !reader.Failed();
+}
+
+void WriteMaterial(BinaryWriter& writer, const Material& material, NameTable& names) {
+    StringId nameId = ResolveId(material.NameId, material.Name);
+    names.Add(nameId, material.Name);
+    writer.Write(nameId.GetValue());
+    writer.Write(material.DiffuseColor);
+    writer.Write(material.SpecularColor);
+    writer.Write(material.SpecularPower);
+    writer.WriteString(material.DiffuseTexturePath);
+}
+
+bool ReadMaterial(BinaryReader& reader, Material& material) {
+    uint64_t nameId = 0;
+    reader.Read(nameId);
+    material.NameId = StringId(nameId);
+    reader.Read(material.DiffuseColor);
+    reader.Read(material.SpecularColor);
+    reader.Read(material.SpecularPower);
+    reader.ReadString(material.DiffuseTexturePath);
+    return !reader.Failed();
+}
+
+void WriteJoint(BinaryWriter& writer, const Joint& joint, NameTable& names) {
+    StringId nameId = ResolveId(joint.NameId, joint.Name);
+    names.Add(nameId, joint.Name);
+    writer.Write(nameId.GetValue());
+    writer.Write(static_cast<int32_t>(joint.ParentIndex));
+    writer.Write(joint.InverseBindPoseMatrix);
+    writer.Write(joint.LocalBindTransform);
+    writer.Write(joint.Translation);
+    writer.Write(joint.RotationQuat);
+    writer.Write(joint.Scale);
+}
+
+bool ReadJoint(BinaryReader& reader, Joint& joint) {
+    int32_t parentIndex = -1;
+    uint64_t nameId = 0;
+    reader.Read(nameId);
+    joint.NameId = StringId(nameId);
+    reader.Read(parentIndex);
+    reader.Read(joint.InverseBindPoseMatrix);
+    reader.Read(joint.LocalBindTransform);
+    reader.Read(joint.Translation);
+    reader.Read(joint.RotationQuat);
+    reader.Read(joint.Scale);
+    joint.ParentIndex = parentIndex;
+    return !reader.Failed();
+}
+
+void WriteClip(BinaryWriter& writer, const AnimationClip& clip, NameTable& names) {
+    StringId nameId = ResolveId(clip.NameId, clip.Name);
+    names.Add(nameId, clip.Name);
+    writer.Write(nameId.GetValue());
+    writer.Write(clip.Duration);
+    writer.Write(clip.TicksPerSecond);
+    writer.Write(clip.Bounds);
+    writer.Write(static_cast<uint32_t>(clip.Channels.size()));
+    for (const AnimationChannel& channel : clip.Channels) {
+        StringId targetId = ResolveId(channel.TargetNodeId, channel.TargetNodeName);
+        names.Add(targetId, channel.TargetNodeName);
+        writer.Write(targetId.GetValue());
+        writer.WriteVector(channel.PositionTimestamps);
+        writer.WriteVector(channel.Positions);
+        writer.WriteVector(channel.RotationTimestamps);
+        writer.WriteVector(channel.Rotations);
+        writer.WriteVector(channel.ScaleTimestamps);
+        writer.WriteVector(channel.Scales);
+        writer.WriteVector(channel.DQTimestamps);
+        writer.WriteVector(channel.DQs);
+    }
+    writer.WriteVector(clip.CompressedTracks);
+    writer.WriteVector(clip.KeyTimes);
+    writer.WriteVector(clip.KeyValues);
+}
+
+bool ReadClip(BinaryReader& reader, AnimationClip& clip) {
+    uint32_t channelCount = 0;
+    uint64_t nameId = 0;
+    reader.Read(nameId);
+    clip.NameId = StringId(nameId);
+    reader.Read(clip.Duration);
+    reader.Read(clip.TicksPerSecond);
+    reader.Read(clip.Bounds);
+    if (!reader.Read(channelCount) || channelCount > reader.Remaining()) {
+        return false;
+    }
+    clip.Channels.resize(channelCount);
+    for (AnimationChannel& channel : clip.Channels) {
+        uint64_t targetId = 0;
+        reader.Read(targetId);
+        channel.TargetNodeId = StringId(targetId);
+        reader.ReadVector(channel.PositionTimestamps);
+        reader.ReadVector(channel.Positions);
+        reader.ReadVector(channel.RotationTimestamps);
+        reader.ReadVector(channel.Rotations);
+        reader.ReadVector(channel.ScaleTimestamps);
+        reader.ReadVector(channel.Scales);
+        reader.ReadVector(channel.DQTimestamps);
+        reader.ReadVector(channel.DQs);
+        if (reader.Failed()) return false;
+    }
+    reader.ReadVector(clip.CompressedTracks);
+    reader.ReadVector(clip.KeyTimes);
+    reader.ReadVector(clip.KeyValues);
+    if (reader.Failed()) return false;
+    // Compressed clips: 3 tracks per channel, every track's keys in range
+    if (clip.IsCompressed()) {
+        if (clip.CompressedTracks.size() != clip.Channels.size() * 3 || clip.KeyValues.size() != clip.KeyTimes.size() * 3) {
+            return false;
+        }
+        for (const CompressedTrack& track : clip.CompressedTracks) {
+            if (static_cast<uint64_t>(track.FirstKey) + track.KeyCount > clip.KeyTimes.size()) return false;
+        }
+    }
+    return true;
+}
+
+void WriteNameTable(BinaryWriter& writer, const NameTable& names) {
+    for (const auto& name : names.GetNames()) {
+        writer.Write(name.first.GetValue());
+        writer.WriteString(name.second);
+    }
+}
+
+// Registers the names with the interner and restores the Name fields. Release builds skip the table.
+bool ReadNameTable(BinaryReader& reader, uint32_t nameCount, Model& model) {
+    if (!STRING_ID_KEEP_NAMES) {
+        return true;
+    }
+    StringIdMap<std::wstring> names;
+    for (uint32_t i = 0; i < nameCount; ++i) {
+        uint64_t id = 0;
+        std::wstring name;
+        reader.Read(id);
+        if (!reader.ReadString(name)) return false;
+        StringId::Intern(name);
+        names[StringId(id)] = std::move(name);
+    }
+    auto restore = [&names](StringId id, AssetString& outName) {
+        auto it = names.find(id);
+        if (it != names.end()) outName.assign(it->second);
+    };
+    for (Mesh& mesh : model.Meshes) restore(mesh.MaterialNameId, mesh.MaterialName);
+    for (Material& material : model.Materials) restore(material.NameId, material.Name);
+    if (model.pSkeleton) {
+        for (Joint& joint : model.pSkeleton->Joints) restore(joint.NameId, joint.Name);
+    }
+    for (AnimationClip& clip : model.Animations) {
+        restore(clip.NameId, clip.Name);
+        for (AnimationChannel& channel : clip.Channels) restore(channel.TargetNodeId, channel.TargetNodeName);
+    }
+    return true;
+}
+
+// Upper bound of the arena bytes Deserialize allocates for a model, stored in the header so the
+// loader can create the arena up front. Arrays are exact; strings, id maps and the per-container
+// slack (debug iterator proxies come from the container's allocator) are estimated high.
+class ArenaSizer {
+public:
+    template <typename T>
+    void AddArray(size_t count) {
+        m_bytes += CONTAINER_SLACK;
+        if (count > 0) m_bytes += AlignUp(count * sizeof(T));
+    }
+    void AddString(size_t length) {
+        AddArray<wchar_t>(length > 0 ? 2 * length + 1 : 0); // Growth policy may over-allocate
+    }
+    void AddIdMap(size_t count) {
+        size_t buckets = 8;
+        while (buckets < count) buckets *= 2;
+        m_bytes += CONTAINER_SLACK + AlignUp(count * (sizeof(std::pair<const StringId, int>) + 4 * sizeof(void*)));
+        m_bytes += AlignUp((2 * buckets + 1) * 2 * sizeof(void*));
+    }
+    uint64_t GetBytes() const { return m_bytes; }
+
+private:
+    static constexpr size_t CONTAINER_SLACK = 32;
+    static uint64_t AlignUp(size_t bytes) { return (static_cast<uint64_t>(bytes) + 15) & ~15ull; }
+    uint64_t m_bytes = 0;
+};
+
+// Shared meshes are loaded into the referencing model's arena, so they count like inline ones
+void AddMeshBytes(ArenaSizer& sizer, const Mesh& mesh, bool withNames) {
+    sizer.AddArray<Vertex>(mesh.Vertices.size());
+    sizer.AddArray<uint32_t>(mesh.Indices.size());
+    sizer.AddArray<MeshLod>(mesh.Lods.size());
+    sizer.AddArray<uint32_t>(mesh.LodIndices.size());
+    sizer.AddArray<Meshlet>(mesh.Meshlets.size());
+    sizer.AddArray<uint32_t>(mesh.MeshletVertices.size());
+    sizer.AddArray<uint8_t>(mesh.MeshletTriangles.size());
+    sizer.AddArray<uint8_t>(mesh.PackedVertices.size());
+    sizer.AddString(withNames ? mesh.MaterialName.size() : 0);
+}
+
+uint64_t ComputeArenaBytes(const Model& model, bool withNames) {
+    ArenaSizer sizer;
+    auto name = [withNames](const AssetString& text) { return withNames ? text.size() : 0; };
+
+    sizer.AddArray<Mesh>(model.Meshes.size());
+    for (const Mesh& mesh : model.Meshes) {
+        AddMeshBytes(sizer, mesh, withNames);
+    }
+    sizer.AddArray<MeshInstance>(model.Instances.size());
+    sizer.AddArray<Material>(model.Materials.size());
+    sizer.AddIdMap(model.Materials.size());
+    for (const Material& material : model.Materials) {
+        sizer.AddString(name(material.Name));
+        sizer.AddString(material.DiffuseTexturePath.size());
+    }
+    if (model.pSkeleton) {
+        sizer.AddArray<Joint>(model.pSkeleton->Joints.size());
+        sizer.AddIdMap(model.pSkeleton->Joints.size());
+        for (const Joint& joint : model.pSkeleton->Joints) {
+            sizer.AddString(name(joint.Name));
+        }
+    }
+    sizer.AddArray<AnimationClip>(model.Animations.size());
+    for (const AnimationClip& clip : model.Animations) {
+        sizer.AddString(name(clip.Name));
+        sizer.AddArray<AnimationChannel>(clip.Channels.size());
+        for (const AnimationChannel& channel : clip.Channels) {
+            sizer.AddString(name(channel.TargetNodeName));
+            sizer.AddArray<float>(channel.PositionTimestamps.size());
+            sizer.AddArray<DirectX::XMFLOAT3>(channel.Positions.size());
+            sizer.AddArray<float>(channel.RotationTimestamps.size());
+            sizer.AddArray<DirectX::XMFLOAT4>(channel.Rotations.size());
+            sizer.AddArray<float>(channel.ScaleTimestamps.size());
+            sizer.AddArray<DirectX::XMFLOAT3>(channel.Scales.size());
+            sizer.AddArray<float>(channel.DQTimestamps.size());
+            sizer.AddArray<DualQuaternion>(channel.DQs.size());
+        }
+        sizer.AddArray<CompressedTrack>(clip.CompressedTracks.size());
+        sizer.AddArray<uint16_t>(clip.KeyTimes.size());
+        sizer.AddArray<uint16_t>(clip.KeyValues.size());
+    }
+    return sizer.GetBytes();
+}
+
+// Counts the allocations made through it (allocation test)
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t Allocations = 0;
+    size_t Deallocations = 0;
+    size_t Bytes = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++Allocations;
+        Bytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++Deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// Allocation test model when no file is given: shaped like a cooked character (a few meshes with a
+// LOD each, a 60 joint skeleton, several clips), so every container kind of the format is loaded
+Model MakeAllocationTestModel() {
+    const uint32_t gridSize = 40, jointCount = 60, clipCount = 5, keyCount = 30;
+    Model model;
+    for (uint32_t m = 0; m < 4; ++m) {
+        Mesh mesh;
+        for (uint32_t y = 0; y < gridSize; ++y) {
+            for (uint32_t x = 0; x < gridSize; ++x) {
+                Vertex vertex = {};
+                vertex.Position = { static_cast<float>(x), static_cast<float>(y), static_cast<float>(m) };
+                vertex.Normal = { 0.0f, 0.0f, 1.0f };
+                vertex.BoneIndices = { (x + y) % jointCount, 0, 0, 0 };
+                vertex.BoneWeights = { 1.0f, 0.0f, 0.0f, 0.0f };
+                mesh.Vertices.push_back(vertex);
+            }
+        }
+        for (uint32_t y = 0; y + 1 < gridSize; ++y) {
+            for (uint32_t x = 0; x + 1 < gridSize; ++x) {
+                uint32_t a = y * gridSize + x, b = a + 1, c = a + gridSize, d = c + 1;
+                mesh.Indices.insert(mesh.Indices.end(), { a, c, b, b, c, d });
+            }
+        }
+        mesh.LodIndices.assign(mesh.Indices.begin(), mesh.Indices.begin() + mesh.Indices.size() / 4);
+        mesh.Lods.push_back({ 0, static_cast<uint32_t>(mesh.LodIndices.size()), 0.01f });
+        mesh.MaterialName = L"Body";
+        mesh.IndexCount = static_cast<uint32_t>(mesh.Indices.size());
+        model.Meshes.push_back(std::move(mesh));
+    }
+    Material material;
+    material.Name = L"Body";
+    material.DiffuseTexturePath = L"Textures/Characters/Body_Diffuse.dds";
+    model.Materials.push_back(material);
+
+    model.pSkeleton = std::make_unique<Skeleton>();
+    for (uint32_t j = 0; j < jointCount; ++j) {
+        Joint joint;
+        joint.Name = L"Joint" + std::to_wstring(j);
+        joint.ParentIndex = static_cast<int>(j) - 1;
+        DirectX::XMStoreFloat4x4(&joint.LocalBindTransform, DirectX::XMMatrixTranslation(0.0f, 0.1f, 0.0f));
+        DirectX::XMStoreFloat4x4(&joint.InverseBindPoseMatrix, DirectX::XMMatrixTranslation(0.0f, -0.1f * j, 0.0f));
+        model.pSkeleton->Joints.push_back(joint);
+    }
+    for (uint32_t c = 0; c < clipCount; ++c) {
+        AnimationClip clip;
+        clip.Name = L"Clip" + std::to_wstring(c);
+        clip.Duration = 1.0f;
+        for (const Joint& joint : model.pSkeleton->Joints) {
+            AnimationChannel channel;
+            channel.TargetNodeName = joint.Name;
+            for (uint32_t k = 0; k < keyCount; ++k) {
+                float time = static_cast<float>(k) / keyCount;
+                channel.PositionTimestamps.push_back(time);
+                channel.Positions.push_back({ 0.0f, 0.1f, 0.0f });
+                channel.RotationTimestamps.push_back(time);
+                DirectX::XMFLOAT4 rotation;
+                DirectX::XMStoreFloat4(&rotation, DirectX::XMQuaternionRotationRollPitchYaw(0.0f, 0.0f, 0.3f * sinf(DirectX::XM_2PI * time)));
+                channel.Rotations.push_back(rotation);
+            }
+            clip.Channels.push_back(std::move(channel));
+        }
+        model.Animations.push_back(std::move(clip));
+    }
+    return model;
+}
+
+} // namespace
+
+
+bool ModelSerializer::Serialize(const Model& model, std::vector<uint8_t>& outData, bool keepNames, const std::wstring& sharedGeometryDirectory) {
+    CookedModelHeader header;
+    header.MeshCount = static_cast<uint32_t>(model.Meshes.size());
+    header.InstanceCount = static_cast<uint32_t>(model.Instances.size());
+    header.MaterialCount = static_cast<uint32_t>(model.Materials.size());
+    header.JointCount = model.pSkeleton ? static_cast<uint32_t>(model.pSkeleton->Joints.size()) : 0;
+    header.AnimationCount = static_cast<uint32_t>(model.Animations.size());
+
+    outData.clear();
+    outData.resize(sizeof(CookedModelHeader)); // Patched once the payload size is known
+    BinaryWriter writer(outData);
+    NameTable names(keepNames);
+
+    writer.Write(model.Bounds);
+    writer.Write(model.AnimatedBounds);
+    std::vector<uint8_t> geometry;
+    for (const Mesh& mesh : model.Meshes) {
+        WriteMesh(writer, mesh, names, sharedGeometryDirectory);
+        if (!sharedGeometryDirectory.empty() && mesh.ContentHash != Hash128() && SerializeGeometry(mesh, geometry)) {
+            header.SharedGeometryBytes += geometry.size();
+        }
+    }
+    for (const MeshInstance& instance : model.Instances) {
+        WriteInstance(writer, instance, names);
+    }
+    for (const Material& material : model.Materials) {
+        WriteMaterial(writer, material, names);
+    }
+    if (model.pSkeleton) {
+        for (const Joint& joint : model.pSkeleton->Joints) {
+            WriteJoint(writer, joint, names);
+        }
+    }
+    for (const AnimationClip& clip : model.Animations) {
+        WriteClip(writer, clip, names);
+    }
+    WriteNameTable(writer, names);
+    header.NameCount = static_cast<uint32_t>(names.GetNames().size());
+    header.ArenaBytes = ComputeArenaBytes(model, keepNames);
+
+    header.PayloadBytes = outData.size() - sizeof(CookedModelHeader);
+    memcpy(outData.data(), &header, sizeof(header));
+    return true;
+}
+
+bool ModelSerializer::SerializeGeometry(const Mesh& mesh, std::vector<uint8_t>& outData) {
+    // A valid one-mesh model without material, so tools can load it on its own
+    CookedModelHeader header;
+    header.MeshCount = 1;
+
+    outData.clear();
+    outData.resize(sizeof(CookedModelHeader));
+    BinaryWriter writer(outData);
+    writer.Write(mesh.Bounds);
+    writer.Write(mesh.Bounds);
+    writer.Write(static_cast<uint8_t>(MeshStorage::Inline));
+    writer.Write(mesh.ContentHash);
+    writer.Write(StringId().GetValue());
+    WriteMeshGeometry(writer, mesh);
+
+    ArenaSizer sizer;
+    sizer.AddArray<Mesh>(1);
+    AddMeshBytes(sizer, mesh, false);
+    sizer.AddArray<MeshInstance>(0);
+    sizer.AddArray<Material>(0);
+    sizer.AddIdMap(0);
+    sizer.AddArray<AnimationClip>(0);
+    header.ArenaBytes = sizer.GetBytes();
+    header.PayloadBytes = outData.size() - sizeof(CookedModelHeader);
+    memcpy(outData.data(), &header, sizeof(header));
+    return true;
+}
+
+std::wstring ModelSerializer::GetGeometryFileName(const Hash128& contentHash) {
+    std::string hex = contentHash.ToString();
+    return std::wstring(hex.begin(), hex.end()) + L".agg";
+}
+
+bool ModelSerializer::GetSharedGeometry(const uint8_t* data, size_t size, std::vector<SharedGeometryRef>& outRefs) {
+    outRefs.clear();
+    if (!IsCookedModel(data, size)) {
+        return false;
+    }
+    CookedModelHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.PayloadBytes > size - sizeof(CookedModelHeader) || header.MeshCount > header.PayloadBytes) {
+        return false;
+    }
+
+    // Mesh records come first; inline ones are read and dropped
+    BinaryReader reader(data + sizeof(CookedModelHeader), static_cast<size_t>(header.PayloadBytes));
+    BoundingVolume bounds;
+    reader.Read(bounds);
+    reader.Read(bounds);
+    std::wstring path;
+    for (uint32_t i = 0; i < header.MeshCount; ++i) {
+        Mesh mesh;
+        if (!ReadMesh(reader, mesh, path)) {
+            return false;
+        }
+        if (!path.empty()) {
+            outRefs.push_back({ mesh.ContentHash, path });
+        }
+    }
+    return true;
+}
+
+bool ModelSerializer::IsCookedModel(const uint8_t* data, size_t size) {
+    if (!data || size < sizeof(CookedModelHeader)) {
+        return false;
+    }
+    CookedModelHeader header;
+    memcpy(&header, data, sizeof(header));
+    return header.Magic == COOKED_MODEL_MAGIC && header.Version == COOKED_MODEL_VERSION;
+}
+
+bool ModelSerializer::Deserialize(const uint8_t* data, size_t size, Model& outModel, bool useArena, const std::wstring& filePath) {
+    if (!IsCookedModel(data, size)) {
+        OutputDebugStringA("ModelSerializer: Not a cooked model or version mismatch.\n");
+        return false;
+    }
+
+    CookedModelHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.PayloadBytes > size - sizeof(CookedModelHeader)) {
+        OutputDebugStringA("ModelSerializer: Truncated cooked model.\n");
+        return false;
+    }
+
+    // Small records (empty channels, materials) need up to ~16x their payload size in arena
+    // memory; anything far beyond that is corrupt
+    if (header.ArenaBytes > 32 * (header.PayloadBytes + header.SharedGeometryBytes) + 1024 * 1024) {
+        OutputDebugStringA("ModelSerializer: Corrupt cooked model arena size.\n");
+        return false;
+    }
+
+    BinaryReader reader(data + sizeof(CookedModelHeader), static_cast<size_t>(header.PayloadBytes));
+    Model model(useArena ? ModelArena::Create(static_cast<size_t>(header.ArenaBytes)) : nullptr);
+    reader.Read(model.Bounds);
+    reader.Read(model.AnimatedBounds);
+
+    // Every record is at least a few bytes, so counts larger than the payload are corrupt
+    if (header.MeshCount > header.PayloadBytes || header.MaterialCount > header.PayloadBytes ||
+        header.JointCount > header.PayloadBytes || header.AnimationCount > header.PayloadBytes ||
+        header.NameCount > header.PayloadBytes || header.InstanceCount > header.PayloadBytes) {
+        OutputDebugStringA("ModelSerializer: Corrupt cooked model header.\n");
+        return false;
+    }
+
+    model.Meshes.resize(header.MeshCount);
+    std::filesystem::path modelDirectory = std::filesystem::path(filePath).parent_path();
+    std::wstring sharedPath;
+    for (Mesh& mesh : model.Meshes) {
+        if (!ReadMesh(reader, mesh, sharedPath)) {
+            OutputDebugStringA("ModelSerializer: Failed to read mesh.\n");
+            return false;
+        }
+        if (!sharedPath.empty() && !ReadSharedGeometry((modelDirectory / sharedPath).lexically_normal().wstring(), mesh)) {
+            return false;
+        }
+    }
+
+    model.Instances.resize(header.InstanceCount);
+    for (MeshInstance& instance : model.Instances) {
+        if (!ReadInstance(reader, instance) || instance.MeshIndex >= header.MeshCount) {
+            OutputDebugStringA("ModelSerializer: Failed to read mesh instance.\n");
+            return false;
+        }
+    }
+
+    model.Materials.resize(header.MaterialCount);
+    model.MaterialNameToIndex.reserve(header.MaterialCount);
+    for (size_t i = 0; i < model.Materials.size(); ++i) {
+        if (!ReadMaterial(reader, model.Materials[i])) {
+            OutputDebugStringA("ModelSerializer: Failed to read material.\n");
+            return false;
+        }
+        model.MaterialNameToIndex[model.Materials[i].NameId] = static_cast<int>(i);
+    }
+
+    if (header.JointCount > 0) {
+        model.pSkeleton = std::make_unique<Skeleton>(model.GetAllocator());
+        model.pSkeleton->Joints.resize(header.JointCount);
+        model.pSkeleton->JointNameToIndex.reserve(header.JointCount);
+        for (size_t i = 0; i < model.pSkeleton->Joints.size(); ++i) {
+            Joint& joint = model.pSkeleton->Joints[i];
+            if (!ReadJoint(reader, joint) || joint.ParentIndex >= static_cast<int>(header.JointCount)) {
+                OutputDebugStringA("ModelSerializer: Failed to read joint.\n");
+                return false;
+            }
+            model.pSkeleton->JointNameToIndex[joint.NameId] = static_cast<int>(i);
+        }
+        // Cooked skeletons are already parents-first; older cooks are sorted here
+        if (!PoseEvaluator::SortJoints(model)) {
+            OutputDebugStringA("ModelSerializer: Cyclic joint hierarchy.\n");
+            return false;
+        }
+    }
+
+    model.Animations.resize(header.AnimationCount);
+    for (AnimationClip& clip : model.Animations) {
+        if (!ReadClip(reader, clip)) {
+            OutputDebugStringA("ModelSerializer: Failed to read animation clip.\n");
+            return false;
+        }
+    }
+
+    if (header.NameCount > 0 && !ReadNameTable(reader, header.NameCount, model)) {
+        OutputDebugStringA("ModelSerializer: Failed to read name table.\n");
+        return false;
+    }
+
+    if (reader.Failed()) {
+        return false;
+    }
+    if (model.Arena && model.Arena->GetOverflowCount() > 0) {
+        OutputDebugStringA(("ModelSerializer: Arena estimate too small, " + std::to_string(model.Arena->GetOverflowCount()) +
+            " allocations went to the heap.\n").c_str());
+    }
+    outModel = std::move(model);
+    return true;
+}
+
+bool ModelSerializer::SaveToFile(const Model& model, const std::wstring& filePath) {
+    std::vector<uint8_t> data;
+    if (!Serialize(model, data)) {
+        return false;
+    }
+    std::ofstream file(std::filesystem::path(filePath), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        OutputDebugString((L"ModelSerializer: Failed to create " + filePath + L"\n").c_str());
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return file.good();
+}
+
+bool ModelSerializer::LoadFromFile(const std::wstring& filePath, Model& outModel) {
+    // Packed models deserialize straight from the pack mapping (entries are 64-byte aligned)
+    FileView file;
+    if (!VirtualFileSystem::Get().ReadFile(filePath, file)) {
+        OutputDebugString((L"ModelSerializer: Failed to open " + filePath + L"\n").c_str());
+        return false;
+    }
+    return Deserialize(file.Data(), file.Size(), outModel, true, filePath);
+}
+
+bool ModelSerializer::RunAllocationTest(const std::wstring& filePath, int iterations) {
+    std::vector<uint8_t> data, compressed;
+    if (filePath.empty()) {
+        if (!Serialize(MakeAllocationTestModel(), data)) {
+            std::cerr << "ModelSerializer: Allocation test failed to serialize the synthetic model." << std::endl;
+            return false;
+        }
+    } else if (AssetCache::ReadFile(filePath, compressed) && BlockCompressor::IsCompressed(compressed.data(), compressed.size())) {
+        BlockCompressor::Decompress(compressed.data(), compressed.size(), data); // Only the load itself is measured
+    } else {
+        data.swap(compressed);
+    }
+    if (!IsCookedModel(data.data(), data.size())) {
+        std::cerr << "ModelSerializer: Allocation test needs a cooked model (.agm) of the current version." << std::endl;
+        return false;
+    }
+    iterations = std::max(iterations, 1);
+
+    struct Result {
+        size_t Allocations = 0; // Per load, through the default resource
+        size_t Deallocations = 0;
+        size_t Bytes = 0;
+        size_t ArenaBytes = 0;
+        double Seconds = 0.0;   // Load + unload, averaged
+    };
+    auto measure = [&](bool useArena, Result& result) {
+        CountingResource counter;
+        std::pmr::memory_resource* previous = std::pmr::set_default_resource(&counter);
+        auto start = std::chrono::high_resolution_clock::now();
+        bool ok = true;
+        for (int i = 0; i < iterations && ok; ++i) {
+            Model model;
+            ok = Deserialize(data.data(), data.size(), model, useArena, filePath);
+            if (ok && i == 0 && model.Arena) {
+                result.ArenaBytes = model.Arena->GetUsed();
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::pmr::set_default_resource(previous);
+        result.Allocations = counter.Allocations / iterations;
+        result.Deallocations = counter.Deallocations / iterations;
+        result.Bytes = counter.Bytes / iterations;
+        result.Seconds = std::chrono::duration<double>(end - start).count() / iterations;
+        return ok;
+    };
+
+    Result heap, arena;
+    if (!measure(false, heap) || !measure(true, arena)) {
+        std::cerr << "ModelSerializer: Allocation test failed to load the model." << std::endl;
+        return false;
+    }
+
+    CookedModelHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "ModelSerializer: Allocation test (" << iterations << " loads of "
+       << (filePath.empty() ? std::string("a synthetic model") : std::filesystem::path(filePath).filename().string()) << ")\n";
+    ss << "  Per-container heap: " << heap.Allocations << " allocations, " << heap.Deallocations << " frees, "
+       << heap.Bytes / 1024.0 << " KB, " << heap.Seconds * 1000.0 << " ms load+unload\n";
+    ss << "  Model arena:        1 block (" << header.ArenaBytes / 1024.0 << " KB reserved, " << arena.ArenaBytes / 1024.0
+       << " KB used) + " << arena.Allocations << " heap allocations, " << arena.Seconds * 1000.0 << " ms load+unload\n";
+    ss << "  (Not counted in either: the Model and Skeleton objects themselves)";
+    std::cout << ss.str() << std::endl;
+    OutputDebugStringA((ss.str() + "\n").c_str());
+    return true;
+}
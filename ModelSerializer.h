@@ -0,0 +1,73 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include "StringId.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr uint32_t COOKED_MODEL_MAGIC = 0x444D4741; // "AGMD"
+constexpr uint32_t COOKED_MODEL_VERSION = 7; // 2: names stored as StringIds, 3: arena size, 4: instances, shared geometry, 5: compressed clips, 6: dual quaternion keys, 7: float key fallback tracks
+
+// Fixed header at the start of a cooked model (.agm) file
+struct CookedModelHeader {
+    uint32_t Magic = COOKED_MODEL_MAGIC;
+    uint32_t Version = COOKED_MODEL_VERSION;
+    uint32_t MeshCount = 0;
+    uint32_t MaterialCount = 0;
+    uint32_t JointCount = 0;     // 0 = no skeleton
+    uint32_t AnimationCount = 0;
+    uint32_t NameCount = 0;      // Entries in the trailing id -> name table, 0 = names stripped
+    uint32_t InstanceCount = 0;
+    uint64_t PayloadBytes = 0;   // Bytes following the header
+    uint64_t ArenaBytes = 0;     // Size of the ModelArena a load needs (upper bound)
+    uint64_t SharedGeometryBytes = 0; // Uncompressed size of the shared geometry files the meshes reference
+};
+
+// Mesh of a cooked model stored in a shared geometry file
+struct SharedGeometryRef {
+    Hash128 ContentHash;
+    std::wstring Path; // Relative to the model file, as stored
+};
+
+// Binary (de)serialization of cooked models. Everything the cook stages produce is stored
+// (vertices, packed vertices, LODs, meshlets, bounds), so loading needs no processing.
+// GPU buffers are not part of the format and have to be created after loading.
+// Names are stored as StringIds; 'keepNames' appends the id -> name table, which debug builds
+// read back into the interner and the Name fields (release builds skip it).
+// Meshes are stored inline or, when cooked with shared geometry, as a reference to a
+// content-addressed geometry file (.agg, a cooked model holding just that mesh) that every
+// model with the same mesh points to.
+class ModelSerializer {
+public:
+    // A non-empty 'sharedGeometryDirectory' (relative to the model file) writes every mesh as a reference
+    // to '<directory>/<Mesh::ContentHash>.agg'; the caller writes those files with SerializeGeometry
+    static bool Serialize(const Model& model, std::vector<uint8_t>& outData, bool keepNames = STRING_ID_KEEP_NAMES,
+                          const std::wstring& sharedGeometryDirectory = std::wstring());
+    // With 'useArena' all containers of the model live in one ModelArena sized from the header.
+    // Shared geometry is read through the VirtualFileSystem, relative to 'filePath' (the file 'data' came from).
+    static bool Deserialize(const uint8_t* data, size_t size, Model& outModel, bool useArena = true,
+                            const std::wstring& filePath = std::wstring());
+
+    // Shared geometry file of 'mesh' (the material stays with the referencing model)
+    static bool SerializeGeometry(const Mesh& mesh, std::vector<uint8_t>& outData);
+    static std::wstring GetGeometryFileName(const Hash128& contentHash);
+    // Shared geometry files a cooked model references
+    static bool GetSharedGeometry(const uint8_t* data, size_t size, std::vector<SharedGeometryRef>& outRefs);
+
+    static bool SaveToFile(const Model& model, const std::wstring& filePath);
+    static bool LoadFromFile(const std::wstring& filePath, Model& outModel);
+
+    // True if 'data' starts with a cooked model header of the current version
+    static bool IsCookedModel(const uint8_t* data, size_t size);
+
+    // Test mode: loads a cooked model (a synthetic character serialized in memory when 'filePath' is
+    // empty) repeatedly with and without the arena and reports the heap allocations and load + unload
+    // time of both
+    static bool RunAllocationTest(const std::wstring& filePath = std::wstring(), int iterations = 100);
+};
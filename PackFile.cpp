@@ -0,0 +1,401 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "PackFile.h"
+#include "Timing.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+#include "VirtualFileSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t MAX_SEED_ATTEMPTS = 1u << 24;
+
+void LogPackMessage(const std::string& message) {
+    std::string line = "Pack File: " + message + "\n";
+    std::cout << line;
+    OutputDebugStringA(line.c_str());
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+PackFile::PackFile() {}
+
+PackFile::~PackFile() {
+    Close();
+}
+
+std::string PackFile::NormalizePath(std::string_view path) {
+    std::string result;
+    result.reserve(path.size());
+    for (char c : path) {
+        if (c == '\\') c = '/';
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c == '/' && (result.empty() || result.back() == '/')) continue; // Leading and doubled separators
+        result.push_back(c);
+        if (result.size() == 2 && result[0] == '.' && result[1] == '/') result.clear(); // Leading "./"
+    }
+    return result;
+}
+
+std::string PackFile::NormalizePath(std::wstring_view path, const std::filesystem::path& workingDirectory) {
+    // Absolute paths below the working directory (AssetManager keys, watcher events) map to the
+    // same relative entry names as the loose paths the game passes
+    std::filesystem::path widePath = std::filesystem::path(path).lexically_normal();
+    if (widePath.is_absolute() && !workingDirectory.empty()) {
+        std::filesystem::path relative = widePath.lexically_relative(workingDirectory);
+        if (!relative.empty() && *relative.begin() != L"..") {
+            widePath = relative;
+        }
+    }
+    return NormalizePath(std::string_view(widePath.u8string()));
+}
+
+uint32_t PackFile::GetSlot(uint64_t hash, uint32_t seed, uint32_t entryCount) {
+    // 64-bit finalizer (MurmurHash3 fmix64) over the hash mixed with the seed
+    uint64_t x = hash ^ (static_cast<uint64_t>(seed) * 0x9E3779B97F4A7C15ULL);
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return static_cast<uint32_t>(x % entryCount);
+}
+
+bool PackFile::Open(const std::wstring& packPath) {
+    Close();
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->Open(packPath)) {
+        LogMessage("Failed to map " + std::filesystem::path(packPath).string());
+        return false;
+    }
+
+    const uint8_t* data = mapping->Data();
+    size_t size = mapping->Size();
+    const PackHeader* header = reinterpret_cast<const PackHeader*>(data);
+    if (size < sizeof(PackHeader) || header->Magic != PACK_MAGIC || header->Version != PACK_VERSION) {
+        LogMessage("Not a pack file (or an old version): " + std::filesystem::path(packPath).string());
+        return false;
+    }
+
+    uint64_t expectedDirectorySize = uint64_t(header->BucketCount) * sizeof(uint32_t) + uint64_t(header->EntryCount) * sizeof(PackEntry) +
+                                     uint64_t(header->BlockCount) * sizeof(PackBlock) + header->NamesSize;
+    if (header->DirectoryOffset > size || header->DirectorySize > size - header->DirectoryOffset ||
+        header->DirectorySize != expectedDirectorySize || (header->EntryCount > 0 && header->BucketCount == 0)) {
+        LogMessage("Corrupt pack directory: " + std::filesystem::path(packPath).string());
+        return false;
+    }
+
+    const uint8_t* directory = data + header->DirectoryOffset;
+    const uint32_t* seeds = reinterpret_cast<const uint32_t*>(directory);
+    const PackEntry* entries = reinterpret_cast<const PackEntry*>(seeds + header->BucketCount);
+    const PackBlock* blocks = reinterpret_cast<const PackBlock*>(entries + header->EntryCount);
+    const char* names = reinterpret_cast<const char*>(blocks + header->BlockCount);
+    if (header->NamesSize > 0 && names[header->NamesSize - 1] != '\0') {
+        LogMessage("Corrupt pack names: " + std::filesystem::path(packPath).string());
+        return false;
+    }
+    // Validate once so lookups and reads can trust the entries
+    for (uint32_t i = 0; i < header->EntryCount; ++i) {
+        const PackEntry& entry = entries[i];
+        bool stored = entry.Compression == static_cast<uint32_t>(PackCompression::None);
+        bool compressed = entry.Compression == static_cast<uint32_t>(PackCompression::LZ);
+        bool valid = entry.Offset <= size && entry.StoredSize <= size - entry.Offset && entry.NameOffset < std::max<uint64_t>(header->NamesSize, 1) &&
+                     (stored || compressed) && (!stored || entry.StoredSize == entry.Size) &&
+                     uint64_t(entry.FirstBlock) + entry.BlockCount <= header->BlockCount;
+        if (valid && compressed) {
+            valid = entry.BlockCount == (entry.Size + PACK_BLOCK_SIZE - 1) / PACK_BLOCK_SIZE;
+            for (uint32_t b = 0; b < entry.BlockCount && valid; ++b) {
+                const PackBlock& block = blocks[entry.FirstBlock + b];
+                valid = block.Offset >= entry.Offset && block.Offset <= entry.Offset + entry.StoredSize &&
+                        block.StoredSize <= entry.Offset + entry.StoredSize - block.Offset;
+            }
+        }
+        if (!valid) {
+            LogMessage("Corrupt pack entry " + std::to_string(i) + ": " + std::filesystem::path(packPath).string());
+            return false;
+        }
+    }
+
+    m_path = packPath;
+    m_mapping = std::move(mapping);
+    m_header = header;
+    m_seeds = seeds;
+    m_entries = entries;
+    m_blocks = blocks;
+    m_names = names;
+    m_entryCount = header->EntryCount;
+    return true;
+}
+
+void PackFile::Close() {
+    m_mapping.reset(); // Views handed out keep their own reference
+    m_header = nullptr;
+    m_seeds = nullptr;
+    m_entries = nullptr;
+    m_blocks = nullptr;
+    m_names = nullptr;
+    m_entryCount = 0;
+}
+
+const PackEntry* PackFile::Find(std::string_view path) const {
+    std::string normalized = NormalizePath(path);
+    return Find(StringId(StringId::Hash(normalized.data(), normalized.size())));
+}
+
+const PackEntry* PackFile::Find(StringId pathId) const {
+    if (m_entryCount == 0) {
+        return nullptr;
+    }
+    uint64_t hash = pathId.GetValue();
+    uint32_t seed = m_seeds[hash % m_header->BucketCount];
+    const PackEntry& entry = m_entries[GetSlot(hash, seed, static_cast<uint32_t>(m_entryCount))];
+    return entry.PathHash == hash ? &entry : nullptr; // Paths not in the pack land on some other entry
+}
+
+const uint8_t* PackFile::GetStoredData(const PackEntry& entry) const {
+    if (!m_mapping || entry.Compression != static_cast<uint32_t>(PackCompression::None)) {
+        return nullptr;
+    }
+    return m_mapping->Data() + entry.Offset;
+}
+
+bool PackFile::ReadRange(const PackEntry& entry, uint64_t offset, size_t length, uint8_t* out, JobSystem* jobSystem) const {
+    if (!m_mapping || offset > entry.Size || length > entry.Size - offset) {
+        return false;
+    }
+    if (entry.Compression == static_cast<uint32_t>(PackCompression::None)) {
+        std::memcpy(out, m_mapping->Data() + entry.Offset + offset, length);
+        return true;
+    }
+    return BlockCompressor::DecompressRange(m_mapping->Data(), m_mapping->Size(), m_blocks + entry.FirstBlock, entry.BlockCount,
+                                            entry.Size, offset, length, out, jobSystem);
+}
+
+const char* PackFile::GetEntryName(const PackEntry& entry) const {
+    return m_header && m_header->NamesSize > 0 ? m_names + entry.NameOffset : "";
+}
+
+void PackFile::LogMessage(const std::string& message) const {
+    LogPackMessage(message);
+}
+
+// --- PackWriter ---
+
+bool PackWriter::BuildPerfectHash(const std::vector<uint64_t>& hashes, std::vector<uint32_t>& outSeeds, std::vector<uint32_t>& outSlots) {
+    uint32_t entryCount = static_cast<uint32_t>(hashes.size());
+    uint32_t bucketCount = std::max(1u, (entryCount + PACK_KEYS_PER_BUCKET - 1) / PACK_KEYS_PER_BUCKET);
+    outSeeds.assign(bucketCount, 0);
+    outSlots.assign(entryCount, 0);
+    if (entryCount == 0) {
+        return true;
+    }
+
+    std::vector<std::vector<uint32_t>> buckets(bucketCount);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        buckets[hashes[i] % bucketCount].push_back(i);
+    }
+    // Largest buckets first, while most slots are still free
+    std::vector<uint32_t> order(bucketCount);
+    for (uint32_t b = 0; b < bucketCount; ++b) order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    std::vector<bool> occupied(entryCount, false);
+    std::vector<uint32_t> slots;
+    for (uint32_t b : order) {
+        const std::vector<uint32_t>& keys = buckets[b];
+        if (keys.empty()) {
+            break;
+        }
+        bool placed = false;
+        for (uint32_t seed = 0; seed < MAX_SEED_ATTEMPTS && !placed; ++seed) {
+            slots.clear();
+            placed = true;
+            for (uint32_t key : keys) {
+                uint32_t slot = PackFile::GetSlot(hashes[key], seed, entryCount);
+                if (occupied[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (placed) {
+                outSeeds[b] = seed;
+                for (size_t k = 0; k < keys.size(); ++k) {
+                    occupied[slots[k]] = true;
+                    outSlots[keys[k]] = slots[k];
+                }
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PackWriter::WritePack(const std::vector<SourceFile>& files, const std::wstring& packPath, const PackWriterSettings& settings,
+                           JobSystem* jobSystem) {
+    std::vector<uint64_t> hashes(files.size());
+    std::unordered_map<uint64_t, size_t> firstWithHash;
+    for (size_t i = 0; i < files.size(); ++i) {
+        hashes[i] = StringId::Hash(files[i].PackPath.data(), files[i].PackPath.size());
+        auto result = firstWithHash.emplace(hashes[i], i);
+        if (!result.second) {
+            LogPackMessage("Path hash collision: " + files[result.first->second].PackPath + " / " + files[i].PackPath);
+            return false;
+        }
+    }
+
+    std::vector<uint32_t> seeds, slots;
+    if (!BuildPerfectHash(hashes, seeds, slots)) {
+        LogPackMessage("Failed to build the perfect hash directory");
+        return false;
+    }
+
+    // Written to a temporary file and renamed, so a failed pack never replaces a good one
+    std::filesystem::path finalPath(packPath);
+    std::filesystem::path tempPath = finalPath;
+    tempPath += L".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        LogPackMessage("Failed to create " + tempPath.string());
+        return false;
+    }
+
+    PackHeader header;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t offset = sizeof(header);
+
+    std::vector<PackEntry> entries(files.size());
+    std::vector<PackBlock> blocks;
+    std::string names;
+    std::vector<uint8_t> data, compressed;
+    std::vector<PackBlock> entryBlocks;
+    size_t compressedCount = 0;
+    static const char padding[4096] = {};
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!AssetCache::ReadFile(files[i].SourcePath, data)) {
+            LogPackMessage("Failed to read " + std::filesystem::path(files[i].SourcePath).string());
+            return false;
+        }
+
+        // Cooked payloads that are already block compressed are stored as they are
+        entryBlocks.clear();
+        compressed.clear();
+        bool useCompression = false;
+        if (settings.Compress && !data.empty() && !BlockCompressor::IsCompressed(data.data(), data.size())) {
+            BlockCompressor::CompressBlocks(data.data(), data.size(), 0, entryBlocks, compressed, jobSystem);
+            useCompression = compressed.size() <= data.size() * (1.0 - settings.MinSavings);
+        }
+        const std::vector<uint8_t>& stored = useCompression ? compressed : data;
+
+        // Compressed entries are decoded into a buffer, they only need the small alignment
+        uint64_t alignment = !useCompression && data.size() >= settings.LargeEntrySize ? settings.LargeAlignment : settings.Alignment;
+        uint64_t aligned = AlignUp(offset, std::max<uint64_t>(alignment, 1));
+        out.write(padding, static_cast<std::streamsize>(aligned - offset));
+        out.write(reinterpret_cast<const char*>(stored.data()), static_cast<std::streamsize>(stored.size()));
+
+        PackEntry& entry = entries[slots[i]];
+        entry.PathHash = hashes[i];
+        entry.Offset = aligned;
+        entry.Size = data.size();
+        entry.StoredSize = stored.size();
+        entry.Compression = static_cast<uint32_t>(useCompression ? PackCompression::LZ : PackCompression::None);
+        if (useCompression) {
+            entry.FirstBlock = static_cast<uint32_t>(blocks.size());
+            entry.BlockCount = static_cast<uint32_t>(entryBlocks.size());
+            for (PackBlock& block : entryBlocks) {
+                block.Offset += aligned;
+                blocks.push_back(block);
+            }
+            compressedCount++;
+        }
+        entry.NameOffset = static_cast<uint32_t>(names.size());
+        names += files[i].PackPath;
+        names.push_back('\0');
+        offset = aligned + stored.size();
+    }
+
+    header.EntryCount = static_cast<uint32_t>(entries.size());
+    header.BucketCount = static_cast<uint32_t>(seeds.size());
+    header.BlockCount = static_cast<uint32_t>(blocks.size());
+    header.DirectoryOffset = AlignUp(offset, 8);
+    header.NamesSize = names.size();
+    header.DirectorySize = seeds.size() * sizeof(uint32_t) + entries.size() * sizeof(PackEntry) + blocks.size() * sizeof(PackBlock) + names.size();
+    out.write(padding, static_cast<std::streamsize>(header.DirectoryOffset - offset));
+    out.write(reinterpret_cast<const char*>(seeds.data()), static_cast<std::streamsize>(seeds.size() * sizeof(uint32_t)));
+    out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(PackEntry)));
+    out.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size() * sizeof(PackBlock)));
+    out.write(names.data(), static_cast<std::streamsize>(names.size()));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        LogPackMessage("Failed to write " + tempPath.string());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, finalPath, ec);
+    if (ec) {
+        LogPackMessage("Failed to replace " + finalPath.string() + " (mounted?)");
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    if (compressedCount > 0) {
+        LogPackMessage(std::to_string(compressedCount) + " of " + std::to_string(files.size()) + " entries block compressed, " +
+                       std::to_string(offset / 1024) + " KB of entry data");
+    }
+    return true;
+}
+
+bool PackWriter::PackDirectory(const std::wstring& sourceDirectory, const std::wstring& packPath, const PackWriterSettings& settings,
+                               JobSystem* jobSystem) {
+    std::filesystem::path sourceRoot(sourceDirectory);
+    std::filesystem::path packFullPath = std::filesystem::absolute(packPath);
+    std::vector<SourceFile> files;
+    uint64_t totalBytes = 0;
+
+    std::error_code ec;
+    const std::filesystem::path workingDirectory = std::filesystem::current_path(ec);
+    for (std::filesystem::recursive_directory_iterator it(sourceRoot, ec), endIt; !ec && it != endIt; it.increment(ec)) {
+        if (!it->is_regular_file(ec) || std::filesystem::absolute(it->path()) == packFullPath) {
+            continue;
+        }
+        std::filesystem::path relative = std::filesystem::relative(it->path(), sourceRoot, ec);
+        SourceFile file;
+        file.PackPath = PackFile::NormalizePath((sourceRoot / relative).wstring(), workingDirectory);
+        file.SourcePath = it->path().wstring();
+        totalBytes += it->file_size(ec);
+        files.push_back(std::move(file));
+    }
+    if (ec) {
+        LogPackMessage("Failed to enumerate " + sourceRoot.string());
+        return false;
+    }
+
+    // Sorted paths keep packs byte-identical across runs and keep directories together on disk
+    std::sort(files.begin(), files.end(), [](const SourceFile& a, const SourceFile& b) { return a.PackPath < b.PackPath; });
+    auto start = std::chrono::high_resolution_clock::now();
+    bool ok = WritePack(files, packPath, settings, jobSystem);
+    double seconds = SecondsSince(start);
+    if (ok) {
+        LogPackMessage("Packed " + std::to_string(files.size()) + " files (" + std::to_string(totalBytes / 1024) + " KB) into " +
+                       std::filesystem::path(packPath).string() + " in " + std::to_string(seconds) + " s");
+    }
+    return ok;
+}
@@ -0,0 +1,134 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "BlockCompression.h"
+#include "StringId.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+class JobSystem;
+class MappedFile;
+
+// Read-only archive (.agp) of many asset files:
+//   [PackHeader][entry data, each aligned][directory]
+// The directory is a perfect hash over the entry paths (hash and displace: one seed per bucket
+// of ~4 keys moves its keys to free slots), so a lookup is one seed read and one entry compare.
+constexpr uint32_t PACK_MAGIC = 0x4B504741; // "AGPK"
+constexpr uint32_t PACK_VERSION = 1;
+constexpr uint32_t PACK_KEYS_PER_BUCKET = 4;
+constexpr uint32_t PACK_BLOCK_SIZE = COMPRESSION_BLOCK_SIZE; // Uncompressed bytes per block of a compressed entry
+
+enum class PackCompression : uint32_t {
+    None = 0, // Entry bytes are stored as is and read in place from the mapping
+    LZ = 1,   // BlockCompressor blocks, listed in the block table from FirstBlock on
+};
+
+#pragma pack(push, 1)
+struct PackHeader {
+    uint32_t Magic = PACK_MAGIC;
+    uint32_t Version = PACK_VERSION;
+    uint32_t EntryCount = 0;
+    uint32_t BucketCount = 0;
+    uint32_t BlockCount = 0;
+    uint32_t Reserved = 0;
+    uint64_t DirectoryOffset = 0; // Seeds[BucketCount], Entries[EntryCount], Blocks[BlockCount], names
+    uint64_t DirectorySize = 0;
+    uint64_t NamesSize = 0;       // UTF-8 paths, null terminated
+};
+
+struct PackEntry {
+    uint64_t PathHash = 0;   // StringId of the normalized path
+    uint64_t Offset = 0;     // From the start of the pack
+    uint64_t Size = 0;       // Uncompressed
+    uint64_t StoredSize = 0; // Bytes in the pack
+    uint32_t Compression = 0; // PackCompression
+    uint32_t FirstBlock = 0;  // Blocks of compressed entries, PACK_BLOCK_SIZE uncompressed bytes each
+    uint32_t BlockCount = 0;
+    uint32_t NameOffset = 0;  // Into the names table
+};
+
+#pragma pack(pop)
+
+// Offsets are from the start of the pack
+using PackBlock = CompressedBlock;
+
+// A mounted pack. The whole file is memory mapped; entries stored uncompressed are returned as
+// pointers into the mapping. Thread safe once opened.
+class PackFile {
+public:
+    PackFile();
+    ~PackFile();
+
+    bool Open(const std::wstring& packPath);
+    void Close();
+
+    // 'path' is normalized first (see NormalizePath). Null when the pack doesn't have it.
+    const PackEntry* Find(std::string_view path) const;
+    const PackEntry* Find(StringId pathId) const;
+    // Bytes of an uncompressed entry inside the mapping (null for compressed entries)
+    const uint8_t* GetStoredData(const PackEntry& entry) const;
+    // Copies or decodes bytes [offset, offset + length) of an entry. Compressed entries only decode
+    // the blocks overlapping the range, in parallel on 'jobSystem' when given.
+    bool ReadRange(const PackEntry& entry, uint64_t offset, size_t length, uint8_t* out, JobSystem* jobSystem = nullptr) const;
+
+    size_t GetEntryCount() const { return m_entryCount; }
+    const PackEntry& GetEntry(size_t index) const { return m_entries[index]; }
+    const char* GetEntryName(const PackEntry& entry) const;
+    const std::wstring& GetPath() const { return m_path; }
+    // Keeps the mapping alive for views handed out by the VFS
+    std::shared_ptr<MappedFile> GetMapping() const { return m_mapping; }
+
+    // Lowercase, '/' separators, no leading "./" or "/". Hashes of normalized paths are the keys.
+    static std::string NormalizePath(std::string_view path);
+    // Absolute paths below 'workingDirectory' are made relative to it first. Callers look the working
+    // directory up once (VirtualFileSystem at mount time), not per path.
+    static std::string NormalizePath(std::wstring_view path, const std::filesystem::path& workingDirectory);
+    // Slot of 'hash' for a bucket seed
+    static uint32_t GetSlot(uint64_t hash, uint32_t seed, uint32_t entryCount);
+
+private:
+    std::wstring m_path;
+    std::shared_ptr<MappedFile> m_mapping;
+    const PackHeader* m_header = nullptr;
+    const uint32_t* m_seeds = nullptr;
+    const PackEntry* m_entries = nullptr;
+    const PackBlock* m_blocks = nullptr;
+    const char* m_names = nullptr;
+    size_t m_entryCount = 0;
+
+    void LogMessage(const std::string& message) const;
+};
+
+struct PackWriterSettings {
+    uint32_t Alignment = 64;           // Every entry starts on this boundary
+    uint32_t LargeAlignment = 4096;    // Entries of at least LargeEntrySize start on a page
+    uint64_t LargeEntrySize = 64 * 1024;
+    bool Compress = true;              // LZ block compress entries that shrink by at least MinSavings
+    float MinSavings = 0.1f;
+};
+
+// Packer: writes every file below a directory into one pack (WinMain "-pack <dir> <out.agp>")
+class PackWriter {
+public:
+    // Entry paths are the normalized 'sourceDirectory'/relative paths, so a pack of "Assets" resolves
+    // the same paths the game uses for loose files ("Assets/Sounds/shoot.wav").
+    static bool PackDirectory(const std::wstring& sourceDirectory, const std::wstring& packPath,
+                              const PackWriterSettings& settings = PackWriterSettings(), JobSystem* jobSystem = nullptr);
+
+    struct SourceFile {
+        std::string PackPath;    // Normalized
+        std::wstring SourcePath;
+    };
+    static bool WritePack(const std::vector<SourceFile>& files, const std::wstring& packPath, const PackWriterSettings& settings,
+                          JobSystem* jobSystem = nullptr);
+
+    // Hash and displace seeds for 'hashes' (distinct); outSlots[i] is the entry index of hashes[i]
+    static bool BuildPerfectHash(const std::vector<uint64_t>& hashes, std::vector<uint32_t>& outSeeds, std::vector<uint32_t>& outSlots);
+};
@@ -0,0 +1,326 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "PoseEvaluator.h"
+#include "Timing.h"
+#include "CpuSkinning.h"
+#include "JobSystem.h"
+#include "VertexQuantization.h"
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+
+// Scale, then rotate, then translate (row vectors): the rotation rows scaled per axis, translation in r[3]
+inline XMMATRIX LocalMatrix(const LocalPose& pose, size_t joint) {
+    XMMATRIX m = XMMatrixRotationQuaternion(XMLoadFloat4A(&pose.Rotations[joint]));
+    XMVECTOR scale = XMLoadFloat4A(&pose.Scales[joint]);
+    m.r[0] = XMVectorMultiply(m.r[0], XMVectorSplatX(scale));
+    m.r[1] = XMVectorMultiply(m.r[1], XMVectorSplatY(scale));
+    m.r[2] = XMVectorMultiply(m.r[2], XMVectorSplatZ(scale));
+    m.r[3] = XMVectorSetW(XMLoadFloat4A(&pose.Translations[joint]), 1.0f);
+    return m;
+}
+
+// Dual quaternion of 'a' then 'b' (row vector order, like XMMatrixMultiply(a, b)): b * a, with the
+// Hamilton products b.real * a.real and b.real * a.dual + b.dual * a.real
+inline void Concatenate(FXMVECTOR aReal, FXMVECTOR aDual, FXMVECTOR bReal, GXMVECTOR bDual, XMVECTOR& outReal, XMVECTOR& outDual) {
+    XMVECTOR real = XMQuaternionMultiply(aReal, bReal);
+    XMVECTOR dual = XMVectorAdd(XMQuaternionMultiply(aDual, bReal), XMQuaternionMultiply(aReal, bDual));
+    outReal = real; // The outputs may alias the inputs
+    outDual = dual;
+}
+
+// Benchmark baseline: joints in any order, each parent resolved on demand through the Joint structs
+void ResolveRecursive(const Skeleton& skeleton, const LocalPose& pose, size_t joint, std::vector<uint8_t>& resolved,
+                      XMFLOAT4X4* outModel, XMFLOAT4X4* outSkinning) {
+    if (resolved[joint]) {
+        return;
+    }
+    XMMATRIX model = LocalMatrix(pose, joint);
+    int parent = skeleton.Joints[joint].ParentIndex;
+    if (parent >= 0) {
+        ResolveRecursive(skeleton, pose, static_cast<size_t>(parent), resolved, outModel, outSkinning);
+        model = XMMatrixMultiply(model, XMLoadFloat4x4(&outModel[parent]));
+    }
+    XMStoreFloat4x4(&outModel[joint], model);
+    XMStoreFloat4x4(&outSkinning[joint], XMMatrixMultiply(XMLoadFloat4x4(&skeleton.Joints[joint].InverseBindPoseMatrix), model));
+    resolved[joint] = 1;
+}
+
+} // namespace
+
+bool PoseEvaluator::Bind(const Skeleton& skeleton) {
+    m_parents.clear();
+    m_inverseBindPose.clear();
+    m_inverseBindDualQuaternion.clear();
+    if (!IsParentsFirst(skeleton)) {
+        return false;
+    }
+    m_parents.resize(skeleton.Joints.size());
+    m_inverseBindPose.resize(skeleton.Joints.size());
+    m_inverseBindDualQuaternion.resize(skeleton.Joints.size());
+    for (size_t j = 0; j < skeleton.Joints.size(); ++j) {
+        m_parents[j] = skeleton.Joints[j].ParentIndex;
+        XMStoreFloat4x4A(&m_inverseBindPose[j], XMLoadFloat4x4(&skeleton.Joints[j].InverseBindPoseMatrix));
+    }
+    // Decomposed once here, so evaluation never touches a matrix
+    CpuSkinning::BuildDualQuaternionPalette(m_inverseBindPose.data(), m_inverseBindPose.size(), m_inverseBindDualQuaternion.data());
+    return true;
+}
+
+void PoseEvaluator::Evaluate(const LocalPose& pose, XMFLOAT4X4A* outModel, XMFLOAT4X4A* outSkinning) const {
+    const size_t jointCount = std::min(m_parents.size(), pose.GetJointCount());
+    const int32_t* parents = m_parents.data();
+    for (size_t j = 0; j < jointCount; ++j) {
+        XMMATRIX model = LocalMatrix(pose, j);
+        if (parents[j] >= 0) {
+            model = XMMatrixMultiply(model, XMLoadFloat4x4A(&outModel[parents[j]]));
+        }
+        XMStoreFloat4x4A(&outModel[j], model);
+        if (outSkinning) {
+            XMStoreFloat4x4A(&outSkinning[j], XMMatrixMultiply(XMLoadFloat4x4A(&m_inverseBindPose[j]), model));
+        }
+    }
+}
+
+void PoseEvaluator::EvaluateDualQuaternion(const LocalPose& pose, DualQuaternion* outModel, DualQuaternion* outSkinning,
+                                           XMFLOAT4X4A* outModelMatrices) const {
+    const size_t jointCount = std::min(m_parents.size(), pose.GetJointCount());
+    const int32_t* parents = m_parents.data();
+    for (size_t j = 0; j < jointCount; ++j) {
+        // Local: dual = 0.5 * translation * rotation
+        XMVECTOR real = XMLoadFloat4A(&pose.Rotations[j]);
+        XMVECTOR dual = XMVectorScale(XMQuaternionMultiply(real, XMVectorSetW(XMLoadFloat4A(&pose.Translations[j]), 0.0f)), 0.5f);
+        if (parents[j] >= 0) {
+            const DualQuaternion& parent = outModel[parents[j]];
+            Concatenate(real, dual, XMLoadFloat4(&parent.Real), XMLoadFloat4(&parent.Dual), real, dual);
+        }
+        XMStoreFloat4(&outModel[j].Real, real);
+        XMStoreFloat4(&outModel[j].Dual, dual);
+        if (outModelMatrices) {
+            XMMATRIX model = XMMatrixRotationQuaternion(real);
+            model.r[3] = XMVectorSetW(XMVectorScale(XMQuaternionMultiply(XMQuaternionConjugate(real), dual), 2.0f), 1.0f);
+            XMStoreFloat4x4A(&outModelMatrices[j], model);
+        }
+        if (outSkinning) {
+            const DualQuaternion& inverseBind = m_inverseBindDualQuaternion[j];
+            XMVECTOR skinReal, skinDual;
+            Concatenate(XMLoadFloat4(&inverseBind.Real), XMLoadFloat4(&inverseBind.Dual), real, dual, skinReal, skinDual);
+            XMStoreFloat4(&outSkinning[j].Real, skinReal);
+            XMStoreFloat4(&outSkinning[j].Dual, skinDual);
+        }
+    }
+}
+
+void PoseEvaluator::EvaluateBatch(const LocalPose* const* poses, size_t instanceCount, XMFLOAT4X4A* outModel,
+                                  XMFLOAT4X4A* outSkinning, JobSystem* jobSystem, size_t batchSize) const {
+    const size_t jointCount = m_parents.size();
+    auto evaluateRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Evaluate(*poses[i], outModel + i * jointCount, outSkinning ? outSkinning + i * jointCount : nullptr);
+        }
+    };
+    if (jobSystem && jobSystem->GetWorkerCount() > 0) {
+        jobSystem->ParallelFor(instanceCount, batchSize, evaluateRange);
+    } else {
+        evaluateRange(0, instanceCount);
+    }
+}
+
+bool PoseEvaluator::IsParentsFirst(const Skeleton& skeleton) {
+    for (size_t j = 0; j < skeleton.Joints.size(); ++j) {
+        if (skeleton.Joints[j].ParentIndex >= static_cast<int>(j)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PoseEvaluator::SortJoints(Skeleton& skeleton, std::vector<uint32_t>& outRemap) {
+    const size_t count = skeleton.Joints.size();
+    outRemap.resize(count);
+    for (size_t j = 0; j < count; ++j) outRemap[j] = static_cast<uint32_t>(j);
+    if (IsParentsFirst(skeleton)) {
+        return true;
+    }
+
+    // Each joint is placed right after its not yet placed ancestors
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    std::vector<uint8_t> placed(count, 0);
+    std::vector<uint32_t> chain;
+    for (size_t j = 0; j < count; ++j) {
+        chain.clear();
+        size_t current = j;
+        while (!placed[current]) {
+            chain.push_back(static_cast<uint32_t>(current));
+            int parent = skeleton.Joints[current].ParentIndex;
+            if (parent < 0 || static_cast<size_t>(parent) >= count) break;
+            if (chain.size() > count) return false; // Cycle
+            current = static_cast<size_t>(parent);
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            placed[*it] = 1;
+            order.push_back(*it);
+        }
+    }
+
+    for (size_t k = 0; k < count; ++k) outRemap[order[k]] = static_cast<uint32_t>(k);
+    AssetVector<Joint> sorted(skeleton.Joints.get_allocator());
+    sorted.reserve(count);
+    for (uint32_t source : order) {
+        sorted.push_back(std::move(skeleton.Joints[source]));
+        int& parent = sorted.back().ParentIndex;
+        parent = parent >= 0 && static_cast<size_t>(parent) < count ? static_cast<int>(outRemap[parent]) : -1;
+    }
+    skeleton.Joints = std::move(sorted);
+    for (auto& entry : skeleton.JointNameToIndex) {
+        if (entry.second >= 0 && static_cast<size_t>(entry.second) < count) {
+            entry.second = static_cast<int>(outRemap[entry.second]);
+        }
+    }
+    return true;
+}
+
+bool PoseEvaluator::SortJoints(Model& model) {
+    if (!model.pSkeleton || IsParentsFirst(*model.pSkeleton)) {
+        return true;
+    }
+    std::vector<uint32_t> remap;
+    if (!SortJoints(*model.pSkeleton, remap)) {
+        return false;
+    }
+
+    const uint32_t jointCount = static_cast<uint32_t>(remap.size());
+    auto remapIndex = [&](uint32_t index) { return index < jointCount ? remap[index] : index; };
+    for (Mesh& mesh : model.Meshes) {
+        for (Vertex& v : mesh.Vertices) {
+            v.BoneIndices = { remapIndex(v.BoneIndices.x), remapIndex(v.BoneIndices.y), remapIndex(v.BoneIndices.z), remapIndex(v.BoneIndices.w) };
+        }
+        if (VertexQuantization::IsSkinned(mesh.PackedFormat)) {
+            // Only for cooks from before the sort (the cooker sorts before packing); indices stay 8 bit
+            size_t vertexCount = mesh.PackedVertices.size() / sizeof(PackedSkinnedVertex);
+            PackedSkinnedVertex* packed = reinterpret_cast<PackedSkinnedVertex*>(mesh.PackedVertices.data());
+            for (size_t i = 0; i < vertexCount; ++i) {
+                for (uint8_t& index : packed[i].BoneIndices) {
+                    index = static_cast<uint8_t>(remapIndex(index));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool PoseEvaluator::RunBenchmark(size_t instanceCount, size_t jointCount, JobSystem* jobSystem) {
+    instanceCount = std::max<size_t>(instanceCount, 1);
+    jointCount = std::max<size_t>(jointCount, 1);
+
+    // Branchy skeleton, generated parents-first and stored in reverse so every child precedes its parent
+    std::mt19937 random(11);
+    std::vector<int> generatedParents(jointCount, -1);
+    for (size_t j = 1; j < jointCount; ++j) {
+        generatedParents[j] = static_cast<int>(std::uniform_int_distribution<size_t>(j > 4 ? j - 4 : 0, j - 1)(random));
+    }
+    std::vector<XMFLOAT4X4> bindModel(jointCount);
+    Skeleton skeleton;
+    skeleton.Joints.resize(jointCount);
+    for (size_t j = 0; j < jointCount; ++j) {
+        XMMATRIX local = XMMatrixTranslation(0.0f, 0.1f, 0.02f * (j % 3));
+        XMMATRIX model = generatedParents[j] >= 0 ? XMMatrixMultiply(local, XMLoadFloat4x4(&bindModel[generatedParents[j]])) : local;
+        XMStoreFloat4x4(&bindModel[j], model);
+
+        Joint& joint = skeleton.Joints[jointCount - 1 - j];
+        joint.NameId = StringId::Intern(L"joint" + std::to_wstring(j));
+        joint.ParentIndex = generatedParents[j] >= 0 ? static_cast<int>(jointCount - 1 - generatedParents[j]) : -1;
+        XMStoreFloat4x4(&joint.LocalBindTransform, local);
+        XMStoreFloat4x4(&joint.InverseBindPoseMatrix, XMMatrixInverse(nullptr, model));
+        skeleton.JointNameToIndex[joint.NameId] = static_cast<int>(jointCount - 1 - j);
+    }
+
+    Skeleton sorted = skeleton;
+    std::vector<uint32_t> remap;
+    PoseEvaluator evaluator;
+    if (!SortJoints(sorted, remap) || !evaluator.Bind(sorted)) {
+        std::cerr << "Pose benchmark: joint sort failed." << std::endl;
+        return false;
+    }
+
+    // Random poses per instance, in source order for the baseline and remapped for the sorted skeleton
+    std::uniform_real_distribution<float> angle(-0.8f, 0.8f);
+    std::vector<LocalPose> sourcePoses(instanceCount), sortedPoses(instanceCount);
+    std::vector<const LocalPose*> posePointers(instanceCount);
+    for (size_t i = 0; i < instanceCount; ++i) {
+        LocalPose& source = sourcePoses[i];
+        AnimationSampler::GetBindPose(skeleton, source);
+        LocalPose& target = sortedPoses[i];
+        target.Resize(jointCount);
+        for (size_t j = 0; j < jointCount; ++j) {
+            XMStoreFloat4A(&source.Rotations[j], XMQuaternionRotationRollPitchYaw(angle(random), angle(random), angle(random)));
+            target.Translations[remap[j]] = source.Translations[j];
+            target.Rotations[remap[j]] = source.Rotations[j];
+            target.Scales[remap[j]] = source.Scales[j];
+        }
+        posePointers[i] = &sortedPoses[i];
+    }
+
+    const size_t matrixCount = instanceCount * jointCount;
+    std::vector<XMFLOAT4X4> recursiveModel(matrixCount), recursiveSkinning(matrixCount);
+    std::vector<XMFLOAT4X4A> linearModel(matrixCount), linearSkinning(matrixCount);
+    std::vector<XMFLOAT4X4A> batchModel(matrixCount), batchSkinning(matrixCount);
+    std::vector<uint8_t> resolved(jointCount);
+
+    // Best of 10 frames each
+    double recursiveSeconds = 1e30, linearSeconds = 1e30, batchSeconds = 1e30;
+    for (int frame = 0; frame < 10; ++frame) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < instanceCount; ++i) {
+            std::fill(resolved.begin(), resolved.end(), 0);
+            for (size_t j = 0; j < jointCount; ++j) {
+                ResolveRecursive(skeleton, sourcePoses[i], j, resolved, &recursiveModel[i * jointCount], &recursiveSkinning[i * jointCount]);
+            }
+        }
+        recursiveSeconds = std::min(recursiveSeconds, SecondsSince(start));
+
+        start = std::chrono::high_resolution_clock::now();
+        evaluator.EvaluateBatch(posePointers.data(), instanceCount, linearModel.data(), linearSkinning.data(), nullptr);
+        linearSeconds = std::min(linearSeconds, SecondsSince(start));
+
+        start = std::chrono::high_resolution_clock::now();
+        evaluator.EvaluateBatch(posePointers.data(), instanceCount, batchModel.data(), batchSkinning.data(), jobSystem);
+        batchSeconds = std::min(batchSeconds, SecondsSince(start));
+    }
+
+    // All three must produce the same skinning matrices
+    float maxDifference = 0.0f;
+    for (size_t i = 0; i < instanceCount; ++i) {
+        for (size_t j = 0; j < jointCount; ++j) {
+            const float* reference = &recursiveSkinning[i * jointCount + j]._11;
+            const float* linear = &linearSkinning[i * jointCount + remap[j]]._11;
+            const float* batch = &batchSkinning[i * jointCount + remap[j]]._11;
+            for (int k = 0; k < 16; ++k) {
+                maxDifference = std::max(maxDifference, std::max(std::abs(reference[k] - linear[k]), std::abs(reference[k] - batch[k])));
+            }
+        }
+    }
+    bool ok = maxDifference <= 1e-4f;
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2);
+    report << "Pose benchmark: " << instanceCount << " characters x " << jointCount << " joints\n"
+           << "  Recursive lookups: " << recursiveSeconds * 1000.0 << " ms (" << instanceCount / std::max(recursiveSeconds * 1000.0, 1e-9) << " characters/ms)\n"
+           << "  Linear pass:       " << linearSeconds * 1000.0 << " ms (" << instanceCount / std::max(linearSeconds * 1000.0, 1e-9) << " characters/ms)\n"
+           << "  Linear, batched:   " << batchSeconds * 1000.0 << " ms (" << instanceCount / std::max(batchSeconds * 1000.0, 1e-9) << " characters/ms, "
+           << (jobSystem ? jobSystem->GetWorkerCount() : 0) << " workers)\n";
+    if (!ok) {
+        report << "  FAILED: skinning matrices differ by " << maxDifference << "\n";
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
@@ -0,0 +1,61 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include "AnimationSampler.h"
+#include <vector>
+
+class JobSystem;
+
+// Local pose -> model space joint transforms and skinning matrices (InverseBindPose * model) for one
+// skeleton (runtime). Requires parents-first joint order (SortJoints, done by the cooker and at load),
+// so every joint's parent transform is already computed and the whole skeleton is one linear pass.
+// The per-frame data is kept as structure of arrays: parent indices and inverse bind matrices only.
+// Rigid skeletons can skip the matrices: EvaluateDualQuaternion chains dual quaternions built straight
+// from the local rotations and translations into a dual quaternion skinning palette.
+class PoseEvaluator {
+public:
+    PoseEvaluator() = default;
+
+    // Returns false if the joints are not parents-first
+    bool Bind(const Skeleton& skeleton);
+
+    size_t GetJointCount() const { return m_parents.size(); }
+
+    // 'outModel' and 'outSkinning' (optional) hold GetJointCount() matrices
+    void Evaluate(const LocalPose& pose, DirectX::XMFLOAT4X4A* outModel, DirectX::XMFLOAT4X4A* outSkinning) const;
+
+    // 'outModel' receives the model space dual quaternions, 'outSkinning' (optional) InverseBindPose then
+    // model, GetJointCount() each; 'outModelMatrices' (optional) the model transforms as matrices. Local
+    // scales are ignored, so the results match Evaluate for unit scale poses only.
+    void EvaluateDualQuaternion(const LocalPose& pose, DualQuaternion* outModel, DualQuaternion* outSkinning,
+                                DirectX::XMFLOAT4X4A* outModelMatrices = nullptr) const;
+
+    // Many instances of the skeleton: outputs are instance-major, GetJointCount() matrices per instance.
+    // Instances are split into batches of 'batchSize' run on 'jobSystem' (on the caller without one).
+    void EvaluateBatch(const LocalPose* const* poses, size_t instanceCount, DirectX::XMFLOAT4X4A* outModel,
+                       DirectX::XMFLOAT4X4A* outSkinning, JobSystem* jobSystem = nullptr, size_t batchSize = 16) const;
+
+    static bool IsParentsFirst(const Skeleton& skeleton);
+
+    // Reorders the joints so parents come before their children, keeping the source order otherwise.
+    // Remaps ParentIndex, JointNameToIndex and the bone indices of every mesh vertex (source and packed).
+    // Returns false (and leaves the model unchanged) if the hierarchy has a cycle.
+    static bool SortJoints(Model& model);
+    // outRemap[old index] = new index
+    static bool SortJoints(Skeleton& skeleton, std::vector<uint32_t>& outRemap);
+
+    // Resolves random poses of a 'jointCount' joint skeleton (stored children-first) for 'instanceCount'
+    // characters: recursive parent lookups over the joints, the sorted linear pass, and the linear pass
+    // batched on 'jobSystem' (WinMain "-posebench"). Reports characters per millisecond.
+    static bool RunBenchmark(size_t instanceCount = 1000, size_t jointCount = 60, JobSystem* jobSystem = nullptr);
+
+private:
+    std::vector<int32_t> m_parents;                        // -1 for roots, always < own index
+    std::vector<DirectX::XMFLOAT4X4A> m_inverseBindPose;
+    std::vector<DualQuaternion> m_inverseBindDualQuaternion; // Rigid part of m_inverseBindPose
+};
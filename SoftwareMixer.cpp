@@ -0,0 +1,614 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#ifdef _WIN32
+#include "pch.h" // OutputDebugStringA; the mixer itself builds anywhere
+#endif
+#include "SoftwareMixer.h"
+#include "Timing.h"
+#include "CpuFeatures.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// Source frames past the end: silence for the last interpolation, plus a full AVX2 vector
+constexpr size_t SOURCE_PADDING = 9;
+
+#if defined(_MSC_VER)
+#define MIX_TARGET_AVX2
+#else
+#define MIX_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+void DebugLog(const std::string& message) {
+#ifdef _WIN32
+    OutputDebugStringA(message.c_str());
+#else
+    (void)message;
+#endif
+}
+
+// out[i] += lerp(source, position + i * step) * (gain + i * gainStep) for i < count. 'source' starts
+// at the voice's whole frame, 'position' is the fraction, and every frame read is inside the sound
+// or its padding. Frame positions are computed from i, not accumulated, so the kernels agree.
+
+void MixScalar(const float* source, float position, float step, float gain, float gainStep, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const float p = position + static_cast<float>(i) * step;
+        const int32_t k = static_cast<int32_t>(p);
+        const float t = p - static_cast<float>(k);
+        const float sample = source[k] + (source[k + 1] - source[k]) * t;
+        out[i] += sample * (gain + static_cast<float>(i) * gainStep);
+    }
+}
+
+void MixSse(const float* source, float position, float step, float gain, float gainStep, float* out, size_t count) {
+    const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 steps = _mm_set1_ps(step);
+    const __m128 gainSteps = _mm_set1_ps(gainStep);
+    size_t i = 0;
+    if (step == 1.0f) {
+        // Same rate, no pitch: consecutive source frames, one fraction for all
+        const __m128 t = _mm_set1_ps(position);
+        for (; i + 4 <= count; i += 4) {
+            __m128 a = _mm_loadu_ps(source + i);
+            __m128 b = _mm_loadu_ps(source + i + 1);
+            __m128 sample = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+            __m128 g = _mm_add_ps(_mm_set1_ps(gain), _mm_mul_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes), gainSteps));
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(sample, g)));
+        }
+    } else {
+        alignas(16) int32_t index[4];
+        for (; i + 4 <= count; i += 4) {
+            __m128 frame = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes);
+            __m128 p = _mm_add_ps(_mm_set1_ps(position), _mm_mul_ps(frame, steps));
+            __m128i k = _mm_cvttps_epi32(p);
+            __m128 t = _mm_sub_ps(p, _mm_cvtepi32_ps(k));
+            _mm_store_si128(reinterpret_cast<__m128i*>(index), k);
+            __m128 a = _mm_setr_ps(source[index[0]], source[index[1]], source[index[2]], source[index[3]]);
+            __m128 b = _mm_setr_ps(source[index[0] + 1], source[index[1] + 1], source[index[2] + 1], source[index[3] + 1]);
+            __m128 sample = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+            __m128 g = _mm_add_ps(_mm_set1_ps(gain), _mm_mul_ps(frame, gainSteps));
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(sample, g)));
+        }
+    }
+    for (; i < count; ++i) {
+        const float p = position + static_cast<float>(i) * step;
+        const int32_t k = static_cast<int32_t>(p);
+        const float t = p - static_cast<float>(k);
+        out[i] += (source[k] + (source[k + 1] - source[k]) * t) * (gain + static_cast<float>(i) * gainStep);
+    }
+}
+
+MIX_TARGET_AVX2
+void MixAvx2(const float* source, float position, float step, float gain, float gainStep, float* out, size_t count) {
+    const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 steps = _mm256_set1_ps(step);
+    const __m256 gainSteps = _mm256_set1_ps(gainStep);
+    const __m256 gains = _mm256_set1_ps(gain);
+    size_t i = 0;
+    if (step == 1.0f) {
+        const __m256 t = _mm256_set1_ps(position);
+        for (; i + 8 <= count; i += 8) {
+            __m256 a = _mm256_loadu_ps(source + i);
+            __m256 b = _mm256_loadu_ps(source + i + 1);
+            __m256 sample = _mm256_fmadd_ps(_mm256_sub_ps(b, a), t, a);
+            __m256 g = _mm256_fmadd_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lanes), gainSteps, gains);
+            _mm256_storeu_ps(out + i, _mm256_fmadd_ps(sample, g, _mm256_loadu_ps(out + i)));
+        }
+    } else {
+        const __m256 positions = _mm256_set1_ps(position);
+        for (; i + 8 <= count; i += 8) {
+            __m256 frame = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lanes);
+            __m256 p = _mm256_fmadd_ps(frame, steps, positions);
+            __m256i k = _mm256_cvttps_epi32(p);
+            __m256 t = _mm256_sub_ps(p, _mm256_cvtepi32_ps(k));
+            __m256 a = _mm256_i32gather_ps(source, k, 4);
+            __m256 b = _mm256_i32gather_ps(source + 1, k, 4);
+            __m256 sample = _mm256_fmadd_ps(_mm256_sub_ps(b, a), t, a);
+            __m256 g = _mm256_fmadd_ps(frame, gainSteps, gains);
+            _mm256_storeu_ps(out + i, _mm256_fmadd_ps(sample, g, _mm256_loadu_ps(out + i)));
+        }
+    }
+    for (; i < count; ++i) {
+        const float p = position + static_cast<float>(i) * step;
+        const int32_t k = static_cast<int32_t>(p);
+        const float t = p - static_cast<float>(k);
+        out[i] += (source[k] + (source[k + 1] - source[k]) * t) * (gain + static_cast<float>(i) * gainStep);
+    }
+}
+
+using MixFunction = void (*)(const float*, float, float, float, float, float*, size_t);
+
+MixFunction GetMixFunction(MixKernel kernel) {
+    switch (kernel) {
+    case MixKernel::Avx2: return MixAvx2;
+    case MixKernel::Sse: return MixSse;
+    default: return MixScalar;
+    }
+}
+
+// Keeps the interleaved output of a mixer (benchmark reference)
+class CaptureAudioSink : public AudioSink {
+public:
+    std::vector<float> Frames;
+
+    bool Open(uint32_t, uint32_t) override { Frames.clear(); return true; }
+    bool Write(const float* frames, size_t frameCount) override {
+        Frames.insert(Frames.end(), frames, frames + frameCount * 2);
+        return true;
+    }
+    void Close() override {}
+};
+
+} // namespace
+
+// --- Sinks ---
+
+bool WavFileAudioSink::Open(uint32_t sampleRate, uint32_t channelCount) {
+    Close();
+    m_file.open(m_path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        return false;
+    }
+    m_channelCount = channelCount;
+    m_dataBytes = 0;
+
+    // Sizes are written by Close
+    const AudioFormat format = MakePcmFormat(static_cast<uint16_t>(channelCount), sampleRate);
+    const uint32_t zero = 0, formatSize = 16;
+    m_file.write("RIFF", 4);
+    m_file.write(reinterpret_cast<const char*>(&zero), 4);
+    m_file.write("WAVEfmt ", 8);
+    m_file.write(reinterpret_cast<const char*>(&formatSize), 4);
+    m_file.write(reinterpret_cast<const char*>(&format), formatSize);
+    m_file.write("data", 4);
+    m_file.write(reinterpret_cast<const char*>(&zero), 4);
+    return m_file.good();
+}
+
+bool WavFileAudioSink::Write(const float* frames, size_t frameCount) {
+    if (!m_file.is_open()) {
+        return false;
+    }
+    const size_t sampleCount = frameCount * m_channelCount;
+    m_samples.resize(sampleCount);
+    for (size_t i = 0; i < sampleCount; ++i) {
+        float value = std::min(std::max(frames[i], -1.0f), 1.0f) * 32767.0f;
+        m_samples[i] = static_cast<int16_t>(std::lrintf(value));
+    }
+    m_file.write(reinterpret_cast<const char*>(m_samples.data()), sampleCount * sizeof(int16_t));
+    m_dataBytes += sampleCount * sizeof(int16_t);
+    return m_file.good();
+}
+
+void WavFileAudioSink::Close() {
+    if (!m_file.is_open()) {
+        return;
+    }
+    const uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(m_dataBytes, UINT32_MAX - 36));
+    const uint32_t riffSize = 36 + dataSize;
+    m_file.seekp(4);
+    m_file.write(reinterpret_cast<const char*>(&riffSize), 4);
+    m_file.seekp(40);
+    m_file.write(reinterpret_cast<const char*>(&dataSize), 4);
+    m_file.close();
+}
+
+// --- Mixer ---
+
+SoftwareMixer::~SoftwareMixer() {
+    Shutdown();
+}
+
+MixKernel SoftwareMixer::GetBestKernel() {
+    static const MixKernel best = CpuSupportsAvx2() ? MixKernel::Avx2 : MixKernel::Sse;
+    return best;
+}
+
+bool SoftwareMixer::Initialize(AudioSink* sink, uint32_t sampleRate, uint32_t channelCount, uint32_t maxVoices, size_t blockFrames, MixKernel kernel) {
+    Shutdown();
+    if (!sink || sampleRate == 0 || channelCount < 1 || channelCount > 2 || !sink->Open(sampleRate, channelCount)) {
+        return false;
+    }
+    m_sink = sink;
+    m_kernel = (kernel == MixKernel::Avx2 && GetBestKernel() != MixKernel::Avx2) ? MixKernel::Sse : kernel;
+    m_sampleRate = sampleRate;
+    m_channelCount = channelCount;
+    m_blockFrames = std::max<size_t>(blockFrames, 8);
+    m_masterVolume = 1.0f;
+
+    m_voices.assign(std::max(maxVoices, 1u), Voice());
+    m_freeVoices.clear();
+    for (uint32_t i = static_cast<uint32_t>(m_voices.size()); i-- > 0;) {
+        m_freeVoices.push_back(i);
+    }
+    m_activeVoices.clear();
+    m_activeVoices.reserve(m_voices.size());
+    m_output.assign(m_blockFrames * m_channelCount, 0.0f);
+    m_buses.clear();
+    AddBus(1.0f);
+    return true;
+}
+
+void SoftwareMixer::Shutdown() {
+    if (m_sink) {
+        m_sink->Close();
+        m_sink = nullptr;
+    }
+    m_voices.clear();
+    m_freeVoices.clear();
+    m_activeVoices.clear();
+    m_buses.clear();
+    m_sounds.clear();
+}
+
+bool SoftwareMixer::AddSound(StringId soundId, const WaveData& waveData) {
+    const AudioFormat& format = waveData.WaveFormat;
+    if (format.FormatTag != AUDIO_FORMAT_PCM || format.BitsPerSample != 16 || format.Channels < 1 || format.Channels > 2 ||
+        format.SampleRate == 0 || waveData.AudioData.size() < format.BlockAlign) {
+        DebugLog("Mixer supports 16 bit mono or stereo PCM only: " + soundId.ToString() + "\n");
+        return false;
+    }
+
+    // Voices of the old version would read past the new data
+    for (size_t i = m_activeVoices.size(); i-- > 0;) {
+        if (m_voices[m_activeVoices[i]].SoundId == soundId) {
+            ReleaseVoice(m_activeVoices[i]);
+        }
+    }
+
+    Sound& sound = m_sounds[soundId];
+    sound.SampleRate = format.SampleRate;
+    sound.ChannelCount = format.Channels;
+    sound.FrameCount = waveData.AudioData.size() / format.BlockAlign;
+    const int16_t* samples = reinterpret_cast<const int16_t*>(waveData.AudioData.data());
+    for (uint32_t c = 0; c < 2; ++c) {
+        std::vector<float>& channel = sound.Channels[c];
+        if (c >= sound.ChannelCount) {
+            channel.clear();
+            continue;
+        }
+        channel.assign(sound.FrameCount + SOURCE_PADDING, 0.0f);
+        for (size_t i = 0; i < sound.FrameCount; ++i) {
+            int16_t sample;
+            memcpy(&sample, samples + i * sound.ChannelCount + c, sizeof(sample)); // Wave data is only byte aligned
+            channel[i] = sample * (1.0f / 32768.0f);
+        }
+    }
+    return true;
+}
+
+uint32_t SoftwareMixer::AddBus(float volume) {
+    Bus bus;
+    bus.Volume = volume;
+    for (uint32_t c = 0; c < m_channelCount; ++c) {
+        bus.Channels[c].assign(m_blockFrames, 0.0f);
+    }
+    m_buses.push_back(std::move(bus));
+    return static_cast<uint32_t>(m_buses.size() - 1);
+}
+
+void SoftwareMixer::SetBusVolume(uint32_t bus, float volume) {
+    if (bus < m_buses.size()) {
+        m_buses[bus].Volume = volume;
+    }
+}
+
+void SoftwareMixer::SetRoutes(Voice& voice, float volume, float pan) const {
+    pan = std::min(std::max(pan, -1.0f), 1.0f);
+    if (m_channelCount == 1) {
+        // Stereo sounds fold down at half volume per channel
+        const float gain = voice.Source->ChannelCount == 2 ? volume * 0.5f : volume;
+        voice.RouteCount = voice.Source->ChannelCount;
+        for (uint32_t c = 0; c < voice.RouteCount; ++c) {
+            voice.Routes[c].SourceChannel = c;
+            voice.Routes[c].BusChannel = 0;
+            voice.Routes[c].Gain = gain;
+        }
+    } else if (voice.Source->ChannelCount == 1) {
+        // Constant power pan
+        const float angle = (pan + 1.0f) * 0.25f * 3.14159265f;
+        voice.RouteCount = 2;
+        voice.Routes[0] = { 0, 0, volume * std::cos(angle), voice.Routes[0].CurrentGain };
+        voice.Routes[1] = { 0, 1, volume * std::sin(angle), voice.Routes[1].CurrentGain };
+    } else {
+        // Balance: the far channel fades out
+        voice.RouteCount = 2;
+        voice.Routes[0] = { 0, 0, volume * std::min(1.0f, 1.0f - pan), voice.Routes[0].CurrentGain };
+        voice.Routes[1] = { 1, 1, volume * std::min(1.0f, 1.0f + pan), voice.Routes[1].CurrentGain };
+    }
+}
+
+SoundHandle SoftwareMixer::Play(StringId soundId, float volume, float pitch, float pan, bool loop, uint32_t bus) {
+    auto it = m_sounds.find(soundId);
+    if (it == m_sounds.end() || m_freeVoices.empty() || bus >= m_buses.size()) {
+        return SoundHandle();
+    }
+
+    const uint32_t index = m_freeVoices.back();
+    m_freeVoices.pop_back();
+    Voice& voice = m_voices[index];
+    voice.Source = &it->second;
+    voice.SoundId = soundId;
+    voice.Bus = bus;
+    voice.Position = 0.0;
+    voice.Step = static_cast<float>(voice.Source->SampleRate) / m_sampleRate * std::max(pitch, 0.0f);
+    voice.Loop = loop;
+    voice.Playing = true;
+    ++voice.Generation;
+    SetRoutes(voice, volume, pan);
+    for (uint32_t r = 0; r < voice.RouteCount; ++r) {
+        voice.Routes[r].CurrentGain = voice.Routes[r].Gain; // Starts at its volume, no fade in
+    }
+    voice.ActiveIndex = static_cast<uint32_t>(m_activeVoices.size());
+    m_activeVoices.push_back(index);
+
+    SoundHandle handle;
+    handle.Voice = index;
+    handle.Generation = voice.Generation;
+    return handle;
+}
+
+bool SoftwareMixer::IsPlaying(const SoundHandle& handle) const {
+    return handle.Voice < m_voices.size() && m_voices[handle.Voice].Playing && m_voices[handle.Voice].Generation == handle.Generation;
+}
+
+void SoftwareMixer::Stop(SoundHandle& handle) {
+    if (IsPlaying(handle)) {
+        ReleaseVoice(handle.Voice);
+    }
+    handle = SoundHandle();
+}
+
+void SoftwareMixer::SetVolume(const SoundHandle& handle, float volume, float pan) {
+    if (IsPlaying(handle)) {
+        SetRoutes(m_voices[handle.Voice], volume, pan); // Ramped over the next block
+    }
+}
+
+void SoftwareMixer::SetPitch(const SoundHandle& handle, float pitch) {
+    if (IsPlaying(handle)) {
+        Voice& voice = m_voices[handle.Voice];
+        voice.Step = static_cast<float>(voice.Source->SampleRate) / m_sampleRate * std::max(pitch, 0.0f);
+    }
+}
+
+void SoftwareMixer::ReleaseVoice(uint32_t index) {
+    Voice& voice = m_voices[index];
+    const uint32_t last = m_activeVoices.back();
+    m_activeVoices[voice.ActiveIndex] = last;
+    m_voices[last].ActiveIndex = voice.ActiveIndex;
+    m_activeVoices.pop_back();
+    voice.Playing = false;
+    voice.Source = nullptr;
+    m_freeVoices.push_back(index);
+}
+
+bool SoftwareMixer::MixVoice(Voice& voice, size_t frameCount) {
+    const MixFunction mix = GetMixFunction(m_kernel);
+    const Sound& sound = *voice.Source;
+    Bus& bus = m_buses[voice.Bus];
+    float gainSteps[2];
+    for (uint32_t r = 0; r < voice.RouteCount; ++r) {
+        gainSteps[r] = (voice.Routes[r].Gain - voice.Routes[r].CurrentGain) / static_cast<float>(frameCount);
+    }
+
+    size_t mixed = 0;
+    while (mixed < frameCount) {
+        // Output frames whose first interpolated source frame is still inside the sound
+        const double end = static_cast<double>(sound.FrameCount);
+        size_t available = 0;
+        if (voice.Step <= 0.0f) {
+            available = voice.Position < end ? frameCount - mixed : 0;
+        } else if (voice.Position < end) {
+            available = static_cast<size_t>(std::ceil((end - voice.Position) / voice.Step));
+        }
+        if (available == 0) {
+            if (!voice.Loop || voice.Step <= 0.0f) {
+                return false;
+            }
+            voice.Position = std::fmod(voice.Position, end);
+            continue;
+        }
+
+        const size_t count = std::min(available, frameCount - mixed);
+        const size_t whole = static_cast<size_t>(voice.Position);
+        const float fraction = static_cast<float>(voice.Position - static_cast<double>(whole));
+        for (uint32_t r = 0; r < voice.RouteCount; ++r) {
+            const Route& route = voice.Routes[r];
+            mix(sound.Channels[route.SourceChannel].data() + whole, fraction, voice.Step,
+                route.CurrentGain + gainSteps[r] * static_cast<float>(mixed), gainSteps[r],
+                bus.Channels[route.BusChannel].data() + mixed, count);
+        }
+        voice.Position += static_cast<double>(count) * voice.Step;
+        mixed += count;
+    }
+    for (uint32_t r = 0; r < voice.RouteCount; ++r) {
+        voice.Routes[r].CurrentGain = voice.Routes[r].Gain;
+    }
+    return true;
+}
+
+void SoftwareMixer::MixBlock(size_t frameCount) {
+    for (size_t i = 0; i < m_activeVoices.size();) {
+        const uint32_t index = m_activeVoices[i];
+        if (MixVoice(m_voices[index], frameCount)) {
+            ++i;
+        } else {
+            ReleaseVoice(index); // Swaps the last active voice into slot i
+        }
+    }
+
+    // Sum the buses into the interleaved block and clear them for the next one
+    std::fill(m_output.begin(), m_output.begin() + frameCount * m_channelCount, 0.0f);
+    for (Bus& bus : m_buses) {
+        const float volume = bus.Volume * m_masterVolume;
+        for (uint32_t c = 0; c < m_channelCount; ++c) {
+            float* channel = bus.Channels[c].data();
+            for (size_t i = 0; i < frameCount; ++i) {
+                m_output[i * m_channelCount + c] += channel[i] * volume;
+            }
+            std::fill(channel, channel + frameCount, 0.0f);
+        }
+    }
+}
+
+bool SoftwareMixer::Render(size_t frameCount) {
+    if (!m_sink) {
+        return false;
+    }
+    while (frameCount > 0) {
+        const size_t count = std::min(frameCount, m_blockFrames);
+        MixBlock(count);
+        if (!m_sink->Write(m_output.data(), count)) {
+            return false;
+        }
+        frameCount -= count;
+    }
+    return true;
+}
+
+bool SoftwareMixer::RunBenchmark(size_t voiceCount, float seconds) {
+    voiceCount = std::max<size_t>(voiceCount, 1);
+    const uint32_t sampleRate = 48000;
+    const size_t frameCount = std::max<size_t>(static_cast<size_t>(seconds * sampleRate), sampleRate / 10);
+
+    // A second of 48 kHz mono (mixed without resampling unless pitched), 44.1 kHz stereo and 22.05 kHz mono
+    struct Source { uint32_t Rate; uint32_t Channels; float Frequency; };
+    const Source sources[] = { { 48000, 1, 440.0f }, { 44100, 2, 330.0f }, { 22050, 1, 220.0f } };
+    std::vector<std::pair<StringId, WaveData>> sounds;
+    for (size_t s = 0; s < 3; ++s) {
+        WaveData wave = {};
+        wave.WaveFormat = MakePcmFormat(static_cast<uint16_t>(sources[s].Channels), sources[s].Rate);
+        std::vector<int16_t> samples(sources[s].Rate * sources[s].Channels);
+        for (size_t i = 0; i < sources[s].Rate; ++i) {
+            for (size_t c = 0; c < sources[s].Channels; ++c) {
+                float t = static_cast<float>(i) / sources[s].Rate;
+                samples[i * sources[s].Channels + c] = static_cast<int16_t>(std::sin(6.2831853f * sources[s].Frequency * (c + 1) * t) * 20000.0f);
+            }
+        }
+        wave.AudioData.resize(samples.size() * sizeof(int16_t));
+        memcpy(wave.AudioData.data(), samples.data(), wave.AudioData.size());
+        sounds.emplace_back(StringId::Intern("mixbench_" + std::to_string(s)), std::move(wave));
+    }
+
+    // The same voices on every mixer: a third unpitched, the rest pitched, panned across
+    auto setup = [&](SoftwareMixer& mixer) {
+        for (const auto& sound : sounds) {
+            mixer.AddSound(sound.first, sound.second);
+        }
+        std::mt19937 random(50);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<SoundHandle> handles;
+        for (size_t v = 0; v < voiceCount; ++v) {
+            float pitch = v % 3 == 0 ? 1.0f : 0.8f + 0.4f * unit(random);
+            handles.push_back(mixer.Play(sounds[v % 3].first, 1.0f / voiceCount, pitch, unit(random) * 2.0f - 1.0f, true));
+        }
+        return handles;
+    };
+
+    const MixKernel kernels[] = { MixKernel::Scalar, MixKernel::Sse, MixKernel::Avx2 };
+    const char* names[] = { "Scalar", "SSE2  ", "AVX2  " };
+    const size_t checkFrames = sampleRate / 10;
+    CaptureAudioSink reference;
+    double mixSeconds[3] = {};
+    float maxDifference = 0.0f;
+    bool ok = true;
+    for (size_t k = 0; k < 3; ++k) {
+        if (kernels[k] == MixKernel::Avx2 && GetBestKernel() != MixKernel::Avx2) {
+            continue;
+        }
+        // Agreement over the first 100 ms (volume ramps included: every voice changes volume at 50 ms)
+        CaptureAudioSink capture;
+        SoftwareMixer check;
+        ok = check.Initialize(&capture, sampleRate, 2, static_cast<uint32_t>(voiceCount), 480, kernels[k]) && ok;
+        std::vector<SoundHandle> handles = setup(check);
+        check.Render(checkFrames / 2);
+        for (const SoundHandle& handle : handles) {
+            check.SetVolume(handle, 0.5f / voiceCount, 0.0f);
+        }
+        check.Render(checkFrames - checkFrames / 2);
+        if (k == 0) {
+            reference.Frames = capture.Frames;
+        } else {
+            for (size_t i = 0; i < reference.Frames.size() && i < capture.Frames.size(); ++i) {
+                maxDifference = std::max(maxDifference, std::abs(reference.Frames[i] - capture.Frames[i]));
+            }
+            ok = ok && capture.Frames.size() == reference.Frames.size();
+        }
+
+        NullAudioSink sink;
+        SoftwareMixer mixer;
+        mixer.Initialize(&sink, sampleRate, 2, static_cast<uint32_t>(voiceCount), 480, kernels[k]);
+        setup(mixer);
+        auto start = std::chrono::high_resolution_clock::now();
+        ok = mixer.Render(frameCount) && ok;
+        mixSeconds[k] = SecondsSince(start);
+        ok = ok && sink.GetFramesWritten() == frameCount && mixer.GetActiveVoiceCount() == voiceCount;
+    }
+    ok = ok && maxDifference <= 1e-5f;
+
+    // The WAV sink: the same mix twice gives the same bytes, and the file reads back as the mix
+    auto writeWave = [&](const std::filesystem::path& path) {
+        WavFileAudioSink sink(path);
+        SoftwareMixer mixer;
+        if (!mixer.Initialize(&sink, sampleRate, 2, static_cast<uint32_t>(voiceCount))) {
+            return std::vector<uint8_t>();
+        }
+        setup(mixer);
+        mixer.Render(checkFrames);
+        mixer.Shutdown();
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+    const std::filesystem::path wavePath = std::filesystem::temp_directory_path() / "agrona_mixbench.wav";
+    std::vector<uint8_t> first = writeWave(wavePath);
+    std::vector<uint8_t> second = writeWave(wavePath);
+    std::error_code error;
+    std::filesystem::remove(wavePath, error);
+    // Canonical 44 byte header: RIFF, WAVE, a 16 byte fmt chunk, then the data chunk
+    const AudioFormat expected = MakePcmFormat(2, sampleRate);
+    AudioFormat format;
+    uint32_t riffSize = 0, dataSize = 0;
+    const bool headerOk = first.size() >= 44 && memcmp(first.data(), "RIFF", 4) == 0 && memcmp(first.data() + 8, "WAVEfmt ", 8) == 0 &&
+                          memcmp(first.data() + 36, "data", 4) == 0;
+    if (headerOk) {
+        memcpy(&riffSize, first.data() + 4, 4);
+        memcpy(&format, first.data() + 20, sizeof(format));
+        memcpy(&dataSize, first.data() + 40, 4);
+    }
+    const bool waveOk = headerOk && first == second && memcmp(&format, &expected, sizeof(format)) == 0 &&
+                        dataSize == checkFrames * 4 && riffSize == 36 + dataSize && first.size() == 44 + dataSize;
+    ok = ok && waveOk;
+
+    const double audioMs = frameCount * 1000.0 / sampleRate;
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    report << "Mixer benchmark: " << voiceCount << " voices, " << audioMs / 1000.0 << " s of " << sampleRate / 1000 << " kHz stereo\n";
+    for (size_t k = 0; k < 3; ++k) {
+        if (mixSeconds[k] <= 0.0) continue;
+        // Voice milliseconds of audio mixed per millisecond: the voices one core mixes in real time
+        report << "  " << names[k] << ": " << mixSeconds[k] * 1000.0 << " ms, " << voiceCount * audioMs / (mixSeconds[k] * 1000.0)
+               << " voices mixed per ms of audio (" << std::setprecision(2) << mixSeconds[0] / mixSeconds[k] << "x scalar)\n"
+               << std::setprecision(1);
+    }
+    report << std::scientific << std::setprecision(2) << "  Max difference from scalar " << maxDifference
+           << (waveOk ? ", WAV sink output identical across runs\n" : ", WAV sink output differs or is unreadable\n");
+    if (!ok) {
+        report << "  FAILED: kernels disagree, voices dropped, or the WAV sink is not deterministic\n";
+    }
+    std::cout << report.str() << std::flush;
+    DebugLog(report.str());
+    return ok;
+}
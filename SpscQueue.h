@@ -0,0 +1,60 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded single producer / single consumer queue: lock-free, and allocation-free after Reset.
+// Exactly one thread pushes (e.g. the XAudio2 callback thread) and one other thread pops.
+template <typename T>
+class SpscQueue {
+public:
+    SpscQueue() = default;
+    explicit SpscQueue(size_t capacity) { Reset(capacity); }
+
+    // Empties the queue and rounds 'capacity' up to a power of two. Not thread safe: call while
+    // neither side is running.
+    void Reset(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_items.assign(size, T());
+        m_mask = size - 1;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    // Producer. Returns false (and drops 'value') when the queue is full.
+    bool TryPush(const T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask) {
+            return false;
+        }
+        m_items[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer. Returns false when the queue is empty.
+    bool TryPop(T& outValue) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        outValue = m_items[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t GetCapacity() const { return m_items.size(); }
+
+private:
+    std::vector<T> m_items;
+    size_t m_mask = 0;
+    // Separate cache lines, so the two threads don't invalidate each other's index on every operation
+    alignas(64) std::atomic<size_t> m_head{ 0 }; // Next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> m_tail{ 0 }; // Next slot to push, written by the producer
+};
@@ -0,0 +1,150 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#ifdef _WIN32
+#include "pch.h" // OutputDebugStringA; string ids build anywhere
+#endif
+#include "StringId.h"
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+
+namespace {
+
+// Appends the UTF-8 encoding of 'text' (UTF-16 on Windows, UTF-32 elsewhere)
+void EncodeUtf8(std::wstring_view text, std::string& out) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        uint32_t codePoint = static_cast<uint32_t>(text[i]);
+        if (sizeof(wchar_t) == 2 && codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < text.size()) {
+            uint32_t low = static_cast<uint32_t>(text[i + 1]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                ++i;
+            }
+        }
+        if (codePoint < 0x80) {
+            out.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+}
+
+struct InternTable {
+    std::mutex Mutex;
+    std::unordered_map<uint64_t, std::string> Names;
+};
+
+InternTable& GetInternTable() {
+    static InternTable table; // Constructed on first use, safe during static initialization
+    return table;
+}
+
+} // namespace
+
+uint64_t StringId::Hash(std::wstring_view text) {
+    std::string utf8;
+    utf8.reserve(text.size());
+    EncodeUtf8(text, utf8);
+    return Hash(utf8.data(), utf8.size());
+}
+
+StringId StringId::Intern(std::string_view name) {
+    StringId id(Hash(name.data(), name.size()));
+    if (STRING_ID_KEEP_NAMES) {
+        StringInterner::Register(id, name);
+    }
+    return id;
+}
+
+StringId StringId::Intern(std::wstring_view name) {
+    std::string utf8;
+    utf8.reserve(name.size());
+    EncodeUtf8(name, utf8);
+    return Intern(std::string_view(utf8));
+}
+
+std::string StringId::ToString() const {
+    std::string name;
+    if (StringInterner::TryGetName(*this, name)) {
+        return name;
+    }
+    std::ostringstream ss;
+    ss << '#' << std::hex << std::setw(16) << std::setfill('0') << m_value;
+    return ss.str();
+}
+
+std::wstring StringId::ToWideString() const {
+    // Names are mostly ASCII; anything else is only needed for debug display
+    std::string name = ToString();
+    std::wstring wide;
+    wide.reserve(name.size());
+    for (size_t i = 0; i < name.size();) {
+        uint8_t lead = static_cast<uint8_t>(name[i]);
+        uint32_t codePoint = lead;
+        size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+        if (length > 1) {
+            codePoint = lead & (0xFF >> (length + 1));
+            for (size_t k = 1; k < length && i + k < name.size(); ++k) {
+                codePoint = (codePoint << 6) | (static_cast<uint8_t>(name[i + k]) & 0x3F);
+            }
+        }
+        if (sizeof(wchar_t) == 2 && codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            wide.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+            wide.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+        } else {
+            wide.push_back(static_cast<wchar_t>(codePoint));
+        }
+        i += length;
+    }
+    return wide;
+}
+
+void StringInterner::Register(StringId id, std::string_view name) {
+    if (!STRING_ID_KEEP_NAMES || !id.IsValid()) {
+        return;
+    }
+    InternTable& table = GetInternTable();
+    std::lock_guard<std::mutex> lock(table.Mutex);
+    auto result = table.Names.emplace(id.GetValue(), std::string(name));
+    if (!result.second && result.first->second != name) {
+        std::string message = "String Interner: Hash collision between \"" + result.first->second + "\" and \"" + std::string(name) + "\"";
+        std::cerr << message << std::endl;
+#ifdef _WIN32
+        OutputDebugStringA((message + "\n").c_str());
+#endif
+    }
+}
+
+bool StringInterner::TryGetName(StringId id, std::string& outName) {
+    if (!STRING_ID_KEEP_NAMES) {
+        return false;
+    }
+    InternTable& table = GetInternTable();
+    std::lock_guard<std::mutex> lock(table.Mutex);
+    auto it = table.Names.find(id.GetValue());
+    if (it == table.Names.end()) {
+        return false;
+    }
+    outName = it->second;
+    return true;
+}
+
+size_t StringInterner::GetCount() {
+    InternTable& table = GetInternTable();
+    std::lock_guard<std::mutex> lock(table.Mutex);
+    return table.Names.size();
+}
@@ -0,0 +1,90 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Debug builds keep the id -> name table (names in logs, collision checks, names in cooked files)
+#ifdef _DEBUG
+constexpr bool STRING_ID_KEEP_NAMES = true;
+#else
+constexpr bool STRING_ID_KEEP_NAMES = false;
+#endif
+
+// 64-bit FNV-1a hash of a name. Literals hash at compile time, so lookups by a literal name
+// ("shoot", "root") cost an integer hash-map probe and no string work at all.
+// Wide names hash their UTF-8 encoding, so StringId::Intern(L"hip") == StringId("hip").
+class StringId {
+public:
+    static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    constexpr StringId() = default;
+    constexpr explicit StringId(uint64_t value) : m_value(value) {}
+    // Implicit from string literals (hashed up to the first null)
+    template <size_t N>
+    constexpr StringId(const char (&literal)[N]) : m_value(Hash(literal, N - 1)) {}
+
+    // Runtime names. In debug builds the name is added to the reverse table.
+    static StringId Intern(std::string_view name);
+    static StringId Intern(std::wstring_view name);
+
+    constexpr uint64_t GetValue() const { return m_value; }
+    constexpr bool IsValid() const { return m_value != 0; } // 0 = no name
+
+    // The interned name in debug builds, "#<hex id>" when unknown (and always in release)
+    std::string ToString() const;
+    std::wstring ToWideString() const;
+
+    constexpr bool operator==(StringId other) const { return m_value == other.m_value; }
+    constexpr bool operator!=(StringId other) const { return m_value != other.m_value; }
+    constexpr bool operator<(StringId other) const { return m_value < other.m_value; }
+
+    static constexpr uint64_t Hash(const char* text, size_t length) {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        for (size_t i = 0; i < length && text[i] != '\0'; ++i) {
+            hash = (hash ^ static_cast<uint8_t>(text[i])) * FNV_PRIME;
+        }
+        return hash;
+    }
+    static uint64_t Hash(std::wstring_view text);
+
+private:
+    uint64_t m_value = 0;
+};
+
+constexpr StringId operator"" _sid(const char* text, size_t length) {
+    return StringId(StringId::Hash(text, length));
+}
+
+// The ids are already well mixed, the hash is the value itself
+struct StringIdHasher {
+    size_t operator()(StringId id) const { return static_cast<size_t>(id.GetValue()); }
+};
+
+namespace std {
+template <>
+struct hash<StringId> {
+    size_t operator()(StringId id) const { return static_cast<size_t>(id.GetValue()); }
+};
+}
+
+template <typename T>
+using StringIdMap = std::unordered_map<StringId, T, StringIdHasher>;
+
+// Global id -> name table. Thread safe. Only populated when STRING_ID_KEEP_NAMES is set.
+class StringInterner {
+public:
+    // Records 'name' for 'id'; logs when a different name already has the id (hash collision)
+    static void Register(StringId id, std::string_view name);
+    // False when the name isn't known (or names aren't kept)
+    static bool TryGetName(StringId id, std::string& outName);
+    static size_t GetCount();
+};
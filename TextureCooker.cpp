@@ -0,0 +1,1124 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "TextureCooker.h"
+#include "Timing.h"
+#include "AssetCache.h"
+#include <chrono>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace DirectX;
+
+namespace {
+
+constexpr float KAISER_RADIUS = 3.0f; // In destination pixels
+constexpr float KAISER_ALPHA = 4.0f;
+constexpr size_t LINEAR_TABLE_SIZE = 16384;
+
+// BC7 index weights for 4-bit indices (mode 6)
+constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct ColorTables {
+    float SrgbToLinear[256];
+    uint8_t LinearToSrgb[LINEAR_TABLE_SIZE];
+
+    ColorTables() {
+        for (int i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            SrgbToLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (size_t i = 0; i < LINEAR_TABLE_SIZE; ++i) {
+            float l = static_cast<float>(i) / (LINEAR_TABLE_SIZE - 1);
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            LinearToSrgb[i] = static_cast<uint8_t>(std::min(255.0f, c * 255.0f + 0.5f));
+        }
+    }
+};
+
+const ColorTables& GetColorTables() {
+    static ColorTables tables;
+    return tables;
+}
+
+// Linear light, premultiplied RGBA
+struct FloatImage {
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    std::vector<XMFLOAT4A> Pixels;
+};
+
+// RGBA8 in the stored encoding (sRGB or linear, premultiplied or straight)
+struct Rgba8Image {
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    std::vector<uint8_t> Pixels;
+};
+
+double BesselI0(double x) {
+    double sum = 1.0, term = 1.0, halfX = x * 0.5;
+    for (int k = 1; k < 32; ++k) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+float EvaluateFilter(MipFilter filter, float x) {
+    x = std::abs(x);
+    if (filter == MipFilter::Box) {
+        return x < 0.5f ? 1.0f : 0.0f;
+    }
+    if (x >= KAISER_RADIUS) {
+        return 0.0f;
+    }
+    static const double i0Alpha = BesselI0(KAISER_ALPHA);
+    double ratio = x / KAISER_RADIUS;
+    double window = BesselI0(KAISER_ALPHA * std::sqrt(1.0 - ratio * ratio)) / i0Alpha;
+    double sinc = x < 1e-6f ? 1.0 : std::sin(3.14159265358979 * x) / (3.14159265358979 * x);
+    return static_cast<float>(sinc * window);
+}
+
+// Source taps and weights for every destination sample along one axis
+struct FilterWeights {
+    std::vector<uint32_t> Begin; // Destination sample d uses entries [Begin[d], Begin[d + 1])
+    std::vector<uint32_t> Index;
+    std::vector<float> Weight;
+};
+
+FilterWeights BuildFilterWeights(uint32_t sourceSize, uint32_t destSize, MipFilter filter) {
+    FilterWeights weights;
+    float scale = static_cast<float>(sourceSize) / destSize;
+    float filterScale = std::max(scale, 1.0f); // Widen the kernel when minifying
+    float support = (filter == MipFilter::Box ? 0.5f : KAISER_RADIUS) * filterScale;
+
+    weights.Begin.reserve(destSize + 1);
+    for (uint32_t d = 0; d < destSize; ++d) {
+        weights.Begin.push_back(static_cast<uint32_t>(weights.Index.size()));
+        float center = (d + 0.5f) * scale;
+        int first = static_cast<int>(std::floor(center - support));
+        int last = static_cast<int>(std::ceil(center + support));
+        float sum = 0.0f;
+        size_t firstEntry = weights.Weight.size();
+        for (int s = first; s <= last; ++s) {
+            float w = EvaluateFilter(filter, (s + 0.5f - center) / filterScale);
+            if (w == 0.0f) continue;
+            weights.Index.push_back(static_cast<uint32_t>(std::clamp(s, 0, static_cast<int>(sourceSize) - 1)));
+            weights.Weight.push_back(w);
+            sum += w;
+        }
+        if (sum == 0.0f) { // Can't happen for sane sizes, fall back to the nearest sample
+            weights.Index.push_back(std::min(static_cast<uint32_t>(center), sourceSize - 1));
+            weights.Weight.push_back(1.0f);
+            sum = 1.0f;
+        }
+        for (size_t i = firstEntry; i < weights.Weight.size(); ++i) {
+            weights.Weight[i] /= sum;
+        }
+    }
+    weights.Begin.push_back(static_cast<uint32_t>(weights.Index.size()));
+    return weights;
+}
+
+// Separable resample, one XMVECTOR (SIMD over RGBA) multiply-add per tap
+FloatImage Resample(const FloatImage& source, uint32_t width, uint32_t height, MipFilter filter) {
+    FilterWeights horizontal = BuildFilterWeights(source.Width, width, filter);
+    FilterWeights vertical = BuildFilterWeights(source.Height, height, filter);
+
+    std::vector<XMFLOAT4A> rows(static_cast<size_t>(width) * source.Height);
+    for (uint32_t y = 0; y < source.Height; ++y) {
+        const XMFLOAT4A* sourceRow = source.Pixels.data() + static_cast<size_t>(y) * source.Width;
+        XMFLOAT4A* destRow = rows.data() + static_cast<size_t>(y) * width;
+        for (uint32_t x = 0; x < width; ++x) {
+            XMVECTOR sum = XMVectorZero();
+            for (uint32_t t = horizontal.Begin[x]; t < horizontal.Begin[x + 1]; ++t) {
+                sum = XMVectorMultiplyAdd(XMLoadFloat4A(&sourceRow[horizontal.Index[t]]), XMVectorReplicate(horizontal.Weight[t]), sum);
+            }
+            XMStoreFloat4A(&destRow[x], sum);
+        }
+    }
+
+    FloatImage result;
+    result.Width = width;
+    result.Height = height;
+    result.Pixels.resize(static_cast<size_t>(width) * height);
+    for (uint32_t y = 0; y < height; ++y) {
+        XMFLOAT4A* destRow = result.Pixels.data() + static_cast<size_t>(y) * width;
+        for (uint32_t t = vertical.Begin[y]; t < vertical.Begin[y + 1]; ++t) {
+            const XMFLOAT4A* sourceRow = rows.data() + static_cast<size_t>(vertical.Index[t]) * width;
+            XMVECTOR weight = XMVectorReplicate(vertical.Weight[t]);
+            bool first = t == vertical.Begin[y];
+            for (uint32_t x = 0; x < width; ++x) {
+                XMVECTOR sum = first ? XMVectorZero() : XMLoadFloat4A(&destRow[x]);
+                XMStoreFloat4A(&destRow[x], XMVectorMultiplyAdd(XMLoadFloat4A(&sourceRow[x]), weight, sum));
+            }
+        }
+    }
+    return result;
+}
+
+FloatImage ToFloatImage(const DecodedImage& image, bool srgb) {
+    const ColorTables& tables = GetColorTables();
+    FloatImage result;
+    result.Width = image.Width;
+    result.Height = image.Height;
+    result.Pixels.resize(static_cast<size_t>(image.Width) * image.Height);
+    for (uint32_t y = 0; y < image.Height; ++y) {
+        const uint8_t* row = image.Pixels.data() + static_cast<size_t>(y) * image.Stride;
+        for (uint32_t x = 0; x < image.Width; ++x) {
+            const uint8_t* bgra = row + x * 4;
+            float a = bgra[3] / 255.0f;
+            float r = srgb ? tables.SrgbToLinear[bgra[2]] : bgra[2] / 255.0f;
+            float g = srgb ? tables.SrgbToLinear[bgra[1]] : bgra[1] / 255.0f;
+            float b = srgb ? tables.SrgbToLinear[bgra[0]] : bgra[0] / 255.0f;
+            result.Pixels[static_cast<size_t>(y) * image.Width + x] = XMFLOAT4A(r * a, g * a, b * a, a);
+        }
+    }
+    return result;
+}
+
+Rgba8Image ToRgba8(const FloatImage& image, bool srgb, bool premultiplied) {
+    const ColorTables& tables = GetColorTables();
+    Rgba8Image result;
+    result.Width = image.Width;
+    result.Height = image.Height;
+    result.Pixels.resize(image.Pixels.size() * 4);
+    XMVECTOR one = XMVectorSplatOne();
+    for (size_t i = 0; i < image.Pixels.size(); ++i) {
+        // Sinc filters ring: clamp to [0, 1] and keep color <= alpha
+        XMVECTOR value = XMVectorMin(XMVectorMax(XMLoadFloat4A(&image.Pixels[i]), XMVectorZero()), one);
+        float a = XMVectorGetW(value);
+        value = XMVectorMin(value, XMVectorSplatW(value));
+        if (!premultiplied) {
+            value = a > 0.0f ? XMVectorScale(value, 1.0f / a) : XMVectorZero();
+        }
+        XMFLOAT4 c;
+        XMStoreFloat4(&c, value);
+        uint8_t* out = result.Pixels.data() + i * 4;
+        const float rgb[3] = { c.x, c.y, c.z };
+        for (int k = 0; k < 3; ++k) {
+            out[k] = srgb ? tables.LinearToSrgb[static_cast<size_t>(rgb[k] * (LINEAR_TABLE_SIZE - 1) + 0.5f)]
+                          : static_cast<uint8_t>(rgb[k] * 255.0f + 0.5f);
+        }
+        out[3] = static_cast<uint8_t>(a * 255.0f + 0.5f);
+    }
+    return result;
+}
+
+// Mip chain in the stored encoding, largest first
+std::vector<Rgba8Image> BuildMipChain(const DecodedImage& image, const TextureCookSettings& settings, bool blockCompressed) {
+    FloatImage level = ToFloatImage(image, settings.SRGB);
+    if (blockCompressed && (level.Width % 4 != 0 || level.Height % 4 != 0)) {
+        // D3D requires the top level of a BC texture to be whole blocks
+        level = Resample(level, (level.Width + 3) & ~3u, (level.Height + 3) & ~3u, MipFilter::Kaiser);
+    }
+
+    std::vector<Rgba8Image> mips;
+    while (true) {
+        mips.push_back(ToRgba8(level, settings.SRGB, settings.Premultiply));
+        if (!settings.GenerateMips || (level.Width == 1 && level.Height == 1)) {
+            break;
+        }
+        level = Resample(level, std::max(level.Width / 2, 1u), std::max(level.Height / 2, 1u), settings.Filter);
+    }
+    return mips;
+}
+
+DXGI_FORMAT GetDxgiFormat(TextureFormat format, bool srgb) {
+    switch (format) {
+    case TextureFormat::BC1: return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+    case TextureFormat::BC3: return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+    case TextureFormat::BC7: return srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+    default: return srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+const char* GetFormatName(TextureFormat format) {
+    switch (format) {
+    case TextureFormat::BC1: return "BC1";
+    case TextureFormat::BC3: return "BC3";
+    case TextureFormat::BC7: return "BC7";
+    default: return "RGBA8";
+    }
+}
+
+// Encodes 'mips' into texture (Format, Width and Height already set)
+void EncodeMips(const std::vector<Rgba8Image>& mips, TextureFormat format, CookedTexture& texture) {
+    size_t dataSize = TextureSerializer::ComputeMipLayout(texture, static_cast<uint32_t>(mips.size()));
+    texture.Data.assign(dataSize, 0);
+    for (size_t level = 0; level < mips.size(); ++level) {
+        const Rgba8Image& image = mips[level];
+        const TextureMip& mip = texture.Mips[level];
+        uint8_t* out = texture.Data.data() + mip.Offset;
+        if (format == TextureFormat::RGBA8) {
+            memcpy(out, image.Pixels.data(), image.Pixels.size());
+            continue;
+        }
+        uint32_t bytesPerBlock = TextureSerializer::GetBytesPerBlock(texture.Format);
+        uint8_t block[64];
+        for (uint32_t by = 0; by < mip.RowCount; ++by) {
+            for (uint32_t bx = 0; bx < mip.RowPitch / bytesPerBlock; ++bx) {
+                // Partial blocks of the 2x2 and 1x1 mips repeat the edge pixels
+                for (uint32_t py = 0; py < 4; ++py) {
+                    uint32_t y = std::min(by * 4 + py, image.Height - 1);
+                    for (uint32_t px = 0; px < 4; ++px) {
+                        uint32_t x = std::min(bx * 4 + px, image.Width - 1);
+                        memcpy(block + (py * 4 + px) * 4, image.Pixels.data() + (static_cast<size_t>(y) * image.Width + x) * 4, 4);
+                    }
+                }
+                uint8_t* blockOut = out + static_cast<size_t>(by) * mip.RowPitch + static_cast<size_t>(bx) * bytesPerBlock;
+                switch (format) {
+                case TextureFormat::BC1: TextureCooker::EncodeBlockBC1(block, blockOut, true); break;
+                case TextureFormat::BC3: TextureCooker::EncodeBlockBC3(block, blockOut); break;
+                case TextureFormat::BC7: TextureCooker::EncodeBlockBC7(block, blockOut); break;
+                default: break;
+                }
+            }
+        }
+    }
+}
+
+// --- Block codec helpers ---
+
+// Mean and principal axis (power iteration on the covariance) of 'count' points with D channels
+template <int D>
+void ComputePrincipalAxis(const float (*points)[D], int count, float (&mean)[D], float (&axis)[D]) {
+    for (int c = 0; c < D; ++c) {
+        mean[c] = 0.0f;
+        for (int i = 0; i < count; ++i) mean[c] += points[i][c];
+        mean[c] /= std::max(count, 1);
+    }
+    float covariance[D][D] = {};
+    for (int i = 0; i < count; ++i) {
+        for (int a = 0; a < D; ++a) {
+            for (int b = a; b < D; ++b) {
+                covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+            }
+        }
+    }
+    for (int a = 0; a < D; ++a) {
+        for (int b = 0; b < a; ++b) covariance[a][b] = covariance[b][a];
+    }
+
+    for (int c = 0; c < D; ++c) axis[c] = 1.0f;
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[D] = {};
+        float length = 0.0f;
+        for (int a = 0; a < D; ++a) {
+            for (int b = 0; b < D; ++b) next[a] += covariance[a][b] * axis[b];
+            length += next[a] * next[a];
+        }
+        if (length < 1e-12f) break; // Flat block, any axis works
+        length = 1.0f / std::sqrt(length);
+        for (int c = 0; c < D; ++c) axis[c] = next[c] * length;
+    }
+}
+
+// Endpoints at the extreme projections on the axis, inset by 1/16 of the range
+template <int D>
+void FitEndpoints(const float (*points)[D], int count, float (&low)[D], float (&high)[D]) {
+    float mean[D], axis[D];
+    ComputePrincipalAxis<D>(points, count, mean, axis);
+    float minT = FLT_MAX, maxT = -FLT_MAX;
+    for (int i = 0; i < count; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < D; ++c) t += (points[i][c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float inset = (maxT - minT) / 16.0f;
+    minT += inset;
+    maxT -= inset;
+    for (int c = 0; c < D; ++c) {
+        low[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        high[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+}
+
+// Least squares endpoints for fixed interpolation weights (weight of 'high' per point)
+template <int D>
+bool SolveEndpoints(const float (*points)[D], const float* weights, int count, float (&low)[D], float (&high)[D]) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ap[D] = {}, bp[D] = {};
+    for (int i = 0; i < count; ++i) {
+        float b = weights[i], a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < D; ++c) {
+            ap[c] += a * points[i][c];
+            bp[c] += b * points[i][c];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+    float inverse = 1.0f / determinant;
+    for (int c = 0; c < D; ++c) {
+        low[c] = std::clamp((bb * ap[c] - ab * bp[c]) * inverse, 0.0f, 255.0f);
+        high[c] = std::clamp((aa * bp[c] - ab * ap[c]) * inverse, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+uint16_t PackColor565(const float (&rgb)[3]) {
+    int r = static_cast<int>(rgb[0] * 31.0f / 255.0f + 0.5f);
+    int g = static_cast<int>(rgb[1] * 63.0f / 255.0f + 0.5f);
+    int b = static_cast<int>(rgb[2] * 31.0f / 255.0f + 0.5f);
+    return static_cast<uint16_t>((std::clamp(r, 0, 31) << 11) | (std::clamp(g, 0, 63) << 5) | std::clamp(b, 0, 31));
+}
+
+void UnpackColor565(uint16_t color, int (&rgb)[3]) {
+    int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Palette exactly as the decoder builds it. Entry 3 is transparent black in three-color mode.
+void BuildColorPalette(uint16_t c0, uint16_t c1, bool forceFourColor, int (&palette)[4][4]) {
+    int a[3], b[3];
+    UnpackColor565(c0, a);
+    UnpackColor565(c1, b);
+    bool fourColor = forceFourColor || c0 > c1;
+    for (int c = 0; c < 3; ++c) {
+        palette[0][c] = a[c];
+        palette[1][c] = b[c];
+        palette[2][c] = fourColor ? (2 * a[c] + b[c]) / 3 : (a[c] + b[c]) / 2;
+        palette[3][c] = fourColor ? (a[c] + 2 * b[c]) / 3 : 0;
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = fourColor ? 255 : 0;
+}
+
+// Picks the indices for fixed endpoints; returns the squared RGB error of the opaque pixels
+int SelectColorIndices(const float (*points)[3], const bool* transparent, uint16_t c0, uint16_t c1, bool forceFourColor, uint32_t& outIndices) {
+    int palette[4][4];
+    BuildColorPalette(c0, c1, forceFourColor, palette);
+    bool threeColor = !forceFourColor && c0 <= c1;
+    int totalError = 0;
+    outIndices = 0;
+    for (int i = 0; i < 16; ++i) {
+        uint32_t best = 3;
+        if (!transparent[i]) {
+            int bestError = INT_MAX;
+            for (uint32_t k = 0; k < (threeColor ? 3u : 4u); ++k) {
+                int error = 0;
+                for (int c = 0; c < 3; ++c) {
+                    int d = static_cast<int>(points[i][c]) - palette[k][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = k;
+                }
+            }
+            totalError += bestError;
+        }
+        outIndices |= best << (i * 2);
+    }
+    return totalError;
+}
+
+// BC1 color part (also the color half of BC2/BC3 blocks with allowTransparent = false)
+void EncodeColorBlock(const uint8_t* rgba, uint8_t* outBlock, bool allowTransparent, bool forceFourColor) {
+    float points[16][3];
+    bool transparent[16];
+    float opaquePoints[16][3];
+    int opaqueCount = 0;
+    bool anyTransparent = false;
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) points[i][c] = rgba[i * 4 + c];
+        transparent[i] = allowTransparent && rgba[i * 4 + 3] < 128;
+        anyTransparent |= transparent[i];
+        if (!transparent[i]) {
+            memcpy(opaquePoints[opaqueCount++], points[i], sizeof(points[i]));
+        }
+    }
+
+    uint16_t c0 = 0, c1 = 0;
+    uint32_t indices = 0xFFFFFFFFu; // All transparent
+    if (opaqueCount > 0) {
+        float low[3], high[3];
+        FitEndpoints<3>(opaquePoints, opaqueCount, low, high);
+
+        // Three-color mode (needed for transparency) wants c0 <= c1, four-color mode c0 > c1
+        auto order = [anyTransparent](uint16_t& a, uint16_t& b) {
+            if (anyTransparent ? a > b : a < b) std::swap(a, b);
+        };
+        uint16_t bestC0 = PackColor565(high), bestC1 = PackColor565(low);
+        order(bestC0, bestC1);
+        int bestError = SelectColorIndices(points, transparent, bestC0, bestC1, forceFourColor, indices);
+
+        // One least squares refinement of the endpoints for the chosen indices
+        if (bestError > 0) {
+            float weights[16];
+            float solvePoints[16][3];
+            int solveCount = 0;
+            bool threeColor = !forceFourColor && bestC0 <= bestC1;
+            for (int i = 0; i < 16; ++i) {
+                if (transparent[i]) continue;
+                uint32_t index = (indices >> (i * 2)) & 3;
+                // Weight of c1 for each palette entry
+                static const float fourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+                static const float threeColorWeights[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+                weights[solveCount] = threeColor ? threeColorWeights[index] : fourColorWeights[index];
+                memcpy(solvePoints[solveCount++], points[i], sizeof(points[i]));
+            }
+            float e0[3], e1[3];
+            if (SolveEndpoints<3>(solvePoints, weights, solveCount, e0, e1)) {
+                uint16_t refinedC0 = PackColor565(e0), refinedC1 = PackColor565(e1);
+                order(refinedC0, refinedC1);
+                uint32_t refinedIndices = 0;
+                int refinedError = SelectColorIndices(points, transparent, refinedC0, refinedC1, forceFourColor, refinedIndices);
+                if (refinedError < bestError) {
+                    bestC0 = refinedC0;
+                    bestC1 = refinedC1;
+                    indices = refinedIndices;
+                }
+            }
+        }
+        c0 = bestC0;
+        c1 = bestC1;
+    }
+
+    outBlock[0] = static_cast<uint8_t>(c0);
+    outBlock[1] = static_cast<uint8_t>(c0 >> 8);
+    outBlock[2] = static_cast<uint8_t>(c1);
+    outBlock[3] = static_cast<uint8_t>(c1 >> 8);
+    memcpy(outBlock + 4, &indices, 4);
+}
+
+void DecodeColorBlock(const uint8_t* block, bool forceFourColor, uint8_t* outRgba) {
+    uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    uint32_t indices = 0;
+    memcpy(&indices, block + 4, 4);
+    int palette[4][4];
+    BuildColorPalette(c0, c1, forceFourColor, palette);
+    for (int i = 0; i < 16; ++i) {
+        const int* color = palette[(indices >> (i * 2)) & 3];
+        for (int c = 0; c < 4; ++c) outRgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+    }
+}
+
+void BuildAlphaPalette(int a0, int a1, int (&palette)[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    } else {
+        for (int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+void EncodeAlphaBlock(const uint8_t* rgba, uint8_t* outBlock) {
+    int minAlpha = 255, maxAlpha = 0;
+    for (int i = 0; i < 16; ++i) {
+        minAlpha = std::min<int>(minAlpha, rgba[i * 4 + 3]);
+        maxAlpha = std::max<int>(maxAlpha, rgba[i * 4 + 3]);
+    }
+    // Eight interpolated levels between the extremes (a0 > a1); equal extremes use index 0 only
+    int palette[8];
+    BuildAlphaPalette(maxAlpha, minAlpha, palette);
+    uint64_t indices = 0;
+    for (int i = 0; i < 16 && maxAlpha != minAlpha; ++i) {
+        int alpha = rgba[i * 4 + 3];
+        uint64_t best = 0;
+        int bestError = INT_MAX;
+        for (int k = 0; k < 8; ++k) {
+            int error = std::abs(alpha - palette[k]);
+            if (error < bestError) {
+                bestError = error;
+                best = static_cast<uint64_t>(k);
+            }
+        }
+        indices |= best << (i * 3);
+    }
+    outBlock[0] = static_cast<uint8_t>(maxAlpha);
+    outBlock[1] = static_cast<uint8_t>(minAlpha);
+    for (int b = 0; b < 6; ++b) outBlock[2 + b] = static_cast<uint8_t>(indices >> (b * 8));
+}
+
+void DecodeAlphaBlock(const uint8_t* block, uint8_t* outRgba) {
+    int palette[8];
+    BuildAlphaPalette(block[0], block[1], palette);
+    uint64_t indices = 0;
+    for (int b = 0; b < 6; ++b) indices |= static_cast<uint64_t>(block[2 + b]) << (b * 8);
+    for (int i = 0; i < 16; ++i) {
+        outRgba[i * 4 + 3] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* out) : m_out(out) { memset(m_out, 0, 16); }
+    void Write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; ++i, ++m_position) {
+            m_out[m_position >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (m_position & 7));
+        }
+    }
+private:
+    uint8_t* m_out;
+    int m_position = 0;
+};
+
+class BitReader {
+public:
+    explicit BitReader(const uint8_t* data) : m_data(data) {}
+    uint32_t Read(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; ++i, ++m_position) {
+            value |= static_cast<uint32_t>((m_data[m_position >> 3] >> (m_position & 7)) & 1) << i;
+        }
+        return value;
+    }
+private:
+    const uint8_t* m_data;
+    int m_position = 0;
+};
+
+// BC7 decoding (all eight modes) follows the BPTC format description in the D3D11 functional spec
+struct Bc7Mode {
+    int SubsetCount;
+    int PartitionBits;
+    int RotationBits;
+    int IndexSelectionBits;
+    int ColorBits;
+    int AlphaBits;
+    int EndpointPBits; // One p-bit per endpoint
+    int SharedPBits;   // One p-bit per subset
+    int IndexBits;
+    int SecondaryIndexBits;
+};
+
+constexpr Bc7Mode BC7_MODES[8] = {
+    { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+    { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+    { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+    { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+    { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+    { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+    { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+    { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+constexpr int BC7_WEIGHTS_2[4] = { 0, 21, 43, 64 };
+constexpr int BC7_WEIGHTS_3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+
+// Two subsets: bit i set = pixel i is in subset 1
+constexpr uint16_t BC7_PARTITIONS_2[64] = {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+// Three subsets: 2 bits per pixel, pixel i at bits 2i
+constexpr uint32_t BC7_PARTITIONS_3[64] = {
+    0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+    0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+    0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+    0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+    0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+    0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+    0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+    0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+};
+
+// Anchor pixels of subsets 1 and 2 (subset 0 always anchors at pixel 0); their index drops the top bit
+constexpr uint8_t BC7_ANCHORS_2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+};
+constexpr uint8_t BC7_ANCHORS_3A[64] = {
+     3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+     3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+     8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+     3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+};
+constexpr uint8_t BC7_ANCHORS_3B[64] = {
+    15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+    15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+    15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+    15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+};
+
+int Bc7Subset(int subsetCount, int partition, int pixel) {
+    if (subsetCount == 2) return (BC7_PARTITIONS_2[partition] >> pixel) & 1;
+    if (subsetCount == 3) return (BC7_PARTITIONS_3[partition] >> (pixel * 2)) & 3;
+    return 0;
+}
+
+bool IsBc7Anchor(int subsetCount, int partition, int pixel) {
+    if (pixel == 0) return true;
+    if (subsetCount == 2) return pixel == BC7_ANCHORS_2[partition];
+    if (subsetCount == 3) return pixel == BC7_ANCHORS_3A[partition] || pixel == BC7_ANCHORS_3B[partition];
+    return false;
+}
+
+int Bc7Weight(int indexBits, uint32_t index) {
+    return indexBits == 2 ? BC7_WEIGHTS_2[index] : indexBits == 3 ? BC7_WEIGHTS_3[index] : BC7_WEIGHTS[index];
+}
+
+// False for the reserved mode (no mode bit in the first byte), which decodes to transparent black
+bool DecodeBc7Block(const uint8_t* block, uint8_t* outRgba) {
+    int modeIndex = 0;
+    while (modeIndex < 8 && !(block[0] & (1 << modeIndex))) ++modeIndex;
+    if (modeIndex == 8) {
+        memset(outRgba, 0, 64);
+        return false;
+    }
+    const Bc7Mode& mode = BC7_MODES[modeIndex];
+    BitReader reader(block);
+    reader.Read(modeIndex + 1);
+    int partition = static_cast<int>(reader.Read(mode.PartitionBits));
+    int rotation = static_cast<int>(reader.Read(mode.RotationBits));
+    int indexSelection = static_cast<int>(reader.Read(mode.IndexSelectionBits));
+
+    // [subset * 2 + endpoint][channel], RGBA
+    int endpoints[6][4] = {};
+    const int endpointCount = mode.SubsetCount * 2;
+    for (int c = 0; c < 3; ++c) {
+        for (int e = 0; e < endpointCount; ++e) endpoints[e][c] = static_cast<int>(reader.Read(mode.ColorBits));
+    }
+    for (int e = 0; e < endpointCount; ++e) endpoints[e][3] = static_cast<int>(reader.Read(mode.AlphaBits));
+
+    int colorBits = mode.ColorBits, alphaBits = mode.AlphaBits;
+    if (mode.EndpointPBits || mode.SharedPBits) {
+        int pBits[6];
+        for (int e = 0; e < endpointCount; ++e) {
+            pBits[e] = (mode.SharedPBits && (e & 1)) ? pBits[e - 1] : static_cast<int>(reader.Read(1));
+        }
+        for (int e = 0; e < endpointCount; ++e) {
+            for (int c = 0; c < 4; ++c) endpoints[e][c] = (endpoints[e][c] << 1) | pBits[e];
+        }
+        ++colorBits;
+        if (alphaBits) ++alphaBits;
+    }
+    // Expand to 8 bits by replicating the top bits into the bottom ones
+    for (int e = 0; e < endpointCount; ++e) {
+        for (int c = 0; c < 4; ++c) {
+            int bits = c < 3 ? colorBits : alphaBits;
+            endpoints[e][c] = bits == 0 ? 255 : ((endpoints[e][c] << (8 - bits)) | (endpoints[e][c] >> (2 * bits - 8)));
+        }
+    }
+
+    uint32_t indices[16], secondaryIndices[16] = {};
+    for (int i = 0; i < 16; ++i) {
+        indices[i] = reader.Read(mode.IndexBits - (IsBc7Anchor(mode.SubsetCount, partition, i) ? 1 : 0));
+    }
+    if (mode.SecondaryIndexBits) {
+        for (int i = 0; i < 16; ++i) secondaryIndices[i] = reader.Read(mode.SecondaryIndexBits - (i == 0 ? 1 : 0));
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        const int* e0 = endpoints[Bc7Subset(mode.SubsetCount, partition, i) * 2];
+        const int* e1 = e0 + 4;
+        int colorWeight = Bc7Weight(mode.IndexBits, indices[i]);
+        int alphaWeight = colorWeight;
+        if (mode.SecondaryIndexBits) {
+            // Mode 4 with the selection bit set takes color from the 3-bit indices, alpha from the 2-bit ones
+            int secondaryWeight = Bc7Weight(mode.SecondaryIndexBits, secondaryIndices[i]);
+            if (indexSelection) {
+                alphaWeight = colorWeight;
+                colorWeight = secondaryWeight;
+            } else {
+                alphaWeight = secondaryWeight;
+            }
+        }
+        uint8_t* pixel = outRgba + i * 4;
+        for (int c = 0; c < 4; ++c) {
+            int weight = c < 3 ? colorWeight : alphaWeight;
+            pixel[c] = static_cast<uint8_t>(((64 - weight) * e0[c] + weight * e1[c] + 32) >> 6);
+        }
+        if (rotation) {
+            std::swap(pixel[3], pixel[rotation - 1]); // Modes 4 and 5 store one color channel in alpha
+        }
+    }
+    return true;
+}
+
+// Mode 6 endpoint: 7 bits per channel plus a shared p-bit (the 8-bit LSB)
+struct Bc7Endpoint {
+    int Quantized[4];
+    int PBit;
+    int Value(int channel) const { return (Quantized[channel] << 1) | PBit; }
+};
+
+Bc7Endpoint QuantizeBc7Endpoint(const float (&color)[4]) {
+    Bc7Endpoint best = {};
+    float bestError = FLT_MAX;
+    for (int p = 0; p < 2; ++p) {
+        Bc7Endpoint candidate = {};
+        candidate.PBit = p;
+        float error = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            candidate.Quantized[c] = std::clamp(static_cast<int>((color[c] - p) * 0.5f + 0.5f), 0, 127);
+            float d = candidate.Value(c) - color[c];
+            error += d * d;
+        }
+        if (error < bestError) {
+            bestError = error;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+int SelectBc7Indices(const float (*points)[4], const Bc7Endpoint& e0, const Bc7Endpoint& e1, uint8_t (&outIndices)[16]) {
+    int palette[16][4];
+    for (int k = 0; k < 16; ++k) {
+        for (int c = 0; c < 4; ++c) {
+            palette[k][c] = ((64 - BC7_WEIGHTS[k]) * e0.Value(c) + BC7_WEIGHTS[k] * e1.Value(c) + 32) >> 6;
+        }
+    }
+    int totalError = 0;
+    for (int i = 0; i < 16; ++i) {
+        int bestError = INT_MAX;
+        for (int k = 0; k < 16; ++k) {
+            int error = 0;
+            for (int c = 0; c < 4; ++c) {
+                int d = static_cast<int>(points[i][c]) - palette[k][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                outIndices[i] = static_cast<uint8_t>(k);
+            }
+        }
+        totalError += bestError;
+    }
+    return totalError;
+}
+
+double Megapixels(const std::vector<Rgba8Image>& mips) {
+    double pixels = 0.0;
+    for (const Rgba8Image& mip : mips) pixels += static_cast<double>(mip.Width) * mip.Height;
+    return pixels / 1.0e6;
+}
+
+} // namespace
+
+TextureCooker::TextureCooker() {}
+
+TextureCooker::TextureCooker(const TextureCookSettings& settings) : m_settings(settings) {}
+
+void TextureCooker::EncodeBlockBC1(const uint8_t* rgba, uint8_t* outBlock, bool allowTransparent) {
+    EncodeColorBlock(rgba, outBlock, allowTransparent, false);
+}
+
+void TextureCooker::EncodeBlockBC3(const uint8_t* rgba, uint8_t* outBlock) {
+    EncodeAlphaBlock(rgba, outBlock);
+    EncodeColorBlock(rgba, outBlock + 8, false, true);
+}
+
+void TextureCooker::EncodeBlockBC7(const uint8_t* rgba, uint8_t* outBlock) {
+    float points[16][4];
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) points[i][c] = rgba[i * 4 + c];
+    }
+
+    float low[4], high[4];
+    FitEndpoints<4>(points, 16, low, high);
+    Bc7Endpoint e0 = QuantizeBc7Endpoint(low), e1 = QuantizeBc7Endpoint(high);
+    uint8_t indices[16];
+    int bestError = SelectBc7Indices(points, e0, e1, indices);
+
+    // Least squares refinement for the chosen indices, kept only when it helps
+    for (int iteration = 0; iteration < 2 && bestError > 0; ++iteration) {
+        float weights[16];
+        for (int i = 0; i < 16; ++i) weights[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+        float refinedLow[4], refinedHigh[4];
+        if (!SolveEndpoints<4>(points, weights, 16, refinedLow, refinedHigh)) break;
+        Bc7Endpoint r0 = QuantizeBc7Endpoint(refinedLow), r1 = QuantizeBc7Endpoint(refinedHigh);
+        uint8_t refinedIndices[16];
+        int refinedError = SelectBc7Indices(points, r0, r1, refinedIndices);
+        if (refinedError >= bestError) break;
+        bestError = refinedError;
+        e0 = r0;
+        e1 = r1;
+        memcpy(indices, refinedIndices, sizeof(indices));
+    }
+
+    // The anchor (first) index is stored without its top bit
+    if (indices[0] & 8) {
+        std::swap(e0, e1);
+        for (uint8_t& index : indices) index = static_cast<uint8_t>(15 - index);
+    }
+
+    BitWriter writer(outBlock);
+    writer.Write(1u << 6, 7); // Mode 6
+    for (int c = 0; c < 4; ++c) {
+        writer.Write(static_cast<uint32_t>(e0.Quantized[c]), 7);
+        writer.Write(static_cast<uint32_t>(e1.Quantized[c]), 7);
+    }
+    writer.Write(static_cast<uint32_t>(e0.PBit), 1);
+    writer.Write(static_cast<uint32_t>(e1.PBit), 1);
+    for (int i = 0; i < 16; ++i) {
+        writer.Write(indices[i], i == 0 ? 3 : 4);
+    }
+}
+
+bool TextureCooker::DecodeBlock(DXGI_FORMAT format, const uint8_t* block, uint8_t* outRgba) {
+    switch (TextureSerializer::ToLinearFormat(format)) {
+    case DXGI_FORMAT_BC1_UNORM:
+        DecodeColorBlock(block, false, outRgba);
+        return true;
+    case DXGI_FORMAT_BC2_UNORM:
+        DecodeColorBlock(block + 8, true, outRgba);
+        for (int i = 0; i < 16; ++i) {
+            int alpha = (block[i / 2] >> ((i & 1) * 4)) & 0xF;
+            outRgba[i * 4 + 3] = static_cast<uint8_t>(alpha * 17);
+        }
+        return true;
+    case DXGI_FORMAT_BC3_UNORM:
+        DecodeColorBlock(block + 8, true, outRgba);
+        DecodeAlphaBlock(block, outRgba);
+        return true;
+    case DXGI_FORMAT_BC7_UNORM:
+        return DecodeBc7Block(block, outRgba);
+    default:
+        return false;
+    }
+}
+
+bool TextureCooker::DecodeMip(const CookedTexture& texture, size_t mipIndex, std::vector<uint8_t>& outRgba) {
+    if (mipIndex >= texture.Mips.size()) return false;
+    const TextureMip& mip = texture.Mips[mipIndex];
+    const uint8_t* data = texture.Data.data() + mip.Offset;
+    outRgba.resize(static_cast<size_t>(mip.Width) * mip.Height * 4);
+
+    DXGI_FORMAT format = TextureSerializer::ToLinearFormat(texture.Format);
+    if (format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_B8G8R8A8_UNORM) {
+        for (uint32_t y = 0; y < mip.Height; ++y) {
+            memcpy(outRgba.data() + static_cast<size_t>(y) * mip.Width * 4, data + static_cast<size_t>(y) * mip.RowPitch, mip.Width * 4);
+        }
+        if (format == DXGI_FORMAT_B8G8R8A8_UNORM) {
+            for (size_t i = 0; i < outRgba.size(); i += 4) std::swap(outRgba[i], outRgba[i + 2]);
+        }
+        return true;
+    }
+    if (!TextureSerializer::IsBlockCompressed(format)) {
+        return false;
+    }
+
+    uint32_t bytesPerBlock = TextureSerializer::GetBytesPerBlock(format);
+    bool ok = true;
+    uint8_t block[64];
+    for (uint32_t by = 0; by < mip.RowCount; ++by) {
+        for (uint32_t bx = 0; bx < mip.RowPitch / bytesPerBlock; ++bx) {
+            ok &= DecodeBlock(format, data + static_cast<size_t>(by) * mip.RowPitch + static_cast<size_t>(bx) * bytesPerBlock, block);
+            for (uint32_t py = 0; py < 4 && by * 4 + py < mip.Height; ++py) {
+                uint32_t columns = std::min(4u, mip.Width - bx * 4);
+                memcpy(outRgba.data() + ((static_cast<size_t>(by) * 4 + py) * mip.Width + bx * 4) * 4, block + py * 16, columns * 4);
+            }
+        }
+    }
+    return ok;
+}
+
+double TextureCooker::ComputePsnr(const uint8_t* a, const uint8_t* b, size_t pixelCount) {
+    double squaredError = 0.0;
+    for (size_t i = 0; i < pixelCount * 4; ++i) {
+        double d = static_cast<double>(a[i]) - b[i];
+        squaredError += d * d;
+    }
+    if (squaredError == 0.0) {
+        return 99.0; // Identical, reported as a cap instead of infinity
+    }
+    double meanSquaredError = squaredError / (pixelCount * 4);
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+bool TextureCooker::DecodeSourceImage(const std::vector<uint8_t>& fileData, DecodedImage& outImage) {
+    // Cook jobs run on worker threads that never initialized COM
+    HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    bool ok = false;
+    {
+        Microsoft::WRL::ComPtr<IWICImagingFactory> wicFactory;
+        HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&wicFactory));
+        if (SUCCEEDED(hr)) {
+            ok = D2DRenderer::DecodeImage(wicFactory.Get(), fileData.data(), fileData.size(), outImage, false);
+        }
+    }
+    if (SUCCEEDED(hrCom)) {
+        CoUninitialize();
+    }
+    return ok;
+}
+
+bool TextureCooker::Cook(const DecodedImage& image, CookedTexture& outTexture, const std::string& textureName) {
+    if (image.Width == 0 || image.Height == 0 || image.Pixels.size() < static_cast<size_t>(image.Stride) * image.Height) {
+        LogMessage("Invalid source image: " + textureName);
+        return false;
+    }
+
+    bool opaque = true;
+    for (uint32_t y = 0; y < image.Height && opaque; ++y) {
+        const uint8_t* row = image.Pixels.data() + static_cast<size_t>(y) * image.Stride;
+        for (uint32_t x = 0; x < image.Width; ++x) {
+            if (row[x * 4 + 3] != 255) {
+                opaque = false;
+                break;
+            }
+        }
+    }
+    TextureFormat format = m_settings.Format;
+    if (opaque && m_settings.UseBC1WhenOpaque && format != TextureFormat::RGBA8) {
+        format = TextureFormat::BC1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<Rgba8Image> mips = BuildMipChain(image, m_settings, format != TextureFormat::RGBA8);
+    double mipSeconds = SecondsSince(start);
+
+    CookedTexture texture;
+    texture.Format = GetDxgiFormat(format, m_settings.SRGB);
+    texture.Width = mips.front().Width;
+    texture.Height = mips.front().Height;
+    texture.Premultiplied = m_settings.Premultiply;
+    start = std::chrono::high_resolution_clock::now();
+    EncodeMips(mips, format, texture);
+    double encodeSeconds = SecondsSince(start);
+
+    if (m_settings.PrintStats) {
+        std::vector<uint8_t> decoded;
+        DecodeMip(texture, 0, decoded);
+        double psnr = ComputePsnr(mips.front().Pixels.data(), decoded.data(), decoded.size() / 4);
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1);
+        ss << textureName << ": " << texture.Width << "x" << texture.Height << " " << GetFormatName(format) << ", "
+           << texture.Mips.size() << " mips, " << texture.Data.size() / 1024 << " KB; mips " << mipSeconds * 1000.0
+           << " ms, encode " << encodeSeconds * 1000.0 << " ms (" << Megapixels(mips) / std::max(encodeSeconds, 1e-9)
+           << " MP/s), PSNR " << psnr << " dB";
+        LogMessage(ss.str());
+    }
+
+    outTexture = std::move(texture);
+    return true;
+}
+
+bool TextureCooker::RunBenchmark(const std::wstring& directory) {
+    struct Source {
+        std::string Name;
+        DecodedImage Image;
+    };
+    std::vector<Source> sources;
+
+    // Synthetic images: smooth gradients, noise with soft alpha, hard edges
+    auto makeImage = [](uint32_t size, auto&& pixel) {
+        DecodedImage image;
+        image.Width = image.Height = size;
+        image.Stride = size * 4;
+        image.Pixels.resize(static_cast<size_t>(image.Stride) * size);
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                pixel(x, y, image.Pixels.data() + (static_cast<size_t>(y) * size + x) * 4); // BGRA
+            }
+        }
+        return image;
+    };
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> noise(-24, 24);
+    sources.push_back({ "synthetic_gradient_1024", makeImage(1024, [](uint32_t x, uint32_t y, uint8_t* p) {
+        p[0] = static_cast<uint8_t>(x / 4);
+        p[1] = static_cast<uint8_t>(y / 4);
+        p[2] = static_cast<uint8_t>(255 - (x + y) / 8);
+        p[3] = 255;
+    }) });
+    sources.push_back({ "synthetic_noise_alpha_512", makeImage(512, [&](uint32_t x, uint32_t y, uint8_t* p) {
+        float dx = x - 255.5f, dy = y - 255.5f;
+        float falloff = std::clamp(1.5f - std::sqrt(dx * dx + dy * dy) / 170.0f, 0.0f, 1.0f);
+        p[0] = static_cast<uint8_t>(std::clamp(128 + noise(random) + static_cast<int>(60 * std::sin(x * 0.05f)), 0, 255));
+        p[1] = static_cast<uint8_t>(std::clamp(100 + noise(random) + static_cast<int>(60 * std::cos(y * 0.07f)), 0, 255));
+        p[2] = static_cast<uint8_t>(std::clamp(160 + noise(random), 0, 255));
+        p[3] = static_cast<uint8_t>(falloff * 255.0f);
+    }) });
+    sources.push_back({ "synthetic_edges_512", makeImage(512, [](uint32_t x, uint32_t y, uint8_t* p) {
+        bool checker = ((x / 16) + (y / 16)) % 2 == 0;
+        bool stripe = (x + y) % 23 < 3;
+        p[0] = stripe ? 20 : (checker ? 230 : 40);
+        p[1] = stripe ? 200 : (checker ? 220 : 60);
+        p[2] = stripe ? 240 : (checker ? 40 : 200);
+        p[3] = 255;
+    }) });
+
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory, ec), endIt; !ec && it != endIt; it.increment(ec)) {
+        std::wstring extension = it->path().extension().wstring();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+        if (!it->is_regular_file(ec) || (extension != L".png" && extension != L".jpg" && extension != L".jpeg" &&
+                                          extension != L".bmp" && extension != L".tif" && extension != L".tiff")) {
+            continue;
+        }
+        std::vector<uint8_t> fileData;
+        Source source;
+        source.Name = it->path().filename().string();
+        if (!AssetCache::ReadFile(it->path().wstring(), fileData) || !DecodeSourceImage(fileData, source.Image)) {
+            std::cout << "Texture Cooker: Skipping " << source.Name << " (could not decode)" << std::endl;
+            continue;
+        }
+        sources.push_back(std::move(source));
+    }
+
+    std::ostringstream report;
+    report << std::fixed;
+    report << "Texture Cooker benchmark (sRGB, premultiplied; PSNR of mip 0 over RGBA)\n";
+    const TextureFormat formats[] = { TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC7 };
+    for (const Source& source : sources) {
+        TextureCookSettings settings;
+        settings.Filter = MipFilter::Box;
+        auto start = std::chrono::high_resolution_clock::now();
+        BuildMipChain(source.Image, settings, true);
+        double boxSeconds = SecondsSince(start);
+
+        settings.Filter = MipFilter::Kaiser;
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<Rgba8Image> mips = BuildMipChain(source.Image, settings, true);
+        double kaiserSeconds = SecondsSince(start);
+
+        report << "  " << source.Name << " " << source.Image.Width << "x" << source.Image.Height << ", " << mips.size()
+               << " mips: box " << std::setprecision(1) << boxSeconds * 1000.0 << " ms, kaiser " << kaiserSeconds * 1000.0 << " ms\n";
+        for (TextureFormat format : formats) {
+            CookedTexture texture;
+            texture.Format = GetDxgiFormat(format, true);
+            texture.Width = mips.front().Width;
+            texture.Height = mips.front().Height;
+            start = std::chrono::high_resolution_clock::now();
+            EncodeMips(mips, format, texture);
+            double encodeSeconds = SecondsSince(start);
+
+            std::vector<uint8_t> decoded;
+            DecodeMip(texture, 0, decoded);
+            double psnr = ComputePsnr(mips.front().Pixels.data(), decoded.data(), decoded.size() / 4);
+            report << "    " << std::left << std::setw(4) << GetFormatName(format) << std::right << std::setprecision(1)
+                   << std::setw(8) << encodeSeconds * 1000.0 << " ms " << std::setw(7) << Megapixels(mips) / std::max(encodeSeconds, 1e-9)
+                   << " MP/s " << std::setprecision(2) << std::setw(6) << psnr << " dB " << std::setw(7) << texture.Data.size() / 1024 << " KB\n";
+        }
+    }
+
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return !sources.empty();
+}
+
+void TextureCooker::LogMessage(const std::string& message) {
+    std::string line = "Texture Cooker: " + message + "\n";
+    std::cout << line;
+    OutputDebugStringA(line.c_str());
+}
@@ -0,0 +1,71 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "D2DRenderer.h"
+#include "TextureSerializer.h"
+#include <string>
+#include <vector>
+
+enum class TextureFormat {
+    RGBA8, // Uncompressed, 32 bpp
+    BC1,   // 4 bpp, RGB + 1-bit alpha
+    BC3,   // 8 bpp, RGB + interpolated alpha
+    BC7,   // 8 bpp, mode 6 (RGBA endpoints, 16 index levels). D3D only, D2D draws BC1-BC3.
+};
+
+enum class MipFilter {
+    Box,    // 2x2 average
+    Kaiser, // Kaiser windowed sinc, sharper mips
+};
+
+struct TextureCookSettings {
+    TextureFormat Format = TextureFormat::BC3; // For images with alpha
+    bool UseBC1WhenOpaque = true;               // Half the size of BC3/BC7 when every alpha is 255
+    bool GenerateMips = true;
+    MipFilter Filter = MipFilter::Kaiser;
+    bool SRGB = true;        // Color data: filter in linear light and store an _SRGB format
+    bool Premultiply = true; // D2D draws premultiplied alpha
+    bool PrintStats = true;
+};
+
+// Offline texture processing: gamma-correct mip generation and CPU BC1/BC3/BC7 encoding.
+// The result is written as DDS by TextureSerializer and uploaded without any runtime decoding.
+class TextureCooker {
+public:
+    TextureCooker();
+    explicit TextureCooker(const TextureCookSettings& settings);
+
+    // 'image' is 32bpp BGRA with straight alpha (D2DRenderer::DecodeImage with premultiplied = false).
+    // Block-compressed outputs get their top level resized to a multiple of 4 when needed.
+    bool Cook(const DecodedImage& image, CookedTexture& outTexture, const std::string& textureName);
+
+    // Decodes an image file (png, jpg, ...) with WIC to straight-alpha BGRA. Initializes COM on the calling thread.
+    static bool DecodeSourceImage(const std::vector<uint8_t>& fileData, DecodedImage& outImage);
+
+    // 4x4 blocks, 'rgba' is 16 pixels of RGBA8 in row order
+    static void EncodeBlockBC1(const uint8_t* rgba, uint8_t* outBlock, bool allowTransparent);
+    static void EncodeBlockBC3(const uint8_t* rgba, uint8_t* outBlock);
+    static void EncodeBlockBC7(const uint8_t* rgba, uint8_t* outBlock);
+    // BC1-BC3 and BC7 (all modes). False for other formats and for reserved BC7 blocks.
+    static bool DecodeBlock(DXGI_FORMAT format, const uint8_t* block, uint8_t* outRgba);
+
+    // One mip to RGBA8 (block-compressed or 8-bit formats)
+    static bool DecodeMip(const CookedTexture& texture, size_t mip, std::vector<uint8_t>& outRgba);
+    // Over all four channels of two RGBA8 images
+    static double ComputePsnr(const uint8_t* a, const uint8_t* b, size_t pixelCount);
+
+    // Encodes the images in 'directory' (plus synthetic ones, so it also runs without WIC) to each
+    // format and reports mip / encode throughput and PSNR per texture (WinMain "-texturebench [dir]")
+    static bool RunBenchmark(const std::wstring& directory);
+
+    const TextureCookSettings& GetSettings() const { return m_settings; }
+
+private:
+    TextureCookSettings m_settings;
+
+    void LogMessage(const std::string& message);
+};
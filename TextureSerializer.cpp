@@ -0,0 +1,270 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "TextureSerializer.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+}
+
+constexpr uint32_t DDS_MAGIC = MakeFourCC('D', 'D', 'S', ' ');
+
+// Layouts from the DDS file format documentation
+constexpr uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PITCH = 0x8;
+constexpr uint32_t DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+constexpr uint32_t DDPF_FOURCC = 0x4;
+constexpr uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+constexpr uint32_t DDS_ALPHA_MODE_STRAIGHT = 1, DDS_ALPHA_MODE_PREMULTIPLIED = 2;
+constexpr uint32_t MAX_MIP_COUNT = 16;
+
+struct DdsPixelFormat {
+    uint32_t Size;
+    uint32_t Flags;
+    uint32_t FourCC;
+    uint32_t RGBBitCount;
+    uint32_t RBitMask, GBitMask, BBitMask, ABitMask;
+};
+
+struct DdsHeader {
+    uint32_t Size;
+    uint32_t Flags;
+    uint32_t Height;
+    uint32_t Width;
+    uint32_t PitchOrLinearSize;
+    uint32_t Depth;
+    uint32_t MipMapCount;
+    uint32_t Reserved1[11];
+    DdsPixelFormat PixelFormat;
+    uint32_t Caps, Caps2, Caps3, Caps4;
+    uint32_t Reserved2;
+};
+
+struct DdsHeaderDx10 {
+    uint32_t DxgiFormat;
+    uint32_t ResourceDimension;
+    uint32_t MiscFlag;
+    uint32_t ArraySize;
+    uint32_t MiscFlags2; // Low 3 bits: alpha mode
+};
+
+static_assert(sizeof(DdsHeader) == 124, "DDS header layout");
+static_assert(sizeof(DdsHeaderDx10) == 20, "DDS DX10 header layout");
+
+void LogMessage(const std::string& message) {
+    std::string line = "Texture Serializer: " + message + "\n";
+    std::cerr << line;
+    OutputDebugStringA(line.c_str());
+}
+
+} // namespace
+
+bool TextureSerializer::IsBlockCompressed(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_BC1_UNORM: case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_UNORM: case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM: case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC7_UNORM: case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t TextureSerializer::GetBytesPerBlock(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_BC1_UNORM: case DXGI_FORMAT_BC1_UNORM_SRGB:
+        return 8;
+    case DXGI_FORMAT_BC2_UNORM: case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM: case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC7_UNORM: case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return 16;
+    case DXGI_FORMAT_R8G8B8A8_UNORM: case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM: case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        return 4;
+    default:
+        return 0; // Not supported
+    }
+}
+
+bool TextureSerializer::IsSRGB(DXGI_FORMAT format) {
+    return ToLinearFormat(format) != format;
+}
+
+DXGI_FORMAT TextureSerializer::ToLinearFormat(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_BC1_UNORM_SRGB: return DXGI_FORMAT_BC1_UNORM;
+    case DXGI_FORMAT_BC2_UNORM_SRGB: return DXGI_FORMAT_BC2_UNORM;
+    case DXGI_FORMAT_BC3_UNORM_SRGB: return DXGI_FORMAT_BC3_UNORM;
+    case DXGI_FORMAT_BC7_UNORM_SRGB: return DXGI_FORMAT_BC7_UNORM;
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: return DXGI_FORMAT_B8G8R8A8_UNORM;
+    default: return format;
+    }
+}
+
+size_t TextureSerializer::ComputeMipLayout(CookedTexture& texture, uint32_t mipCount) {
+    texture.Mips.clear();
+    uint32_t bytesPerBlock = GetBytesPerBlock(texture.Format);
+    bool compressed = IsBlockCompressed(texture.Format);
+    size_t offset = 0;
+    uint32_t width = texture.Width, height = texture.Height;
+    for (uint32_t level = 0; level < mipCount; ++level) {
+        TextureMip mip;
+        mip.Width = width;
+        mip.Height = height;
+        mip.RowPitch = compressed ? ((width + 3) / 4) * bytesPerBlock : width * bytesPerBlock;
+        mip.RowCount = compressed ? (height + 3) / 4 : height;
+        mip.Offset = offset;
+        mip.Size = static_cast<size_t>(mip.RowPitch) * mip.RowCount;
+        offset += mip.Size;
+        texture.Mips.push_back(mip);
+        if (width == 1 && height == 1) {
+            break;
+        }
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+    return offset;
+}
+
+bool TextureSerializer::Serialize(const CookedTexture& texture, std::vector<uint8_t>& outData) {
+    if (texture.Mips.empty() || GetBytesPerBlock(texture.Format) == 0) {
+        LogMessage("Nothing to serialize (no mips or unsupported format)");
+        return false;
+    }
+    const TextureMip& top = texture.Mips.front();
+
+    DdsHeader header = {};
+    header.Size = sizeof(DdsHeader);
+    header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT |
+                   (IsBlockCompressed(texture.Format) ? DDSD_LINEARSIZE : DDSD_PITCH);
+    header.Height = texture.Height;
+    header.Width = texture.Width;
+    header.PitchOrLinearSize = IsBlockCompressed(texture.Format) ? static_cast<uint32_t>(top.Size) : top.RowPitch;
+    header.MipMapCount = static_cast<uint32_t>(texture.Mips.size());
+    header.PixelFormat.Size = sizeof(DdsPixelFormat);
+    header.PixelFormat.Flags = DDPF_FOURCC;
+    header.PixelFormat.FourCC = MakeFourCC('D', 'X', '1', '0');
+    header.Caps = DDSCAPS_TEXTURE | (texture.Mips.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+    DdsHeaderDx10 dx10 = {};
+    dx10.DxgiFormat = static_cast<uint32_t>(texture.Format);
+    dx10.ResourceDimension = DDS_DIMENSION_TEXTURE2D;
+    dx10.ArraySize = 1;
+    dx10.MiscFlags2 = texture.Premultiplied ? DDS_ALPHA_MODE_PREMULTIPLIED : DDS_ALPHA_MODE_STRAIGHT;
+
+    outData.clear();
+    outData.reserve(sizeof(DDS_MAGIC) + sizeof(header) + sizeof(dx10) + texture.Data.size());
+    auto append = [&outData](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        outData.insert(outData.end(), bytes, bytes + size);
+    };
+    append(&DDS_MAGIC, sizeof(DDS_MAGIC));
+    append(&header, sizeof(header));
+    append(&dx10, sizeof(dx10));
+    append(texture.Data.data(), texture.Data.size());
+    return true;
+}
+
+bool TextureSerializer::Deserialize(const uint8_t* data, size_t size, CookedTexture& outTexture) {
+    uint32_t magic = 0;
+    DdsHeader header = {};
+    if (!data || size < sizeof(magic) + sizeof(header)) {
+        return false;
+    }
+    memcpy(&magic, data, sizeof(magic));
+    memcpy(&header, data + sizeof(magic), sizeof(header));
+    if (magic != DDS_MAGIC || header.Size != sizeof(DdsHeader) || header.PixelFormat.Size != sizeof(DdsPixelFormat)) {
+        return false;
+    }
+
+    size_t offset = sizeof(magic) + sizeof(header);
+    CookedTexture texture;
+    texture.Width = header.Width;
+    texture.Height = header.Height;
+    if ((header.PixelFormat.Flags & DDPF_FOURCC) == 0) {
+        LogMessage("Only FourCC / DX10 DDS files are supported");
+        return false;
+    }
+
+    uint32_t fourCC = header.PixelFormat.FourCC;
+    if (fourCC == MakeFourCC('D', 'X', '1', '0')) {
+        DdsHeaderDx10 dx10 = {};
+        if (size - offset < sizeof(dx10)) {
+            return false;
+        }
+        memcpy(&dx10, data + offset, sizeof(dx10));
+        offset += sizeof(dx10);
+        if (dx10.ResourceDimension != DDS_DIMENSION_TEXTURE2D || dx10.ArraySize != 1) {
+            LogMessage("Only single 2D textures are supported");
+            return false;
+        }
+        texture.Format = static_cast<DXGI_FORMAT>(dx10.DxgiFormat);
+        texture.Premultiplied = (dx10.MiscFlags2 & 0x7) == DDS_ALPHA_MODE_PREMULTIPLIED;
+    } else if (fourCC == MakeFourCC('D', 'X', 'T', '1')) {
+        texture.Format = DXGI_FORMAT_BC1_UNORM;
+    } else if (fourCC == MakeFourCC('D', 'X', 'T', '2') || fourCC == MakeFourCC('D', 'X', 'T', '3')) {
+        texture.Format = DXGI_FORMAT_BC2_UNORM;
+        texture.Premultiplied = fourCC == MakeFourCC('D', 'X', 'T', '2');
+    } else if (fourCC == MakeFourCC('D', 'X', 'T', '4') || fourCC == MakeFourCC('D', 'X', 'T', '5')) {
+        texture.Format = DXGI_FORMAT_BC3_UNORM;
+        texture.Premultiplied = fourCC == MakeFourCC('D', 'X', 'T', '4');
+    }
+
+    if (GetBytesPerBlock(texture.Format) == 0 || texture.Width == 0 || texture.Height == 0 ||
+        texture.Width > 16384 || texture.Height > 16384) {
+        LogMessage("Unsupported DDS format or size");
+        return false;
+    }
+
+    uint32_t mipCount = (header.Flags & DDSD_MIPMAPCOUNT) ? std::max(header.MipMapCount, 1u) : 1u;
+    size_t dataSize = ComputeMipLayout(texture, std::min(mipCount, MAX_MIP_COUNT));
+    if (size - offset < dataSize) {
+        LogMessage("DDS file is truncated");
+        return false;
+    }
+    texture.Data.assign(data + offset, data + offset + dataSize);
+    outTexture = std::move(texture);
+    return true;
+}
+
+bool TextureSerializer::CreateTexture(ID3D11Device* device, const CookedTexture& texture,
+                                      Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& outView) {
+    if (!device || texture.Mips.empty()) return false;
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = texture.Width;
+    desc.Height = texture.Height;
+    desc.MipLevels = static_cast<UINT>(texture.Mips.size());
+    desc.ArraySize = 1;
+    desc.Format = texture.Format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initialData(texture.Mips.size());
+    for (size_t i = 0; i < texture.Mips.size(); ++i) {
+        initialData[i].pSysMem = texture.Data.data() + texture.Mips[i].Offset;
+        initialData[i].SysMemPitch = texture.Mips[i].RowPitch;
+        initialData[i].SysMemSlicePitch = static_cast<UINT>(texture.Mips[i].Size);
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> d3dTexture;
+    HRESULT hr = device->CreateTexture2D(&desc, initialData.data(), &d3dTexture);
+    if (SUCCEEDED(hr)) {
+        hr = device->CreateShaderResourceView(d3dTexture.Get(), nullptr, &outView);
+    }
+    if (FAILED(hr)) {
+        OutputDebugString(L"Failed to create D3D11 texture from cooked texture.\n");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include <cstdint>
+#include <vector>
+
+struct TextureMip {
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t RowPitch = 0;  // Bytes per row of pixels, or per row of 4x4 blocks
+    uint32_t RowCount = 0;  // Rows of pixels or rows of blocks
+    size_t Offset = 0;      // Into CookedTexture::Data
+    size_t Size = 0;
+};
+
+// A 2D texture with its mip chain, as written by TextureCooker and stored in .dds files
+struct CookedTexture {
+    DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    bool Premultiplied = false;   // Color channels are multiplied by alpha
+    std::vector<TextureMip> Mips; // Largest first
+    std::vector<uint8_t> Data;
+};
+
+// Reads and writes cooked textures as DDS (DX10 extended header), and creates D3D11 textures
+// from them with every mip uploaded as is.
+class TextureSerializer {
+public:
+    static bool Serialize(const CookedTexture& texture, std::vector<uint8_t>& outData);
+    // Also reads legacy DXT1/DXT2/DXT4/DXT5 headers
+    static bool Deserialize(const uint8_t* data, size_t size, CookedTexture& outTexture);
+
+    // Fills Mips (offsets, pitches) for Format/Width/Height and the given mip count; returns the total size
+    static size_t ComputeMipLayout(CookedTexture& texture, uint32_t mipCount);
+
+    static bool IsBlockCompressed(DXGI_FORMAT format);
+    static uint32_t GetBytesPerBlock(DXGI_FORMAT format); // 4x4 block, or 1 pixel for uncompressed formats
+    static bool IsSRGB(DXGI_FORMAT format);
+    static DXGI_FORMAT ToLinearFormat(DXGI_FORMAT format); // _SRGB -> _UNORM, others unchanged
+
+    // Immutable texture and shader resource view with the full mip chain
+    static bool CreateTexture(ID3D11Device* device, const CookedTexture& texture,
+                              Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& outView);
+};
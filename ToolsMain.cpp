@@ -0,0 +1,28 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+// Console entry point for the headless tools (CI, Linux, no window): "AgronaTools -mixbench 512".
+// Not part of the game executable. Builds with the tools' sources and no Windows headers (DirectXMath, used
+// by the Collada parser, is header only and builds with GCC and Clang), e.g.
+//   g++ -std=c++17 -O2 -pthread -I<DirectXMath> ToolsMain.cpp HeadlessTools.cpp CommandLine.cpp SoftwareMixer.cpp \
+//       CpuFeatures.cpp StringId.cpp ColladaBenchmark.cpp ColladaParser.cpp ModelArena.cpp ContentHash.cpp
+
+#include "HeadlessTools.h"
+#include <filesystem>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    CommandLineArguments arguments;
+    for (int i = 1; i < argc; ++i) {
+        arguments.push_back(std::filesystem::path(argv[i]).wstring());
+    }
+
+    int exitCode = 0;
+    if (RunCommandLineTool(HEADLESS_TOOLS, HEADLESS_TOOL_COUNT, arguments, exitCode)) {
+        return exitCode;
+    }
+    std::cout << "Usage: " << (argc > 0 ? std::filesystem::path(argv[0]).filename().string() : "AgronaTools") << " <tool> [arguments]\n";
+    PrintCommandLineTools(HEADLESS_TOOLS, HEADLESS_TOOL_COUNT);
+    return 2;
+}
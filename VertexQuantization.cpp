@@ -0,0 +1,308 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "VertexQuantization.h"
+#include "ModelBounds.h"
+#include <cmath>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace {
+
+inline float SignNotZero(float v) { return (v >= 0.0f) ? 1.0f : -1.0f; }
+
+inline int16_t ToSNorm16(float v) {
+    v = std::max(-1.0f, std::min(1.0f, v));
+    return static_cast<int16_t>(lroundf(v * 32767.0f));
+}
+
+inline uint16_t ToUNorm16(float v) {
+    v = std::max(0.0f, std::min(1.0f, v));
+    return static_cast<uint16_t>(lroundf(v * 65535.0f));
+}
+
+// Quantizes weights to 8 bits so the stored values always sum to exactly 255
+void QuantizeBoneWeights(const XMFLOAT4& weights, uint8_t outWeights[4]) {
+    float w[4] = { std::max(weights.x, 0.0f), std::max(weights.y, 0.0f), std::max(weights.z, 0.0f), std::max(weights.w, 0.0f) };
+    float sum = w[0] + w[1] + w[2] + w[3];
+    if (sum <= 0.0f) {
+        outWeights[0] = outWeights[1] = outWeights[2] = outWeights[3] = 0;
+        return;
+    }
+
+    int total = 0;
+    float remainders[4];
+    for (int i = 0; i < 4; ++i) {
+        float scaled = w[i] / sum * 255.0f;
+        int q = static_cast<int>(scaled);
+        outWeights[i] = static_cast<uint8_t>(q);
+        remainders[i] = scaled - static_cast<float>(q);
+        total += q;
+    }
+    // Hand out the rounding remainder to the weights that lost the most
+    while (total < 255) {
+        int best = static_cast<int>(std::max_element(remainders, remainders + 4) - remainders);
+        outWeights[best]++;
+        remainders[best] = -1.0f;
+        total++;
+    }
+}
+
+} // namespace
+
+
+UINT VertexQuantization::GetVertexStride(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::StaticHalf:
+    case VertexFormat::StaticUNorm16:
+        return sizeof(PackedStaticVertex);
+    case VertexFormat::SkinnedHalf:
+    case VertexFormat::SkinnedUNorm16:
+        return sizeof(PackedSkinnedVertex);
+    case VertexFormat::Full:
+    default:
+        return sizeof(Vertex);
+    }
+}
+
+bool VertexQuantization::IsSkinned(VertexFormat format) {
+    return format == VertexFormat::SkinnedHalf || format == VertexFormat::SkinnedUNorm16;
+}
+
+bool VertexQuantization::HasSkinningData(const Mesh& mesh) {
+    for (const Vertex& v : mesh.Vertices) {
+        if (v.BoneWeights.x != 0.0f || v.BoneWeights.y != 0.0f || v.BoneWeights.z != 0.0f || v.BoneWeights.w != 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void VertexQuantization::EncodeOctahedral(const XMFLOAT3& normal, int16_t outEncoded[2]) {
+    float l1 = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+    if (l1 <= 0.0f) {
+        outEncoded[0] = 0;
+        outEncoded[1] = 0;
+        return;
+    }
+    float x = normal.x / l1;
+    float y = normal.y / l1;
+    if (normal.z < 0.0f) {
+        // Fold the lower hemisphere over the diagonals
+        float foldedX = (1.0f - fabsf(y)) * SignNotZero(x);
+        float foldedY = (1.0f - fabsf(x)) * SignNotZero(y);
+        x = foldedX;
+        y = foldedY;
+    }
+    outEncoded[0] = ToSNorm16(x);
+    outEncoded[1] = ToSNorm16(y);
+}
+
+XMFLOAT3 VertexQuantization::DecodeOctahedral(const int16_t encoded[2]) {
+    // SNorm16 decode matches the GPU: max(v / 32767, -1)
+    float x = std::max(static_cast<float>(encoded[0]) / 32767.0f, -1.0f);
+    float y = std::max(static_cast<float>(encoded[1]) / 32767.0f, -1.0f);
+    float z = 1.0f - fabsf(x) - fabsf(y);
+    if (z < 0.0f) {
+        float unfoldedX = (1.0f - fabsf(y)) * SignNotZero(x);
+        float unfoldedY = (1.0f - fabsf(x)) * SignNotZero(y);
+        x = unfoldedX;
+        y = unfoldedY;
+    }
+    XMFLOAT3 result;
+    XMStoreFloat3(&result, XMVector3Normalize(XMVectorSet(x, y, z, 0.0f)));
+    return result;
+}
+
+VertexQuantizationReport VertexQuantization::PackMesh(Mesh& mesh, PositionQuantization quantization) {
+    VertexQuantizationReport report;
+    report.SourceBytes = mesh.Vertices.size() * sizeof(Vertex);
+
+    auto keepFull = [&mesh, &report](const std::string& error) {
+        mesh.PackedFormat = VertexFormat::Full;
+        mesh.PackedVertices.clear();
+        mesh.VertexStride = sizeof(Vertex);
+        mesh.PositionScale = { 1.0f, 1.0f, 1.0f };
+        mesh.PositionOffset = { 0.0f, 0.0f, 0.0f };
+        report.Format = VertexFormat::Full;
+        report.PackedBytes = report.SourceBytes;
+        report.Error = error;
+        return report;
+    };
+
+    if (quantization == PositionQuantization::None || mesh.Vertices.empty()) {
+        return keepFull("");
+    }
+
+    const bool skinned = HasSkinningData(mesh);
+    if (skinned) {
+        for (const Vertex& v : mesh.Vertices) {
+            if (v.BoneIndices.x > 255 || v.BoneIndices.y > 255 || v.BoneIndices.z > 255 || v.BoneIndices.w > 255) {
+                return keepFull("Bone index exceeds 255, cannot use 8-bit bone indices.");
+            }
+        }
+    }
+
+    // Mesh bounds
+    XMFLOAT3 boundsMin, boundsMax;
+    ModelBounds::ComputeAABB(mesh.Vertices, boundsMin, boundsMax);
+    XMVECTOR vMin = XMLoadFloat3(&boundsMin);
+    XMVECTOR vMax = XMLoadFloat3(&boundsMax);
+
+    XMFLOAT3 scale, offset;
+    if (quantization == PositionQuantization::Half) {
+        // Halves keep full relative precision around the origin, so center the mesh
+        XMStoreFloat3(&offset, XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f));
+        scale = { 1.0f, 1.0f, 1.0f };
+        XMFLOAT3 halfExtent;
+        XMStoreFloat3(&halfExtent, XMVectorScale(XMVectorSubtract(vMax, vMin), 0.5f));
+        if (std::max(halfExtent.x, std::max(halfExtent.y, halfExtent.z)) > 65504.0f) {
+            return keepFull("Mesh extent exceeds half-float range.");
+        }
+    } else {
+        offset = boundsMin;
+        scale = { boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y, boundsMax.z - boundsMin.z };
+        // Flat axes decode to the offset; avoid dividing by zero
+        if (scale.x <= 0.0f) scale.x = 1.0f;
+        if (scale.y <= 0.0f) scale.y = 1.0f;
+        if (scale.z <= 0.0f) scale.z = 1.0f;
+    }
+
+    if (quantization == PositionQuantization::Half) {
+        mesh.PackedFormat = skinned ? VertexFormat::SkinnedHalf : VertexFormat::StaticHalf;
+    } else {
+        mesh.PackedFormat = skinned ? VertexFormat::SkinnedUNorm16 : VertexFormat::StaticUNorm16;
+    }
+    mesh.PositionScale = scale;
+    mesh.PositionOffset = offset;
+    mesh.VertexStride = GetVertexStride(mesh.PackedFormat);
+    mesh.PackedVertices.assign(mesh.Vertices.size() * mesh.VertexStride, 0);
+
+    for (size_t i = 0; i < mesh.Vertices.size(); ++i) {
+        const Vertex& src = mesh.Vertices[i];
+        PackedStaticVertex packed = {};
+
+        if (quantization == PositionQuantization::Half) {
+            packed.Position[0] = XMConvertFloatToHalf(src.Position.x - offset.x);
+            packed.Position[1] = XMConvertFloatToHalf(src.Position.y - offset.y);
+            packed.Position[2] = XMConvertFloatToHalf(src.Position.z - offset.z);
+            packed.Position[3] = XMConvertFloatToHalf(1.0f);
+        } else {
+            packed.Position[0] = ToUNorm16((src.Position.x - offset.x) / scale.x);
+            packed.Position[1] = ToUNorm16((src.Position.y - offset.y) / scale.y);
+            packed.Position[2] = ToUNorm16((src.Position.z - offset.z) / scale.z);
+            packed.Position[3] = 65535;
+        }
+        EncodeOctahedral(src.Normal, packed.Normal);
+        packed.TexCoord[0] = XMConvertFloatToHalf(src.TexCoord.x);
+        packed.TexCoord[1] = XMConvertFloatToHalf(src.TexCoord.y);
+
+        uint8_t* dst = &mesh.PackedVertices[i * mesh.VertexStride];
+        if (skinned) {
+            PackedSkinnedVertex skinnedVertex = {};
+            skinnedVertex.Base = packed;
+            skinnedVertex.BoneIndices[0] = static_cast<uint8_t>(src.BoneIndices.x);
+            skinnedVertex.BoneIndices[1] = static_cast<uint8_t>(src.BoneIndices.y);
+            skinnedVertex.BoneIndices[2] = static_cast<uint8_t>(src.BoneIndices.z);
+            skinnedVertex.BoneIndices[3] = static_cast<uint8_t>(src.BoneIndices.w);
+            QuantizeBoneWeights(src.BoneWeights, skinnedVertex.BoneWeights);
+            memcpy(dst, &skinnedVertex, sizeof(skinnedVertex));
+        } else {
+            memcpy(dst, &packed, sizeof(packed));
+        }
+    }
+
+    // Error report: decode everything back and compare against the source
+    report.Format = mesh.PackedFormat;
+    report.PackedBytes = mesh.PackedVertices.size();
+    for (size_t i = 0; i < mesh.Vertices.size(); ++i) {
+        const Vertex& src = mesh.Vertices[i];
+        Vertex decoded = DecodeVertex(mesh, i);
+
+        XMVECTOR posError = XMVectorAbs(XMVectorSubtract(XMLoadFloat3(&src.Position), XMLoadFloat3(&decoded.Position)));
+        XMFLOAT3 pe;
+        XMStoreFloat3(&pe, posError);
+        report.MaxPositionError = std::max(report.MaxPositionError, std::max(pe.x, std::max(pe.y, pe.z)));
+
+        XMVECTOR srcNormal = XMVector3Normalize(XMLoadFloat3(&src.Normal));
+        float cosAngle = XMVectorGetX(XMVector3Dot(srcNormal, XMLoadFloat3(&decoded.Normal)));
+        cosAngle = std::max(-1.0f, std::min(1.0f, cosAngle));
+        report.MaxNormalErrorDegrees = std::max(report.MaxNormalErrorDegrees, acosf(cosAngle) * 180.0f / XM_PI);
+
+        report.MaxTexCoordError = std::max(report.MaxTexCoordError,
+            std::max(fabsf(src.TexCoord.x - decoded.TexCoord.x), fabsf(src.TexCoord.y - decoded.TexCoord.y)));
+
+        if (skinned) {
+            float sum = src.BoneWeights.x + src.BoneWeights.y + src.BoneWeights.z + src.BoneWeights.w;
+            float inv = (sum > 0.0f) ? 1.0f / sum : 0.0f;
+            report.MaxBoneWeightError = std::max(report.MaxBoneWeightError, std::max(
+                std::max(fabsf(src.BoneWeights.x * inv - decoded.BoneWeights.x), fabsf(src.BoneWeights.y * inv - decoded.BoneWeights.y)),
+                std::max(fabsf(src.BoneWeights.z * inv - decoded.BoneWeights.z), fabsf(src.BoneWeights.w * inv - decoded.BoneWeights.w))));
+        }
+    }
+
+    return report;
+}
+
+Vertex VertexQuantization::DecodeVertex(const Mesh& mesh, size_t index) {
+    if (mesh.PackedFormat == VertexFormat::Full || mesh.PackedVertices.empty()) {
+        return mesh.Vertices[index];
+    }
+
+    const uint8_t* src = &mesh.PackedVertices[index * GetVertexStride(mesh.PackedFormat)];
+    PackedStaticVertex packed;
+    memcpy(&packed, src, sizeof(packed));
+
+    Vertex v;
+    const XMFLOAT3& scale = mesh.PositionScale;
+    const XMFLOAT3& offset = mesh.PositionOffset;
+    if (mesh.PackedFormat == VertexFormat::StaticHalf || mesh.PackedFormat == VertexFormat::SkinnedHalf) {
+        v.Position = { XMConvertHalfToFloat(packed.Position[0]) * scale.x + offset.x,
+                       XMConvertHalfToFloat(packed.Position[1]) * scale.y + offset.y,
+                       XMConvertHalfToFloat(packed.Position[2]) * scale.z + offset.z };
+    } else {
+        v.Position = { packed.Position[0] / 65535.0f * scale.x + offset.x,
+                       packed.Position[1] / 65535.0f * scale.y + offset.y,
+                       packed.Position[2] / 65535.0f * scale.z + offset.z };
+    }
+    v.Normal = DecodeOctahedral(packed.Normal);
+    v.TexCoord = { XMConvertHalfToFloat(packed.TexCoord[0]), XMConvertHalfToFloat(packed.TexCoord[1]) };
+
+    if (IsSkinned(mesh.PackedFormat)) {
+        PackedSkinnedVertex skinned;
+        memcpy(&skinned, src, sizeof(skinned));
+        v.BoneIndices = { skinned.BoneIndices[0], skinned.BoneIndices[1], skinned.BoneIndices[2], skinned.BoneIndices[3] };
+        v.BoneWeights = { skinned.BoneWeights[0] / 255.0f, skinned.BoneWeights[1] / 255.0f,
+                          skinned.BoneWeights[2] / 255.0f, skinned.BoneWeights[3] / 255.0f };
+    }
+    return v;
+}
+
+void VertexQuantization::GetInputLayout(VertexFormat format, std::vector<D3D11_INPUT_ELEMENT_DESC>& outLayout) {
+    outLayout.clear();
+    if (format == VertexFormat::Full) {
+        outLayout = {
+            { "POSITION",     0, DXGI_FORMAT_R32G32B32_FLOAT,    0, offsetof(Vertex, Position),    D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "NORMAL",       0, DXGI_FORMAT_R32G32B32_FLOAT,    0, offsetof(Vertex, Normal),      D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD",     0, DXGI_FORMAT_R32G32_FLOAT,       0, offsetof(Vertex, TexCoord),    D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "BLENDWEIGHT",  0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(Vertex, BoneWeights), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "BLENDINDICES", 0, DXGI_FORMAT_R32G32B32A32_UINT,  0, offsetof(Vertex, BoneIndices), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        };
+        return;
+    }
+
+    const bool halfPositions = (format == VertexFormat::StaticHalf || format == VertexFormat::SkinnedHalf);
+    outLayout = {
+        { "POSITION", 0, halfPositions ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R16G16B16A16_UNORM,
+                                                 0, offsetof(PackedStaticVertex, Position), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "NORMAL",   0, DXGI_FORMAT_R16G16_SNORM, 0, offsetof(PackedStaticVertex, Normal),   D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, offsetof(PackedStaticVertex, TexCoord), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    };
+    if (IsSkinned(format)) {
+        outLayout.push_back({ "BLENDINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT,  0, offsetof(PackedSkinnedVertex, BoneIndices), D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        outLayout.push_back({ "BLENDWEIGHT",  0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, offsetof(PackedSkinnedVertex, BoneWeights), D3D11_INPUT_PER_VERTEX_DATA, 0 });
+    }
+}
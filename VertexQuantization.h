@@ -0,0 +1,74 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "AssetTypes.h"
+#include <DirectXPackedVector.h>
+#include <string>
+#include <vector>
+
+// Packed vertex for static meshes (16 bytes)
+// Matches DXGI_FORMAT_R16G16B16A16_FLOAT/UNORM, R16G16_SNORM, R16G16_FLOAT
+#pragma pack(push, 1)
+struct PackedStaticVertex {
+    uint16_t Position[4]; // Half (relative to PositionOffset) or UNorm16 (normalized to bounds). [3] is padding
+    int16_t Normal[2];    // Octahedral encoded unit normal, SNorm16
+    DirectX::PackedVector::HALF TexCoord[2];
+};
+
+// Packed vertex for skinned meshes (24 bytes)
+struct PackedSkinnedVertex {
+    PackedStaticVertex Base;
+    uint8_t BoneIndices[4]; // DXGI_FORMAT_R8G8B8A8_UINT
+    uint8_t BoneWeights[4]; // DXGI_FORMAT_R8G8B8A8_UNORM, always sums to 255
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PackedStaticVertex) == 16, "PackedStaticVertex must be 16 bytes");
+static_assert(sizeof(PackedSkinnedVertex) == 24, "PackedSkinnedVertex must be 24 bytes");
+
+// Requested position precision; static vs skinned layout is picked per mesh
+enum class PositionQuantization {
+    None,    // Keep the full 64 byte Vertex
+    Half,
+    UNorm16,
+};
+
+// Per-mesh quantization error report (max absolute errors over all vertices)
+struct VertexQuantizationReport {
+    VertexFormat Format = VertexFormat::Full;
+    size_t SourceBytes = 0;
+    size_t PackedBytes = 0;
+    float MaxPositionError = 0.0f;      // Model units
+    float MaxNormalErrorDegrees = 0.0f;
+    float MaxTexCoordError = 0.0f;
+    float MaxBoneWeightError = 0.0f;
+    std::string Error; // Non-empty if the mesh could not be packed (it stays Full)
+};
+
+class VertexQuantization {
+public:
+    // Returns the vertex stride in bytes of a cooked layout
+    static UINT GetVertexStride(VertexFormat format);
+    static bool IsSkinned(VertexFormat format);
+
+    // True if any vertex carries a non-zero bone weight
+    static bool HasSkinningData(const Mesh& mesh);
+
+    // Packs mesh.Vertices into mesh.PackedVertices. Skinned layouts are chosen when the
+    // mesh has bone weights. Updates PackedFormat, VertexStride and the position transform.
+    static VertexQuantizationReport PackMesh(Mesh& mesh, PositionQuantization quantization);
+
+    // Decodes vertex 'index' from mesh.PackedVertices (or returns the source Vertex for Full)
+    static Vertex DecodeVertex(const Mesh& mesh, size_t index);
+
+    // Octahedral normal encoding helpers
+    static void EncodeOctahedral(const DirectX::XMFLOAT3& normal, int16_t outEncoded[2]);
+    static DirectX::XMFLOAT3 DecodeOctahedral(const int16_t encoded[2]);
+
+    // Fills the D3D11 input layout for a cooked format (semantic names match 'Vertex')
+    static void GetInputLayout(VertexFormat format, std::vector<D3D11_INPUT_ELEMENT_DESC>& outLayout);
+};
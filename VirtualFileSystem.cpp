@@ -0,0 +1,376 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "VirtualFileSystem.h"
+#include "Timing.h"
+#include "AssetCache.h"
+#include "BlockCompression.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+namespace {
+
+// Small loose files are cheaper to read than to map (mapping costs a section object and page faults)
+constexpr size_t LOOSE_MAP_THRESHOLD = 64 * 1024;
+
+} // namespace
+
+// --- MappedFile ---
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::wstring& path) {
+    Close();
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < 0) {
+        Close();
+        return false;
+    }
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    if (m_size == 0) {
+        return true; // Empty files can't be mapped, and don't need to be
+    }
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping) {
+        m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!m_view) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_view) {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+    m_size = 0;
+}
+
+// --- VirtualFileSystem ---
+
+VirtualFileSystem& VirtualFileSystem::Get() {
+    static VirtualFileSystem fileSystem;
+    return fileSystem;
+}
+
+bool VirtualFileSystem::Mount(const std::wstring& packPath) {
+    auto pack = std::make_unique<PackFile>();
+    if (!pack->Open(packPath)) {
+        return false;
+    }
+    LogMessage("Mounted " + std::filesystem::path(packPath).string() + " (" + std::to_string(pack->GetEntryCount()) + " files)");
+    std::error_code ec;
+    std::filesystem::path workingDirectory = std::filesystem::current_path(ec);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_packs.push_back(std::move(pack));
+    m_workingDirectory = ec ? std::filesystem::path() : std::move(workingDirectory);
+    return true;
+}
+
+void VirtualFileSystem::UnmountAll() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_packs.clear(); // Outstanding FileViews keep their mappings alive
+}
+
+size_t VirtualFileSystem::GetMountCount() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_packs.size();
+}
+
+std::string VirtualFileSystem::NormalizePath(const std::wstring& path) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return PackFile::NormalizePath(path, m_workingDirectory);
+}
+
+bool VirtualFileSystem::ReadFromPacks(const std::string& normalizedPath, FileView& outFile) {
+    StringId pathId(StringId::Hash(normalizedPath.data(), normalizedPath.size()));
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    for (auto it = m_packs.rbegin(); it != m_packs.rend(); ++it) {
+        const PackEntry* entry = (*it)->Find(pathId);
+        if (!entry) {
+            continue;
+        }
+        const uint8_t* data = (*it)->GetStoredData(*entry);
+        if (data) {
+            outFile = FileView((*it)->GetMapping(), data, static_cast<size_t>(entry->Size));
+            return true;
+        }
+
+        auto bytes = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(entry->Size));
+        if (!(*it)->ReadRange(*entry, 0, bytes->size(), bytes->data(), m_jobSystem)) {
+            LogMessage("Failed to decompress " + normalizedPath);
+            return false;
+        }
+        const uint8_t* decoded = bytes->data();
+        size_t byteCount = bytes->size();
+        outFile = FileView(std::move(bytes), decoded, byteCount);
+        std::lock_guard<std::mutex> statsLock(m_statsMutex);
+        m_stats.DecompressedReads++;
+        return true;
+    }
+    return false;
+}
+
+bool VirtualFileSystem::DecompressPayload(FileView& file) {
+    if (!BlockCompressor::IsCompressed(file.Data(), file.Size())) {
+        return true;
+    }
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    if (!BlockCompressor::Decompress(file.Data(), file.Size(), *bytes, m_jobSystem)) {
+        return false;
+    }
+    const uint8_t* decoded = bytes->data();
+    size_t byteCount = bytes->size();
+    file = FileView(std::move(bytes), decoded, byteCount);
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.DecompressedReads++;
+    return true;
+}
+
+bool VirtualFileSystem::ReadLoose(const std::wstring& path, FileView& outFile) {
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    if (size < LOOSE_MAP_THRESHOLD) {
+        auto bytes = std::make_shared<std::vector<uint8_t>>();
+        if (!AssetCache::ReadFile(path, *bytes)) {
+            return false;
+        }
+        const uint8_t* data = bytes->data();
+        size_t byteCount = bytes->size();
+        outFile = FileView(std::move(bytes), data, byteCount);
+        return true;
+    }
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->Open(path)) {
+        return false;
+    }
+    const uint8_t* data = mapping->Data();
+    size_t byteCount = mapping->Size();
+    outFile = FileView(std::move(mapping), data, byteCount);
+    return true;
+}
+
+bool VirtualFileSystem::ReadFile(const std::wstring& path, FileView& outFile) {
+    bool fromPack = false;
+    bool found = m_looseOverride && ReadLoose(path, outFile);
+    if (!found) {
+        found = fromPack = ReadFromPacks(NormalizePath(path), outFile);
+    }
+    if (!found && !m_looseOverride) {
+        found = ReadLoose(path, outFile);
+    }
+    if (found && !DecompressPayload(outFile)) {
+        LogMessage("Corrupt compressed payload " + std::filesystem::path(path).string());
+        found = false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    if (!found) {
+        m_stats.Misses++;
+    } else if (fromPack) {
+        m_stats.PackReads++;
+    } else {
+        m_stats.LooseReads++;
+    }
+    return found;
+}
+
+bool VirtualFileSystem::ReadRange(const std::wstring& path, uint64_t offset, size_t length, std::vector<uint8_t>& outData) {
+    outData.resize(length);
+    // Loose files are mapped whole, only the range is decoded
+    auto readLoose = [&]() {
+        FileView file;
+        if (!ReadLoose(path, file)) {
+            return false;
+        }
+        if (BlockCompressor::IsCompressed(file.Data(), file.Size())) {
+            return BlockCompressor::DecompressRange(file.Data(), file.Size(), offset, length, outData.data(), m_jobSystem);
+        }
+        if (offset > file.Size() || length > file.Size() - offset) {
+            return false;
+        }
+        std::memcpy(outData.data(), file.Data() + offset, length);
+        return true;
+    };
+    if (m_looseOverride && readLoose()) {
+        return true;
+    }
+
+    std::string normalizedPath = NormalizePath(path);
+    StringId pathId(StringId::Hash(normalizedPath.data(), normalizedPath.size()));
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        for (auto it = m_packs.rbegin(); it != m_packs.rend(); ++it) {
+            const PackEntry* entry = (*it)->Find(pathId);
+            if (!entry) {
+                continue;
+            }
+            const uint8_t* data = (*it)->GetStoredData(*entry);
+            if (data && BlockCompressor::IsCompressed(data, static_cast<size_t>(entry->Size))) {
+                // Block compressed cooked payload, stored as is
+                return BlockCompressor::DecompressRange(data, static_cast<size_t>(entry->Size), offset, length, outData.data(), m_jobSystem);
+            }
+            return (*it)->ReadRange(*entry, offset, length, outData.data(), m_jobSystem);
+        }
+    }
+    return !m_looseOverride && readLoose();
+}
+
+bool VirtualFileSystem::ReadPacked(const std::wstring& path, FileView& outFile) {
+    if (m_looseOverride) {
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec)) {
+            return false;
+        }
+    }
+    if (!ReadFromPacks(NormalizePath(path), outFile)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.PackReads++;
+    return true;
+}
+
+VfsStats VirtualFileSystem::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+bool VirtualFileSystem::RunStartupBenchmark(const std::wstring& directory) {
+    auto collect = [&directory]() {
+        std::vector<std::wstring> files;
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator it(directory, ec), endIt; !ec && it != endIt; it.increment(ec)) {
+            if (it->is_regular_file(ec) && it->path().extension() != L".agp") {
+                files.push_back(it->path().wstring());
+            }
+        }
+        return files;
+    };
+
+    std::vector<std::wstring> files = collect();
+    if (files.empty()) {
+        // Synthetic set shaped like a game's loose assets: mostly small, a few large
+        std::cout << "Virtual File System: No files in the directory, generating 2000 synthetic assets." << std::endl;
+        std::mt19937 random(3);
+        std::uniform_int_distribution<int> smallSize(512, 48 * 1024);
+        std::error_code ec;
+        for (int i = 0; i < 2000; ++i) {
+            std::filesystem::path folder = std::filesystem::path(directory) / (i % 4 == 0 ? L"Sounds" : i % 4 == 1 ? L"Images" : L"Models");
+            std::filesystem::create_directories(folder, ec);
+            std::vector<uint8_t> bytes(i % 100 == 0 ? 2 * 1024 * 1024 : static_cast<size_t>(smallSize(random)));
+            for (size_t b = 0; b < bytes.size(); ++b) bytes[b] = static_cast<uint8_t>(random());
+            std::filesystem::path file = folder / (L"asset_" + std::to_wstring(i) + L".bin");
+            if (!AssetCache::WriteFileAtomic(file, bytes.data(), bytes.size())) {
+                return false;
+            }
+        }
+        files = collect();
+    }
+
+    // Sum of every byte, so both passes touch all the data
+    auto touch = [](const FileView& file) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < file.Size(); ++i) sum += file.Data()[i];
+        return sum;
+    };
+
+    uint64_t looseChecksum = 0, looseBytes = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const std::wstring& file : files) {
+        FileView view;
+        if (!ReadLoose(file, view)) {
+            std::cerr << "Virtual File System: Failed to read " << std::filesystem::path(file).string() << std::endl;
+            return false;
+        }
+        looseChecksum += touch(view);
+        looseBytes += view.Size();
+    }
+    double looseSeconds = SecondsSince(start);
+
+    std::wstring packPath = (std::filesystem::path(directory).parent_path() / L"VfsBenchmark.agp").wstring();
+    if (std::filesystem::path(directory).parent_path().empty()) {
+        packPath = L"VfsBenchmark.agp";
+    }
+    start = std::chrono::high_resolution_clock::now();
+    if (!PackWriter::PackDirectory(directory, packPath)) {
+        return false;
+    }
+    double packSeconds = SecondsSince(start);
+
+    uint64_t packedChecksum = 0;
+    double mountSeconds = 0.0, lookupSeconds = 0.0;
+    bool ok = true;
+    {
+        VirtualFileSystem fileSystem;
+        start = std::chrono::high_resolution_clock::now();
+        ok = fileSystem.Mount(packPath);
+        mountSeconds = SecondsSince(start);
+
+        std::vector<std::string> normalized;
+        normalized.reserve(files.size());
+        for (const std::wstring& file : files) normalized.push_back(fileSystem.NormalizePath(file));
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < files.size() && ok; ++i) {
+            FileView view;
+            ok = fileSystem.ReadFromPacks(normalized[i], view);
+            packedChecksum += ok ? touch(view) : 0;
+        }
+        lookupSeconds = SecondsSince(start);
+    }
+    std::error_code ec;
+    std::filesystem::remove(packPath, ec);
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2);
+    report << "Virtual File System startup benchmark: " << files.size() << " files, " << looseBytes / (1024.0 * 1024.0) << " MB (OS cache warm for both)\n"
+           << "  Loose:  " << files.size() << " opens, " << looseSeconds * 1000.0 << " ms\n"
+           << "  Packed: 1 open, mount " << mountSeconds * 1000.0 << " ms + reads " << lookupSeconds * 1000.0 << " ms = "
+           << (mountSeconds + lookupSeconds) * 1000.0 << " ms (" << std::setprecision(1)
+           << looseSeconds / std::max(mountSeconds + lookupSeconds, 1e-9) << "x)\n"
+           << "  Packing took " << std::setprecision(2) << packSeconds * 1000.0 << " ms\n";
+    if (!ok || packedChecksum != looseChecksum) {
+        report << "  FAILED: packed contents differ from the loose files\n";
+        ok = false;
+    }
+    std::cout << report.str() << std::flush;
+    OutputDebugStringA(report.str().c_str());
+    return ok;
+}
+
+void VirtualFileSystem::LogMessage(const std::string& message) const {
+    std::string line = "Virtual File System: " + message + "\n";
+    std::cout << line;
+    OutputDebugStringA(line.c_str());
+}
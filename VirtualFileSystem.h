@@ -0,0 +1,115 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "PackFile.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::wstring& path);
+    void Close();
+
+    const uint8_t* Data() const { return m_view; }
+    size_t Size() const { return m_size; }
+
+private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const uint8_t* m_view = nullptr;
+    size_t m_size = 0;
+};
+
+// Bytes of one file: a span into a mapped pack or mapped loose file, or an owned buffer
+// (decompressed data).
+// Keeps its mapping alive; cheap to move, not copyable.
+class FileView {
+public:
+    FileView() = default;
+    FileView(std::shared_ptr<const void> owner, const uint8_t* data, size_t size)
+        : m_owner(std::move(owner)), m_data(data), m_size(size) {}
+    FileView(FileView&&) noexcept = default;
+    FileView& operator=(FileView&&) noexcept = default;
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+
+    const uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+    bool IsValid() const { return m_owner != nullptr; }
+
+private:
+    std::shared_ptr<const void> m_owner; // MappedFile or std::vector<uint8_t>
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+struct VfsStats {
+    size_t PackReads = 0;
+    size_t LooseReads = 0;
+    size_t Misses = 0;
+    size_t DecompressedReads = 0; // Compressed pack entries and block compressed cooked payloads
+};
+
+// Resolves asset paths against mounted packs (newest mount first), then loose files.
+// AudioManager, D2DRenderer, ModelSerializer and AssetManager read through it.
+// ReadFile returns decompressed bytes: compressed pack entries and block compressed cooked
+// payloads (BlockCompression.h) are decoded in parallel on the job system when one is set.
+class VirtualFileSystem {
+public:
+    static VirtualFileSystem& Get();
+
+    bool Mount(const std::wstring& packPath);
+    void UnmountAll();
+    size_t GetMountCount() const;
+
+    // Loose files win over packs when set (hot reload writes loose cooked files)
+    void SetLooseOverride(bool looseOverride) { m_looseOverride = looseOverride; }
+    // Decompression runs on these workers (set once at startup, before loading)
+    void SetJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+    bool ReadFile(const std::wstring& path, FileView& outFile);
+    // Bytes [offset, offset + length) of a file; compressed files only decode the blocks overlapping the range
+    bool ReadRange(const std::wstring& path, uint64_t offset, size_t length, std::vector<uint8_t>& outData);
+    // Pack-only read for callers with their own loose path (AssetManager's aligned reads). Pack
+    // compression is undone, cooked payload compression is not. False when no pack has 'path',
+    // or the loose override is set and the loose file exists.
+    bool ReadPacked(const std::wstring& path, FileView& outFile);
+
+    VfsStats GetStats() const;
+
+    // Reads every file below 'directory' loose, then from a pack built from it, and reports
+    // open count and time for both (WinMain "-vfsbench <directory>")
+    static bool RunStartupBenchmark(const std::wstring& directory);
+
+private:
+    mutable std::shared_mutex m_mutex;
+    std::vector<std::unique_ptr<PackFile>> m_packs; // Searched back to front
+    std::filesystem::path m_workingDirectory;       // At the last Mount; absolute paths below it are looked up relative
+    std::atomic<bool> m_looseOverride{ false };
+    JobSystem* m_jobSystem = nullptr;
+
+    mutable std::mutex m_statsMutex;
+    VfsStats m_stats;
+
+    std::string NormalizePath(const std::wstring& path) const;
+    bool ReadFromPacks(const std::string& normalizedPath, FileView& outFile);
+    bool DecompressPayload(FileView& file);
+    static bool ReadLoose(const std::wstring& path, FileView& outFile);
+    void LogMessage(const std::string& message) const;
+};
@@ -4,16 +4,150 @@
 
 #include "pch.h"
 #include "WinMain.h"
+#include "HeadlessTools.h"
 #include "AssetTypes.h" // Make sure asset types are included if used directly here
+#include "ModelSerializer.h"
+#include "TextureCooker.h"
+#include "BlockCompression.h"
+#include "VirtualFileSystem.h"
+#include "AnimationSampler.h"
+#include "PoseEvaluator.h"
+#include "CpuSkinning.h"
+#include "Meshlets.h"
 
 // For ComPtr<> and other WRL utilities
 using namespace Microsoft::WRL;
 using namespace DirectX; // For math types if needed directly
 
+namespace {
+
+// Runs 'fn' with worker threads up and returns the exit code of its result
+template <typename Fn>
+int RunWithJobSystem(const Fn& fn) {
+    JobSystem jobSystem;
+    jobSystem.Initialize();
+    bool passed = fn(jobSystem);
+    jobSystem.Shutdown();
+    return passed ? 0 : 1;
+}
+
+// Tests and benchmarks run instead of the game: "<flag> [arguments]", exit code 0 when they pass.
+// The ones without Windows dependencies are in HEADLESS_TOOLS.
+const CommandLineTool COMMAND_LINE_TOOLS[] = {
+    { L"-assettest", L"[directory]: loads every file in the directory through the AssetManager and reports throughput",
+      [](const CommandLineArguments& arguments) {
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              return AssetManager::RunThroughputTest(GetArgument(arguments, 0, L"Assets"), &jobSystem);
+          });
+      } },
+    { L"-modelalloctest", L"[file.agm]: compares heap allocations of a cooked model load (a synthetic model without one) with and without its arena",
+      [](const CommandLineArguments& arguments) {
+          return ModelSerializer::RunAllocationTest(GetArgument(arguments, 0, L"")) ? 0 : 1;
+      } },
+    { L"-texturebench", L"[directory]: encodes synthetic images plus any images in the directory to BC1/BC3/BC7 with mips and reports encode throughput and PSNR",
+      [](const CommandLineArguments& arguments) {
+          return TextureCooker::RunBenchmark(GetArgument(arguments, 0, L"Assets")) ? 0 : 1;
+      } },
+    { L"-pack", L"<directory> <pack.agp>: writes every file below the directory into one pack",
+      [](const CommandLineArguments& arguments) {
+          if (GetArgument(arguments, 1, L"").empty()) {
+              return 1;
+          }
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              return PackWriter::PackDirectory(GetArgument(arguments, 0, L""), GetArgument(arguments, 1, L""), PackWriterSettings(), &jobSystem);
+          });
+      } },
+    { L"-cook", L"<source directory> <output directory>: cooks every supported asset through the content hashed cache (Cache/Cook) and fails if any item fails. Models are reported as unsupported while ColladaParser is a placeholder.",
+      [](const CommandLineArguments& arguments) {
+          if (GetArgument(arguments, 1, L"").empty()) {
+              return 1;
+          }
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              AssetCooker cooker(jobSystem, CookSettings());
+              if (!cooker.Initialize(L"Cache/Cook")) {
+                  return false;
+              }
+              CookReport report = cooker.CookDirectory(GetArgument(arguments, 0, L""), GetArgument(arguments, 1, L"")); // Prints the report
+              return report.Failures == 0;
+          });
+      } },
+    { L"-modelreloadtest", L"(no arguments): cooks hand-built models with shared geometry into Cache/ModelReloadTest, loads one through the AssetManager and checks an edited cook hot-reloads behind the existing handle",
+      [](const CommandLineArguments&) {
+          return RunWithJobSystem([](JobSystem& jobSystem) {
+              return AssetHotReloader::RunModelReloadTest(L"Cache/ModelReloadTest", jobSystem);
+          });
+      } },
+    { L"-meshletbench", L"[file.agm]: culls the meshlets of a cooked model (a synthetic sphere without one) from views orbiting it and reports clusters culled per microsecond",
+      [](const CommandLineArguments& arguments) {
+          return MeshletCuller::RunBenchmark(GetArgument(arguments, 0, L"")) ? 0 : 1;
+      } },
+    { L"-animbench", L"[instances]: samples a synthetic 60 joint clip on many instances with keyframe cursors and with binary search, and reports joints sampled per millisecond",
+      [](const CommandLineArguments& arguments) {
+          return AnimationSampler::RunBenchmark(GetCountArgument(arguments, 0, 1000)) ? 0 : 1;
+      } },
+    { L"-posebench", L"[instances]: resolves random poses of a 60 joint skeleton with recursive parent lookups, the parents-first linear pass and the pass batched on the job system",
+      [](const CommandLineArguments& arguments) {
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              return PoseEvaluator::RunBenchmark(GetCountArgument(arguments, 0, 1000), 60, &jobSystem);
+          });
+      } },
+    { L"-animsysbench", L"[characters]: updates blend trees of many characters on the calling thread and on the job system and reports characters per millisecond and the speedup",
+      [](const CommandLineArguments& arguments) {
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              return AnimationSystem::RunBenchmark(GetCountArgument(arguments, 0, 500), &jobSystem);
+          });
+      } },
+    { L"-animlodbench", L"[characters]: compares full-detail animation with distance LOD for a crowd seen by two split-screen cameras and reports the work saved and the pose error",
+      [](const CommandLineArguments& arguments) {
+          return AnimationSystem::RunLodBenchmark(GetCountArgument(arguments, 0, 1000)) ? 0 : 1;
+      } },
+    { L"-crowdbench", L"[agents]: animates a crowd playing three clips with and without the shared pose cache and reports the hit rate and the time saved",
+      [](const CommandLineArguments& arguments) {
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              return AnimationSystem::RunCrowdBenchmark(GetCountArgument(arguments, 0, 5000), &jobSystem);
+          });
+      } },
+    { L"-dqbench", L"[characters]: cooks the animation benchmark clips to dual quaternion keys and compares dual quaternion palettes with converted matrix palettes",
+      [](const CommandLineArguments& arguments) {
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              return AnimationSystem::RunDualQuaternionBenchmark(GetCountArgument(arguments, 0, 500), &jobSystem);
+          });
+      } },
+    { L"-skinbench", L"[vertices]: skins a synthetic twisted tube with linear blend and dual quaternion skinning, scalar and AVX2, single-threaded and on the job system",
+      [](const CommandLineArguments& arguments) {
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              return CpuSkinning::RunBenchmark(GetCountArgument(arguments, 0, 200000), &jobSystem);
+          });
+      } },
+    { L"-lzbench", L"[file or directory]: block compresses the files (synthetic cooked data when there are none) and reports ratio and single-threaded / parallel decode throughput",
+      [](const CommandLineArguments& arguments) {
+          return RunWithJobSystem([&](JobSystem& jobSystem) {
+              return BlockCompressor::RunBenchmark(GetArgument(arguments, 0, L"Cooked"), jobSystem);
+          });
+      } },
+    { L"-vfsbench", L"[directory]: reads every file loose, then through a pack of the same files",
+      [](const CommandLineArguments& arguments) {
+          return VirtualFileSystem::RunStartupBenchmark(GetArgument(arguments, 0, L"Assets")) ? 0 : 1;
+      } },
+    { L"-audiostress", L"[plays per second]: fires short sounds on the pooled voices for five seconds and checks that no voice is created while playing and every finished voice is reclaimed",
+      [](const CommandLineArguments& arguments) {
+          return AudioManager::RunStressTest(GetCountArgument(arguments, 0, 1000)) ? 0 : 1;
+      } },
+};
+
+} // namespace
+
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPWSTR lpCmdLine, _In_ int nCmdShow)
 {
     UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
+
+    // Tests and benchmarks exit without opening a window
+    CommandLineArguments arguments = SplitCommandLine(lpCmdLine ? lpCmdLine : L"");
+    int exitCode = 0;
+    if (RunCommandLineTool(HEADLESS_TOOLS, HEADLESS_TOOL_COUNT, arguments, exitCode) ||
+        RunCommandLineTool(COMMAND_LINE_TOOLS, std::size(COMMAND_LINE_TOOLS), arguments, exitCode)) {
+        return exitCode;
+    }
 
     HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
     if (FAILED(hr)) {
@@ -256,6 +390,11 @@ bool InitializeManagers() {
         return false;
     }
 
+    // Shipping builds read assets from Assets.agp ("-pack Assets Assets.agp"); loose files are the fallback
+    if (std::filesystem::exists(L"Assets.agp")) {
+        VirtualFileSystem::Get().Mount(L"Assets.agp");
+    }
+
     // Audio Manager
     g_audioManager = std::make_unique<AudioManager>();
     if (!g_audioManager || !g_audioManager->Initialize()) {
@@ -294,11 +433,43 @@ bool InitializeManagers() {
     g_gameTimer->Reset();
 
 
-    // Asset Manager / Collada Parser (Initialize later when needed)
+    // Job System (worker threads, the main thread helps while waiting)
+    g_jobSystem = std::make_unique<JobSystem>();
+    if (!g_jobSystem || !g_jobSystem->Initialize()) return false;
+    VirtualFileSystem::Get().SetJobSystem(g_jobSystem.get()); // Parallel block decompression
+
+    // Animation System (every character's blend tree, pose and palette as jobs, once per frame)
+    g_animationSystem = std::make_unique<AnimationSystem>();
+    g_animationSystem->Initialize(g_jobSystem.get());
+
+
+    // Asset Manager (I/O thread + decode jobs; waves / images are registered with audio / D2D when ready)
+    g_assetManager = std::make_unique<AssetManager>();
+    if (!g_assetManager || !g_assetManager->Initialize(g_jobSystem.get(), g_audioManager.get(), g_d2dRenderer.get())) return false;
+    // g_assetManager->Load(L"Assets/Sounds/jump.wav", AssetType::Wave, ASSET_PRIORITY_HIGH, "jump");
+    // g_assetManager->Load(L"Assets/Images/crosshair.png", AssetType::Image, ASSET_PRIORITY_CRITICAL, "crosshair");
+
+#ifdef _DEBUG
+    // Hot reload: edits under Assets/ are re-cooked into Cooked/ and swapped in behind existing handles
+    g_assetCooker = std::make_unique<AssetCooker>(*g_jobSystem, CookSettings());
+    g_hotReloader = std::make_unique<AssetHotReloader>(*g_assetManager, *g_jobSystem);
+    VirtualFileSystem::Get().SetLooseOverride(true); // Edited loose files win over a stale pack
+    if (!g_assetCooker->Initialize(L"Cache/Cook") || !g_hotReloader->Start(L"Assets", g_assetCooker.get(), L"Cooked")) {
+        g_hotReloader.reset(); // Not fatal, e.g. no Assets directory next to the executable
+    }
+#endif
+
+    // Collada Parser (Initialize later when needed)
     // g_colladaParser = std::make_unique<ColladaParser>();
-    // g_assetManager = std::make_unique<AssetManager>();
     // Model testModel;
     // g_colladaParser->ParseFile(L"Assets/Models/character.dae", testModel); // Placeholder!
+    // ModelCooker modelCooker; // Vertex cache / overdraw / vertex fetch optimization
+    // modelCooker.Cook(testModel, "character");
+    // Incremental cook of Assets/ (unchanged files come from the content hashed cache):
+    // AssetCooker assetCooker(*g_jobSystem, CookSettings());
+    // if (assetCooker.Initialize(L"Cache/Cook")) {
+    //     assetCooker.CookDirectory(L"Assets", L"Cooked"); // Prints hits / misses / time saved
+    // }
 
     return true;
 }
@@ -385,8 +556,14 @@ void Update(float deltaTime) {
      // 1. Update Input Manager (reads current state)
      g_inputManager->Update();
 
-     // 2. Update Audio System (e.g., check for finished sounds, stream data)
-     // g_audioManager->Update(); // Add if needed
+     // 2. Update Audio System (returns finished sound effect voices to their pools)
+     g_audioManager->Update();
+
+     // Publish assets that finished loading (or hot reloading) since last frame (never blocks)
+#ifdef _DEBUG
+     if (g_hotReloader) g_hotReloader->Update();
+#endif
+     g_assetManager->Update();
 
      // 3. Update Physics
      g_physicsManager->Update(deltaTime);
@@ -440,6 +617,16 @@ void Update(float deltaTime) {
          }
      }
 
+     // Animate every character in one pass of jobs (after game logic has set blend parameters);
+     // GetPalette() then holds all skinning matrices for one upload in Render().
+     // Animation LOD follows every active player's view.
+     std::vector<AnimationLodView> lodViews;
+     for (int i = 0; i < g_activePlayers && i < static_cast<int>(g_viewports.size()); ++i) {
+         if (g_players[i].isActive) lodViews.push_back({ &g_players[i].camera, g_viewports[i].Height });
+     }
+     g_animationSystem->SetLodViews(lodViews);
+     g_animationSystem->Update(deltaTime);
+
      // 5. Update UI Text (example)
      static float fps = 0.0f;
      static int frameCount = 0;
@@ -464,6 +651,13 @@ void Update(float deltaTime) {
       if(pObj) {
            debugTextStream << L"P0 Phys: (" << pObj->Position.x << L", " << pObj->Position.y << L", " << pObj->Position.z << L")" << std::endl;
       }
+      const AnimationSystemStats& animStats = g_animationSystem->GetStats();
+      if (animStats.Instances > 0) {
+           debugTextStream << L"Anim: " << animStats.PosesEvaluated << L"/" << animStats.Instances << L" evaluated, LOD "
+                           << animStats.LodInstances[0] << L"/" << animStats.LodInstances[1] << L"/" << animStats.LodInstances[2]
+                           << L", " << animStats.CacheEntries << L" shared (" << animStats.GetCacheHitRate() * 100.0f << L"% hits), "
+                           << animStats.UpdateMilliseconds << L" ms" << std::endl;
+      }
 
      // Recreate text layout for dynamic text
       g_debugTextLayout = g_d2dRenderer->CreateTextLayout(
@@ -590,6 +784,15 @@ void Render() {
 
           // TODO: Draw the models/scene geometry
           // g_d3dContext->DrawIndexed(modelMesh.IndexCount, 0, 0);
+          // With a cooked LOD chain, pick the level per viewport:
+          // size_t lod = MeshSimplifier::SelectLod(modelMesh, g_players[i].camera, modelPosition, 1.0f, g_viewports[i].Height);
+          // UINT startIndex, indexCount;
+          // MeshSimplifier::GetLodDrawRange(modelMesh, lod, startIndex, indexCount);
+          // g_d3dContext->DrawIndexed(indexCount, startIndex, 0);
+          // Scene nodes share meshes, so draw them as instances (MeshInstancing.h), once per distinct geometry:
+          // batcher.Clear(); batcher.AddModel(*model, world); ...; batcher.Build();
+          // (upload batcher.GetTransforms() to the per-instance vertex buffer, then per batch:)
+          // g_d3dContext->DrawIndexedInstanced(batch.pMesh->IndexCount, batch.InstanceCount, 0, 0, batch.FirstInstance);
 
           // --- Example: Draw Physics Object Bounding Boxes (Debug) ---
           // Need a simple cube mesh and appropriate shaders/state
@@ -866,16 +1069,26 @@ void UpdateViewports() {
 }
 
 void ShutdownManagers() {
+#ifdef _DEBUG
+     g_hotReloader.reset(); // Waits for its cook jobs
+     g_assetCooker.reset();
+#endif
+     if(g_assetManager) g_assetManager->Shutdown(); // First: decode jobs may use the D2D WIC factory
      if(g_inputManager) g_inputManager->Shutdown();
      if(g_audioManager) g_audioManager->Shutdown();
      if(g_d2dRenderer) g_d2dRenderer->Shutdown();
      if(g_physicsManager) g_physicsManager->Shutdown();
+     VirtualFileSystem::Get().SetJobSystem(nullptr);
+     if(g_jobSystem) g_jobSystem->Shutdown();
 
      g_inputManager.reset();
      g_audioManager.reset();
      g_d2dRenderer.reset();
      g_physicsManager.reset();
      g_gameTimer.reset();
+     g_assetManager.reset();
+     g_animationSystem.reset(); // Before the job system it runs on
+     g_jobSystem.reset();
      // Reset other managers
 }
 
@@ -12,6 +12,10 @@
 #include "Camera.h"
 #include "PhysicsManager.h"
 #include "GameTimer.h"
+#include "JobSystem.h"
+#include "AssetManager.h"
+#include "AssetHotReload.h"
+#include "AnimationSystem.h"
 #include "AssetTypes.h" // Include asset types
 
 // Forward Declarations
@@ -21,6 +25,8 @@ class D2DRenderer;
 class Camera;
 class PhysicsManager;
 class GameTimer;
+class JobSystem;
+class AssetManager;
 struct PlayerState;
 
 
@@ -37,7 +43,13 @@ std::unique_ptr<AudioManager>    g_audioManager;
 std::unique_ptr<D2DRenderer>     g_d2dRenderer;
 std::unique_ptr<PhysicsManager>  g_physicsManager;
 std::unique_ptr<GameTimer>       g_gameTimer;
-// std::unique_ptr<AssetManager> g_assetManager; // Add later
+std::unique_ptr<JobSystem>       g_jobSystem; // Worker threads for cooking / loading / animation jobs
+std::unique_ptr<AssetManager>    g_assetManager; // Async loads, completed assets published in Update()
+std::unique_ptr<AnimationSystem> g_animationSystem; // Character poses and skinning palettes, updated as jobs
+#ifdef _DEBUG
+std::unique_ptr<AssetCooker>      g_assetCooker;   // Re-cooks sources changed while the game runs
+std::unique_ptr<AssetHotReloader> g_hotReloader;
+#endif
 // std::unique_ptr<ColladaParser> g_colladaParser; // Add later if needed
 
 
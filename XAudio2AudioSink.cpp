@@ -0,0 +1,72 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#include "pch.h"
+#include "XAudio2AudioSink.h"
+
+bool XAudio2AudioSink::Open(uint32_t sampleRate, uint32_t channelCount) {
+    Close();
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED); // May already be initialized
+    if (FAILED(XAudio2Create(&m_pXAudio2, 0)) || FAILED(m_pXAudio2->CreateMasteringVoice(&m_pMasterVoice))) {
+        OutputDebugString(L"Failed to create the XAudio2 engine for the mixer sink.\n");
+        Close();
+        return false;
+    }
+
+    WAVEFORMATEX format = {};
+    format.wFormatTag = WAVE_FORMAT_IEEE_FLOAT;
+    format.nChannels = static_cast<WORD>(channelCount);
+    format.nSamplesPerSec = sampleRate;
+    format.wBitsPerSample = 32;
+    format.nBlockAlign = static_cast<WORD>(channelCount * sizeof(float));
+    format.nAvgBytesPerSec = sampleRate * format.nBlockAlign;
+    m_callback.BufferEndEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!m_callback.BufferEndEvent || FAILED(m_pXAudio2->CreateSourceVoice(&m_pSourceVoice, &format, 0, XAUDIO2_DEFAULT_FREQ_RATIO, &m_callback))) {
+        OutputDebugString(L"Failed to create the mixer sink voice.\n");
+        Close();
+        return false;
+    }
+    m_channelCount = channelCount;
+    m_buffers.assign(m_bufferCount, std::vector<float>());
+    m_nextBuffer = 0;
+    return SUCCEEDED(m_pSourceVoice->Start(0));
+}
+
+bool XAudio2AudioSink::Write(const float* frames, size_t frameCount) {
+    if (!m_pSourceVoice) {
+        return false;
+    }
+    XAUDIO2_VOICE_STATE state;
+    for (m_pSourceVoice->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED); state.BuffersQueued >= m_bufferCount;
+         m_pSourceVoice->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED)) {
+        WaitForSingleObject(m_callback.BufferEndEvent, INFINITE);
+    }
+
+    // The oldest buffer has played; queued buffers are never reused
+    std::vector<float>& buffer = m_buffers[m_nextBuffer];
+    m_nextBuffer = (m_nextBuffer + 1) % m_buffers.size();
+    buffer.assign(frames, frames + frameCount * m_channelCount);
+    XAUDIO2_BUFFER submit = {0};
+    submit.AudioBytes = static_cast<UINT32>(buffer.size() * sizeof(float));
+    submit.pAudioData = reinterpret_cast<const BYTE*>(buffer.data());
+    return SUCCEEDED(m_pSourceVoice->SubmitSourceBuffer(&submit));
+}
+
+void XAudio2AudioSink::Close() {
+    if (m_pSourceVoice) {
+        m_pSourceVoice->Stop();
+        m_pSourceVoice->DestroyVoice(); // Waits for the callbacks
+        m_pSourceVoice = nullptr;
+    }
+    if (m_pMasterVoice) {
+        m_pMasterVoice->DestroyVoice();
+        m_pMasterVoice = nullptr;
+    }
+    m_pXAudio2.Reset();
+    if (m_callback.BufferEndEvent) {
+        CloseHandle(m_callback.BufferEndEvent);
+        m_callback.BufferEndEvent = nullptr;
+    }
+    m_buffers.clear();
+}
@@ -0,0 +1,44 @@
+// Agrona
+// Copyright (c) 2025 CGLJ08. All rights reserved.
+// This project includes code derived from Microsoft's MSDN samples. See the LICENSE file for details.
+
+#pragma once
+
+#include "pch.h"
+#include "SoftwareMixer.h"
+#include <vector>
+
+// Streams the output to a float XAudio2 source voice on an engine of its own. Write blocks while
+// 'bufferCount' buffers are queued, which paces the mixer to the device.
+class XAudio2AudioSink : public AudioSink {
+public:
+    explicit XAudio2AudioSink(size_t bufferCount = 3) : m_bufferCount(std::max<size_t>(bufferCount, 2)) {}
+    ~XAudio2AudioSink() override { Close(); }
+
+    bool Open(uint32_t sampleRate, uint32_t channelCount) override;
+    bool Write(const float* frames, size_t frameCount) override;
+    void Close() override;
+
+private:
+    // Signals the sink when XAudio2 is done with a buffer
+    class VoiceCallback : public IXAudio2VoiceCallback {
+    public:
+        HANDLE BufferEndEvent = nullptr;
+        void STDMETHODCALLTYPE OnVoiceProcessingPassStart(UINT32) override {}
+        void STDMETHODCALLTYPE OnVoiceProcessingPassEnd() override {}
+        void STDMETHODCALLTYPE OnStreamEnd() override {}
+        void STDMETHODCALLTYPE OnBufferStart(void*) override {}
+        void STDMETHODCALLTYPE OnBufferEnd(void*) override { SetEvent(BufferEndEvent); }
+        void STDMETHODCALLTYPE OnLoopEnd(void*) override {}
+        void STDMETHODCALLTYPE OnVoiceError(void*, HRESULT) override {}
+    };
+
+    size_t m_bufferCount;
+    uint32_t m_channelCount = 0;
+    Microsoft::WRL::ComPtr<IXAudio2> m_pXAudio2;
+    IXAudio2MasteringVoice* m_pMasterVoice = nullptr;
+    IXAudio2SourceVoice* m_pSourceVoice = nullptr;
+    VoiceCallback m_callback;
+    std::vector<std::vector<float>> m_buffers; // Submitted round robin; each stays untouched while queued
+    size_t m_nextBuffer = 0;
+};
@@ -41,6 +41,7 @@
 #include <malloc.h>
 #include <map> // Added for potential asset management
 #include <chrono> // Added for timing
+#include <filesystem> // Added for asset cooking / cache paths
 
 // --- DirectX Includes ---
 #include <d3d11_4.h>